@@ -0,0 +1,53 @@
+/** =======================================================
+ *  \file Core/BindingPlan.h
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#ifndef CLEAN_BINDINGPLAN_H
+#define CLEAN_BINDINGPLAN_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Clean
+{
+    /** @brief How one EffectParameter of a parameters list is uploaded to a RenderPipeline. */
+    struct BindingPlanEntry
+    {
+        //! @brief Index of the EffectParameter in the parameters list.
+        std::uint32_t slot = 0;
+
+        //! @brief Hash of the EffectParameter expected at slot.
+        std::uint64_t hash = 0;
+
+        //! @brief Location of the parameter in the pipeline, as returned by RenderPipeline::findParameterLocation().
+        std::int32_t location = -1;
+
+        //! @brief kShaderParam* type uploaded.
+        std::uint8_t type = 0;
+
+        //! @brief Index of the parameter in the RenderPipeline's uploaded values cache.
+        std::uint32_t cache = 0;
+    };
+
+    /** @brief Precompiled binding of a parameters list to a RenderPipeline.
+     *
+     * A ShaderMapper compiles a BindingPlan once for a RenderPipeline and a parameters list layout, i.e.
+     * the hashes of the parameters in their order (see EffectSession::getLayout()). Binding the list is
+     * then a loop over entries: no mapping, no name nor location lookup. Parameters the pipeline doesn't
+     * use have no entry.
+     *
+    **/
+    struct BindingPlan
+    {
+        //! @brief Number of parameters in the list the plan was compiled for.
+        std::size_t parametersCount = 0;
+
+        //! @brief One entry per parameter uploaded, by increasing slot.
+        std::vector < BindingPlanEntry > entries;
+    };
+}
+
+#endif // CLEAN_BINDINGPLAN_H
@@ -0,0 +1,417 @@
+/** =======================================================
+ *  \file Core/BlockEncoder.cpp
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#include "BlockEncoder.h"
+#include "Allocate.h"
+#include "JobSystem.h"
+#include "NotificationCenter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace Clean
+{
+    /*! @brief Quantizes a color to RGB565. */
+    static std::uint16_t BlockPackRGB565(float const* color)
+    {
+        const int r = static_cast < int >(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+        const int g = static_cast < int >(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+        const int b = static_cast < int >(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+        return static_cast < std::uint16_t >((r << 11) | (g << 5) | b);
+    }
+
+    /*! @brief Expands a RGB565 color to 8 bits per channel, as the hardware does. */
+    static void BlockUnpackRGB565(std::uint16_t packed, int* color)
+    {
+        const int r = (packed >> 11) & 31;
+        const int g = (packed >> 5) & 63;
+        const int b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    /*! @brief Writes a 16 bits value in little endian. */
+    static void BlockWrite16(std::uint8_t* dest, std::uint16_t value)
+    {
+        dest[0] = static_cast < std::uint8_t >(value & 0xFF);
+        dest[1] = static_cast < std::uint8_t >(value >> 8);
+    }
+
+    void BlockEncodeBC1(const std::uint8_t* block, std::uint8_t* dest, bool allowAlpha)
+    {
+        assert(block && dest && "Null block given.");
+
+        // Computes the mean of every opaque pixels. Transparent pixels are only used when
+        // allowAlpha is true and are always encoded with index 3 in the 3-colors mode.
+
+        bool transparent[16];
+        bool hasAlpha = false;
+        float mean[3] = { 0.0f, 0.0f, 0.0f };
+        int count = 0;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const std::uint8_t* pixel = block + i * 4;
+            transparent[i] = allowAlpha && pixel[3] < 128;
+
+            if (transparent[i]) {
+                hasAlpha = true;
+                continue;
+            }
+
+            mean[0] += pixel[0];
+            mean[1] += pixel[1];
+            mean[2] += pixel[2];
+            count++;
+        }
+
+        if (!count)
+        {
+            BlockWrite16(dest, 0);
+            BlockWrite16(dest + 2, 0);
+            dest[4] = dest[5] = dest[6] = dest[7] = 0xFF;
+            return;
+        }
+
+        for (int c = 0; c < 3; ++c)
+            mean[c] /= static_cast < float >(count);
+
+        // Finds the principal axis of the colors with a few power iterations on the covariance
+        // matrix. Endpoints are the extremes of the colors projected on this axis, slightly inset
+        // to reduce the error on the middle colors.
+
+        float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+        for (int i = 0; i < 16; ++i)
+        {
+            if (transparent[i]) continue;
+            const std::uint8_t* pixel = block + i * 4;
+            const float r = pixel[0] - mean[0];
+            const float g = pixel[1] - mean[1];
+            const float b = pixel[2] - mean[2];
+            cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+            cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+        }
+
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+
+        for (int iteration = 0; iteration < 4; ++iteration)
+        {
+            const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+            const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+            const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+            const float norm = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+            if (norm < 1e-6f) break;
+            axis[0] = x / norm; axis[1] = y / norm; axis[2] = z / norm;
+        }
+
+        const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        for (int c = 0; c < 3; ++c) axis[c] /= axisLength;
+
+        float minT = 0.0f, maxT = 0.0f;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            if (transparent[i]) continue;
+            const std::uint8_t* pixel = block + i * 4;
+            const float t = (pixel[0] - mean[0]) * axis[0] + (pixel[1] - mean[1]) * axis[1] + (pixel[2] - mean[2]) * axis[2];
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        const float inset = (maxT - minT) / 16.0f;
+        minT += inset;
+        maxT -= inset;
+
+        float maxColor[3], minColor[3];
+        for (int c = 0; c < 3; ++c)
+        {
+            maxColor[c] = mean[c] + axis[c] * maxT;
+            minColor[c] = mean[c] + axis[c] * minT;
+        }
+
+        std::uint16_t c0 = BlockPackRGB565(maxColor);
+        std::uint16_t c1 = BlockPackRGB565(minColor);
+
+        // 4-colors mode needs c0 > c1, and 3-colors mode (with transparency) needs c0 <= c1.
+        if ((!hasAlpha && c0 < c1) || (hasAlpha && c0 > c1))
+            std::swap(c0, c1);
+
+        int palette[4][3];
+        BlockUnpackRGB565(c0, palette[0]);
+        BlockUnpackRGB565(c1, palette[1]);
+
+        int paletteSize = 4;
+
+        if (hasAlpha)
+        {
+            for (int c = 0; c < 3; ++c)
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            paletteSize = 3;
+        }
+
+        else
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+
+            if (c0 == c1)
+                paletteSize = 1;
+        }
+
+        std::uint32_t indices = 0;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            std::uint32_t best = 3;
+
+            if (!transparent[i])
+            {
+                const std::uint8_t* pixel = block + i * 4;
+                int bestError = 0x7FFFFFFF;
+
+                for (int p = 0; p < paletteSize; ++p)
+                {
+                    const int dr = pixel[0] - palette[p][0];
+                    const int dg = pixel[1] - palette[p][1];
+                    const int db = pixel[2] - palette[p][2];
+                    const int error = dr * dr + dg * dg + db * db;
+
+                    if (error < bestError) {
+                        bestError = error;
+                        best = static_cast < std::uint32_t >(p);
+                    }
+                }
+            }
+
+            indices |= best << (i * 2);
+        }
+
+        BlockWrite16(dest, c0);
+        BlockWrite16(dest + 2, c1);
+        dest[4] = static_cast < std::uint8_t >(indices & 0xFF);
+        dest[5] = static_cast < std::uint8_t >((indices >> 8) & 0xFF);
+        dest[6] = static_cast < std::uint8_t >((indices >> 16) & 0xFF);
+        dest[7] = static_cast < std::uint8_t >((indices >> 24) & 0xFF);
+    }
+
+    /*! @brief Encodes the alpha channel of a block to the 8 bytes BC3 alpha block. */
+    static void BlockEncodeBC3Alpha(const std::uint8_t* block, std::uint8_t* dest)
+    {
+        int a0 = 0, a1 = 255;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            a0 = std::max(a0, static_cast < int >(block[i * 4 + 3]));
+            a1 = std::min(a1, static_cast < int >(block[i * 4 + 3]));
+        }
+
+        dest[0] = static_cast < std::uint8_t >(a0);
+        dest[1] = static_cast < std::uint8_t >(a1);
+
+        int palette[8] = { a0, a1 };
+        for (int p = 1; p < 7; ++p)
+            palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+
+        std::uint64_t indices = 0;
+
+        if (a0 != a1)
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                const int alpha = block[i * 4 + 3];
+                std::uint64_t best = 0;
+                int bestError = 256;
+
+                for (int p = 0; p < 8; ++p)
+                {
+                    const int error = std::abs(alpha - palette[p]);
+
+                    if (error < bestError) {
+                        bestError = error;
+                        best = static_cast < std::uint64_t >(p);
+                    }
+                }
+
+                indices |= best << (i * 3);
+            }
+        }
+
+        for (int b = 0; b < 6; ++b)
+            dest[2 + b] = static_cast < std::uint8_t >((indices >> (b * 8)) & 0xFF);
+    }
+
+    void BlockEncodeBC3(const std::uint8_t* block, std::uint8_t* dest)
+    {
+        assert(block && dest && "Null block given.");
+        BlockEncodeBC3Alpha(block, dest);
+        BlockEncodeBC1(block, dest + 8, false);
+    }
+
+    bool BlockEncoderSupports(std::uint8_t format)
+    {
+        return format == kPixelFormatBC1 || format == kPixelFormatBC3;
+    }
+
+    /*! @brief Encodes rows of blocks [firstRow, lastRow) of a level. */
+    static void BlockEncodeRows(std::uint8_t format, const unsigned char* src, std::size_t pitch,
+                                std::size_t width, std::size_t height, unsigned char* dest,
+                                std::size_t firstRow, std::size_t lastRow)
+    {
+        const std::size_t blocksX = (width + 3) / 4;
+        const std::size_t blockSize = PixelFormatGetBlockSize(format);
+        std::uint8_t block[64];
+
+        for (std::size_t by = firstRow; by < lastRow; ++by)
+        {
+            for (std::size_t bx = 0; bx < blocksX; ++bx)
+            {
+                for (std::size_t y = 0; y < 4; ++y)
+                {
+                    const std::size_t srcY = std::min(by * 4 + y, height - 1);
+
+                    for (std::size_t x = 0; x < 4; ++x)
+                    {
+                        const std::size_t srcX = std::min(bx * 4 + x, width - 1);
+                        memcpy(block + (y * 4 + x) * 4, src + srcY * pitch + srcX * 4, 4);
+                    }
+                }
+
+                std::uint8_t* out = dest + (by * blocksX + bx) * blockSize;
+
+                if (format == kPixelFormatBC1) BlockEncodeBC1(block, out, true);
+                else BlockEncodeBC3(block, out);
+            }
+        }
+    }
+
+    void BlockEncodeLevel(std::uint8_t format, const unsigned char* src, std::size_t pitch,
+                          std::size_t width, std::size_t height, unsigned char* dest, std::size_t threads)
+    {
+        assert(src && dest && "Null buffers given.");
+        assert(BlockEncoderSupports(format) && "Unsupported block format.");
+
+        if (!width || !height)
+            return;
+
+        const std::size_t blocksY = (height + 3) / 4;
+
+        if (!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        threads = std::min(threads, blocksY);
+        const std::size_t rowsPerThread = (blocksY + threads - 1) / threads;
+
+        if (JobSystem* jobSystem = JobSystem::Find())
+        {
+            jobSystem->parallelFor(0, blocksY, rowsPerThread, [&](std::size_t first, std::size_t last) {
+                BlockEncodeRows(format, src, pitch, width, height, dest, first, last);
+            });
+
+            return;
+        }
+
+        std::vector < std::thread > workers;
+        workers.reserve(threads);
+
+        for (std::size_t first = rowsPerThread; first < blocksY; first += rowsPerThread)
+        {
+            const std::size_t last = std::min(first + rowsPerThread, blocksY);
+            workers.emplace_back(BlockEncodeRows, format, src, pitch, width, height, dest, first, last);
+        }
+
+        // The calling thread encodes the first chunk itself.
+        BlockEncodeRows(format, src, pitch, width, height, dest, 0, std::min(rowsPerThread, blocksY));
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    std::shared_ptr < PixelSet > BlockEncodePixelSet(std::shared_ptr < PixelSet > const& src, std::uint8_t format, std::size_t threads)
+    {
+        assert(src && src->data && "Null PixelSet given.");
+
+        if (src->format != kPixelFormatRGBA8 || !BlockEncoderSupports(format))
+        {
+            NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "Can't encode PixelFormat %s to %s.",
+                PixelFormatToString(src->format).data(), PixelFormatToString(format).data()));
+            return nullptr;
+        }
+
+        std::vector < PixelSetLevel > srcLevels = src->levels;
+
+        if (srcLevels.empty())
+        {
+            PixelSetLevel base;
+            base.width = src->lineWidth / 4;
+            base.height = src->columnsCount;
+            base.offset = 0;
+            base.size = src->lineWidth * src->columnsCount;
+            srcLevels.push_back(base);
+        }
+
+        auto result = AllocateShared < PixelSet >();
+        result->format = format;
+        result->levels.reserve(srcLevels.size());
+
+        std::size_t totalSize = 0;
+
+        for (auto const& srcLevel : srcLevels)
+        {
+            PixelSetLevel level;
+            level.width = srcLevel.width;
+            level.height = srcLevel.height;
+            level.offset = totalSize;
+            level.size = PixelFormatGetLevelSize(format, srcLevel.width, srcLevel.height);
+            totalSize += level.size;
+            result->levels.push_back(level);
+        }
+
+        result->data = Allocate < unsigned char >(totalSize);
+        result->lineWidth = PixelFormatGetLevelSize(format, srcLevels[0].width, 4);
+        result->columnsCount = srcLevels[0].height;
+
+        for (std::size_t i = 0; i < srcLevels.size(); ++i)
+        {
+            // Source levels without their own pitch use the PixelSet's lineWidth only for the base level.
+            const std::size_t pitch = (src->levels.empty()) ? src->lineWidth : srcLevels[i].width * 4;
+
+            BlockEncodeLevel(format, src->data + srcLevels[i].offset, pitch,
+                             srcLevels[i].width, srcLevels[i].height,
+                             result->data + result->levels[i].offset, threads);
+        }
+
+        return result;
+    }
+
+    BlockEncoderConverter::BlockEncoderConverter(std::uint8_t destFormat) : format(destFormat)
+    {
+        assert(BlockEncoderSupports(format) && "Unsupported block format.");
+    }
+
+    std::uint8_t BlockEncoderConverter::srcFormat() const
+    {
+        return kPixelFormatRGBA8;
+    }
+
+    std::uint8_t BlockEncoderConverter::destFormat() const
+    {
+        return format;
+    }
+
+    std::shared_ptr < PixelSet > BlockEncoderConverter::convert(std::shared_ptr < PixelSet > const& srcPixels) const
+    {
+        return BlockEncodePixelSet(srcPixels, format);
+    }
+}
@@ -0,0 +1,81 @@
+/** =======================================================
+ *  \file Core/BlockEncoder.h
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#ifndef CLEAN_BLOCKENCODER_H
+#define CLEAN_BLOCKENCODER_H
+
+#include "PixelSetConverter.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace Clean
+{
+    /*! @brief Encodes one 4x4 block of RGBA8 pixels (64 bytes, row-major) to BC1 (8 bytes).
+     *
+     * \param block Sixteen RGBA8 pixels.
+     * \param dest Destination of the 8 encoded bytes.
+     * \param allowAlpha If true, pixels with alpha lower than 128 are encoded as transparent
+     *      using the 3-colors mode of BC1. If false, the 4-colors mode is always used (this
+     *      is required for the color part of BC3).
+     *
+    **/
+    void BlockEncodeBC1(const std::uint8_t* block, std::uint8_t* dest, bool allowAlpha = true);
+
+    /*! @brief Encodes one 4x4 block of RGBA8 pixels (64 bytes, row-major) to BC3 (16 bytes). */
+    void BlockEncodeBC3(const std::uint8_t* block, std::uint8_t* dest);
+
+    /*! @brief Returns true if BlockEncodePixelSet can produce the given format. */
+    bool BlockEncoderSupports(std::uint8_t format);
+
+    /*! @brief Encodes a whole RGBA8 level to a block-compressed format.
+     *
+     * Rows of blocks are split in the given number of chunks, encoded by the JobSystem's workers
+     * (or by threads of their own when there is no Core). Borders of images
+     * whose size is not a multiple of 4 are filled by repeating the last row and column.
+     *
+     * \param format Destination format, must be supported by \ref BlockEncoderSupports.
+     * \param src First RGBA8 pixel of the level.
+     * \param pitch Number of bytes between two rows of src.
+     * \param width Width of the level, in pixels.
+     * \param height Height of the level, in pixels.
+     * \param dest Destination buffer of at least PixelFormatGetLevelSize(format, width, height) bytes.
+     * \param threads Number of chunks. Zero uses std::thread::hardware_concurrency().
+     *
+    **/
+    void BlockEncodeLevel(std::uint8_t format, const unsigned char* src, std::size_t pitch,
+                          std::size_t width, std::size_t height, unsigned char* dest, std::size_t threads = 0);
+
+    /*! @brief Encodes every level of an RGBA8 PixelSet to a block-compressed PixelSet.
+     *
+     * If the source PixelSet has no levels, its base level is described by lineWidth (in bytes)
+     * and columnsCount (number of rows). Returns nullptr if the source format is not RGBA8 or if
+     * the destination format cannot be encoded.
+     *
+    **/
+    std::shared_ptr < PixelSet > BlockEncodePixelSet(std::shared_ptr < PixelSet > const& src, std::uint8_t format, std::size_t threads = 0);
+
+    /*! @brief PixelSetConverter from RGBA8 to a block-compressed format. */
+    struct BlockEncoderConverter : public PixelSetConverter
+    {
+        //! @brief Block-compressed format produced by this converter.
+        std::uint8_t format;
+
+        /*! @brief Constructs a converter producing the given format. */
+        BlockEncoderConverter(std::uint8_t destFormat);
+
+        /*! @brief Returns the source pixel format. */
+        std::uint8_t srcFormat() const;
+
+        /*! @brief Returns the destination pixel format. */
+        std::uint8_t destFormat() const;
+
+        /*! @brief Creates a new PixelSet where data is converted from srcFormat to destFormat. */
+        std::shared_ptr < PixelSet > convert(std::shared_ptr < PixelSet > const& srcPixels) const;
+    };
+}
+
+#endif // CLEAN_BLOCKENCODER_H
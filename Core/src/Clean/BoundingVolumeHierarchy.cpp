@@ -0,0 +1,560 @@
+/** \file Core/BoundingVolumeHierarchy.cpp
+**/
+
+#include "BoundingVolumeHierarchy.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace Clean
+{
+    /*! @brief Returns the surface area of box, or zero if it is empty. */
+    static float SurfaceArea(BoundingBox const& box)
+    {
+        if (box.empty()) return 0.0f;
+        const glm::vec3 size = box.max - box.min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    /*! @brief Returns the box containing lhs and rhs. */
+    static BoundingBox Union(BoundingBox lhs, BoundingBox const& rhs)
+    {
+        lhs.extend(rhs);
+        return lhs;
+    }
+
+    /*! @brief Returns true if lhs and rhs overlap. */
+    static bool Overlaps(BoundingBox const& lhs, BoundingBox const& rhs)
+    {
+        if (lhs.empty() || rhs.empty()) return false;
+        return lhs.min.x <= rhs.max.x && lhs.max.x >= rhs.min.x
+            && lhs.min.y <= rhs.max.y && lhs.max.y >= rhs.min.y
+            && lhs.min.z <= rhs.max.z && lhs.max.z >= rhs.min.z;
+    }
+
+    SlotHandle BoundingVolumeHierarchy::insert(BoundingBox const& box, std::uint64_t user)
+    {
+        const std::uint32_t leaf = allocateNode();
+        SlotHandle handle = objects.insert(Object{ box, user, leaf });
+
+        Node& node = nodes[leaf];
+        node.bounds = box;
+        node.left = node.right = kNullNode;
+        node.object = handle;
+
+        insertLeaf(leaf);
+        return handle;
+    }
+
+    bool BoundingVolumeHierarchy::remove(SlotHandle const& handle)
+    {
+        Object* object = objects.find(handle);
+        if (!object) return false;
+
+        const std::uint32_t leaf = object->leaf;
+        removeLeaf(leaf);
+        releaseNode(leaf);
+
+        objects.erase(handle);
+        return true;
+    }
+
+    bool BoundingVolumeHierarchy::refit(SlotHandle const& handle, BoundingBox const& box)
+    {
+        Object* object = objects.find(handle);
+        if (!object) return false;
+
+        object->bounds = box;
+        nodes[object->leaf].bounds = box;
+        refitAncestors(nodes[object->leaf].parent);
+        return true;
+    }
+
+    void BoundingVolumeHierarchy::build()
+    {
+        ProfileScope("BoundingVolumeHierarchy::build");
+
+        nodes.clear();
+        root = kNullNode;
+        freeNode = kNullNode;
+
+        const std::size_t count = objects.size();
+        if (!count) return;
+
+        // A binary tree with one object by leaf has exactly 2n - 1 nodes: they are allocated by pairs of
+        // children from an atomic counter, so subtrees are built concurrently without locking.
+
+        nodes.resize(2 * count - 1);
+
+        std::vector < std::uint32_t > refs(count);
+        std::vector < glm::vec3 > centroids(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            refs[i] = static_cast < std::uint32_t >(i);
+            centroids[i] = (objects.begin() + i)->bounds.center();
+        }
+
+        std::atomic < std::uint32_t > nextNode(1);
+        root = 0;
+
+        buildNode(refs, centroids, nextNode, root, kNullNode, 0, count);
+        assert(nextNode.load() == nodes.size() && "BVH build didn't use all nodes.");
+    }
+
+    void BoundingVolumeHierarchy::clear()
+    {
+        objects.clear();
+        nodes.clear();
+        root = kNullNode;
+        freeNode = kNullNode;
+    }
+
+    std::size_t BoundingVolumeHierarchy::size() const
+    {
+        return objects.size();
+    }
+
+    bool BoundingVolumeHierarchy::empty() const
+    {
+        return objects.empty();
+    }
+
+    BoundingBox BoundingVolumeHierarchy::getBounds(SlotHandle const& handle) const
+    {
+        Object const* object = objects.find(handle);
+        return object ? object->bounds : BoundingBox();
+    }
+
+    std::uint64_t BoundingVolumeHierarchy::getUser(SlotHandle const& handle) const
+    {
+        Object const* object = objects.find(handle);
+        return object ? object->user : 0;
+    }
+
+    BoundingBox BoundingVolumeHierarchy::getRootBounds() const
+    {
+        return root == kNullNode ? BoundingBox() : nodes[root].bounds;
+    }
+
+    std::size_t BoundingVolumeHierarchy::getHeight() const
+    {
+        return heightOf(root);
+    }
+
+    void BoundingVolumeHierarchy::queryFrustum(Frustum const& frustum, QueryCallback const& fn) const
+    {
+        if (root == kNullNode) return;
+
+        // Each entry carries the planes its node may still cross: a node fully inside a plane doesn't test
+        // it again for its children, and a node inside all planes reports its subtree without any test.
+
+        std::vector < std::pair < std::uint32_t, std::uint8_t > > stack;
+        stack.emplace_back(root, static_cast < std::uint8_t >((1 << kFrustumPlanes) - 1));
+
+        while (!stack.empty())
+        {
+            const std::uint32_t index = stack.back().first;
+            std::uint8_t mask = stack.back().second;
+            stack.pop_back();
+
+            Node const& node = nodes[index];
+            if (node.bounds.empty()) continue;
+
+            const glm::vec3 center = node.bounds.center();
+            const glm::vec3 extents = node.bounds.extents();
+            bool outside = false;
+
+            for (std::size_t p = 0; p < kFrustumPlanes && !outside; ++p)
+            {
+                if (!(mask & (1 << p))) continue;
+
+                glm::vec4 const& plane = frustum.planes[p];
+                const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+                const float radius = glm::dot(glm::abs(glm::vec3(plane)), extents);
+
+                if (distance + radius < 0.0f) outside = true;
+                else if (distance - radius >= 0.0f) mask &= static_cast < std::uint8_t >(~(1 << p));
+            }
+
+            if (outside) continue;
+
+            if (!mask) reportSubtree(index, fn);
+            else if (node.isLeaf()) fn(node.object, objects.find(node.object)->user);
+            else {
+                stack.emplace_back(node.left, mask);
+                stack.emplace_back(node.right, mask);
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::queryBox(BoundingBox const& box, QueryCallback const& fn) const
+    {
+        if (root == kNullNode) return;
+
+        std::vector < std::uint32_t > stack;
+        stack.push_back(root);
+
+        while (!stack.empty())
+        {
+            Node const& node = nodes[stack.back()];
+            stack.pop_back();
+
+            if (!Overlaps(node.bounds, box)) continue;
+
+            if (node.isLeaf()) fn(node.object, objects.find(node.object)->user);
+            else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+
+    std::vector < BvhRayHit > BoundingVolumeHierarchy::queryRay(glm::vec3 const& origin, glm::vec3 const& direction, float maxDistance) const
+    {
+        std::vector < BvhRayHit > result;
+        if (root == kNullNode) return result;
+
+        // Slab test. An infinite inverse is fine: the products give +-inf, or NaN when the origin lies on
+        // a slab, which the comparisons below treat as a hit.
+
+        const glm::vec3 inverse = 1.0f / direction;
+
+        auto enter = [&origin, &inverse, maxDistance](BoundingBox const& box, float& distance){
+            if (box.empty()) return false;
+
+            const glm::vec3 t0 = (box.min - origin) * inverse;
+            const glm::vec3 t1 = (box.max - origin) * inverse;
+            const glm::vec3 tmin = glm::min(t0, t1);
+            const glm::vec3 tmax = glm::max(t0, t1);
+
+            const float near = std::max(std::max(tmin.x, tmin.y), std::max(tmin.z, 0.0f));
+            const float far = std::min(std::min(tmax.x, tmax.y), std::min(tmax.z, maxDistance));
+
+            distance = near;
+            return !(near > far);
+        };
+
+        std::vector < std::uint32_t > stack;
+        stack.push_back(root);
+
+        while (!stack.empty())
+        {
+            Node const& node = nodes[stack.back()];
+            stack.pop_back();
+
+            float distance;
+            if (!enter(node.bounds, distance)) continue;
+
+            if (node.isLeaf()) result.push_back(BvhRayHit{ node.object, objects.find(node.object)->user, distance });
+            else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+
+        std::sort(result.begin(), result.end(), [](BvhRayHit const& lhs, BvhRayHit const& rhs){
+            return lhs.distance < rhs.distance;
+        });
+
+        return result;
+    }
+
+    std::uint32_t BoundingVolumeHierarchy::allocateNode()
+    {
+        if (freeNode != kNullNode)
+        {
+            const std::uint32_t index = freeNode;
+            freeNode = nodes[index].left;
+            nodes[index] = Node();
+            return index;
+        }
+
+        assert(nodes.size() < kNullNode && "BoundingVolumeHierarchy is full.");
+        nodes.emplace_back();
+        return static_cast < std::uint32_t >(nodes.size() - 1);
+    }
+
+    void BoundingVolumeHierarchy::releaseNode(std::uint32_t index)
+    {
+        Node& node = nodes[index];
+        node.parent = kNullNode;
+        node.left = freeNode;
+        node.right = kNullNode;
+        node.object = SlotHandle();
+        freeNode = index;
+    }
+
+    void BoundingVolumeHierarchy::insertLeaf(std::uint32_t leaf)
+    {
+        if (root == kNullNode)
+        {
+            root = leaf;
+            nodes[leaf].parent = kNullNode;
+            return;
+        }
+
+        // Descends toward the sibling whose pairing with the leaf costs the least surface area: the cost
+        // of going down a node is the growth it inherits, compared with making the node itself the sibling.
+
+        const BoundingBox box = nodes[leaf].bounds;
+        std::uint32_t index = root;
+
+        while (!nodes[index].isLeaf())
+        {
+            Node const& node = nodes[index];
+
+            const float area = SurfaceArea(node.bounds);
+            const float combinedArea = SurfaceArea(Union(node.bounds, box));
+
+            const float cost = 2.0f * combinedArea;
+            const float inheritance = 2.0f * (combinedArea - area);
+
+            auto childCost = [&](std::uint32_t child){
+                Node const& childNode = nodes[child];
+                const float grown = SurfaceArea(Union(childNode.bounds, box));
+                return childNode.isLeaf() ? grown + inheritance : grown - SurfaceArea(childNode.bounds) + inheritance;
+            };
+
+            const float leftCost = childCost(node.left);
+            const float rightCost = childCost(node.right);
+
+            if (cost < leftCost && cost < rightCost)
+                break;
+
+            index = leftCost < rightCost ? node.left : node.right;
+        }
+
+        const std::uint32_t sibling = index;
+        const std::uint32_t oldParent = nodes[sibling].parent;
+        const std::uint32_t newParent = allocateNode();
+
+        Node& parent = nodes[newParent];
+        parent.parent = oldParent;
+        parent.bounds = Union(nodes[sibling].bounds, box);
+        parent.left = sibling;
+        parent.right = leaf;
+
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        if (oldParent == kNullNode) {
+            root = newParent;
+        } else {
+            Node& grandParent = nodes[oldParent];
+            if (grandParent.left == sibling) grandParent.left = newParent;
+            else grandParent.right = newParent;
+        }
+
+        refitAncestors(oldParent);
+    }
+
+    void BoundingVolumeHierarchy::removeLeaf(std::uint32_t leaf)
+    {
+        if (leaf == root)
+        {
+            root = kNullNode;
+            return;
+        }
+
+        const std::uint32_t parent = nodes[leaf].parent;
+        const std::uint32_t grandParent = nodes[parent].parent;
+        const std::uint32_t sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+        nodes[sibling].parent = grandParent;
+
+        if (grandParent == kNullNode) {
+            root = sibling;
+        } else {
+            Node& node = nodes[grandParent];
+            if (node.left == parent) node.left = sibling;
+            else node.right = sibling;
+        }
+
+        releaseNode(parent);
+        refitAncestors(grandParent);
+    }
+
+    void BoundingVolumeHierarchy::refitAncestors(std::uint32_t index)
+    {
+        while (index != kNullNode)
+        {
+            Node& node = nodes[index];
+            node.bounds = Union(nodes[node.left].bounds, nodes[node.right].bounds);
+            index = node.parent;
+        }
+    }
+
+    std::size_t BoundingVolumeHierarchy::heightOf(std::uint32_t index) const
+    {
+        if (index == kNullNode) return 0;
+
+        // Iterative: trees built incrementally from sorted input may be deep.
+
+        std::size_t height = 0;
+        std::vector < std::pair < std::uint32_t, std::size_t > > stack;
+        stack.emplace_back(index, 1);
+
+        while (!stack.empty())
+        {
+            auto [current, depth] = stack.back();
+            stack.pop_back();
+
+            height = std::max(height, depth);
+
+            if (!nodes[current].isLeaf()) {
+                stack.emplace_back(nodes[current].left, depth + 1);
+                stack.emplace_back(nodes[current].right, depth + 1);
+            }
+        }
+
+        return height;
+    }
+
+    void BoundingVolumeHierarchy::reportSubtree(std::uint32_t index, QueryCallback const& fn) const
+    {
+        std::vector < std::uint32_t > stack;
+        stack.push_back(index);
+
+        while (!stack.empty())
+        {
+            Node const& node = nodes[stack.back()];
+            stack.pop_back();
+
+            if (node.isLeaf()) fn(node.object, objects.find(node.object)->user);
+            else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::buildNode(std::vector < std::uint32_t >& refs, std::vector < glm::vec3 > const& centroids, std::atomic < std::uint32_t >& nextNode,
+                                            std::uint32_t index, std::uint32_t parent, std::size_t first, std::size_t last)
+    {
+        Node& node = nodes[index];
+        node.parent = parent;
+        node.bounds = BoundingBox();
+
+        BoundingBox centroidBounds;
+
+        for (std::size_t i = first; i < last; ++i)
+        {
+            node.bounds.extend((objects.begin() + refs[i])->bounds);
+            centroidBounds.extend(centroids[refs[i]]);
+        }
+
+        if (last - first == 1)
+        {
+            Object& object = *(objects.begin() + refs[first]);
+            object.leaf = index;
+
+            node.left = node.right = kNullNode;
+            node.object = objects.handleAt(refs[first]);
+            return;
+        }
+
+        const glm::vec3 size = centroidBounds.max - centroidBounds.min;
+        const int axis = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+        const float extent = size[axis];
+        const float origin = centroidBounds.min[axis];
+
+        std::size_t middle = first;
+
+        if (extent > 0.0f)
+        {
+            // Binned SAH: objects are counted in bins along the axis, and the split between two bins
+            // minimizing area(left) * count(left) + area(right) * count(right) is kept.
+
+            auto binOf = [&](std::uint32_t ref){
+                const float position = (centroids[ref][axis] - origin) * (static_cast < float >(kBvhBinsCount) / extent);
+                return std::min(kBvhBinsCount - 1, static_cast < std::size_t >(std::max(position, 0.0f)));
+            };
+
+            std::size_t counts[kBvhBinsCount] = {};
+            BoundingBox boxes[kBvhBinsCount];
+
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const std::size_t bin = binOf(refs[i]);
+                counts[bin]++;
+                boxes[bin].extend((objects.begin() + refs[i])->bounds);
+            }
+
+            float rightCosts[kBvhBinsCount] = {};
+            BoundingBox rightBox;
+            std::size_t rightCount = 0;
+
+            for (std::size_t bin = kBvhBinsCount - 1; bin > 0; --bin)
+            {
+                rightBox.extend(boxes[bin]);
+                rightCount += counts[bin];
+                rightCosts[bin] = SurfaceArea(rightBox) * static_cast < float >(rightCount);
+            }
+
+            BoundingBox leftBox;
+            std::size_t leftCount = 0;
+            std::size_t bestSplit = 0;
+            float bestCost = 0.0f;
+
+            for (std::size_t split = 1; split < kBvhBinsCount; ++split)
+            {
+                leftBox.extend(boxes[split - 1]);
+                leftCount += counts[split - 1];
+
+                const float cost = SurfaceArea(leftBox) * static_cast < float >(leftCount) + rightCosts[split];
+
+                if (leftCount && leftCount < last - first && (!bestSplit || cost < bestCost)) {
+                    bestSplit = split;
+                    bestCost = cost;
+                }
+            }
+
+            if (bestSplit)
+            {
+                auto it = std::partition(refs.begin() + first, refs.begin() + last, [&](std::uint32_t ref){
+                    return binOf(ref) < bestSplit;
+                });
+
+                middle = static_cast < std::size_t >(it - refs.begin());
+            }
+        }
+
+        // All centroids in the same bin: splits in two halves.
+
+        if (middle == first || middle == last)
+        {
+            middle = first + (last - first) / 2;
+
+            std::nth_element(refs.begin() + first, refs.begin() + middle, refs.begin() + last, [&](std::uint32_t lhs, std::uint32_t rhs){
+                return centroids[lhs][axis] < centroids[rhs][axis];
+            });
+        }
+
+        const std::uint32_t children = nextNode.fetch_add(2);
+        node.left = children;
+        node.right = children + 1;
+
+        JobSystem* jobSystem = JobSystem::Find();
+
+        if (jobSystem && last - first > kBvhParallelBuildThreshold)
+        {
+            auto counter = jobSystem->async([&, children, index, first, middle](){
+                buildNode(refs, centroids, nextNode, children, index, first, middle);
+            });
+
+            buildNode(refs, centroids, nextNode, children + 1, index, middle, last);
+            jobSystem->wait(counter);
+        }
+
+        else
+        {
+            buildNode(refs, centroids, nextNode, children, index, first, middle);
+            buildNode(refs, centroids, nextNode, children + 1, index, middle, last);
+        }
+    }
+}
@@ -0,0 +1,174 @@
+/** \file Core/BoundingVolumeHierarchy.h
+**/
+
+#ifndef CLEAN_BOUNDINGVOLUMEHIERARCHY_H
+#define CLEAN_BOUNDINGVOLUMEHIERARCHY_H
+
+#include "Bounds.h"
+#include "SlotMap.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Clean
+{
+    //! @brief Number of objects below which a subtree is built by the calling thread in BoundingVolumeHierarchy::build().
+    static constexpr const std::size_t kBvhParallelBuildThreshold = 4096;
+
+    //! @brief Number of bins used to evaluate the SAH in BoundingVolumeHierarchy::build().
+    static constexpr const std::size_t kBvhBinsCount = 16;
+
+    /** @brief A hit of BoundingVolumeHierarchy::queryRay(). */
+    struct BvhRayHit
+    {
+        //! @brief Object hit.
+        SlotHandle handle;
+
+        //! @brief User data of the object.
+        std::uint64_t user;
+
+        //! @brief Distance along the ray where it enters the box of the object.
+        float distance;
+    };
+
+    /** @brief A bounding volume hierarchy over the boxes of objects, like mesh instances.
+     *
+     * Each object is a leaf of a binary tree whose nodes bound their children. Objects are inserted and removed
+     * incrementally: a new leaf goes next to the node minimizing the surface area growth of the tree. A moving
+     * object is refit: the boxes of its ancestors grow or shrink with it, which is fast but lowers the quality
+     * of the tree over time. \ref build() rebuilds the whole tree top-down with a binned surface area heuristic,
+     * on the JobSystem when there is one: use it after loading a static scene, or after many objects moved.
+     *
+     * Objects are identified by a SlotHandle and carry a user value, like an index in the caller's instances.
+     * Boxes are given in world space, for example with BoundingBox::transformed() on the bounds of a Mesh.
+     *
+     * The hierarchy is not thread-safe: it may be queried by several threads at once, but must not be
+     * modified meanwhile.
+     *
+    **/
+    class BoundingVolumeHierarchy
+    {
+        //! @brief Index of no node.
+        static constexpr const std::uint32_t kNullNode = 0xFFFFFFFF;
+
+        /** @brief A node of the tree. Leaves have no children and designate an object. */
+        struct Node
+        {
+            //! @brief Box containing the node's objects.
+            BoundingBox bounds;
+
+            //! @brief Parent node, or kNullNode for the root and free nodes.
+            std::uint32_t parent = kNullNode;
+
+            //! @brief Children of an inner node, or kNullNode for a leaf. For a free node, left is the next free node.
+            std::uint32_t left = kNullNode;
+            std::uint32_t right = kNullNode;
+
+            //! @brief Object of a leaf.
+            SlotHandle object;
+
+            bool isLeaf() const { return right == kNullNode; }
+        };
+
+        /** @brief An object of the hierarchy. */
+        struct Object
+        {
+            BoundingBox bounds;
+            std::uint64_t user;
+            std::uint32_t leaf;
+        };
+
+        //! @brief Objects, by handle.
+        SlotMap < Object > objects;
+
+        //! @brief Nodes of the tree, including free ones.
+        std::vector < Node > nodes;
+
+        //! @brief Root of the tree, or kNullNode if empty.
+        std::uint32_t root = kNullNode;
+
+        //! @brief First free node, or kNullNode.
+        std::uint32_t freeNode = kNullNode;
+
+    public:
+
+        //! @brief Called for each object found by a query.
+        typedef std::function < void(SlotHandle const&, std::uint64_t) > QueryCallback;
+
+        /*! @brief Inserts an object bounded by box and returns its handle. */
+        SlotHandle insert(BoundingBox const& box, std::uint64_t user = 0);
+
+        /*! @brief Removes an object. Returns false if handle is stale. */
+        bool remove(SlotHandle const& handle);
+
+        /*! @brief Changes the box of an object and refits its ancestors. Returns false if handle is stale. */
+        bool refit(SlotHandle const& handle, BoundingBox const& box);
+
+        /*! @brief Rebuilds the tree from all objects with the surface area heuristic. */
+        void build();
+
+        /*! @brief Removes all objects. */
+        void clear();
+
+        /*! @brief Returns the number of objects. */
+        std::size_t size() const;
+
+        /*! @brief Returns true if there is no object. */
+        bool empty() const;
+
+        /*! @brief Returns the box of an object, or an empty box if handle is stale. */
+        BoundingBox getBounds(SlotHandle const& handle) const;
+
+        /*! @brief Returns the user value of an object, or zero if handle is stale. */
+        std::uint64_t getUser(SlotHandle const& handle) const;
+
+        /*! @brief Returns the box containing all objects. */
+        BoundingBox getRootBounds() const;
+
+        /*! @brief Returns the height of the tree. A tree with a single object has a height of one. */
+        std::size_t getHeight() const;
+
+        /*! @brief Calls fn for each object whose box intersects frustum. */
+        void queryFrustum(Frustum const& frustum, QueryCallback const& fn) const;
+
+        /*! @brief Calls fn for each object whose box intersects box. */
+        void queryBox(BoundingBox const& box, QueryCallback const& fn) const;
+
+        /*! @brief Returns the objects whose box is crossed by the ray before maxDistance, nearest first.
+         *  direction doesn't need to be normalized: distances are then in units of its length. **/
+        std::vector < BvhRayHit > queryRay(glm::vec3 const& origin, glm::vec3 const& direction, float maxDistance) const;
+
+    private:
+
+        /*! @brief Returns a node from the free list, or a new one. */
+        std::uint32_t allocateNode();
+
+        /*! @brief Adds a node to the free list. */
+        void releaseNode(std::uint32_t index);
+
+        /*! @brief Inserts a leaf in the tree, next to the sibling increasing the surface area the least. */
+        void insertLeaf(std::uint32_t leaf);
+
+        /*! @brief Removes a leaf from the tree. The leaf itself is not released. */
+        void removeLeaf(std::uint32_t leaf);
+
+        /*! @brief Recomputes the boxes of index and its ancestors. */
+        void refitAncestors(std::uint32_t index);
+
+        /*! @brief Returns the height of the subtree at index. */
+        std::size_t heightOf(std::uint32_t index) const;
+
+        /*! @brief Calls fn for each object below index. */
+        void reportSubtree(std::uint32_t index, QueryCallback const& fn) const;
+
+        /*! @brief Builds the subtree at node from the objects refs[first, last). Subtrees of more than
+         *  kBvhParallelBuildThreshold objects build their left child on a job. **/
+        void buildNode(std::vector < std::uint32_t >& refs, std::vector < glm::vec3 > const& centroids, std::atomic < std::uint32_t >& nextNode,
+                       std::uint32_t node, std::uint32_t parent, std::size_t first, std::size_t last);
+    };
+}
+
+#endif // CLEAN_BOUNDINGVOLUMEHIERARCHY_H
@@ -0,0 +1,186 @@
+/** \file Core/Bounds.h
+**/
+
+#ifndef CLEAN_BOUNDS_H
+#define CLEAN_BOUNDS_H
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/matrix.hpp>
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+
+#include <cmath>
+#include <limits>
+
+namespace Clean
+{
+    /** @brief An axis-aligned bounding box. A default-constructed box is empty. */
+    struct BoundingBox
+    {
+        //! @brief Minimum corner.
+        glm::vec3 min = glm::vec3(std::numeric_limits < float >::max());
+
+        //! @brief Maximum corner.
+        glm::vec3 max = glm::vec3(-std::numeric_limits < float >::max());
+
+        /*! @brief Returns true if no point was added to the box. */
+        bool empty() const
+        {
+            return min.x > max.x || min.y > max.y || min.z > max.z;
+        }
+
+        /*! @brief Grows the box to contain point. */
+        void extend(glm::vec3 const& point)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        /*! @brief Grows the box to contain rhs. */
+        void extend(BoundingBox const& rhs)
+        {
+            if (rhs.empty()) return;
+            min = glm::min(min, rhs.min);
+            max = glm::max(max, rhs.max);
+        }
+
+        /*! @brief Returns the center of the box. */
+        glm::vec3 center() const
+        {
+            return (min + max) * 0.5f;
+        }
+
+        /*! @brief Returns the half-size of the box. */
+        glm::vec3 extents() const
+        {
+            return (max - min) * 0.5f;
+        }
+
+        /*! @brief Returns the box containing this box transformed by matrix. */
+        BoundingBox transformed(glm::mat4 const& matrix) const
+        {
+            if (empty()) return BoundingBox();
+
+            // Arvo's method: the extents of the transformed box are the absolute matrix times the extents.
+            const glm::vec3 c = glm::vec3(matrix * glm::vec4(center(), 1.0f));
+            const glm::vec3 e = extents();
+            const glm::mat3 a = glm::mat3(glm::abs(matrix[0]), glm::abs(matrix[1]), glm::abs(matrix[2]));
+            const glm::vec3 r = a * e;
+
+            BoundingBox result;
+            result.min = c - r;
+            result.max = c + r;
+            return result;
+        }
+    };
+
+    /** @brief A bounding sphere. A sphere with a negative radius is empty. */
+    struct BoundingSphere
+    {
+        //! @brief Center of the sphere.
+        glm::vec3 center = glm::vec3(0.0f);
+
+        //! @brief Radius of the sphere.
+        float radius = -1.0f;
+
+        /*! @brief Returns true if the sphere is empty. */
+        bool empty() const
+        {
+            return radius < 0.0f;
+        }
+
+        /*! @brief Returns the sphere containing box. */
+        static BoundingSphere FromBox(BoundingBox const& box)
+        {
+            BoundingSphere result;
+            if (box.empty()) return result;
+
+            result.center = box.center();
+            result.radius = glm::length(box.extents());
+            return result;
+        }
+    };
+
+    //! @brief Indexes of the frustum planes.
+    static constexpr const std::size_t kFrustumLeft = 0;
+    static constexpr const std::size_t kFrustumRight = 1;
+    static constexpr const std::size_t kFrustumBottom = 2;
+    static constexpr const std::size_t kFrustumTop = 3;
+    static constexpr const std::size_t kFrustumNear = 4;
+    static constexpr const std::size_t kFrustumFar = 5;
+    static constexpr const std::size_t kFrustumPlanes = 6;
+
+    /** @brief The six planes of a view frustum, normals pointing inside.
+     *
+     * A point p is inside a plane if dot(plane.xyz, p) + plane.w >= 0. Planes are normalized, so
+     * this value is the distance of p to the plane.
+     *
+    **/
+    struct Frustum
+    {
+        //! @brief Planes, indexed by kFrustumLeft to kFrustumFar.
+        glm::vec4 planes[kFrustumPlanes];
+
+        /*! @brief Extracts the planes of a view-projection matrix with a [-1, 1] depth range (Gribb-Hartmann). */
+        static Frustum FromMatrix(glm::mat4 const& viewProj)
+        {
+            const glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+            const glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+            const glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+            const glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+            Frustum result;
+            result.planes[kFrustumLeft] = row3 + row0;
+            result.planes[kFrustumRight] = row3 - row0;
+            result.planes[kFrustumBottom] = row3 + row1;
+            result.planes[kFrustumTop] = row3 - row1;
+            result.planes[kFrustumNear] = row3 + row2;
+            result.planes[kFrustumFar] = row3 - row2;
+
+            for (glm::vec4& plane : result.planes)
+            {
+                const float length = glm::length(glm::vec3(plane));
+                if (length > 0.0f) plane /= length;
+            }
+
+            return result;
+        }
+
+        /*! @brief Returns true if sphere is at least partly inside the frustum. */
+        bool intersects(BoundingSphere const& sphere) const
+        {
+            if (sphere.empty()) return false;
+
+            for (glm::vec4 const& plane : planes)
+            {
+                if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+                    return false;
+            }
+
+            return true;
+        }
+
+        /*! @brief Returns true if box is at least partly inside the frustum. Boxes crossing two planes
+         *  outside the frustum's corners may be reported inside. **/
+        bool intersects(BoundingBox const& box) const
+        {
+            if (box.empty()) return false;
+
+            const glm::vec3 center = box.center();
+            const glm::vec3 extents = box.extents();
+
+            for (glm::vec4 const& plane : planes)
+            {
+                const glm::vec3 normal = glm::vec3(plane);
+
+                if (glm::dot(normal, center) + plane.w < -glm::dot(glm::abs(normal), extents))
+                    return false;
+            }
+
+            return true;
+        }
+    };
+}
+
+#endif // CLEAN_BOUNDS_H
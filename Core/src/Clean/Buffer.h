@@ -27,6 +27,7 @@ namespace Clean
     
     static constexpr const std::uint8_t kBufferTypeVertex = 0;
     static constexpr const std::uint8_t kBufferTypeIndex = 1;
+    static constexpr const std::uint8_t kBufferTypeUniform = 2;
     
     /** @} */
     
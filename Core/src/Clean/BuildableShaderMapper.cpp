@@ -9,6 +9,8 @@
 #include "VertexDescriptor.h"
 #include "RenderPipeline.h"
 
+#include <unordered_map>
+
 namespace Clean 
 {
     ShaderAttributesMap BuildableShaderMapper::map(VertexDescriptor const& descriptor, RenderPipeline const& pipeline) const 
@@ -48,10 +50,68 @@ namespace Clean
         return ShaderParameter(constant.type, constant.name, constant.index, param.value);
     }
     
+    BindingPlan BuildableShaderMapper::compile(std::vector < std::shared_ptr < EffectParameter > > const& parameters, RenderPipeline const& pipeline) const
+    {
+        BindingPlan plan;
+        plan.parametersCount = parameters.size();
+        
+        std::vector < ShaderParameter > mapped;
+        mapped.reserve(parameters.size());
+        
+        {
+            auto& consts = constants.lock();
+            std::unordered_map < std::uint64_t, Constant const* > index;
+            
+            for (auto const& constant : consts)
+                index.emplace(constant.hash, &constant);
+            
+            for (auto const& parameter : parameters)
+            {
+                auto it = index.find(parameter->hash);
+                
+                if (it == index.end()) {
+                    mapped.emplace_back();
+                    continue;
+                }
+                
+                mapped.emplace_back(it->second->type, it->second->name);
+                mapped.back().idx = it->second->index;
+            }
+            
+            constants.unlock();
+        }
+        
+        // Locations are resolved out of the constants lock, as the pipeline may query its program. 
+        
+        for (std::size_t slot = 0; slot < parameters.size(); ++slot)
+        {
+            std::shared_ptr < EffectParameter > const& parameter = parameters[slot];
+            
+            if (!mapped[slot].type) {
+                std::lock_guard < std::mutex > lck(parameter->mutex);
+                const ShaderParameter sparam = ShaderMapper::map(*parameter, pipeline);
+                mapped[slot].type = sparam.type;
+                mapped[slot].name = sparam.name;
+                if (!mapped[slot].type) continue;
+            }
+            
+            BindingPlanEntry entry;
+            entry.slot = static_cast < std::uint32_t >(slot);
+            entry.hash = parameter->hash;
+            entry.location = pipeline.findParameterLocation(mapped[slot]);
+            entry.type = mapped[slot].type;
+            
+            if (entry.location >= 0)
+                plan.entries.push_back(entry);
+        }
+        
+        return plan;
+    }
+    
     BuildableShaderMapper::Attribute BuildableShaderMapper::findAttribute(std::uint8_t component) const 
     {
         auto& attribs = attributes.lock();
-        auto it = std::find_if(attribs.begin(), attribs.end(), [component](auto a){ return a.vertexComponent == component; });
+        auto it = std::find_if(attribs.begin(), attribs.end(), [component](auto const& a){ return a.vertexComponent == component; });
         Attribute result = (it == attribs.end()) ? Attribute() : *it;
         attributes.unlock();
         return result;
@@ -60,7 +120,7 @@ namespace Clean
     BuildableShaderMapper::Constant BuildableShaderMapper::findConstant(std::uint64_t hash) const
     {
         auto& consts = constants.lock();
-        auto it = std::find_if(consts.begin(), consts.end(), [hash](auto c){ return c.hash == hash; });
+        auto it = std::find_if(consts.begin(), consts.end(), [hash](auto const& c){ return c.hash == hash; });
         Constant result = (it == consts.end()) ? Constant() : *it;
         constants.unlock();
         return result;
@@ -88,6 +148,21 @@ namespace Clean
         return true;
     }
     
+    ParameterBlockLayout BuildableShaderMapper::makeBlockLayout(std::string const& block) const
+    {
+        ParameterBlockLayout result;
+        auto& consts = constants.lock();
+        
+        for (auto const& constant : consts)
+        {
+            if (constant.block == block)
+                result.add(constant.hash, constant.type);
+        }
+        
+        constants.unlock();
+        return result;
+    }
+    
     void BuildableShaderMapper::clear() 
     {
         attributes.store({});
@@ -8,6 +8,7 @@
 #define CLEAN_BUILDABLESHADERMAPPER_H
 
 #include "ShaderMapper.h"
+#include "ParameterBlock.h"
 #include "Property.h"
 
 #include <string>
@@ -55,6 +56,10 @@ namespace Clean
             std::uint8_t type = 0;
             std::int8_t index = -1;
             std::uint64_t hash = 0;
+            
+            //! @brief Name of the constant block (uniform block) holding this constant, or empty if
+            //! the constant is bound alone. 
+            std::string block;
         };
         
     private:
@@ -88,6 +93,10 @@ namespace Clean
         /*! @brief Maps the given parameter to given pipeline. */
         ShaderParameter map(EffectParameter const& param, RenderPipeline const& pipeline) const;
         
+        /*! @brief Compiles the binding of a parameters list to given pipeline. 
+         *  Constants are looked for under one lock; parameters without constant are mapped by ShaderMapper. */
+        BindingPlan compile(std::vector < std::shared_ptr < EffectParameter > > const& parameters, RenderPipeline const& pipeline) const;
+        
     private:
         
         /*! @brief Finds an attribute already parameted. */
@@ -104,6 +113,9 @@ namespace Clean
         /*! @brief Adds a constant. */
         bool addConstant(Constant const& constant);
         
+        /*! @brief Returns the std140 layout of the constants in the given block, in the order they were added. */
+        ParameterBlockLayout makeBlockLayout(std::string const& block) const;
+        
         /*! @brief Clears all attributes and constants. */
         void clear();
         
@@ -168,6 +180,7 @@ namespace Clean
                     cst.hash = Hash64(value.at("name"));
                     cst.type = value.has("type") ? value.at("type") : ShaderParam::FindTypeFromHash(cst.hash);
                     cst.index = value.has("index") ? value.at("index") : -1;
+                    cst.block = value.has("block") ? value.at("block") : "";
                     
                     result->addConstant(cst);
                 }
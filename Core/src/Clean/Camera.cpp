@@ -23,14 +23,28 @@ namespace Clean
         yaw = -90.0f;
         pitch = 0.0f;
         
-        matViewParam = AllocateShared < EffectParameter >(kEffectViewMat4, ShaderValue{ .mat4 = matView }, kShaderParamMat4);
-        matProjParam = AllocateShared < EffectParameter >(kEffectProjectionMat4, ShaderValue{ .mat4 = matProj }, kShaderParamMat4);
+        ratio = 1.0f; fov = 45.0f;
+        near = 0.1f; far = 100.0f;
+        projectionType = kCameraPerspective;
+        orthoBounds = glm::vec4(-1.0f, 1.0f, -1.0f, 1.0f);
+        customView = false;
+        customViewMatrix = glm::mat4(1.0f);
+        dirty = kCameraDirtyAll;
+        
+        constraintPitch = false;
+        constraintPitchValue = 89.0f;
+        
+        matViewParam = AllocateShared < EffectParameter >(kEffectViewMat4, ShaderValue{ .mat4 = matrices.view }, kShaderParamMat4);
+        matProjParam = AllocateShared < EffectParameter >(kEffectProjectionMat4, ShaderValue{ .mat4 = matrices.projection }, kShaderParamMat4);
+        parameters = { matViewParam, matProjParam };
         
         makeVectors();
     }
     
     Camera::Camera(Camera const& rhs) 
     {
+        std::scoped_lock < std::mutex > lck(rhs.mutex);
+        
         position = rhs.position;
         front = rhs.front;
         worldUp = rhs.worldUp;
@@ -42,29 +56,39 @@ namespace Clean
         fov = rhs.fov;
         near = rhs.near;
         far = rhs.far;
+        projectionType = rhs.projectionType;
+        orthoBounds = rhs.orthoBounds;
+        customView = rhs.customView;
+        customViewMatrix = rhs.customViewMatrix;
+        dirty = kCameraDirtyAll;
+        
+        constraintPitch = rhs.constraintPitch.load();
+        constraintPitchValue = rhs.constraintPitchValue.load();
         
-        matProj = glm::perspective(glm::radians(fov), ratio, near, far);
-        matViewParam = AllocateShared < EffectParameter >(kEffectViewMat4, ShaderValue{ .mat4 = matView }, kShaderParamMat4);
-        matProjParam = AllocateShared < EffectParameter >(kEffectProjectionMat4, ShaderValue{ .mat4 = matProj }, kShaderParamMat4);
+        matViewParam = AllocateShared < EffectParameter >(kEffectViewMat4, ShaderValue{ .mat4 = matrices.view }, kShaderParamMat4);
+        matProjParam = AllocateShared < EffectParameter >(kEffectProjectionMat4, ShaderValue{ .mat4 = matrices.projection }, kShaderParamMat4);
+        parameters = { matViewParam, matProjParam };
         
         makeVectors();
     }
     
     bool Camera::onAction(CameraAction const& action)
     {
+        std::scoped_lock < std::mutex > lck(mutex);
+        
         if (action.action == kCameraActionTranslate) 
         {
             position = position + action.translation;
-            matView = glm::translate(matView, -action.translation);
-            setViewParam(matView);
+            customView = false;
+            dirty |= kCameraDirtyView;
             return true;
         }
         
         else if (action.action == kCameraActionBackTranslate)
         {
             position = position - action.translation;
-            matView = glm::translate(matView, action.translation);
-            setViewParam(matView);
+            customView = false;
+            dirty |= kCameraDirtyView;
             return true;
         }
         
@@ -82,6 +106,7 @@ namespace Clean
                     pitch = -constraintPitchValue;
             }
             
+            customView = false;
             makeVectors();
             return true;
         }
@@ -91,9 +116,12 @@ namespace Clean
     
     void Camera::onWindowResize(WindowResizeEvent const& event) 
     {
+        if (!event.newSize.height)
+            return;
+        
+        std::scoped_lock < std::mutex > lck(mutex);
         ratio = (float) event.newSize.width / (float) event.newSize.height;
-        matProj = glm::perspective(glm::radians(fov), ratio, near, far);
-        setProjParam(matProj);
+        dirty |= kCameraDirtyProjection;
     }
     
     void Camera::listen(std::shared_ptr < Window > const& window) 
@@ -102,17 +130,16 @@ namespace Clean
         window->addListener(cameraAsListener);
         
         WindowSize size = window->getSize();
+        if (!size.height) return;
+        
+        std::scoped_lock < std::mutex > lck(mutex);
         ratio = (float) size.width / (float) size.height;
-        matProj = glm::perspective(glm::radians(fov), ratio, near, far);
-        setProjParam(matProj);
+        dirty |= kCameraDirtyProjection;
     }
     
     Camera::SharedParameters Camera::findAllParameters() const 
     {
-        SharedParameters params;
-        params.push_back(matViewParam.load());
-        params.push_back(matProjParam.load());
-        return params;
+        return parameters;
     }
     
     Camera::SharedTexParams Camera::findAllTexturedParameters() const 
@@ -122,72 +149,170 @@ namespace Clean
     
     void Camera::setProjection(float r, float f, float nr, float fr)
     {
+        std::scoped_lock < std::mutex > lck(mutex);
         ratio = r; fov = f; near = nr; far = fr;
-        matProj = glm::perspective(glm::radians(fov), ratio, near, far);
-        setProjParam(matProj);
+        projectionType = kCameraPerspective;
+        dirty |= kCameraDirtyProjection;
     }
     
     void Camera::setProjection(float f, float nr, float fr)
     {
+        std::scoped_lock < std::mutex > lck(mutex);
         fov = f; near = nr; far = fr;
-        matProj = glm::perspective(glm::radians(fov), ratio, near, far);
-        setProjParam(matProj);
+        projectionType = kCameraPerspective;
+        dirty |= kCameraDirtyProjection;
+    }
+    
+    void Camera::setOrthographic(float left, float right, float bottom, float top, float nr, float fr)
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        orthoBounds = glm::vec4(left, right, bottom, top);
+        near = nr; far = fr;
+        projectionType = kCameraOrthographic;
+        dirty |= kCameraDirtyProjection;
+    }
+    
+    void Camera::lookAt(glm::vec3 const& pos, glm::vec3 const& target)
+    {
+        const glm::vec3 direction = target - pos;
+        if (glm::length(direction) <= 0.0f) return;
+        
+        const glm::vec3 dir = glm::normalize(direction);
+        
+        std::scoped_lock < std::mutex > lck(mutex);
+        position = pos;
+        yaw = glm::degrees(std::atan2(dir.z, dir.x));
+        pitch = glm::degrees(std::asin(glm::clamp(dir.y, -1.0f, 1.0f)));
+        customView = false;
+        makeVectors();
+    }
+    
+    void Camera::setViewMatrix(glm::mat4 const& view)
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        customView = true;
+        customViewMatrix = view;
+        dirty |= kCameraDirtyView;
+    }
+    
+    std::uint64_t Camera::commit() const 
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        refresh();
+        return matrices.version;
+    }
+    
+    CameraMatrices Camera::getMatrices() const 
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        refresh();
+        return matrices;
+    }
+    
+    std::uint64_t Camera::getVersion() const 
+    {
+        return commit();
+    }
+    
+    Camera::SharedParameters const& Camera::getParameters() const 
+    {
+        return parameters;
     }
     
     glm::vec3 Camera::getPosition() const 
     {
+        std::scoped_lock < std::mutex > lck(mutex);
         return position;
     }
     
     glm::vec3 Camera::getForward() const 
     {
+        std::scoped_lock < std::mutex > lck(mutex);
         return -front;
     }
     
     glm::vec3 Camera::getTarget() const 
     {
+        std::scoped_lock < std::mutex > lck(mutex);
         return position + front;
     }
     
     glm::mat4 Camera::getViewMatrix() const 
     {
-        return matView;
+        std::scoped_lock < std::mutex > lck(mutex);
+        refresh();
+        return matrices.view;
+    }
+    
+    glm::mat4 Camera::getInverseViewMatrix() const 
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        refresh();
+        return matrices.inverseView;
+    }
+    
+    glm::mat4 Camera::getProjectionMatrix() const 
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        refresh();
+        return matrices.projection;
+    }
+    
+    glm::mat4 Camera::getViewProjectionMatrix() const 
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        refresh();
+        return matrices.viewProjection;
+    }
+    
+    glm::mat4 Camera::getInverseViewProjectionMatrix() const 
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        refresh();
+        return matrices.inverseViewProjection;
+    }
+    
+    Frustum Camera::getFrustum() const 
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        refresh();
+        return matrices.frustum;
     }
     
     glm::vec3 Camera::getDirection() const
     {
+        std::scoped_lock < std::mutex > lck(mutex);
         return front;
     }
     
     glm::vec3 Camera::getRight() const
     {
+        std::scoped_lock < std::mutex > lck(mutex);
         return right;
     }
     
     void Camera::reset()
     {
+        std::scoped_lock < std::mutex > lck(mutex);
         position = glm::vec3(0.0f, 0.0f, 0.0f);
         front = glm::vec3(0.0f, 0.0f, -1.0f);
         worldUp = glm::vec3(0.0f, 1.0f, 0.0f);
+        customView = false;
         makeVectors();
     }
         
-    void Camera::setViewParam(glm::mat4 const& mat4) 
+    void Camera::setViewParam(glm::mat4 const& mat4) const
     {
-        auto param = matViewParam.lock();
-        param->mutex.lock();
-        param->value.mat4 = mat4;
-        param->mutex.unlock();
-        matViewParam.unlock();
+        std::scoped_lock < std::mutex > lck(matViewParam->mutex);
+        matViewParam->value.mat4 = mat4;
+        matViewParam->version = EffectParameterNextVersion();
     }
     
-    void Camera::setProjParam(glm::mat4 const& mat4)
+    void Camera::setProjParam(glm::mat4 const& mat4) const
     {
-        auto param = matProjParam.lock();
-        param->mutex.lock();
-        param->value.mat4 = mat4;
-        param->mutex.unlock();
-        matProjParam.unlock();
+        std::scoped_lock < std::mutex > lck(matProjParam->mutex);
+        matProjParam->value.mat4 = mat4;
+        matProjParam->version = EffectParameterNextVersion();
     }
     
     void Camera::makeVectors()
@@ -201,7 +326,36 @@ namespace Clean
         front = glm::normalize(newFront);
         right = glm::normalize(glm::cross(front, worldUp));
         up    = glm::normalize(glm::cross(right, front));
-        matView = glm::lookAt(position, position + front, up);
-        setViewParam(matView);
+        dirty |= kCameraDirtyView;
+    }
+    
+    void Camera::refresh() const 
+    {
+        if (!dirty)
+            return;
+        
+        if (dirty & kCameraDirtyView)
+        {
+            matrices.view = customView ? customViewMatrix : glm::lookAt(position, position + front, up);
+            matrices.inverseView = glm::inverse(matrices.view);
+            setViewParam(matrices.view);
+        }
+        
+        if (dirty & kCameraDirtyProjection)
+        {
+            if (projectionType == kCameraOrthographic)
+                matrices.projection = glm::ortho(orthoBounds.x, orthoBounds.y, orthoBounds.z, orthoBounds.w, near, far);
+            else
+                matrices.projection = glm::perspective(glm::radians(fov), ratio, near, far);
+            
+            matrices.inverseProjection = glm::inverse(matrices.projection);
+            setProjParam(matrices.projection);
+        }
+        
+        matrices.viewProjection = matrices.projection * matrices.view;
+        matrices.inverseViewProjection = matrices.inverseView * matrices.inverseProjection;
+        matrices.frustum = Frustum::FromMatrix(matrices.viewProjection);
+        matrices.version = EffectParameterNextVersion();
+        dirty = 0;
     }
 }
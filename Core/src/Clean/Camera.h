@@ -9,6 +9,9 @@
 #include "Window.h"
 #include "EffectParameterProvider.h"
 #include "Property.h"
+#include "Bounds.h"
+
+#include <mutex>
 
 namespace Clean 
 {
@@ -16,6 +19,32 @@ namespace Clean
     static constexpr const std::uint8_t kCameraActionBackTranslate = 2;
     static constexpr const std::uint8_t kCameraActionRotate = 3;
     
+    //! @brief Flags of the Camera's data changed since its last commit.
+    static constexpr const std::uint8_t kCameraDirtyView = 1;
+    static constexpr const std::uint8_t kCameraDirtyProjection = 2;
+    static constexpr const std::uint8_t kCameraDirtyAll = kCameraDirtyView | kCameraDirtyProjection;
+    
+    //! @brief Kinds of projection of a Camera.
+    static constexpr const std::uint8_t kCameraPerspective = 0;
+    static constexpr const std::uint8_t kCameraOrthographic = 1;
+    
+    /** @brief Matrices and frustum computed by a Camera for one version of its data. */
+    struct CameraMatrices 
+    {
+        glm::mat4 view = glm::mat4(1.0f);
+        glm::mat4 projection = glm::mat4(1.0f);
+        glm::mat4 viewProjection = glm::mat4(1.0f);
+        glm::mat4 inverseView = glm::mat4(1.0f);
+        glm::mat4 inverseProjection = glm::mat4(1.0f);
+        glm::mat4 inverseViewProjection = glm::mat4(1.0f);
+        
+        //! @brief Planes of viewProjection, in world space.
+        Frustum frustum;
+        
+        //! @brief Version of these matrices. Changes each time one of them changes.
+        std::uint64_t version = 0;
+    };
+    
     struct CameraAction 
     {
         std::uint8_t action;
@@ -46,6 +75,13 @@ namespace Clean
      * to a Window for its WindowResizeEvent. It will automatically take the ratio from the listened
      * Window to update the Projection matrix.
      *
+     * Actions, resizes and projection changes only store their inputs and mark the matrices dirty.
+     * The matrices, their inverses and the frustum are computed once, by \ref commit() or by the first
+     * getter called after a change, and published to the EffectParameters at this time. Each new set of
+     * matrices gets a new version, from EffectParameterNextVersion(): an EffectSession, a CullingBatch
+     * or a ParameterBlock may skip their work while the version of the Camera doesn't change. Shadow
+     * and reflection views are Cameras too, with \ref setOrthographic() or \ref setViewMatrix().
+     *
      * \note Deriving Camera:
      * Camera can be derived from to create custom Cameras, like FPS-like, or following a particular
      * object in a custom way. To derive correctly Camera, you must override:
@@ -71,11 +107,33 @@ namespace Clean
         float ratio, fov;
         float near, far;
         
-        mutable glm::mat4 matView;
-        mutable glm::mat4 matProj;
+        //! @brief kCameraPerspective or kCameraOrthographic.
+        std::uint8_t projectionType;
+        
+        //! @brief Left, right, bottom and top planes of the orthographic projection.
+        glm::vec4 orthoBounds;
+        
+        //! @brief True if the view matrix was given by setViewMatrix().
+        bool customView;
+        
+        //! @brief View matrix given by setViewMatrix().
+        glm::mat4 customViewMatrix;
+        
+        //! @brief kCameraDirty* flags of the data changed since matrices were computed.
+        mutable std::uint8_t dirty;
+        
+        //! @brief Matrices computed by the last commit.
+        mutable CameraMatrices matrices;
+        
+        //! @brief Parameters published by commit(). They never change, only their values do.
+        SharedParameter matViewParam;
+        SharedParameter matProjParam;
+        
+        //! @brief matViewParam and matProjParam, returned by findAllParameters().
+        SharedParameters parameters;
         
-        Property < SharedParameter > matViewParam;
-        Property < SharedParameter > matProjParam;
+        //! @brief Protects the data above.
+        mutable std::mutex mutex;
         
         std::atomic < bool > constraintPitch;
         std::atomic < float > constraintPitchValue;
@@ -104,6 +162,29 @@ namespace Clean
         
         virtual void setProjection(float fov, float near, float far);
         
+        /*! @brief Uses an orthographic projection, like for a directional light's shadow view. */
+        virtual void setOrthographic(float left, float right, float bottom, float top, float near, float far);
+        
+        /*! @brief Places the Camera at position, looking at target. Yaw and pitch are deduced from the direction. */
+        virtual void lookAt(glm::vec3 const& position, glm::vec3 const& target);
+        
+        /*! @brief Uses the given view matrix, like a mirrored view for reflections, until the next action,
+         *  lookAt() or reset(). */
+        virtual void setViewMatrix(glm::mat4 const& view);
+        
+        /*! @brief Computes the matrices changed since the last commit and publishes them to the EffectParameters.
+         *  Usually called once per frame, before rendering. Returns the version of the matrices. */
+        std::uint64_t commit() const;
+        
+        /*! @brief Returns the matrices, computing them if they changed. */
+        CameraMatrices getMatrices() const;
+        
+        /*! @brief Returns the version of the matrices, computing them if they changed. */
+        std::uint64_t getVersion() const;
+        
+        /*! @brief Returns the parameters published by this Camera, without copying them. */
+        SharedParameters const& getParameters() const;
+        
         virtual glm::vec3 getPosition() const;
         
         virtual glm::vec3 getForward() const;
@@ -112,6 +193,21 @@ namespace Clean
         
         virtual glm::mat4 getViewMatrix() const;
         
+        /*! @brief Returns the inverse of the view matrix, the camera's transform in world space. */
+        virtual glm::mat4 getInverseViewMatrix() const;
+        
+        /*! @brief Returns the projection matrix. */
+        virtual glm::mat4 getProjectionMatrix() const;
+        
+        /*! @brief Returns the projection matrix times the view matrix. */
+        virtual glm::mat4 getViewProjectionMatrix() const;
+        
+        /*! @brief Returns the inverse of the view projection, to unproject points from clip space. */
+        virtual glm::mat4 getInverseViewProjectionMatrix() const;
+        
+        /*! @brief Returns the planes of the view frustum, in world space. */
+        virtual Frustum getFrustum() const;
+        
         virtual glm::vec3 getDirection() const;
         
         virtual glm::vec3 getRight() const;
@@ -120,11 +216,15 @@ namespace Clean
         
     protected:
         
-        void setViewParam(glm::mat4 const& mat4);
+        void setViewParam(glm::mat4 const& mat4) const;
         
-        void setProjParam(glm::mat4 const& mat4);
+        void setProjParam(glm::mat4 const& mat4) const;
         
+        /*! @brief Updates front, right and up from yaw and pitch, and marks the view dirty. mutex must be locked. */
         void makeVectors();
+        
+        /*! @brief Computes the dirty matrices and publishes them. mutex must be locked. */
+        void refresh() const;
     };
 }
 
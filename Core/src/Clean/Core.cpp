@@ -6,6 +6,8 @@
 #include "Exception.h"
 #include "Platform.h"
 
+#include <algorithm>
+
 namespace Clean
 {
     std::unique_ptr < Core > Core::instance = nullptr;
@@ -30,12 +32,15 @@ namespace Clean
         return *instance;
     }
 
-    Core::Core()
+    Core::Core() : deferredCount(0)
     {
         notificationCenter = AllocateShared < NotificationCenter >();
         assert(notificationCenter && "Can't allocate Clean::NotificationCenter.");
         std::atomic_store(&NotificationCenter::defaultCenter, notificationCenter);
 
+        JobSystem::currentInstance.store(&jobSystem);
+        assert(JobSystem::currentInstance.load() && "Can't store Clean::JobSystem.");
+
         moduleManager = AllocateShared < ModuleManager >();
         assert(moduleManager && "Can't allocate Clean::ModuleManager.");
 
@@ -69,7 +74,8 @@ namespace Clean
 
     Core::~Core()
     {
-        
+        // Members destroyed from now on deliver their events on the calling thread.
+        JobSystem::currentInstance.store(nullptr);
     }
 
     std::shared_ptr < NotificationCenter > Core::getNotificationCenter()
@@ -79,71 +85,175 @@ namespace Clean
 
     std::size_t Core::loadAllModules(std::uint8_t const& loadMode)
     {
-        std::lock_guard < std::mutex > lck(modulesDirMutex);
         assert(dynlibManager && moduleManager && "Invalid managers.");
-        std::size_t result = 0;
+        std::list < std::string > directories;
+
+        {
+            std::lock_guard < std::mutex > lck(modulesDirMutex);
+            directories = modulesDirectories;
+        }
+
+        std::scoped_lock < std::recursive_mutex > lck(modulesLoadMutex);
+        std::vector < std::string > files;
 
-        for (auto& dir : modulesDirectories)
+        for (auto& dir : directories)
         {
             std::string path = Platform::PathConcatenate(dir, std::string("*.") + kDynlibFileExtension);
-            auto files = Platform::FindFiles(path, Platform::kFindFilesNotRecursive);
+            auto found = Platform::FindFiles(path, Platform::kFindFilesNotRecursive);
 
-            for (auto& file : files)
+            for (auto& file : found)
             {
                 auto dynlib = dynlibManager->findFromFile(file);
 
-                if (dynlib && (loadMode == kModulesLoadReload))
+                if (dynlib)
                 {
-                    dynlib->forEachModules([](Module& module){
-                        module.reload();
-                    });
+                    if (loadMode == kModulesLoadReload)
+                    {
+                        dynlib->forEachModules([](Module& module){
+                            module.reload();
+                        });
+                    }
+
+                    continue;
                 }
 
-                else if (!dynlib)
+                auto deferred = std::find_if(deferredModules.begin(), deferredModules.end(), [&file](ModuleManifest const& manifest){
+                    return manifest.getFile() == file;
+                });
+
+                if (deferred != deferredModules.end())
+                    continue;
+
+                ModuleManifest manifest(file);
+
+                if (manifest.load(ModuleManifest::PathFor(file)))
                 {
-                    try
-                    {
-                        dynlib = AllocateShared < Dynlib >(file);
-                        dynlibManager->add(dynlib);
-
-                        ModuleGetFirstModuleInfosCbk callback = (ModuleGetFirstModuleInfosCbk) dynlib->symbol(kModuleGetFirstModuleInfosCbk);
-
-                        if (callback)
-                        {
-                            ModuleInfos* infos = callback();
-
-                            do
-                            {
-                                try
-                                {
-                                    auto module = AllocateShared < Module >(infos);
-                                    module->start();
-                                    dynlib->addModule(module);
-                                    moduleManager->add(module);
-                                    result++;
-                                }
-
-                                catch(ModuleInfosException const& e)
-                                {
-                                    Notification notif = BuildNotification(kNotificationLevelError,
-                                                                           "Module %s cannot be loaded: %s",
-                                                                           infos->name.data(), e.what());
-                                    notificationCenter->send(notif);
-                                }
-                            }
-                            while((infos = infos->next) != NULL);
-                        }
-                    }
+                    deferredModules.push_back(std::move(manifest));
+                    continue;
+                }
 
-                    catch(DynlibLoadException const& e)
-                    {
-                        Notification notif = BuildNotification(kNotificationLevelError,
-                                                               "Dynlib %s cannot be loaded: %s",
-                                                               file.data(), e.what());
-                        notificationCenter->send(notif);
-                    }
+                files.push_back(file);
+            }
+        }
+
+        deferredCount.store(deferredModules.size());
+        return loadDynlibs(files);
+    }
+
+    std::size_t Core::loadDeferredModules()
+    {
+        return loadDeferredModules([](ModuleManifest const&){ return true; });
+    }
+
+    std::size_t Core::loadDeferredModules(std::function < bool(ModuleManifest const&) > const& predicate)
+    {
+        if (!deferredCount.load())
+            return 0;
+
+        std::scoped_lock < std::recursive_mutex > lck(modulesLoadMutex);
+        std::vector < std::string > files;
+
+        auto kept = std::stable_partition(deferredModules.begin(), deferredModules.end(), [&predicate](ModuleManifest const& manifest){
+            return !predicate(manifest);
+        });
+
+        for (auto it = kept; it != deferredModules.end(); ++it)
+            files.push_back(it->getFile());
+
+        deferredModules.erase(kept, deferredModules.end());
+        deferredCount.store(deferredModules.size());
+
+        return loadDynlibs(files);
+    }
+
+    std::size_t Core::loadDeferredModulesForExtension(std::string const& ext)
+    {
+        return loadDeferredModules([&ext](ModuleManifest const& manifest){
+            return manifest.providesExtension(ext);
+        });
+    }
+
+    std::size_t Core::loadDeferredModulesForContent(const void* bytes, std::size_t size)
+    {
+        return loadDeferredModules([bytes, size](ModuleManifest const& manifest){
+            return manifest.providesContent(bytes, size);
+        });
+    }
+
+    std::size_t Core::loadDynlibs(std::vector < std::string > const& files)
+    {
+        struct OpenedDynlib
+        {
+            std::shared_ptr < Dynlib > dynlib;
+            ModuleGetFirstModuleInfosCbk callback = nullptr;
+            std::string error;
+        };
+
+        // Opening a library maps it, relocates it and runs its static initializers: this is what takes
+        // time, and it doesn't depend on the other libraries.
+
+        std::vector < OpenedDynlib > opened(files.size());
+
+        jobSystem.parallelFor(0, files.size(), 1, [&files, &opened](std::size_t first, std::size_t last){
+            for (std::size_t i = first; i < last; ++i)
+            {
+                try
+                {
+                    opened[i].dynlib = AllocateShared < Dynlib >(files[i]);
+                    opened[i].callback = (ModuleGetFirstModuleInfosCbk) opened[i].dynlib->symbol(kModuleGetFirstModuleInfosCbk);
+                }
+
+                catch(DynlibLoadException const& e)
+                {
+                    opened[i].dynlib.reset();
+                    opened[i].error = e.what();
+                }
+            }
+        });
+
+        // Modules register loaders and drivers when started: they are started by this thread, in the
+        // order their libraries were found.
+
+        std::size_t result = 0;
+
+        for (std::size_t i = 0; i < files.size(); ++i)
+        {
+            auto& dynlib = opened[i].dynlib;
+
+            if (!dynlib)
+            {
+                Notification notif = BuildNotification(kNotificationLevelError,
+                                                       "Dynlib %s cannot be loaded: %s",
+                                                       files[i].data(), opened[i].error.data());
+                notificationCenter->send(notif);
+                continue;
+            }
+
+            dynlibManager->add(dynlib);
+            if (!opened[i].callback) continue;
+
+            ModuleInfos* infos = opened[i].callback();
+
+            do
+            {
+                try
+                {
+                    auto module = AllocateShared < Module >(infos);
+                    module->start();
+                    dynlib->addModule(module);
+                    moduleManager->add(module);
+                    result++;
+                }
+
+                catch(ModuleInfosException const& e)
+                {
+                    Notification notif = BuildNotification(kNotificationLevelError,
+                                                           "Module %s cannot be loaded: %s",
+                                                           infos->name.data(), e.what());
+                    notificationCenter->send(notif);
                 }
             }
+            while((infos = infos->next) != NULL);
         }
 
         return result;
@@ -154,14 +264,25 @@ namespace Clean
         return moduleManager->count();
     }
 
+    std::size_t Core::getDeferredModuleCount() const
+    {
+        return deferredCount.load();
+    }
+
     std::shared_ptr < Driver > Core::findDriver(std::string const& name)
     {
-        return driverManager->findDriverByName(name);
+        if (auto driver = driverManager->findDriverByName(name))
+            return driver;
+
+        auto loaded = loadDeferredModules([&name](ModuleManifest const& manifest){
+            return manifest.providesDriver(name);
+        });
+
+        return loaded ? driverManager->findDriverByName(name) : nullptr;
     }
 
     void Core::clearFileLoaders()
     {
-        std::scoped_lock < std::mutex > lck(fileLoadersMutex);
         fileLoaders.clear();
     }
     
@@ -187,6 +308,12 @@ namespace Clean
     {
         NotificationCenter::GetDefault()->terminate();
         
+        {
+            std::scoped_lock < std::recursive_mutex > lck(modulesLoadMutex);
+            deferredModules.clear();
+            deferredCount.store(0);
+        }
+        
         clearFileLoaders();
         imgManager.reset();
         pixConvManager.reset();
@@ -212,4 +339,9 @@ namespace Clean
     {
         return pixConvManager;
     }
+    
+    JobSystem& Core::getJobSystem()
+    {
+        return jobSystem;
+    }
 }
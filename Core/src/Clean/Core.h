@@ -9,17 +9,21 @@
 #include "NotificationListener.h"
 #include "ModuleManager.h"
 #include "DynlibManager.h"
+#include "ModuleManifest.h"
 #include "WindowManager.h"
 #include "DriverManager.h"
 #include "FileLoader.h"
+#include "FileLoaderRegistry.h"
 #include "FileSystem.h"
 #include "MeshManager.h"
 #include "MaterialManager.h"
 #include "PixelSetConverterManager.h"
 #include "ImageManager.h"
+#include "JobSystem.h"
 
 #include <memory>
 #include <atomic>
+#include <functional>
 #include <list>
 #include <mutex>
 #include <typeindex>
@@ -46,6 +50,13 @@ namespace Clean
      * into the DynlibManager. Then, 'GetFirstModuleInfos()' is called from the dynamic library. All modules
      * for this file are loaded from this structure into the ModuleManager. 
      *
+     * ### Deferred and parallel loading
+     * A dynamic library with a ModuleManifest next to it is not loaded by loadAllModules(): it is loaded by
+     * the first findFileLoader() or findDriver() asking for an extension or a driver it provides, or by 
+     * loadDeferredModules(). Libraries without a manifest are opened, and their symbols resolved, in parallel 
+     * by the JobSystem; their modules are then started one after the other, in directory order, by the thread
+     * loading them. 
+     *
      * Core's manipulation function should be called from main thread. However, all Core's getters can be 
      * called from any thread. Managers are threadsafe and can be used from any threads.
      *
@@ -65,7 +76,7 @@ namespace Clean
      *
      * ### Management of FileLoaders
      * A FileLoader is managed upon the following principles: a common base class, FileLoaderInterface, is used
-     * to store all FileLoaders in a std::vector. A template class, FileLoader, is used to define a loader for 
+     * to store all FileLoaders in a FileLoaderRegistry, by type and extension. A template class, FileLoader, is used to define a loader for 
      * a specific type, like Mesh. All loaders that loads a Mesh will derives from the specialized class  
      * FileLoader < Mesh >. Taking as example an md5 mesh loader, it will derive from FileLoader < Mesh >. It will
      * override its specialized method. 
@@ -76,6 +87,10 @@ namespace Clean
         //! @brief NotificationCenter used by the Core object. 
         std::shared_ptr < NotificationCenter > notificationCenter;
         
+        //! @brief JobSystem shared by the managers, loaders and drivers. Declared before them so it is
+        //! destroyed after them.
+        JobSystem jobSystem;
+        
         //! @brief Modules manager. 
         std::shared_ptr < ModuleManager > moduleManager;
         
@@ -94,14 +109,18 @@ namespace Clean
         //! @brief Protects modulesDirectories. 
         mutable std::mutex modulesDirMutex;
         
-        //! @brief Stores a list of shared FileLoaderInterface. 
-        typedef std::vector < std::shared_ptr < FileLoaderInterface > > SVFileLoaders;
+        //! @brief Libraries whose loading is deferred until something they provide is needed.
+        std::vector < ModuleManifest > deferredModules;
+        
+        //! @brief Size of deferredModules, read without locking by findFileLoader() and findDriver().
+        std::atomic < std::size_t > deferredCount;
         
-        //! @brief Registers FileLoaderInterface for each typeid. 
-        std::map < std::type_index, SVFileLoaders > fileLoaders; 
+        //! @brief Serializes the loading of libraries, and protects deferredModules. Recursive, as a module's
+        //! start function may need a deferred module.
+        mutable std::recursive_mutex modulesLoadMutex;
         
-        //! @brief Protects fileLoaders.
-        mutable std::mutex fileLoadersMutex;
+        //! @brief Registers FileLoaderInterface for each typeid and extension. 
+        FileLoaderRegistry fileLoaders;
         
         //! @brief Global FileSystem used by Core. 
         FileSystem fileSystem;
@@ -161,16 +180,22 @@ namespace Clean
          *      If second, already loaded modules are not reloaded. 
          * 
          * \note When adding a new module directory, use kModulesLoadNoReload to load only new
-         * modules from that directory. 
+         * modules from that directory. Libraries with a ModuleManifest are deferred, not loaded.
          * 
-         * \return Number of modules loaded. 
+         * \return Number of modules loaded. Deferred libraries are not counted: see getDeferredModuleCount(). 
         **/
         std::size_t loadAllModules(std::uint8_t const& loadMode = kModulesLoadNoReload);
         
+        /*! @brief Loads every deferred library. Returns the number of modules loaded. */
+        std::size_t loadDeferredModules();
+        
         /*! @brief Returns number of modules in moduleManager. */
         std::size_t getModuleCount() const;
         
-        /*! @brief Finds a driver with given name. */
+        /*! @brief Returns the number of libraries whose loading is deferred. */
+        std::size_t getDeferredModuleCount() const;
+        
+        /*! @brief Finds a driver with given name, loading the deferred library providing it if needed. */
         std::shared_ptr < Driver > findDriver(std::string const& name);
         
         /*! @brief Adds a file loader to the engine. */
@@ -178,30 +203,38 @@ namespace Clean
         void addFileLoader(std::shared_ptr < LoaderType > const& loader) 
         {
             assert(loader && "Invalid FileLoader pointer.");
-            const std::type_index idx = typeid(ResultType);
-            std::shared_ptr < FileLoaderInterface > basePtr = std::static_pointer_cast < FileLoaderInterface >(loader);
-            
-            std::scoped_lock < std::mutex > lck(fileLoadersMutex);
-            fileLoaders[idx].push_back(basePtr);
+            fileLoaders.add(typeid(ResultType), std::static_pointer_cast < FileLoaderInterface >(loader));
         }
         
-        /*! @brief Finds the first loader responding to given extension for the desired type, 
-         * or returns nullptr if none were found. */
+        /*! @brief Finds the loader with the highest priority for given extension and the desired type, 
+         * or returns nullptr if none were found. If no loaded module has one, the deferred libraries
+         * providing the extension are loaded. */
         template < class ResultType > 
         auto findFileLoader(std::string const& ext) -> std::shared_ptr < FileLoader < ResultType > >
         {
-            const std::type_index idx = typeid(ResultType);
-            std::scoped_lock < std::mutex > lck(fileLoadersMutex);
-            auto it = fileLoaders.find(idx);
-            if (it == fileLoaders.end()) return nullptr;
+            if (auto loader = fileLoaders.find(typeid(ResultType), ext))
+                return ReinterpretShared < FileLoader < ResultType > >(loader);
+            
+            if (!loadDeferredModulesForExtension(ext))
+                return nullptr;
+            
+            return ReinterpretShared < FileLoader < ResultType > >(fileLoaders.find(typeid(ResultType), ext));
+        }
+        
+        /*! @brief Finds the loader with the highest priority whose FileLoaderInfos::magics match the first bytes
+         *  of a file, for the desired type, or returns nullptr if none were found. Reading kFileLoaderSniffSize 
+         *  bytes is enough for the loaders of the engine. If no loaded module has one, the deferred libraries
+         *  whose manifest has a matching magic are loaded. */
+        template < class ResultType >
+        auto findFileLoaderByContent(const void* bytes, std::size_t size) -> std::shared_ptr < FileLoader < ResultType > >
+        {
+            if (auto loader = fileLoaders.findByContent(typeid(ResultType), bytes, size))
+                return ReinterpretShared < FileLoader < ResultType > >(loader);
             
-            for (auto& loader : it->second)
-            {
-                assert(loader && "Invalid FileLoader pointer.");
-                if (loader->isLoadable(ext)) return ReinterpretShared < FileLoader < ResultType > >(loader);
-            }
+            if (!loadDeferredModulesForContent(bytes, size))
+                return nullptr;
             
-            return nullptr;
+            return ReinterpretShared < FileLoader < ResultType > >(fileLoaders.findByContent(typeid(ResultType), bytes, size));
         }
         
         /*! @brief Finds the first loader responding to given name for the desired type, or returns 
@@ -209,47 +242,26 @@ namespace Clean
         template < class ResultType >
         auto findFileLoaderByName(std::string const& name) -> std::shared_ptr < FileLoader < ResultType > >
         {
-            const std::type_index idx = typeid(ResultType);
-            std::scoped_lock < std::mutex > lck(fileLoadersMutex);
-            auto it = fileLoaders.find(idx);
-            if (it == fileLoaders.end()) return nullptr;
-            
-            for (auto& loader : it->second)
-            {
-                assert(loader && "Invalid FileLoader pointer.");
-                if (loader->getInfos().name == name) return ReinterpretShared < FileLoader < ResultType > >(loader);
-            }
-            
-            return nullptr;
+            return ReinterpretShared < FileLoader < ResultType > >(fileLoaders.findByName(typeid(ResultType), name));
         }
         
-        /*! @brief Returns all file loaders for a given type. */
+        /*! @brief Returns all file loaders for a given type, by decreasing priority. */
         template < class ResultType > 
         auto findAllFileLoaders() -> std::vector < std::shared_ptr < FileLoader < ResultType > > >
         {
-            typedef std::vector < std::shared_ptr < FileLoader < ResultType > > > SVResult;
-            const std::type_index idx = typeid(ResultType);
-            std::scoped_lock < std::mutex > lck(fileLoadersMutex);
-            auto it = fileLoaders.find(idx);
-            if (it == fileLoaders.end()) return SVResult();
+            std::vector < std::shared_ptr < FileLoader < ResultType > > > result;
             
-            return it->second;
+            for (auto const& loader : fileLoaders.findAll(typeid(ResultType)))
+                result.push_back(ReinterpretShared < FileLoader < ResultType > >(loader));
+            
+            return result;
         }
         
         /*! @brief Removes the given file loader from the list of loaders for the given type. */
         template < class ResultType >
         void removeFileLoader(std::shared_ptr < FileLoader < ResultType > > const& loader)
         {
-            const std::type_index idx = typeid(ResultType);
-            std::scoped_lock < std::mutex > lck(fileLoadersMutex);
-            auto it = fileLoaders.find(idx);
-            if (it == fileLoaders.end()) return;
-            
-            auto localIt = std::find_if(it->second.begin(), it->second.end(), [loader](auto localLoader) { 
-                return loader.get() == localLoader.get(); });
-                
-            if (localIt != it->second.end())
-                it->second.erase(localIt);
+            fileLoaders.remove(typeid(ResultType), std::static_pointer_cast < FileLoaderInterface >(loader));
         }
         
         /*! @brief Clear all file loaders. */
@@ -275,6 +287,25 @@ namespace Clean
         
         /*! @brief Returns pixConvManager. */
         PixelSetConverterManager& getPixelSetConverterManager();
+        
+        /*! @brief Returns the JobSystem. */
+        JobSystem& getJobSystem();
+        
+    private:
+        
+        /*! @brief Loads the deferred libraries accepted by predicate. Returns the number of modules loaded. */
+        std::size_t loadDeferredModules(std::function < bool(ModuleManifest const&) > const& predicate);
+        
+        /*! @brief Loads the deferred libraries providing a loader for ext. Returns the number of modules loaded. */
+        std::size_t loadDeferredModulesForExtension(std::string const& ext);
+        
+        /*! @brief Loads the deferred libraries providing a loader for files starting with bytes. Returns the number
+         *  of modules loaded. */
+        std::size_t loadDeferredModulesForContent(const void* bytes, std::size_t size);
+        
+        /*! @brief Opens the given libraries in parallel, then starts their modules in order. modulesLoadMutex
+         *  must be locked. Returns the number of modules loaded. */
+        std::size_t loadDynlibs(std::vector < std::string > const& files);
     };
 }
 
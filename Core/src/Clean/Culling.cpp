@@ -0,0 +1,279 @@
+/** \file Core/Culling.cpp
+**/
+
+#include "Culling.h"
+#include "RenderQueue.h"
+#include "OcclusionBuffer.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define CLEAN_CULLING_SSE2
+#endif
+
+namespace Clean
+{
+    std::size_t CullingBatch::add(BoundingBox const& box, RenderCommand command)
+    {
+        const glm::vec3 center = box.empty() ? glm::vec3(0.0f) : box.center();
+        const glm::vec3 extents = box.empty() ? glm::vec3(-1.0f) : box.extents();
+
+        centerX.push_back(center.x);
+        centerY.push_back(center.y);
+        centerZ.push_back(center.z);
+        radius.push_back(box.empty() ? -1.0f : glm::length(extents));
+        extentX.push_back(extents.x);
+        extentY.push_back(extents.y);
+        extentZ.push_back(extents.z);
+        commands.push_back(std::move(command));
+
+        return centerX.size() - 1;
+    }
+
+    std::size_t CullingBatch::add(BoundingSphere const& sphere, RenderCommand command)
+    {
+        centerX.push_back(sphere.center.x);
+        centerY.push_back(sphere.center.y);
+        centerZ.push_back(sphere.center.z);
+        radius.push_back(sphere.radius);
+        extentX.push_back(sphere.radius);
+        extentY.push_back(sphere.radius);
+        extentZ.push_back(sphere.radius);
+        commands.push_back(std::move(command));
+
+        return centerX.size() - 1;
+    }
+
+    void CullingBatch::clear()
+    {
+        centerX.clear(); centerY.clear(); centerZ.clear();
+        radius.clear();
+        extentX.clear(); extentY.clear(); extentZ.clear();
+        commands.clear();
+        visibility.clear();
+        visibleCount = 0;
+        occludedCount = 0;
+    }
+
+    void CullingBatch::reserve(std::size_t count)
+    {
+        centerX.reserve(count); centerY.reserve(count); centerZ.reserve(count);
+        radius.reserve(count);
+        extentX.reserve(count); extentY.reserve(count); extentZ.reserve(count);
+        commands.reserve(count);
+    }
+
+    std::size_t CullingBatch::size() const
+    {
+        return centerX.size();
+    }
+
+    std::size_t CullingBatch::cull(Frustum const& frustum, OcclusionBuffer const* occlusion)
+    {
+        ProfileScope("CullingBatch::cull");
+
+        const std::size_t count = size();
+        visibility.assign(count, kCullingHidden);
+
+        std::atomic < std::size_t > visible(0), occluded(0);
+
+        auto fn = [this, &frustum, occlusion, &visible, &occluded](std::size_t first, std::size_t last){
+            const std::size_t inFrustum = cullRange(frustum, first, last);
+            const std::size_t hidden = inFrustum ? occludeRange(occlusion, first, last) : 0;
+            visible.fetch_add(inFrustum - hidden, std::memory_order_relaxed);
+            occluded.fetch_add(hidden, std::memory_order_relaxed);
+        };
+
+        // Chunks are multiples of four objects, so each one is tested with whole SIMD iterations but the last.
+
+        if (JobSystem* jobSystem = JobSystem::Find())
+            jobSystem->parallelFor(0, count, kCullingBatchGrain, fn);
+        else
+            fn(0, count);
+
+        visibleCount = visible.load();
+        occludedCount = occluded.load();
+        ProfileCount("occluded", static_cast < std::int64_t >(occludedCount));
+        return visibleCount;
+    }
+
+    bool CullingBatch::isVisible(std::size_t index) const
+    {
+        return index < visibility.size() && visibility[index] == kCullingVisible;
+    }
+
+    std::size_t CullingBatch::getVisibleCount() const
+    {
+        return visibleCount;
+    }
+
+    std::vector < std::size_t > CullingBatch::findVisible() const
+    {
+        std::vector < std::size_t > result;
+        result.reserve(visibleCount);
+
+        for (std::size_t i = 0; i < visibility.size(); ++i)
+        {
+            if (visibility[i] == kCullingVisible) result.push_back(i);
+        }
+
+        return result;
+    }
+
+    std::size_t CullingBatch::getOccludedCount() const
+    {
+        return occludedCount;
+    }
+
+    std::vector < std::size_t > CullingBatch::findOcclusionProxies() const
+    {
+        std::vector < std::size_t > result;
+
+        for (std::size_t i = 0; i < visibility.size(); ++i)
+        {
+            if (visibility[i] == kCullingQueryOccluded && !commands[i].occlusionQuery->isPending())
+                result.push_back(i);
+        }
+
+        return result;
+    }
+
+    void CullingBatch::commit(RenderQueue& queue) const
+    {
+        for (std::size_t i = 0; i < visibility.size(); ++i)
+        {
+            if (visibility[i] == kCullingVisible && commands[i].pipeline)
+                queue.addCommand(commands[i]);
+        }
+    }
+
+    void CullingBatch::commit(RenderQueue& queue, std::uint64_t frame) const
+    {
+        std::vector < RenderCommand > visible;
+        visible.reserve(visibleCount);
+
+        for (std::size_t i = 0; i < visibility.size(); ++i)
+        {
+            if (visibility[i] == kCullingVisible && commands[i].pipeline)
+                visible.push_back(commands[i]);
+        }
+
+        queue.addCommands(visible, frame);
+    }
+
+    std::size_t CullingBatch::cullRange(Frustum const& frustum, std::size_t first, std::size_t last)
+    {
+        std::size_t visible = 0;
+        std::size_t i = first;
+
+#   ifdef CLEAN_CULLING_SSE2
+        // Planes are broadcast once: each lane tests one object against the six planes.
+
+        __m128 nx[kFrustumPlanes], ny[kFrustumPlanes], nz[kFrustumPlanes], nw[kFrustumPlanes];
+        __m128 ax[kFrustumPlanes], ay[kFrustumPlanes], az[kFrustumPlanes];
+
+        for (std::size_t p = 0; p < kFrustumPlanes; ++p)
+        {
+            glm::vec4 const& plane = frustum.planes[p];
+            nx[p] = _mm_set1_ps(plane.x); ny[p] = _mm_set1_ps(plane.y);
+            nz[p] = _mm_set1_ps(plane.z); nw[p] = _mm_set1_ps(plane.w);
+            ax[p] = _mm_set1_ps(std::fabs(plane.x)); ay[p] = _mm_set1_ps(std::fabs(plane.y));
+            az[p] = _mm_set1_ps(std::fabs(plane.z));
+        }
+
+        const __m128 zero = _mm_setzero_ps();
+
+        for (; i + 4 <= last; i += 4)
+        {
+            const __m128 cx = _mm_loadu_ps(&centerX[i]);
+            const __m128 cy = _mm_loadu_ps(&centerY[i]);
+            const __m128 cz = _mm_loadu_ps(&centerZ[i]);
+            const __m128 r = _mm_loadu_ps(&radius[i]);
+            const __m128 ex = _mm_loadu_ps(&extentX[i]);
+            const __m128 ey = _mm_loadu_ps(&extentY[i]);
+            const __m128 ez = _mm_loadu_ps(&extentZ[i]);
+
+            // Empty bounds have a negative radius.
+            __m128 inside = _mm_cmpge_ps(r, zero);
+
+            for (std::size_t p = 0; p < kFrustumPlanes; ++p)
+            {
+                __m128 d = _mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy));
+                d = _mm_add_ps(d, _mm_add_ps(_mm_mul_ps(nz[p], cz), nw[p]));
+
+                __m128 boxRadius = _mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey));
+                boxRadius = _mm_add_ps(boxRadius, _mm_mul_ps(az[p], ez));
+
+                // Distance + radius >= 0 for both the sphere and the box.
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, r), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, boxRadius), zero));
+            }
+
+            const int mask = _mm_movemask_ps(inside);
+
+            for (std::size_t lane = 0; lane < 4; ++lane)
+            {
+                const std::uint8_t value = (mask >> lane) & 1;
+                visibility[i + lane] = value;
+                visible += value;
+            }
+        }
+#   endif
+
+        for (; i < last; ++i)
+        {
+            bool inside = radius[i] >= 0.0f;
+
+            for (std::size_t p = 0; p < kFrustumPlanes && inside; ++p)
+            {
+                glm::vec4 const& plane = frustum.planes[p];
+                const float d = plane.x * centerX[i] + plane.y * centerY[i] + plane.z * centerZ[i] + plane.w;
+                const float boxRadius = std::fabs(plane.x) * extentX[i] + std::fabs(plane.y) * extentY[i] + std::fabs(plane.z) * extentZ[i];
+                inside = (d + radius[i] >= 0.0f) && (d + boxRadius >= 0.0f);
+            }
+
+            visibility[i] = inside ? 1 : 0;
+            visible += inside ? 1 : 0;
+        }
+
+        return visible;
+    }
+
+    std::size_t CullingBatch::occludeRange(OcclusionBuffer const* occlusion, std::size_t first, std::size_t last)
+    {
+        std::size_t occluded = 0;
+
+        for (std::size_t i = first; i < last; ++i)
+        {
+            if (visibility[i] != kCullingVisible)
+                continue;
+
+            // The GPU result is one frame late but exact; the CPU buffer is current but only knows the occluders.
+
+            auto const& query = commands[i].occlusionQuery;
+
+            if (query && query->isOccluded()) {
+                visibility[i] = kCullingQueryOccluded;
+                occluded++;
+                continue;
+            }
+
+            if (occlusion) {
+                const glm::vec3 center(centerX[i], centerY[i], centerZ[i]);
+                const glm::vec3 extents(extentX[i], extentY[i], extentZ[i]);
+
+                if (!occlusion->isVisible(BoundingBox{ center - extents, center + extents })) {
+                    visibility[i] = kCullingHidden;
+                    occluded++;
+                }
+            }
+        }
+
+        return occluded;
+    }
+}
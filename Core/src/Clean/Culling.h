@@ -0,0 +1,121 @@
+/** \file Core/Culling.h
+**/
+
+#ifndef CLEAN_CULLING_H
+#define CLEAN_CULLING_H
+
+#include "Bounds.h"
+#include "RenderCommand.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Clean
+{
+    class RenderQueue;
+    class OcclusionBuffer;
+
+    //! @brief Number of objects tested by a job of CullingBatch::cull().
+    static constexpr const std::size_t kCullingBatchGrain = 1024;
+
+    /** @brief Culls a batch of objects against a frustum before their commands reach a RenderQueue.
+     *
+     * Bounds are stored as structure of arrays: a center and a radius, and the extents of the box when
+     * there is one. \ref cull() tests four objects per iteration with SSE when available, on the jobs of the
+     * JobSystem when there is one. An object is visible if both its sphere and its box intersect the frustum.
+     *
+     * The usual frame is: clear(), add() the bounds and RenderCommand of every object, cull() with the frustum
+     * of the Camera, and commit() the visible commands to the RenderQueue.
+     *
+     * Objects inside the frustum may also be tested for occlusion, so hidden objects never reach the RenderQueue:
+     * - against an OcclusionBuffer given to cull(), rasterized on the CPU from the occluders of the frame,
+     * - by the GPU, when their RenderCommand has an OcclusionQuery: an object whose last query says it was hidden
+     *      is culled. Its query must then be issued on a proxy, listed by findOcclusionProxies(), so the object
+     *      comes back when it is visible again.
+     *
+     * A CullingBatch is not thread-safe: it is filled by one thread, then culled.
+     *
+    **/
+    class CullingBatch
+    {
+        //! @brief Centers of the objects.
+        std::vector < float > centerX, centerY, centerZ;
+
+        //! @brief Radius of the spheres of the objects.
+        std::vector < float > radius;
+
+        //! @brief Half-sizes of the boxes of the objects. Equal to the radius for spheres.
+        std::vector < float > extentX, extentY, extentZ;
+
+        //! @brief Command of each object. Commands without a pipeline are not committed.
+        std::vector < RenderCommand > commands;
+
+        //! @brief Values of visibility.
+        static constexpr const std::uint8_t kCullingHidden = 0;
+        static constexpr const std::uint8_t kCullingVisible = 1;
+        static constexpr const std::uint8_t kCullingQueryOccluded = 2;
+
+        //! @brief Result of the last cull(), one byte per object.
+        std::vector < std::uint8_t > visibility;
+
+        //! @brief Number of visible objects at the last cull().
+        std::size_t visibleCount = 0;
+
+        //! @brief Number of objects in the frustum but occluded at the last cull().
+        std::size_t occludedCount = 0;
+
+    public:
+
+        /*! @brief Adds an object bounded by box and returns its index. */
+        std::size_t add(BoundingBox const& box, RenderCommand command = RenderCommand());
+
+        /*! @brief Adds an object bounded by sphere and returns its index. */
+        std::size_t add(BoundingSphere const& sphere, RenderCommand command = RenderCommand());
+
+        /*! @brief Removes all objects. */
+        void clear();
+
+        /*! @brief Reserves storage for count objects. */
+        void reserve(std::size_t count);
+
+        /*! @brief Returns the number of objects. */
+        std::size_t size() const;
+
+        /*! @brief Tests all objects against frustum, then against occlusion if not null and against their
+         *  OcclusionQuery if any, and returns the number of visible objects. occlusion must be rasterized. **/
+        std::size_t cull(Frustum const& frustum, OcclusionBuffer const* occlusion = nullptr);
+
+        /*! @brief Returns true if the object at index was visible at the last cull(). */
+        bool isVisible(std::size_t index) const;
+
+        /*! @brief Returns the number of visible objects at the last cull(). */
+        std::size_t getVisibleCount() const;
+
+        /*! @brief Returns the number of objects in the frustum but occluded at the last cull(). */
+        std::size_t getOccludedCount() const;
+
+        /*! @brief Returns the indexes of the visible objects, in the order they were added. */
+        std::vector < std::size_t > findVisible() const;
+
+        /*! @brief Returns the indexes of the objects culled by their OcclusionQuery at the last cull(). Their
+         *  query, not pending anymore, must be issued by drawing their bounds. **/
+        std::vector < std::size_t > findOcclusionProxies() const;
+
+        /*! @brief Adds the commands of the visible objects to queue, in the order they were added. */
+        void commit(RenderQueue& queue) const;
+
+        /*! @brief Adds the commands of the visible objects to queue for a frame of the FramePipeline, at once. */
+        void commit(RenderQueue& queue, std::uint64_t frame) const;
+
+    private:
+
+        /*! @brief Tests objects [first, last) and returns the number of visible ones. */
+        std::size_t cullRange(Frustum const& frustum, std::size_t first, std::size_t last);
+
+        /*! @brief Tests the visible objects [first, last) for occlusion and returns the number of occluded ones. */
+        std::size_t occludeRange(OcclusionBuffer const* occlusion, std::size_t first, std::size_t last);
+    };
+}
+
+#endif // CLEAN_CULLING_H
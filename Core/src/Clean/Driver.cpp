@@ -5,10 +5,11 @@
 #include "Core.h"
 #include "Platform.h"
 #include "ImageManager.h"
+#include "Profiler.h"
 
 namespace Clean 
 {
-    Driver::Driver() : state(kDriverStateNotInited)
+    Driver::Driver() : state(kDriverStateNotInited), mipmapFilter(kMipmapFilterBox), mipmapSRGB(true), submittedFrame(0)
     {
         
     }
@@ -46,28 +47,89 @@ namespace Clean
     
     void Driver::update() 
     {
-        renderWindows.forEach([this](std::shared_ptr < RenderWindow >& wnd){
-            assert(wnd && "Null window stored.");
-            wnd->prepare(*this);
-        });
-        
-        commitAllQueues();
+        {
+            ProfileScope("Driver::update");
+            
+            if (JobSystem* jobSystem = JobSystem::Find())
+                jobSystem->update();
+            
+            textureStreamer.update();
+            
+            if (framePipeline.isActive())
+            {
+                framePipeline.poll();
+                std::uint64_t frame = framePipeline.beginSubmit();
+                
+                if (frame)
+                {
+                    submittedFrame = frame;
+                    
+                    renderWindows.forEach([this](std::shared_ptr < RenderWindow > const& wnd){
+                        assert(wnd && "Null window stored.");
+                        wnd->prepare(*this);
+                    });
+                    
+                    if (auto graph = std::atomic_load(&renderGraph))
+                        graph->execute(*this);
+                    
+                    commitAllQueues(frame);
+                    framePipeline.endSubmit(frame, makeFrameFence());
+                    submittedFrame = 0;
+                }
+                
+                renderWindows.forEach([frame](std::shared_ptr < RenderWindow > const& wnd){
+                    assert(wnd && "Null window stored.");
+                    if (frame) wnd->swapBuffers();
+                    wnd->update();
+                });
+                
+                framePipeline.poll();
+            }
+            
+            else
+            {
+                renderWindows.forEach([this](std::shared_ptr < RenderWindow > const& wnd){
+                    assert(wnd && "Null window stored.");
+                    wnd->prepare(*this);
+                });
+                
+                if (auto graph = std::atomic_load(&renderGraph))
+                    graph->execute(*this);
+                
+                commitAllQueues();
+                
+                renderWindows.forEach([](std::shared_ptr < RenderWindow > const& wnd){
+                    assert(wnd && "Null window stored.");
+                    wnd->swapBuffers();
+                    wnd->update();
+                });
+            }
+        }
         
-        renderWindows.forEach([](std::shared_ptr < RenderWindow >& wnd){
-            assert(wnd && "Null window stored.");
-            wnd->swapBuffers();
-            wnd->update();
-        });
+        // The scope above must be recorded before the frame ends.
+        Profiler::Get().endFrame();
     }
     
     void Driver::commitAllQueues() 
     {
+        ProfileScope("Driver::commitAllQueues");
+        
         renderQueues.forEachCpy([this](std::shared_ptr < RenderQueue > const& queue){
             assert(queue && "Null RenderQueue stored.");
             commit(queue);
         });
     }
     
+    void Driver::commitAllQueues(std::uint64_t frame) 
+    {
+        ProfileScope("Driver::commitAllQueues");
+        
+        renderQueues.forEach([this, frame](std::shared_ptr < RenderQueue > const& queue){
+            assert(queue && "Null RenderQueue stored.");
+            commit(queue, frame);
+        });
+    }
+    
     std::shared_ptr < RenderQueue > Driver::makeRenderQueue(std::uint8_t priority, std::uint8_t type)
     {
         auto result = _createRenderQueue(type);
@@ -94,21 +156,54 @@ namespace Clean
         }
     }
     
+    void Driver::commit(std::shared_ptr < RenderQueue > const& queue, std::uint64_t frame)
+    {
+        commit(queue);
+        
+        queue->takeFrameCommands(frame, frameCommands);
+        
+        for (RenderCommand const& command : frameCommands)
+            renderCommand(command);
+        
+        // Commands are released now, not when the queue swaps this vector back. Its memory is kept.
+        frameCommands.clear();
+    }
+    
     void Driver::renderCommand(RenderCommand const& command)
     {
+        ProfileScope("Driver::renderCommand");
+        ProfileCount("commands", 1);
+        
         assert(command.target && command.pipeline && "Null RenderTarget or RenderPipeline for given RenderCommand.");
         RenderPipeline const& pipeline = *(command.pipeline);
+        pipelineWarmup.record(pipeline);
         
         command.bind(*this);
+        pipeline.resetParameterBlocks();
         
         // Notes: Now RenderTarget and RenderPipeline are bound. We must ensure all parameters for the render command
         // are set for the current pipeline. Notes also that EffectSession binds its parameters here for the RenderCommand.
         
-        effSession.bind(pipeline);
+        EffectSession const& session = submittedFrame ? frameSessions[FramePipeline::SlotOf(submittedFrame)] : effSession;
+        session.bind(pipeline);
         command.parameters.bind(pipeline);
         
+        // Streamed textures drawn by this command need levels for its size on screen. 
+        
+        if (command.screenSize > 0.0f)
+        {
+            auto request = [this, &command](Texture const& texture){ textureStreamer.request(texture, command.screenSize); };
+            command.parameters.forEachTexture(request);
+            
+            for (RenderSubCommand const& subCommand : command.subCommands)
+                subCommand.parameters.forEachTexture(request);
+        }
+        
         // Now just render each subcommands. 
         
+        if (command.occlusionQuery)
+            command.occlusionQuery->begin();
+        
         for (RenderSubCommand const& subCommand : command.subCommands)
         {
             subCommand.parameters.bind(pipeline);
@@ -116,6 +211,9 @@ namespace Clean
             pipeline.setDrawingMethod(subCommand.drawingMethod);
             drawShaderAttributes(subCommand.attributes);
         }
+        
+        if (command.occlusionQuery)
+            command.occlusionQuery->end();
     }
     
     bool Driver::shouldReleaseResource(DriverResource const& resource) const 
@@ -179,6 +277,133 @@ namespace Clean
     }
     
     std::shared_ptr < Texture > Driver::makeTexture(std::string const& filepath) 
+    {
+        auto image = loadTextureImage(filepath);
+        if (!image) return nullptr;
+        
+        auto texture = makeTexture(image);
+        
+        // An image converted or mipmapped by loadTextureImage() is not stored by ImageManager and is only
+        // used for this upload: the texture holds its own copy now.
+        if (image != ImageManager::Current().findFile(filepath))
+            Free(image->getPixelSet()->data);
+        
+        return texture;
+    }
+    
+    std::shared_ptr < Texture > Driver::makeStreamedTexture(std::string const& filepath)
+    {
+        auto image = loadTextureImage(filepath);
+        if (!image) return nullptr;
+        
+        // Creates the texture with its coarse levels, which TextureStreamer::add() thus doesn't upload again.
+        auto pixels = image->getPixelSet();
+        const std::size_t coarse = textureStreamer.findCoarseLevel(*pixels);
+        
+        auto coarseImage = image;
+        
+        if (coarse)
+        {
+            PixelSetLevel const& level = pixels->levels[coarse];
+            coarseImage = AllocateShared < Image >(MipmapMakeLevelsView(pixels, coarse), SizePair{ 0, 0 }, SizePair{ level.width, level.height });
+        }
+        
+        const bool temporary = (image != ImageManager::Current().findFile(filepath));
+        auto texture = makeTexture(coarseImage);
+        
+        // The streamer frees a temporary chain when the texture stops being streamed.
+        const std::uint8_t flags = kTextureStreamerUploaded | (temporary ? kTextureStreamerOwnsPixels : 0);
+        
+        if ((!texture || !textureStreamer.add(texture, image, flags)) && temporary)
+            Free(pixels->data);
+        
+        return texture;
+    }
+    
+    TextureStreamer& Driver::getTextureStreamer()
+    {
+        return textureStreamer;
+    }
+    
+    void Driver::setPipelineCache(std::shared_ptr < PipelineCache > const& cache)
+    {
+        std::atomic_store(&pipelineCache, cache);
+    }
+    
+    std::shared_ptr < PipelineCache > Driver::getPipelineCache() const
+    {
+        return std::atomic_load(&pipelineCache);
+    }
+    
+    std::shared_ptr < RenderPipeline > Driver::makeRenderPipeline()
+    {
+        return makeRenderCommand().pipeline;
+    }
+    
+    std::shared_ptr < OcclusionQuery > Driver::makeOcclusionQuery()
+    {
+        return nullptr;
+    }
+    
+    std::shared_ptr < FrameFence > Driver::makeFrameFence()
+    {
+        return nullptr;
+    }
+    
+    FramePipeline& Driver::getFramePipeline()
+    {
+        return framePipeline;
+    }
+    
+    void Driver::endRecord(std::uint64_t frame)
+    {
+        frameSessions[FramePipeline::SlotOf(frame)].snapshot(effSession);
+        framePipeline.endRecord(frame);
+    }
+    
+    std::shared_ptr < RenderTexture > Driver::makeRenderTexture(RenderTextureDescriptor const&)
+    {
+        return nullptr;
+    }
+    
+    void Driver::insertBarrier(RenderGraphBarrier const&)
+    {
+        
+    }
+    
+    void Driver::setRenderGraph(std::shared_ptr < RenderGraph > const& graph)
+    {
+        std::atomic_store(&renderGraph, graph);
+    }
+    
+    std::shared_ptr < RenderGraph > Driver::getRenderGraph() const
+    {
+        return std::atomic_load(&renderGraph);
+    }
+    
+    std::shared_ptr < PipelineCompilation > Driver::compilePipelines(std::vector < std::shared_ptr < RenderPipeline > > const& pipelines)
+    {
+        auto compilation = AllocateShared < PipelineCompilation >(pipelines.size());
+        assert(compilation && "Null allocation.");
+        
+        for (auto const& pipeline : pipelines)
+            compilation->done(pipeline && pipeline->compile());
+        
+        return compilation;
+    }
+    
+    PipelineWarmup& Driver::getPipelineWarmup()
+    {
+        return pipelineWarmup;
+    }
+    
+    void Driver::setMipmapFilter(std::uint8_t filter, bool srgb)
+    {
+        mipmapFilter.store(filter);
+        mipmapSRGB.store(srgb);
+    }
+    
+    std::shared_ptr < Image > Driver::loadTextureImage(std::string const& filepath)
     {
         auto image = ImageManager::Current().load(filepath);
         
@@ -213,7 +438,27 @@ namespace Clean
             }
         }
         
-        return makeTexture(image);
+        // Mipmaps are generated here, on the CPU and on all threads, instead of glGenerateMipmap-like 
+        // calls on the render thread. Compressed images can't be filtered and keep their own chain.
+        
+        auto pixels = image->getPixelSet();
+        
+        if (pixels && pixels->levels.empty() && !PixelFormatIsCompressed(pixels->format))
+        {
+            auto levels = MipmapGenerate(pixels, mipmapFilter.load(), mipmapSRGB.load());
+            
+            if (levels)
+            {
+                // The chain is a copy: a converted base level is not needed anymore.
+                if (image != ImageManager::Current().findFile(filepath))
+                    Free(pixels->data);
+                
+                auto mipmappedImage = AllocateShared < Image >(levels, SizePair{ 0, 0 }, image->getSize());
+                image = mipmappedImage;
+            }
+        }
+        
+        return image;
     }
     
     bool Driver::shouldConvertPixelFormat(std::uint8_t src, std::uint8_t& best) const
@@ -11,6 +11,14 @@
 #include "RenderQueueManager.h"
 #include "EffectSession.h"
 #include "TextureManager.h"
+#include "TextureStreamer.h"
+#include "MipmapGenerator.h"
+#include "PipelineCache.h"
+#include "PipelineCompilation.h"
+#include "PipelineWarmup.h"
+#include "OcclusionQuery.h"
+#include "FramePipeline.h"
+#include "RenderGraph.h"
 #include "Image.h"
 
 namespace Clean
@@ -104,6 +112,42 @@ namespace Clean
         //! Calls DriverResource::release on each resources created by this driver.
         TextureManager textureManager;
         
+        //! @brief Streams mipmaps of textures made by makeStreamedTexture(). Updated at the beginning
+        //! of each Driver::update().
+        TextureStreamer textureStreamer;
+        
+        //! @brief Filter used to generate mipmaps of textures loaded from files.
+        std::atomic < std::uint8_t > mipmapFilter;
+        
+        //! @brief True if mipmaps of textures loaded from files are filtered in linear space.
+        std::atomic < bool > mipmapSRGB;
+        
+        //! @brief Cache where compiled pipelines are loaded and stored, or null. Accessed with
+        //! std::atomic_load and std::atomic_store. 
+        std::shared_ptr < PipelineCache > pipelineCache;
+        
+        //! @brief Records pipelines used by renderCommand() when recording is started. 
+        PipelineWarmup pipelineWarmup;
+        
+        //! @brief Frames recorded by other threads and submitted by update(). 
+        FramePipeline framePipeline;
+        
+        //! @brief Snapshots of effSession taken by endRecord(), by FramePipeline::SlotOf(). A slot is written
+        //! only once the GPU passed the fence of the frame which used it before, as beginRecord() waits for it.
+        EffectSession frameSessions[kFramePipelineMaxFrames];
+        
+        //! @brief Frame submitted by update(), whose snapshot renderCommand() binds, or 0. Only used by the 
+        //! driver's thread. 
+        std::uint64_t submittedFrame;
+        
+        //! @brief Commands of the queue being submitted by commit(queue, frame). Only used by the driver's 
+        //! thread, and kept to reuse its memory. 
+        std::vector < RenderCommand > frameCommands;
+        
+        //! @brief Graph executed by update() before the RenderQueues, or null. Accessed with std::atomic_load
+        //! and std::atomic_store. 
+        std::shared_ptr < RenderGraph > renderGraph;
+        
     public:
         
         /*! @brief Default constructor. */
@@ -161,7 +205,8 @@ namespace Clean
         
         /*! @brief Performs an update operation on all this driver's resources. 
          *
-         * This includes: - commits of all RenderQueue registered to the driver. 
+         * This includes: - jobs queued with JobSystem::runOnMainThread(). 
+         *                - commits of all RenderQueue registered to the driver. 
          *                - swaps buffers for all RenderWindow registered. 
          *                - updates all windows registered. 
          *
@@ -170,12 +215,23 @@ namespace Clean
          * some render queues might be static and as this, their RenderCommands never
          * get cleared. 
          *
+         * The frame ends with Profiler::endFrame(), which aggregates the scopes and counters
+         * recorded since the last update. 
+         *
+         * Once frames are recorded through the FramePipeline, update() submits the next recorded frame 
+         * instead: it waits for it at most kFramePipelineSubmitTimeout, and only updates windows if it 
+         * is not recorded yet. A fence made by makeFrameFence() follows the frame's commands, and the 
+         * fences of the previous frames are polled to let the recording threads go on. 
+         *
         **/
         virtual void update();
         
         /*! @brief Commits all RenderQueue objects to the driver. */
         virtual void commitAllQueues();
         
+        /*! @brief Commits all RenderQueue objects to the driver, with their commands for the given frame. */
+        virtual void commitAllQueues(std::uint64_t frame);
+        
         /*! @brief Creates a RenderQueue. 
          *
          * \param[in] priority RenderQueueManager stores RenderQueue inside a map where each key is the queue
@@ -196,6 +252,9 @@ namespace Clean
         /*! @brief Commits given RenderQueue to this driver, if the queue is registered by this driver. */
         virtual void commit(std::shared_ptr < RenderQueue > const& queue);
         
+        /*! @brief Commits given RenderQueue, then renders its commands added for the given frame. */
+        virtual void commit(std::shared_ptr < RenderQueue > const& queue, std::uint64_t frame);
+        
         /*! @brief Renders a RenderCommand. */
         virtual void renderCommand(RenderCommand const& command);
         
@@ -267,6 +326,85 @@ namespace Clean
         **/
         virtual std::shared_ptr < Texture > makeTexture(std::string const& filepath);
         
+        /*! @brief Makes a texture whose mipmaps are streamed by the TextureStreamer.
+         *
+         * The texture is loaded as in \ref makeTexture(std::string const&), but only its coarse levels
+         * are uploaded. Finer levels are uploaded later, depending on calls to TextureStreamer::request(),
+         * which renderCommand() makes for commands with a RenderCommand::screenSize.
+         *
+         * \return A null texture if not loaded.
+        **/
+        virtual std::shared_ptr < Texture > makeStreamedTexture(std::string const& filepath);
+        
+        /*! @brief Returns the TextureStreamer of this driver. */
+        virtual TextureStreamer& getTextureStreamer();
+        
+        /*! @brief Changes how mipmaps are generated for textures loaded from files. 
+         *
+         * \param filter One of kMipmapFilterBox or kMipmapFilterKaiser.
+         * \param srgb True if images hold sRGB colors, which must be filtered in linear space.
+         *
+        **/
+        virtual void setMipmapFilter(std::uint8_t filter, bool srgb);
+        
+        /*! @brief Sets the cache used to load compiled pipelines instead of compiling them, and to store 
+         *  pipelines compiled. A null cache disables caching, which is the default. */
+        virtual void setPipelineCache(std::shared_ptr < PipelineCache > const& cache);
+        
+        /*! @brief Returns the cache of compiled pipelines, or null. */
+        virtual std::shared_ptr < PipelineCache > getPipelineCache() const;
+        
+        /*! @brief Makes a new RenderPipeline with this driver's default mapper. 
+         *  Default implementation returns the pipeline of makeRenderCommand(). */
+        virtual std::shared_ptr < RenderPipeline > makeRenderPipeline();
+        
+        /*! @brief Makes a new OcclusionQuery, or returns null if the driver doesn't support them, which is
+         *  the default implementation. Results are read by the driver's update(). **/
+        virtual std::shared_ptr < OcclusionQuery > makeOcclusionQuery();
+        
+        /*! @brief Makes a FrameFence following the commands submitted until now, or returns null if the driver
+         *  doesn't support them, which is the default implementation. Called by update() after each frame. */
+        virtual std::shared_ptr < FrameFence > makeFrameFence();
+        
+        /*! @brief Returns the FramePipeline whose frames are submitted by update(). */
+        virtual FramePipeline& getFramePipeline();
+        
+        /*! @brief Takes a snapshot of the driver's EffectSession for frame, then marks the frame recorded.
+         *
+         * Recording threads call it instead of FramePipeline::endRecord(), once they committed the parameters
+         * of the frame (Camera::commit() for example). Commands of the frame are then drawn with this snapshot, 
+         * while the next frame changes the session. 
+         *
+        **/
+        virtual void endRecord(std::uint64_t frame);
+        
+        /*! @brief Makes a RenderTexture with the given attachments, or returns null if the driver can't draw
+         *  into textures, which is the default implementation. */
+        virtual std::shared_ptr < RenderTexture > makeRenderTexture(RenderTextureDescriptor const& descriptor);
+        
+        /*! @brief Synchronizes a resource used differently by two passes of a RenderGraph. Default implementation
+         *  does nothing, for drivers whose API synchronizes them itself. */
+        virtual void insertBarrier(RenderGraphBarrier const& barrier);
+        
+        /*! @brief Changes the RenderGraph executed by update() once the windows are prepared, before the
+         *  RenderQueues are committed. A null graph disables it. */
+        virtual void setRenderGraph(std::shared_ptr < RenderGraph > const& graph);
+        
+        /*! @brief Returns the RenderGraph executed by update(), or null. */
+        virtual std::shared_ptr < RenderGraph > getRenderGraph() const;
+        
+        /*! @brief Compiles the given pipelines before their first use. 
+         *
+         * Derived drivers compile them in parallel or on another thread when possible, and the function 
+         * returns before they are compiled. Default implementation calls RenderPipeline::compile() for each
+         * pipeline before returning. A pipeline bound before its compilation is done waits for it. 
+         *
+        **/
+        virtual std::shared_ptr < PipelineCompilation > compilePipelines(std::vector < std::shared_ptr < RenderPipeline > > const& pipelines);
+        
+        /*! @brief Returns the PipelineWarmup recording the pipelines drawn by this driver. */
+        virtual PipelineWarmup& getPipelineWarmup();
+        
         /*! @brief Returns true if the given PixelFormat is not adapted to this driver. 
          *  Default implementation returns always false.
          *
@@ -281,6 +419,17 @@ namespace Clean
         
     protected:
         
+        /*! @brief Loads an Image for a texture. 
+         *
+         * Image is loaded through ImageManager, converted to the best pixel format advised by 
+         * \ref shouldConvertPixelFormat, and its mipmaps are generated with MipmapGenerate() if 
+         * the file did not provide them. 
+         *
+         * \return A null image if not loaded. An image other than the one stored by ImageManager is
+         *      temporary: the caller frees its PixelSet data once uploaded.
+        **/
+        virtual std::shared_ptr < Image > loadTextureImage(std::string const& filepath);
+        
         /*! @brief Creates a RenderWindow from implementation. */
         virtual std::shared_ptr < RenderWindow > _createRenderWindow(std::size_t width, std::size_t height, 
             std::string const& title, std::uint16_t style, bool fullscreen) const = 0;
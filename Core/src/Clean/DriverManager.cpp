@@ -5,12 +5,13 @@
 
 namespace Clean 
 {
+    DriverManager::DriverManager()
+    {
+        nameIndex = addIndex([](Driver const& driver){ return HashKey(driver.getName()); });
+    }
+    
     std::shared_ptr < Driver > DriverManager::findDriverByName(std::string const& name)
     {
-        std::scoped_lock < std::mutex > lck(managedListMutex);
-        auto found = std::find_if(managedList.begin(), managedList.end(), [name](auto const& driver){ 
-            assert(driver); return driver->getName() == name; });
-        if (found != managedList.end()) return *found;
-        return nullptr;
+        return findIndexed(nameIndex, HashKey(name), [&name](Driver const& driver){ return driver.getName() == name; });
     }
 }
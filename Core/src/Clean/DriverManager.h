@@ -12,8 +12,14 @@ namespace Clean
     /** @brief Specialization of Manager for Driver. */
     class DriverManager : public Manager < Driver >
     {
+        //! @brief Index of drivers by name.
+        std::size_t nameIndex;
+        
     public:
         
+        /*! @brief Constructs the manager and its index by name. */
+        DriverManager();
+        
         /*! @brief Finds a Driver with given name. */
         std::shared_ptr < Driver > findDriverByName(std::string const& name);
     };
@@ -5,13 +5,13 @@
 
 namespace Clean 
 {
+    DynlibManager::DynlibManager()
+    {
+        fileIndex = addIndex([](Dynlib const& dynlib){ return HashKey(dynlib.getFilepath()); });
+    }
+    
     std::shared_ptr < Dynlib > DynlibManager::findFromFile(std::string const& path)
     {
-        std::lock_guard < std::mutex > lck(managedListMutex);
-        auto check = std::find_if(managedList.begin(), managedList.end(), [path](std::shared_ptr < Dynlib > const& managed) {
-            return managed->getFilepath() == path;
-        });
-        
-        return (check != managedList.end()) ? *check : nullptr;
+        return findIndexed(fileIndex, HashKey(path), [&path](Dynlib const& dynlib){ return dynlib.getFilepath() == path; });
     }
 }
@@ -12,10 +12,13 @@ namespace Clean
     /*! @brief Manages all Dynlib objects for Core class. */
     class DynlibManager final : public Manager < Dynlib > 
     {
+        //! @brief Index of libraries by file path.
+        std::size_t fileIndex;
+        
     public:
         
-        /*! @brief Default constructor. */
-        DynlibManager() = default;
+        /*! @brief Constructs the manager and its index by file. */
+        DynlibManager();
         
         /*! @brief Default destructor. */
         ~DynlibManager() = default;
@@ -7,8 +7,16 @@
 #include "EffectParameter.h"
 #include "ShaderParameter.h"
 
+#include <atomic>
+
 namespace Clean 
 {
+    std::uint64_t EffectParameterNextVersion()
+    {
+        static std::atomic < std::uint64_t > counter(1);
+        return counter.fetch_add(1);
+    }
+    
     std::uint8_t EffectParameterGetTypeFromHash(std::uint64_t const& rhs)
     {
         switch (rhs)
@@ -22,6 +30,7 @@ namespace Clean
             case kEffectMaterialDiffuseVec4Hash:
             case kEffectMaterialSpecularVec4Hash:
             case kEffectMaterialEmissiveVec4Hash:
+            case kEffectMaterialDiffuseUVVec4Hash:
             return kShaderParamVec4;
                 
             case kEffectMaterialAmbientTextureHash:
@@ -29,6 +38,9 @@ namespace Clean
             case kEffectMaterialSpecularTextureHash:
             return kShaderParamI32;
             
+            case kEffectLodFadeFloatHash:
+            return kShaderParamFloat;
+            
             default:
             return kShaderParamNull;
         }
@@ -17,6 +17,14 @@
 
 namespace Clean 
 {
+    /*! @brief Returns a new version stamp, unique and greater than all stamps returned before. 
+     *
+     * Stamps are shared by EffectParameter and EffectSession: an object whose stamp did not change
+     * was not modified, and two objects never have the same stamp. 
+     *
+    **/
+    std::uint64_t EffectParameterNextVersion();
+    
     struct EffectParameter 
     {
         std::string name;
@@ -25,6 +33,10 @@ namespace Clean
         ShaderValue value;
         mutable std::mutex mutex;
         
+        //! @brief Stamp changed by each writer of value, while holding mutex. RenderPipeline does not
+        //! upload a parameter again while its stamp is unchanged. 
+        std::uint64_t version = EffectParameterNextVersion();
+        
         EffectParameter(std::string const& n, ShaderValue const& v, std::uint8_t const& t)
         : name(n), hash(Hash64(n.data())), type(t), value(v) {}
         
@@ -58,6 +70,9 @@ namespace Clean
     static constexpr const char* kEffectMaterialEmissiveVec4 = "kEffectMaterialEmissiveVec4";
     static constexpr const std::uint64_t kEffectMaterialEmissiveVec4Hash = Hash64Const(kEffectMaterialEmissiveVec4);
     
+    static constexpr const char* kEffectMaterialDiffuseUVVec4 = "kEffectMaterialDiffuseUVVec4";
+    static constexpr const std::uint64_t kEffectMaterialDiffuseUVVec4Hash = Hash64Const(kEffectMaterialDiffuseUVVec4);
+    
     static constexpr const char* kEffectMaterialDiffuseTexture = "kEffectMaterialDiffuseTexture";
     static constexpr const std::uint64_t kEffectMaterialDiffuseTextureHash = Hash64Const(kEffectMaterialDiffuseTexture);
     
@@ -67,6 +82,9 @@ namespace Clean
     static constexpr const char* kEffectMaterialSpecularTexture = "kEffectMaterialSpecularTexture";
     static constexpr const std::uint64_t kEffectMaterialSpecularTextureHash = Hash64Const(kEffectMaterialSpecularTexture);
     
+    static constexpr const char* kEffectLodFadeFloat = "kEffectLodFadeFloat";
+    static constexpr const std::uint64_t kEffectLodFadeFloatHash = Hash64Const(kEffectLodFadeFloat);
+    
     /*! @brief Returns the ShaderParam type constant from given Hash. 
      *
      * Hash must be a valid value recognized as one of the preset Effect Parameters Constants. In
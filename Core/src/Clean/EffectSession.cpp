@@ -9,22 +9,35 @@
 #include "EffectParameterProvider.h"
 #include "Allocate.h"
 
+#include <algorithm>
+
 namespace Clean 
 {
+    EffectSession::EffectSession() : version(EffectParameterNextVersion()), layout(0)
+    {
+    
+    }
+    
     EffectSession::EffectSession(EffectSession const& rhs)
     {
-        globals.store(rhs.globals.load());
-        texturedParams.store(rhs.texturedParams.load());
+        std::scoped_lock < std::mutex > lck(rhs.mutex);
+        globals = rhs.globals;
+        globalsIndex = rhs.globalsIndex;
+        texturedParams = rhs.texturedParams;
+        texturedParamsIndex = rhs.texturedParamsIndex;
+        blocks = rhs.blocks;
+        version = rhs.version;
+        layout = rhs.layout;
     }
     
-    std::weak_ptr < EffectParameter > EffectSession::add(std::string const& name, ShaderValue const& value, std::uint8_t const& type) 
+    std::weak_ptr < EffectParameter > EffectSession::add(std::string const& name, ShaderValue const& value, std::uint8_t const& type)
     {
         std::shared_ptr < EffectParameter > param = AllocateShared < EffectParameter >(name, value, type);
         assert(param && "Null allocation.");
         
-        auto& params = globals.lock();
-        params.push_back(param);
-        globals.unlock();
+        std::scoped_lock < std::mutex > lck(mutex);
+        insert(param);
+        changed();
         
         return param;
     }
@@ -34,35 +47,85 @@ namespace Clean
         if (!parameter)
             return {};
         
-        auto& params = globals.lock();
-        auto it = std::find_if(params.begin(), params.end(), [parameter](auto p) { return p == parameter; });
+        std::scoped_lock < std::mutex > lck(mutex);
+        auto it = globalsIndex.find(parameter->hash);
         
-        if (params.end() == it) 
-            params.push_back(parameter);
+        if (it == globalsIndex.end() || globals[it->second] != parameter) {
+            insert(parameter);
+            changed();
+        }
         
-        globals.unlock();
         return parameter;
     }
     
     void EffectSession::remove(std::string const& name)
     {
-        auto& params = globals.lock();
-        auto it = std::find_if(params.begin(), params.end(), [name](auto p) { return p->name == name; });
-        params.erase(it);
-        globals.unlock();
+        remove(Hash64(name.data()));
+    }
+    
+    void EffectSession::remove(std::uint64_t hash)
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        auto it = globalsIndex.find(hash);
+        if (it == globalsIndex.end()) return;
+        
+        // Moves the last parameter in the removed slot, so globals stays dense.
+        const std::size_t index = it->second;
+        globalsIndex.erase(it);
+        
+        if (index + 1 != globals.size()) {
+            globals[index] = std::move(globals.back());
+            globalsIndex[globals[index]->hash] = index;
+        }
+        
+        globals.pop_back();
+        changed();
+    }
+    
+    std::shared_ptr < EffectParameter > EffectSession::find(std::uint64_t hash) const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        auto it = globalsIndex.find(hash);
+        return it != globalsIndex.end() ? globals[it->second] : nullptr;
+    }
+    
+    std::uint64_t EffectSession::getVersion() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return version;
+    }
+    
+    std::uint64_t EffectSession::getLayout() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return layout;
     }
     
     void EffectSession::clear()
     {
-        auto& params = globals.lock();
-        params.clear();
-        globals.unlock();
+        std::scoped_lock < std::mutex > lck(mutex);
+        globals.clear();
+        globalsIndex.clear();
+        changed();
     }
     
     void EffectSession::bind(RenderPipeline const& pipeline) const
     {
-        pipeline.bindEffectParameters(globals.load());
-        pipeline.bindTexturedParameters(texturedParams.load());
+        std::scoped_lock < std::mutex > lck(mutex);
+        
+        for (auto const& block : blocks)
+            pipeline.bindParameterBlock(*block);
+        
+        pipeline.bindEffectParameters(globals, layout);
+        pipeline.bindTexturedParameters(texturedParams);
+    }
+    
+    void EffectSession::forEachTexture(std::function < void(Texture const&) > const& callback) const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        
+        for (auto const& param : texturedParams)
+            if (param->texture) callback(*param->texture);
     }
     
     void EffectSession::add(EffectParameterProvider const& provider)
@@ -76,36 +139,164 @@ namespace Clean
     
     void EffectSession::batchAddOneHash(std::vector < std::shared_ptr < EffectParameter > > const& p)
     {
-        auto& parameters = globals.lock();
+        std::scoped_lock < std::mutex > lck(mutex);
         
         for (auto& param : p)
-        {
-            auto it = std::find_if(parameters.begin(), parameters.end(), [param](auto& pointer) { return pointer->hash == param->hash; });
-            
-            if (it != parameters.end()) 
-                (*it) = param;
-            else 
-                parameters.push_back(param);
-        }
+            insert(param);
         
-        globals.unlock();
+        changed();
     }
     
     void EffectSession::batchAddOneHash(std::vector < std::shared_ptr < TexturedParameter > > const& p)
     {
-        auto& parameters = texturedParams.lock();
+        std::scoped_lock < std::mutex > lck(mutex);
         
         for (auto& param : p)
+            insert(param);
+        
+        changed();
+    }
+    
+    void EffectSession::addBlock(std::shared_ptr < ParameterBlock > const& block)
+    {
+        if (!block) return;
+        
+        std::scoped_lock < std::mutex > lck(mutex);
+        if (std::find(blocks.begin(), blocks.end(), block) != blocks.end()) return;
+        
+        blocks.push_back(block);
+        changed();
+    }
+    
+    void EffectSession::removeBlock(std::shared_ptr < ParameterBlock > const& block)
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        auto it = std::find(blocks.begin(), blocks.end(), block);
+        if (it == blocks.end()) return;
+        
+        blocks.erase(it);
+        changed();
+    }
+    
+    void EffectSession::snapshot(EffectSession const& source)
+    {
+        if (&source == this) return;
+        
+        std::vector < std::shared_ptr < EffectParameter > > sourceGlobals;
+        std::vector < std::shared_ptr < TexturedParameter > > sourceTextured;
+        std::vector < std::shared_ptr < ParameterBlock > > sourceBlocks;
+        
+        {
+            std::scoped_lock < std::mutex > lck(source.mutex);
+            sourceGlobals = source.globals;
+            sourceTextured = source.texturedParams;
+            sourceBlocks = source.blocks;
+        }
+        
+        std::scoped_lock < std::mutex > lck(mutex);
+        bool listChanged = globals.size() != sourceGlobals.size() || texturedParams.size() != sourceTextured.size();
+        
+        // A copy is reused only if it is private: a session copied by its copy constructor shares source's ones. 
+        globals.resize(sourceGlobals.size());
+        
+        for (std::size_t i = 0; i < sourceGlobals.size(); ++i)
+        {
+            EffectParameter const& param = *sourceGlobals[i];
+            std::shared_ptr < EffectParameter >& copy = globals[i];
+            
+            if (!copy || copy == sourceGlobals[i] || copy->hash != param.hash) {
+                copy = AllocateShared < EffectParameter >(param.name, ShaderValue(), param.type);
+                assert(copy && "Null allocation.");
+                listChanged = true;
+            }
+            
+            std::scoped_lock < std::mutex, std::mutex > paramLock(copy->mutex, param.mutex);
+            copy->hash = param.hash;
+            copy->type = param.type;
+            copy->value = param.value;
+            copy->version = param.version;
+        }
+        
+        texturedParams.resize(sourceTextured.size());
+        
+        for (std::size_t i = 0; i < sourceTextured.size(); ++i)
+        {
+            TexturedParameter const& param = *sourceTextured[i];
+            std::shared_ptr < TexturedParameter >& copy = texturedParams[i];
+            
+            if (!copy || copy == sourceTextured[i] || copy->param.hash != param.param.hash) {
+                copy = AllocateShared < TexturedParameter >(param.param.name, ShaderValue(), param.param.type);
+                assert(copy && "Null allocation.");
+                listChanged = true;
+            }
+            
+            std::scoped_lock < std::mutex, std::mutex > paramLock(copy->param.mutex, param.param.mutex);
+            copy->param.hash = param.param.hash;
+            copy->param.type = param.param.type;
+            copy->param.value = param.param.value;
+            copy->param.version = param.param.version;
+            copy->texture = param.texture;
+        }
+        
+        // Blocks are copied with their data: RenderPipeline uploads the copy, whose version is source's one. 
+        blocks.resize(sourceBlocks.size());
+        
+        for (std::size_t i = 0; i < sourceBlocks.size(); ++i)
         {
-            auto it = std::find_if(parameters.begin(), parameters.end(), [param](auto& ptr) { 
-                return ptr->param.hash == param->param.hash; });
+            ParameterBlock& block = *sourceBlocks[i];
+            std::shared_ptr < ParameterBlock >& copy = blocks[i];
+            
+            if (!copy || copy == sourceBlocks[i] || copy->getName() != block.getName() || copy->getBinding() != block.getBinding()) {
+                copy = AllocateShared < ParameterBlock >(block.getName(), block.getBinding(), block.getLayout(), block.getFrequency());
+                assert(copy && "Null allocation.");
+                listChanged = true;
+            }
             
-            if (it != parameters.end()) 
-                (*it) = param;
-            else 
-                parameters.push_back(param);
+            copy->assign(block);
         }
         
-        texturedParams.unlock();
+        if (!listChanged) return;
+        
+        globalsIndex.clear();
+        texturedParamsIndex.clear();
+        
+        for (std::size_t i = 0; i < globals.size(); ++i)
+            globalsIndex.emplace(globals[i]->hash, i);
+        
+        for (std::size_t i = 0; i < texturedParams.size(); ++i)
+            texturedParamsIndex.emplace(texturedParams[i]->param.hash, i);
+        
+        changed();
+    }
+    
+    void EffectSession::insert(std::shared_ptr < EffectParameter > const& parameter)
+    {
+        auto result = globalsIndex.emplace(parameter->hash, globals.size());
+        
+        if (result.second)
+            globals.push_back(parameter);
+        else
+            globals[result.first->second] = parameter;
+    }
+    
+    void EffectSession::insert(std::shared_ptr < TexturedParameter > const& parameter)
+    {
+        auto result = texturedParamsIndex.emplace(parameter->param.hash, texturedParams.size());
+        
+        if (result.second)
+            texturedParams.push_back(parameter);
+        else
+            texturedParams[result.first->second] = parameter;
+    }
+    
+    void EffectSession::changed()
+    {
+        version = EffectParameterNextVersion();
+        
+        // FNV-1a over the hashes: the order matters as BindingPlans refer to parameters by index. 
+        layout = 14695981039346656037ULL;
+        
+        for (auto const& param : globals)
+            layout = (layout ^ param->hash) * 1099511628211ULL;
     }
 }
@@ -7,12 +7,15 @@
 #ifndef CLEAN_EFFECTSESSION_H
 #define CLEAN_EFFECTSESSION_H
 
-#include "Property.h"
 #include "EffectParameter.h"
 #include "ShaderParameter.h"
+#include "ParameterBlock.h"
 
 #include <vector>
 #include <memory>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
 
 namespace Clean 
 {
@@ -30,19 +33,47 @@ namespace Clean
      * texture unit, binds the texture and binds the texture unit to the parameter. In this case, TexturedParameter
      * lets the RenderPipeline know which texture to bind to a new available texture unit. 
      *
+     * Parameters are unique by hash: adding a parameter with the hash of another one replaces it. They are 
+     * stored in a dense array, bound as-is by \ref bind(), and indexed by hash for adds and removes. Each 
+     * change of the parameters list gives the session a new version (see EffectParameterNextVersion()), 
+     * so an unchanged version means the same list of parameters. The layout, a hash of the parameters'
+     * hashes in order, is shared by sessions holding the same kinds of parameters: RenderPipeline keys its
+     * BindingPlans with it. 
+     *
+     * ParameterBlocks added to the session are bound before its parameters. Parameters held by a block
+     * uploaded to the RenderPipeline for the current command are not bound one by one. 
+     *
     **/
     class EffectSession 
     {
         //! @brief List of EffectParameters we manage. 
-        Property < std::vector < std::shared_ptr < EffectParameter > > > globals;
+        std::vector < std::shared_ptr < EffectParameter > > globals;
+        
+        //! @brief Index of each EffectParameter in globals, by hash. 
+        std::unordered_map < std::uint64_t, std::size_t > globalsIndex;
         
         //! @brief List of TexturedParameters we manage.
-        Property < std::vector < std::shared_ptr < TexturedParameter > > > texturedParams;
+        std::vector < std::shared_ptr < TexturedParameter > > texturedParams;
+        
+        //! @brief Index of each TexturedParameter in texturedParams, by hash. 
+        std::unordered_map < std::uint64_t, std::size_t > texturedParamsIndex;
+        
+        //! @brief ParameterBlocks bound with this session. 
+        std::vector < std::shared_ptr < ParameterBlock > > blocks;
+        
+        //! @brief Version of the parameters lists. 
+        std::uint64_t version;
+        
+        //! @brief Hash of the hashes in globals, in order. 
+        std::uint64_t layout;
+        
+        //! @brief Protects every field above. 
+        mutable std::mutex mutex;
         
     public:
         
         /*! @brief Default constructor. */
-        EffectSession() = default;
+        EffectSession();
         
         /*! @brief Copies the EffectSession. */
         EffectSession(EffectSession const& rhs);
@@ -75,21 +106,66 @@ namespace Clean
         /*! @brief Removes the parameter designated by name. **/
         void remove(std::string const& name);
         
+        /*! @brief Removes the parameter designated by hash. **/
+        void remove(std::uint64_t hash);
+        
+        /*! @brief Returns the parameter with the given hash, or null. */
+        std::shared_ptr < EffectParameter > find(std::uint64_t hash) const;
+        
+        /*! @brief Returns the version of the parameters lists. */
+        std::uint64_t getVersion() const;
+        
+        /*! @brief Returns the hash of the parameters' hashes, in the order they are bound. */
+        std::uint64_t getLayout() const;
+        
         /*! @brief Clears all globals in this session. **/
         void clear();
         
-        /*! @brief Binds all globals parameters to the given RenderPipeline. */
+        /*! @brief Binds all globals parameters to the given RenderPipeline. 
+         *  Parameters lists are given by reference, while the session is locked. */
         void bind(RenderPipeline const& pipeline) const;
         
+        /*! @brief Calls callback with the texture of each TexturedParameter, while the session is locked. */
+        void forEachTexture(std::function < void(Texture const&) > const& callback) const;
+        
         /*! @brief Adds provider's parameters to this EffectSession. */
         void add(EffectParameterProvider const& provider);
         
-        /*! @brief Adds multiple Materials making in sort that there will be not more than one hash
+        /*! @brief Adds multiple EffectParameters making in sort that there will be not more than one hash
          * registered in this session. */
         void batchAddOneHash(std::vector < std::shared_ptr < EffectParameter > > const& parameters);
         
         /*! @brief Adds multiple TexturedParameters once by hash in this session. */
         void batchAddOneHash(std::vector < std::shared_ptr < TexturedParameter > > const& parameters);
+        
+        /*! @brief Adds a ParameterBlock, if not already present. */
+        void addBlock(std::shared_ptr < ParameterBlock > const& block);
+        
+        /*! @brief Removes a ParameterBlock. */
+        void removeBlock(std::shared_ptr < ParameterBlock > const& block);
+        
+        /*! @brief Replaces the lists of this session by copies of source's parameters and blocks, with their 
+         *  current values and versions.
+         *
+         * Copies are private to this session: later changes of source's parameters, made by Camera::commit() 
+         * for example, are not seen by this session until the next snapshot. Driver keeps one snapshot of its 
+         * session by frame in flight (see Driver::endRecord()), so the commands of a frame are drawn with the 
+         * parameters of this frame while the next one is recorded. Copies made by a previous snapshot are reused 
+         * when they have the same hash at the same place. 
+         *
+        **/
+        void snapshot(EffectSession const& source);
+        
+    private:
+        
+        /*! @brief Adds or replaces a parameter by its hash. mutex must be locked. */
+        void insert(std::shared_ptr < EffectParameter > const& parameter);
+        
+        /*! @brief Adds or replaces a textured parameter by its hash. mutex must be locked. */
+        void insert(std::shared_ptr < TexturedParameter > const& parameter);
+        
+        /*! @brief Gives the session a new version and computes its layout. mutex must be locked. */
+        void changed();
     };
 }
 
@@ -5,214 +5,303 @@
 #define CLEAN_EMITTER_H
 
 #include "Traits.h"
+#include "JobSystem.h"
 
-#include <list>
-#include <shared_mutex>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
-#include <queue>
-#include <thread>
-#include <future>
+#include <vector>
 
-namespace Clean 
+namespace Clean
 {
     //! @defgroup EventEmittingPolicy Event Emitting Policy Constants
     //! @{
-    
+
     static constexpr const std::uint8_t kEventEmittingPolicyAsync = 1;
     static constexpr const std::uint8_t kEventEmittingPolicySync = 2;
-    
+
     //! @}
 
-    /** @brief Generic description of an emitter. 
+    //! @brief Maximum number of events an emitter delivers before letting other tasks use its worker.
+    static constexpr const std::size_t kEmitterEventsPerTask = 64;
+
+    /** @brief Merges an event into the previous one, when both are still waiting to be delivered.
+     *
+     * Specialize it for events where only the sum matters, like mouse moves. Merge() returns true if next
+     * was merged into last: next is then not delivered. Only events sent with the same callback are merged.
      *
-     * An emitter can sends any event to its dedicated listener. Basically, for each 
+    **/
+    template < class EventT >
+    struct EventCoalescing
+    {
+        static bool Merge(EventT& last, EventT const& next) { return false; }
+    };
+
+    /** @brief Generic description of an emitter.
+     *
+     * An emitter can sends any event to its dedicated listener. Basically, for each
      * pair Listener/Callback an event is sent. An event doesn't require the listener
      * to answer anything. Thus, an emitter stores its listeners but only in a weak_ptr
-     * (the emitter doesn't own its listeners). 
+     * (the emitter doesn't own its listeners).
+     *
+     * Monothreaded mode: When eventEmittingPolicy is kEventEmittingPolicySync, the emitter
+     * sends its event to listeners in the same thread as the caller.
      *
-     * Monothreaded mode: When eventEmittingPolicy is kEventEmittingPolicyAsync, the emitter
-     * sends its event to listeners in the same thread as the caller. 
+     * Multithreaded mode: When eventEmittingPolicy is kEventEmittingPolicyAsync, the emitter
+     * queues its event, and the events are sent to listeners by the JobSystem's workers. Events
+     * of one emitter are delivered in the order they were sent, one at a time; events of different
+     * emitters are delivered concurrently. While an event waits in the queue, the next one sent with
+     * the same callback may be merged into it (see EventCoalescing). The emitter waits for its events
+     * to be delivered before being destroyed.
      *
-     * Multithreaded mode: When eventEmittingPolicy is kEventEmittingPolicySync, the emitter
-     * sends its event to listeners in a different thread, enabling asynchroneous event handling. 
-     * In Multithreaded mode, threads generated are never detached to ensure a correct termination. 
-     * Protected method flushSendThreads joins all threads within a limit defined by sendThreadsLimit.
-     * This limit is the maximum number of threads the emitter can handle simultaneously. If more than 
-     * this limit number of threads are launched, emitter will join all of them before finishing its
-     * work.
+     * Listeners are stored in a list replaced when a listener is added or removed: sending an event
+     * only loads the current list.
      *
-     * \note Actually multithreaded mode does not store threads but use std::future instead. \ref wait()
-     * is used to know if the thread has finished its task or not. Using std::thread with std::queue
-     * did caused some crashes... So no regrets on this. 
     **/
     template < class Listener >
-    class Emitter 
+    class Emitter
     {
+        //! @brief List of listeners.
+        typedef std::vector < std::weak_ptr < Listener > > ListenersList;
+
+        /** @brief An event waiting to be delivered. */
+        struct PendingEventBase
+        {
+            virtual ~PendingEventBase() = default;
+
+            /*! @brief Calls the callback of each listener with the event. */
+            virtual void deliver(ListenersList const& listeners, Caller < Listener > const& caller) = 0;
+
+            /*! @brief Merges next into this event if possible. */
+            virtual bool merge(PendingEventBase& next) = 0;
+
+            /*! @brief Returns an identifier of the type of event and callback. */
+            virtual const void* getTag() const = 0;
+        };
+
+        /** @brief An event of type EventT sent with Callback. */
+        template < typename Callback, class EventT >
+        struct PendingEvent : public PendingEventBase
+        {
+            Callback callback;
+            EventT event;
+
+            PendingEvent(Callback cb, EventT const& ev) : callback(cb), event(ev) {}
+
+            static const void* Tag() { static const char tag = 0; return &tag; }
+
+            const void* getTag() const { return Tag(); }
+
+            void deliver(ListenersList const& listeners, Caller < Listener > const& caller)
+            {
+                for (auto const& listener : listeners)
+                {
+                    auto slistener = listener.lock();
+                    if (!slistener) continue;
+
+                    caller(callback, slistener.get(), event);
+                }
+            }
+
+            bool merge(PendingEventBase& next)
+            {
+                if (next.getTag() != Tag()) return false;
+
+                auto& other = static_cast < PendingEvent& >(next);
+                if (!(other.callback == callback)) return false;
+
+                return EventCoalescing < EventT >::Merge(event, other.event);
+            }
+        };
+
         //! @brief Helper to call a listener's callback.
         Caller < Listener > caller;
-    
-        //! @brief Listeners registered in this emitter. 
-        std::list < std::weak_ptr < Listener > > listeners;
-    
-        //! @brief Protects listeners. A shared mutex lets multiple threads send an event
-        //! by using this emitter. This may be rare but it also let event sending faster. 
-        std::shared_mutex listenersMutex;
-    
-        //! @brief Queue of threads sent by this emitter.
-        std::queue < std::future < void > > sendThreads;
-    
-        //! @brief Protects the thread's queue.
-        std::mutex sendThreadsMutex;
-    
+
+        //! @brief Listeners registered in this emitter. Never null.
+        std::shared_ptr < const ListenersList > listeners;
+
+        //! @brief Serializes modifications of listeners.
+        std::mutex listenersMutex;
+
+        //! @brief Events waiting to be delivered, in order.
+        std::deque < std::unique_ptr < PendingEventBase > > pendingEvents;
+
+        //! @brief True while a task of the JobSystem delivers pendingEvents.
+        bool deliveryScheduled;
+
+        //! @brief Protects pendingEvents and deliveryScheduled.
+        std::mutex pendingEventsMutex;
+
+        //! @brief Notified when the delivery task ends.
+        std::condition_variable deliveryEnded;
+
         //! @brief Policy to event emition.
         std::atomic < std::uint8_t > eventEmittingPolicy;
-    
-        //! @brief Limits for the number of threads that can be launched simultaneously.
-        std::atomic < std::size_t > sendThreadsLimit;
-    
+
     public:
-    
+
         /*! @brief Default constructor. */
-        Emitter() : eventEmittingPolicy(kEventEmittingPolicyAsync), sendThreadsLimit(20)
+        Emitter() : listeners(std::make_shared < const ListenersList >()), deliveryScheduled(false), eventEmittingPolicy(kEventEmittingPolicyAsync)
         {
-        
+
+        }
+
+        /*! @brief Waits for the events sent to be delivered. */
+        ~Emitter()
+        {
+            waitDelivered();
         }
-    
+
         /*! @brief Registers a new listener for this emitter. */
         void addListener(std::shared_ptr < Listener > const& listener)
         {
-            std::scoped_lock < std::shared_mutex > lck(listenersMutex);
-            listeners.push_back(listener);
+            std::scoped_lock < std::mutex > lck(listenersMutex);
+            auto result = std::make_shared < ListenersList >(*std::atomic_load(&listeners));
+            result->push_back(listener);
+            std::atomic_store(&listeners, std::shared_ptr < const ListenersList >(result));
         }
-    
+
         /*! @brief Registers a new listener if its type is derived from this emitter's listener type. */
         template < class DerivedListener, EnableIf < IsBase < Listener, DerivedListener > >* = nullptr >
         void addListener(std::shared_ptr < DerivedListener > const& listener)
         {
             addListener(std::static_pointer_cast < Listener >(listener));
-        } 
-    
+        }
+
         /*! @brief Removes a listener from this emitter. */
         void removeListener(std::shared_ptr < Listener > const& listener)
         {
-            std::scoped_lock < std::shared_mutex > lck(listenersMutex);
-            auto it = std::find_if(listeners.begin(), listeners.end(), [&listener](std::weak_ptr < Listener > const& wl) {
+            std::scoped_lock < std::mutex > lck(listenersMutex);
+            auto result = std::make_shared < ListenersList >(*std::atomic_load(&listeners));
+
+            auto it = std::find_if(result->begin(), result->end(), [&listener](std::weak_ptr < Listener > const& wl) {
                 return wl.lock() == listener;
             });
-            listeners.erase(it);
+
+            if (it == result->end()) return;
+
+            result->erase(it);
+            std::atomic_store(&listeners, std::shared_ptr < const ListenersList >(result));
         }
-    
+
         /*! @brief Removes all listeners. */
-        void resetListeners() 
+        void resetListeners()
         {
-            std::scoped_lock lck(listenersMutex);
-            listeners.clear();
+            std::scoped_lock < std::mutex > lck(listenersMutex);
+            std::atomic_store(&listeners, std::make_shared < const ListenersList >());
         }
-    
+
         /*! @brief Sends an event to all listeners to this emitter. */
         template < typename Callback, class EventT >
         void send(Callback callback, EventT const& event)
-        {   
+        {
             if (eventEmittingPolicy.load() == kEventEmittingPolicyAsync)
-            {   
-                listenersMutex.lock_shared();
-                
-                auto listenersCopy = listeners;
-                auto callerCopy = caller;
-            
-                auto sendThread = std::async(std::launch::async, [callback, event, listenersCopy, callerCopy](){
-                
-                    for (auto listener : listenersCopy)
-                    {
-                        auto slistener = listener.lock();
-                        if (!slistener) continue;
-                    
-                        callerCopy(callback, slistener.get(), event);
-                    }
-                
-                });
-            
-                listenersMutex.unlock_shared();
-            
-                std::scoped_lock lck2(sendThreadsMutex);
-                sendThreads.push(std::move(sendThread));
-                flushSendThreads();
-            }
-        
-            else if (eventEmittingPolicy.load() == kEventEmittingPolicySync)
             {
-                std::scoped_lock lck(listenersMutex);
-                for (auto listener : listeners)
+                auto pending = std::make_unique < PendingEvent < Callback, EventT > >(callback, event);
+
                 {
-                    auto slistener = listener.lock();
-                    if (!slistener) continue;
-                
-                    caller(callback, slistener.get(), event);
+                    std::scoped_lock < std::mutex > lck(pendingEventsMutex);
+
+                    if (!pendingEvents.empty() && pendingEvents.back()->merge(*pending))
+                        return;
+
+                    pendingEvents.push_back(std::move(pending));
+
+                    if (deliveryScheduled)
+                        return;
+
+                    deliveryScheduled = true;
                 }
+
+                scheduleDelivery();
+            }
+
+            else if (eventEmittingPolicy.load() == kEventEmittingPolicySync)
+            {
+                auto current = std::atomic_load(&listeners);
+                PendingEvent < Callback, EventT >(callback, event).deliver(*current, caller);
             }
         }
-    
+
         /*! @brief Changes eventEmittingPolicy. */
         void setEventEmittingPolicy(std::uint8_t value)
         {
             eventEmittingPolicy.store(value);
         }
-    
+
         /*! @brief Returns eventEmittingPolicy. */
-        std::uint8_t getEventEmittingPolicy() const 
+        std::uint8_t getEventEmittingPolicy() const
         {
             return eventEmittingPolicy.load();
         }
-    
-        /*! @brief Changes sendThreadsLimit. */
-        void setSendThreadsLimit(std::size_t limit)
+
+        /*! @brief Returns number of listeners. */
+        std::size_t getListenersCount() const
         {
-            sendThreadsLimit.store(limit);
+            return std::atomic_load(&listeners)->size();
         }
-    
-        /*! @brief Returns sendThreadsLimit. */
-        std::size_t getSendThreadsLimit() const 
+
+        /*! @brief Waits until all events sent are delivered. Must not be called by a listener. */
+        void waitDelivered()
         {
-            return sendThreadsLimit.load();
+            std::unique_lock < std::mutex > lck(pendingEventsMutex);
+            deliveryEnded.wait(lck, [this](){ return !deliveryScheduled; });
         }
-    
-        /*! @brief Returns number of listeners. */
-        std::size_t getListenersCount() const 
+
+    protected:
+
+        /*! @brief Submits a task delivering pending events to the JobSystem.
+         *  Without JobSystem (Core not created yet), events are delivered by the calling thread. **/
+        void scheduleDelivery()
         {
-            std::scoped_lock lck(listenersMutex);
-            return listeners.size();
+            JobSystem* jobSystem = JobSystem::Find();
+
+            if (!jobSystem)
+            {
+                while (!deliverPending());
+                return;
+            }
+
+            jobSystem->getPool().submit([this](){
+                if (!deliverPending())
+                    scheduleDelivery();
+            });
         }
-    
-    protected:
-    
-        /*! @brief Joins threads in the thread's queue if its limits has been reached. */
-        void flushSendThreads()
+
+        /*! @brief Delivers pending events in order. Returns true when no events are left.
+         *
+         * Returns false after kEmitterEventsPerTask events, so the task is submitted again and an
+         * emitter sending events continuously doesn't keep a worker for itself.
+         *
+        **/
+        bool deliverPending()
         {
-            if (sendThreads.size() > sendThreadsLimit.load())
-            { 
-                bool quit = false;
-                std::size_t currentFinished = 0;
-                std::size_t limit = sendThreadsLimit.load();
-            
-                do
-                {            
-                    std::future < void > lastThread = std::move(sendThreads.front());
-                    sendThreads.pop();
-                
-                    try
-                    {
-                        lastThread.wait();
-                        currentFinished++;
-                    }
-                
-                    catch(std::system_error const& e)
+            for (std::size_t i = 0; i < kEmitterEventsPerTask; ++i)
+            {
+                std::unique_ptr < PendingEventBase > event;
+
+                {
+                    std::scoped_lock < std::mutex > lck(pendingEventsMutex);
+
+                    if (pendingEvents.empty())
                     {
-                        quit = true;
+                        deliveryScheduled = false;
+                        deliveryEnded.notify_all();
+                        return true;
                     }
-                
+
+                    event = std::move(pendingEvents.front());
+                    pendingEvents.pop_front();
                 }
-                while (!quit && currentFinished < limit && !sendThreads.empty());
+
+                auto current = std::atomic_load(&listeners);
+                event->deliver(*current, caller);
             }
+
+            return false;
         }
     };
 }
@@ -6,9 +6,29 @@
 
 #include "Version.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace Clean 
 {
-    /** @brief Defines some informations about a file loader. */
+    /** @brief Bytes found at a given offset of every file of a format, like "\x89PNG" at the start of a PNG file. */
+    struct FileLoaderMagic
+    {
+        //! @brief Offset of the bytes in the file.
+        std::size_t offset = 0;
+        
+        //! @brief Bytes expected at offset.
+        std::string bytes;
+    };
+    
+    /** @brief Defines some informations about a file loader. 
+     *
+     * extensions, priority and magics are read once, when the loader is added to Core: they let Core find the
+     * loader of a file without calling isLoadable() on every loader of its type.
+     *
+    **/
     struct FileLoaderInfos 
     {
         //! @brief Name for the loader. 
@@ -22,6 +42,17 @@ namespace Clean
         
         //! @brief Version of this loader. 
         Version version;
+        
+        //! @brief Extensions loaded, compared without case. A loader declaring none is asked with isLoadable(),
+        //! after the loaders declaring the extension. [optional]
+        std::vector < std::string > extensions;
+        
+        //! @brief Loaders with a higher priority are found first, for the same extension or content. [optional]
+        std::int32_t priority = 0;
+        
+        //! @brief Signatures of the files loaded. A file matching one of them may be loaded whatever its
+        //! extension, see Core::findFileLoaderByContent(). [optional]
+        std::vector < FileLoaderMagic > magics;
     };
     
     /** @brief Interface for a file's loader. 
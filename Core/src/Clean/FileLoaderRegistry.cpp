@@ -0,0 +1,170 @@
+/** \file Core/FileLoaderRegistry.cpp
+**/
+
+#include "FileLoaderRegistry.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace Clean
+{
+    std::size_t FileLoaderRegistry::KeyHash::operator () (Key const& key) const
+    {
+        const std::size_t lhs = key.type.hash_code();
+        const std::size_t rhs = std::hash < std::string >()(key.extension);
+        return lhs ^ (rhs + 0x9e3779b9 + (lhs << 6) + (lhs >> 2));
+    }
+
+    FileLoaderRegistry::FileLoaderRegistry() : table(std::make_shared < const Table >())
+    {
+
+    }
+
+    void FileLoaderRegistry::add(std::type_index type, std::shared_ptr < FileLoaderInterface > const& loader)
+    {
+        assert(loader && "Invalid FileLoader pointer.");
+
+        Entry entry { type, loader, loader->getInfos() };
+
+        for (std::string& extension : entry.infos.extensions)
+            extension = Platform::StringToLower(extension);
+
+        std::scoped_lock < std::mutex > lck(writeMutex);
+        entries.push_back(std::move(entry));
+        publish();
+    }
+
+    void FileLoaderRegistry::remove(std::type_index type, std::shared_ptr < FileLoaderInterface > const& loader)
+    {
+        std::scoped_lock < std::mutex > lck(writeMutex);
+
+        auto it = std::find_if(entries.begin(), entries.end(), [&](Entry const& entry){
+            return entry.type == type && entry.loader.get() == loader.get();
+        });
+
+        if (it == entries.end())
+            return;
+
+        entries.erase(it);
+        publish();
+    }
+
+    void FileLoaderRegistry::clear()
+    {
+        std::scoped_lock < std::mutex > lck(writeMutex);
+        entries.clear();
+        publish();
+    }
+
+    std::shared_ptr < FileLoaderInterface > FileLoaderRegistry::find(std::type_index type, std::string const& extension) const
+    {
+        auto current = std::atomic_load(&table);
+
+        auto it = current->byExtension.find(Key { type, Platform::StringToLower(extension) });
+        if (it != current->byExtension.end())
+            return it->second.front();
+
+        auto undeclared = current->undeclared.find(type);
+        if (undeclared == current->undeclared.end())
+            return nullptr;
+
+        for (auto const& loader : undeclared->second)
+        {
+            if (loader->isLoadable(extension))
+                return loader;
+        }
+
+        return nullptr;
+    }
+
+    std::shared_ptr < FileLoaderInterface > FileLoaderRegistry::findByContent(std::type_index type, const void* bytes, std::size_t size) const
+    {
+        if (!bytes || !size)
+            return nullptr;
+
+        auto current = std::atomic_load(&table);
+        auto it = current->byType.find(type);
+        if (it == current->byType.end()) return nullptr;
+
+        for (Entry const& entry : it->second)
+        {
+            for (FileLoaderMagic const& magic : entry.infos.magics)
+            {
+                if (Matches(magic, bytes, size))
+                    return entry.loader;
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool FileLoaderRegistry::Matches(FileLoaderMagic const& magic, const void* bytes, std::size_t size)
+    {
+        if (!bytes || magic.bytes.empty() || magic.offset > size || magic.bytes.size() > size - magic.offset)
+            return false;
+
+        return !memcmp(static_cast < const char* >(bytes) + magic.offset, magic.bytes.data(), magic.bytes.size());
+    }
+
+    std::shared_ptr < FileLoaderInterface > FileLoaderRegistry::findByName(std::type_index type, std::string const& name) const
+    {
+        auto current = std::atomic_load(&table);
+        auto it = current->byType.find(type);
+        if (it == current->byType.end()) return nullptr;
+
+        for (Entry const& entry : it->second)
+        {
+            if (entry.infos.name == name)
+                return entry.loader;
+        }
+
+        return nullptr;
+    }
+
+    std::vector < std::shared_ptr < FileLoaderInterface > > FileLoaderRegistry::findAll(std::type_index type) const
+    {
+        std::vector < std::shared_ptr < FileLoaderInterface > > result;
+
+        auto current = std::atomic_load(&table);
+        auto it = current->byType.find(type);
+        if (it == current->byType.end()) return result;
+
+        result.reserve(it->second.size());
+
+        for (Entry const& entry : it->second)
+            result.push_back(entry.loader);
+
+        return result;
+    }
+
+    void FileLoaderRegistry::publish()
+    {
+        auto next = std::make_shared < Table >();
+
+        // A stable sort keeps the loaders of the same priority in the order they were added.
+        std::vector < Entry > sorted = entries;
+        std::stable_sort(sorted.begin(), sorted.end(), [](Entry const& lhs, Entry const& rhs){
+            return lhs.infos.priority > rhs.infos.priority;
+        });
+
+        for (Entry const& entry : sorted)
+        {
+            next->byType[entry.type].push_back(entry);
+
+            if (entry.infos.extensions.empty())
+                next->undeclared[entry.type].push_back(entry.loader);
+
+            for (std::string const& extension : entry.infos.extensions)
+            {
+                auto& loaders = next->byExtension[Key { entry.type, extension }];
+
+                if (std::find(loaders.begin(), loaders.end(), entry.loader) == loaders.end())
+                    loaders.push_back(entry.loader);
+            }
+        }
+
+        std::atomic_store(&table, std::shared_ptr < const Table >(std::move(next)));
+    }
+}
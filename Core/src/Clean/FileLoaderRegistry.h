@@ -0,0 +1,119 @@
+/** \file Core/FileLoaderRegistry.h
+**/
+
+#ifndef CLEAN_FILELOADERREGISTRY_H
+#define CLEAN_FILELOADERREGISTRY_H
+
+#include "FileLoader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace Clean
+{
+    //! @brief Number of bytes of a file read to find its loader from its content.
+    static constexpr const std::size_t kFileLoaderSniffSize = 64;
+
+    /** @brief Stores the FileLoaders of Core, by loaded type and extension.
+     *
+     * Finding a loader is done on every asset load, possibly by several jobs at once, while loaders are only
+     * added and removed when modules start and stop. Lookups thus read an immutable table without locking:
+     * a hash table keyed by the loaded type and the lower-cased extension, whose loaders are sorted by
+     * decreasing FileLoaderInfos::priority. add(), remove() and clear() build a new table and swap it with
+     * std::atomic_store; lookups holding the old table keep it alive until they return.
+     *
+     * Extensions come from FileLoaderInfos::extensions. Loaders declaring none are still found: they are
+     * asked with FileLoaderInterface::isLoadable() when no loader declares the extension.
+     *
+    **/
+    class FileLoaderRegistry final
+    {
+        /** @brief A loader and the infos read when it was added. */
+        struct Entry
+        {
+            std::type_index type;
+            std::shared_ptr < FileLoaderInterface > loader;
+            FileLoaderInfos infos;
+        };
+
+        /** @brief Type and lower-cased extension. */
+        struct Key
+        {
+            std::type_index type;
+            std::string extension;
+
+            bool operator == (Key const& rhs) const { return type == rhs.type && extension == rhs.extension; }
+        };
+
+        /** @brief Hashes a Key. */
+        struct KeyHash
+        {
+            std::size_t operator () (Key const& key) const;
+        };
+
+        /** @brief Immutable lookup table, built from the entries. */
+        struct Table
+        {
+            //! @brief Every entry of a type, by decreasing priority.
+            std::unordered_map < std::type_index, std::vector < Entry > > byType;
+
+            //! @brief Loaders by type and extension, by decreasing priority.
+            std::unordered_map < Key, std::vector < std::shared_ptr < FileLoaderInterface > >, KeyHash > byExtension;
+
+            //! @brief Loaders of a type declaring no extension, by decreasing priority.
+            std::unordered_map < std::type_index, std::vector < std::shared_ptr < FileLoaderInterface > > > undeclared;
+        };
+
+        //! @brief Entries, in the order they were added. Only used by writers.
+        std::vector < Entry > entries;
+
+        //! @brief Protects entries, and serializes the writers.
+        std::mutex writeMutex;
+
+        //! @brief Current table, never null. Accessed with std::atomic_load and std::atomic_store.
+        std::shared_ptr < const Table > table;
+
+    public:
+
+        /*! @brief Constructs an empty registry. */
+        FileLoaderRegistry();
+
+        /*! @brief Adds a loader for type. Its infos are read now. */
+        void add(std::type_index type, std::shared_ptr < FileLoaderInterface > const& loader);
+
+        /*! @brief Removes a loader for type. */
+        void remove(std::type_index type, std::shared_ptr < FileLoaderInterface > const& loader);
+
+        /*! @brief Removes every loader. */
+        void clear();
+
+        /*! @brief Finds the loader of type with the highest priority for extension, or returns null. */
+        std::shared_ptr < FileLoaderInterface > find(std::type_index type, std::string const& extension) const;
+
+        /*! @brief Finds the loader of type with the highest priority whose magics match bytes, the start of a
+         *  file, or returns null. */
+        std::shared_ptr < FileLoaderInterface > findByContent(std::type_index type, const void* bytes, std::size_t size) const;
+
+        /*! @brief Finds the first loader of type with the given name, or returns null. */
+        std::shared_ptr < FileLoaderInterface > findByName(std::type_index type, std::string const& name) const;
+
+        /*! @brief Returns every loader of type, by decreasing priority. */
+        std::vector < std::shared_ptr < FileLoaderInterface > > findAll(std::type_index type) const;
+
+        /*! @brief Returns true if magic is found in bytes, the start of a file. */
+        static bool Matches(FileLoaderMagic const& magic, const void* bytes, std::size_t size);
+
+    private:
+
+        /*! @brief Builds a table from entries and swaps it with table. writeMutex must be locked. */
+        void publish();
+    };
+}
+
+#endif // CLEAN_FILELOADERREGISTRY_H
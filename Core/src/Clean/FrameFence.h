@@ -0,0 +1,37 @@
+/** \file Core/FrameFence.h
+**/
+
+#ifndef CLEAN_FRAMEFENCE_H
+#define CLEAN_FRAMEFENCE_H
+
+#include <atomic>
+
+namespace Clean
+{
+    /** @brief Tells when the GPU is done with the commands submitted before it.
+     *
+     * A fence is made by Driver::makeFrameFence() after the commands of a frame are submitted, for drivers
+     * supporting them. The FramePipeline polls it with fetch() from the driver's thread and frees the frame's
+     * resources when it is signaled, so a frame never writes into buffers the GPU may still read.
+     *
+    **/
+    class FrameFence
+    {
+    protected:
+
+        //! @brief True once the GPU has passed the fence.
+        std::atomic < bool > signaled = { false };
+
+    public:
+
+        virtual ~FrameFence() = default;
+
+        /*! @brief Checks if the GPU has passed the fence, without waiting. Called by the driver's thread. */
+        virtual void fetch() = 0;
+
+        /*! @brief Returns true if the last fetch() found the fence passed. */
+        bool isSignaled() const { return signaled.load(std::memory_order_acquire); }
+    };
+}
+
+#endif // CLEAN_FRAMEFENCE_H
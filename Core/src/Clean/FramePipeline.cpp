@@ -0,0 +1,217 @@
+/** \file Core/FramePipeline.cpp
+**/
+
+#include "FramePipeline.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Clean
+{
+    FramePipeline::FramePipeline(std::size_t count)
+        : framesInFlight(std::clamp < std::size_t >(count, 1, kFramePipelineMaxFrames))
+        , nextRecord(1), nextSubmit(1), completed(0), active(false), cancelled(false)
+    {
+
+    }
+
+    void FramePipeline::setFramesInFlight(std::size_t count)
+    {
+        {
+            std::scoped_lock < std::mutex > lck(mutex);
+            framesInFlight = std::clamp < std::size_t >(count, 1, kFramePipelineMaxFrames);
+        }
+
+        recordable.notify_all();
+    }
+
+    std::size_t FramePipeline::getFramesInFlight() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return framesInFlight;
+    }
+
+    std::uint64_t FramePipeline::beginRecord()
+    {
+        ProfileScope("FramePipeline::beginRecord");
+
+        std::unique_lock < std::mutex > lck(mutex);
+        active = true;
+
+        recordable.wait(lck, [this](){
+            return cancelled || nextRecord - completed <= framesInFlight;
+        });
+
+        if (cancelled)
+            return 0;
+
+        const std::uint64_t frame = nextRecord++;
+        Slot& slot = slots[SlotOf(frame)];
+        assert(slot.state == kFrameFree && "Frame slot still in flight.");
+
+        slot.state = kFrameRecording;
+        slot.frame = frame;
+        return frame;
+    }
+
+    void FramePipeline::endRecord(std::uint64_t frame)
+    {
+        {
+            std::scoped_lock < std::mutex > lck(mutex);
+            Slot& slot = slots[SlotOf(frame)];
+            if (slot.frame != frame || slot.state != kFrameRecording) return;
+            slot.state = kFrameRecorded;
+        }
+
+        submittable.notify_all();
+    }
+
+    std::uint64_t FramePipeline::beginSubmit(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock < std::mutex > lck(mutex);
+
+        // Frames are submitted in the order they were begun, even if a later one was recorded first.
+        auto ready = [this](){
+            Slot const& slot = slots[SlotOf(nextSubmit)];
+            return cancelled || (slot.frame == nextSubmit && slot.state == kFrameRecorded);
+        };
+
+        if (!submittable.wait_for(lck, timeout, ready) || cancelled)
+            return 0;
+
+        return nextSubmit++;
+    }
+
+    void FramePipeline::endSubmit(std::uint64_t frame, std::shared_ptr < FrameFence > const& fence)
+    {
+        {
+            std::scoped_lock < std::mutex > lck(mutex);
+            Slot& slot = slots[SlotOf(frame)];
+            if (slot.frame != frame || slot.state != kFrameRecorded) return;
+
+            slot.state = kFrameSubmitted;
+            slot.fence = fence;
+        }
+
+        // Without a fence, the driver synchronizes its resources itself: the frame is done for us.
+        if (!fence) poll();
+    }
+
+    std::uint64_t FramePipeline::poll()
+    {
+        std::unique_lock < std::mutex > lck(mutex);
+        std::vector < std::function < void() > > callbacks;
+        std::uint64_t last = completed;
+
+        // Frames complete in submission order: the first fence not passed stops the loop.
+        while (last + 1 < nextSubmit)
+        {
+            Slot& slot = slots[SlotOf(last + 1)];
+            if (slot.state != kFrameSubmitted) break;
+
+            if (slot.fence)
+            {
+                slot.fence->fetch();
+                if (!slot.fence->isSignaled()) break;
+            }
+
+            for (auto& callback : slot.retired)
+                callbacks.push_back(std::move(callback));
+
+            slot.retired.clear();
+            ++last;
+        }
+
+        if (last == completed)
+            return completed;
+
+        // Resources of the frames are released before the frames complete, so a frame recorded after
+        // never sees them.
+        lck.unlock();
+
+        for (auto const& callback : callbacks)
+            callback();
+
+        callbacks.clear();
+        lck.lock();
+
+        for (std::uint64_t frame = completed + 1; frame <= last; ++frame)
+        {
+            Slot& slot = slots[SlotOf(frame)];
+            if (slot.frame != frame || slot.state != kFrameSubmitted) continue;
+
+            // Callbacks given to retire() while the others were called.
+            for (auto& callback : slot.retired)
+                callbacks.push_back(std::move(callback));
+
+            slot = Slot();
+        }
+
+        completed = std::max(completed, last);
+        const std::uint64_t result = completed;
+        lck.unlock();
+
+        recordable.notify_all();
+
+        for (auto const& callback : callbacks)
+            callback();
+
+        return result;
+    }
+
+    void FramePipeline::retire(std::uint64_t frame, std::function < void() > const& callback)
+    {
+        {
+            std::scoped_lock < std::mutex > lck(mutex);
+            Slot& slot = slots[SlotOf(frame)];
+
+            if (frame > completed && slot.frame == frame && slot.state != kFrameFree)
+            {
+                slot.retired.push_back(callback);
+                return;
+            }
+        }
+
+        callback();
+    }
+
+    void FramePipeline::cancel()
+    {
+        std::vector < std::function < void() > > callbacks;
+
+        {
+            std::scoped_lock < std::mutex > lck(mutex);
+            cancelled = true;
+
+            for (Slot& slot : slots)
+            {
+                for (auto const& callback : slot.retired)
+                    callbacks.push_back(callback);
+
+                slot = Slot();
+            }
+
+            nextSubmit = nextRecord;
+            completed = nextRecord - 1;
+        }
+
+        recordable.notify_all();
+        submittable.notify_all();
+
+        for (auto const& callback : callbacks)
+            callback();
+    }
+
+    bool FramePipeline::isActive() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return active && !cancelled;
+    }
+
+    std::uint64_t FramePipeline::getCompletedFrame() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return completed;
+    }
+}
@@ -0,0 +1,161 @@
+/** \file Core/FramePipeline.h
+**/
+
+#ifndef CLEAN_FRAMEPIPELINE_H
+#define CLEAN_FRAMEPIPELINE_H
+
+#include "FrameFence.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Clean
+{
+    //! @brief Largest number of frames in flight. Per-frame resources need this many copies at most.
+    static constexpr const std::size_t kFramePipelineMaxFrames = 4;
+
+    //! @brief Default number of frames in flight: one recorded while the previous one is submitted.
+    static constexpr const std::size_t kFramePipelineDefaultFrames = 2;
+
+    //! @brief Default time Driver::update() waits for a recorded frame before only updating windows.
+    static constexpr const std::chrono::milliseconds kFramePipelineSubmitTimeout = std::chrono::milliseconds(8);
+
+    //! @brief States of a frame in the FramePipeline. @{
+    static constexpr const std::uint8_t kFrameFree = 0;
+    static constexpr const std::uint8_t kFrameRecording = 1;
+    static constexpr const std::uint8_t kFrameRecorded = 2;
+    static constexpr const std::uint8_t kFrameSubmitted = 3;
+    //! @}
+
+    /** @brief Lets the commands of a frame be recorded while the driver submits the previous ones.
+     *
+     * Without a pipeline, a frame is simulated, recorded and submitted by the thread calling Driver::update().
+     * With it, a recording thread, or jobs of the JobSystem, call beginRecord() to get a frame number, add their
+     * commands with RenderQueue::addCommand(command, frame), and call Driver::endRecord(), which takes a snapshot of
+     * the driver's parameters for the frame before calling endRecord(). Meanwhile, the driver's thread submits the 
+     * frames recorded, in order, in Driver::update():
+     *
+     * \code
+     *  // Recording thread.
+     *  while (std::uint64_t frame = pipeline.beginRecord()) {
+     *      camera->commit();
+     *      queue->addCommands(commands, frame);
+     *      driver->endRecord(frame);
+     *  }
+     *
+     *  // Driver's thread.
+     *  while (!driver->allWindowClosed())
+     *      driver->update();
+     *
+     *  pipeline.cancel();
+     * \endcode
+     *
+     * A frame stays in flight from beginRecord() until the GPU has passed the fence made after its submission.
+     * beginRecord() waits while the number of frames in flight is the limit set by setFramesInFlight(), so
+     * resources written by a frame, with SlotOf(frame) copies, are never written while the GPU reads them.
+     * Resources to destroy once the GPU is done with a frame are given to retire().
+     *
+    **/
+    class FramePipeline
+    {
+        /** @brief A frame in flight. */
+        struct Slot
+        {
+            //! @brief kFrame* state.
+            std::uint8_t state = kFrameFree;
+
+            //! @brief Number of the frame using this slot.
+            std::uint64_t frame = 0;
+
+            //! @brief Fence made after the frame's submission, or null if the driver doesn't have fences.
+            std::shared_ptr < FrameFence > fence;
+
+            //! @brief Callbacks called when the GPU is done with the frame.
+            std::vector < std::function < void() > > retired;
+        };
+
+        //! @brief Frames in flight, by SlotOf().
+        Slot slots[kFramePipelineMaxFrames];
+
+        //! @brief Maximum number of frames in flight.
+        std::size_t framesInFlight;
+
+        //! @brief Number of the next frame given by beginRecord(). Frames start at 1.
+        std::uint64_t nextRecord;
+
+        //! @brief Number of the next frame to submit.
+        std::uint64_t nextSubmit;
+
+        //! @brief Last frame the GPU is done with.
+        std::uint64_t completed;
+
+        //! @brief True once beginRecord() was called: Driver::update() then submits recorded frames.
+        bool active;
+
+        //! @brief True after cancel(): beginRecord() returns 0.
+        bool cancelled;
+
+        //! @brief Protects every field above.
+        mutable std::mutex mutex;
+
+        //! @brief Notified when a frame is completed, or when the pipeline is cancelled.
+        std::condition_variable recordable;
+
+        //! @brief Notified when a frame is recorded.
+        std::condition_variable submittable;
+
+    public:
+
+        /*! @brief Constructs an inactive pipeline. */
+        FramePipeline(std::size_t framesInFlight = kFramePipelineDefaultFrames);
+
+        /*! @brief Changes the maximum number of frames in flight, clamped to [1, kFramePipelineMaxFrames].
+         *  One frame in flight makes recording wait for the previous frame's completion. */
+        void setFramesInFlight(std::size_t count);
+
+        /*! @brief Returns the maximum number of frames in flight. */
+        std::size_t getFramesInFlight() const;
+
+        /*! @brief Waits until a frame can be recorded and returns its number, or 0 if the pipeline is cancelled. */
+        std::uint64_t beginRecord();
+
+        /*! @brief Marks the frame recorded: the driver may now submit it. */
+        void endRecord(std::uint64_t frame);
+
+        /*! @brief Waits at most timeout for the next frame to be recorded, and returns its number, or 0 if none is.
+         *  Called by the driver's thread. */
+        std::uint64_t beginSubmit(std::chrono::milliseconds timeout = kFramePipelineSubmitTimeout);
+
+        /*! @brief Marks the frame submitted. fence, if not null, tells when the GPU is done with it. */
+        void endSubmit(std::uint64_t frame, std::shared_ptr < FrameFence > const& fence);
+
+        /*! @brief Fetches the fences of the submitted frames, in order, and completes the frames passed.
+         *  Called by the driver's thread. Returns the last completed frame. */
+        std::uint64_t poll();
+
+        /*! @brief Calls callback when the GPU is done with frame, or now if it already is. Callbacks are called
+         *  by the driver's thread. */
+        void retire(std::uint64_t frame, std::function < void() > const& callback);
+
+        /*! @brief Wakes up the threads waiting in beginRecord(), which return 0 from now on. Frames not submitted
+         *  yet are dropped, and frames submitted are completed. */
+        void cancel();
+
+        /*! @brief Returns true if frames were recorded through beginRecord(). */
+        bool isActive() const;
+
+        /*! @brief Returns the last frame the GPU is done with. */
+        std::uint64_t getCompletedFrame() const;
+
+        /*! @brief Returns the index of the per-frame resources used by frame, in [0, kFramePipelineMaxFrames). */
+        static std::size_t SlotOf(std::uint64_t frame) { return static_cast < std::size_t >(frame % kFramePipelineMaxFrames); }
+    };
+}
+
+#endif // CLEAN_FRAMEPIPELINE_H
@@ -7,6 +7,9 @@
 #ifndef CLEAN_HASH_H
 #define CLEAN_HASH_H
 
+#include <cstdint>
+#include <cstring>
+
 namespace Clean 
 {
     namespace HashDetail
@@ -45,6 +45,10 @@ namespace Clean
         if (loadedPixels)
         {
             const std::size_t formatSize = PixelFormatGetSize(loadedPixels->format);
+            
+            // Block-compressed formats have no pixel size and are always tightly packed.
+            if (!formatSize) return loadedPixels->levels.empty() ? 0 : loadedPixels->levels[0].width;
+            
             return loadedPixels->lineWidth / formatSize;
         }
         
@@ -57,6 +61,13 @@ namespace Clean
         return loadedPixels ? loadedPixels->format : kPixelFormatNull;
     }
     
+    std::size_t Image::getLevelsCount() const 
+    {
+        auto loadedPixels = std::atomic_load(&pixels);
+        if (!loadedPixels) return 0;
+        return loadedPixels->levels.empty() ? 1 : loadedPixels->levels.size();
+    }
+    
     SizePair const Image::getOrigin() const 
     {
         return origin.load();
@@ -88,6 +88,11 @@ namespace Clean
         /*! @brief Returns the format of the pixel set. */
         virtual const std::uint8_t pixelFormat() const;
         
+        /*! @brief Returns the number of mipmaps levels in the PixelSet, or 0 if there is no PixelSet.
+         *  A PixelSet without levels array holds only one level. 
+        **/
+        virtual std::size_t getLevelsCount() const;
+        
         /*! @brief Returns the origin of the Image. */
         virtual SizePair const getOrigin() const;
         
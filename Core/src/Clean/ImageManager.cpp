@@ -8,11 +8,19 @@
 #include "Core.h"
 #include "Platform.h"
 #include "NotificationCenter.h"
+#include "Profiler.h"
 
 namespace Clean 
 {
+    ImageManager::ImageManager()
+    {
+        fileIndex = addIndex([](Image const& image){ return HashKey(image.getFile()); });
+    }
+    
     std::shared_ptr < Image > ImageManager::load(std::string const& filepath)
     {
+        ProfileScope("ImageManager::load");
+        
         {
             auto result = findFile(filepath);
             if (result) return result;
@@ -21,6 +29,17 @@ namespace Clean
         std::string extension = Platform::PathGetExtension(filepath);
         auto loader = Core::Get().findFileLoader < Image >(extension);
         
+        if (!loader)
+        {
+            // The extension may be missing or wrong: the first bytes of the file may still tell its format.
+            char bytes[kFileLoaderSniffSize];
+            std::fstream stream = FileSystem::Current().open(filepath, std::ios::in | std::ios::binary);
+            stream.read(bytes, sizeof(bytes));
+            
+            if (stream.gcount() > 0)
+                loader = Core::Get().findFileLoaderByContent < Image >(bytes, static_cast < std::size_t >(stream.gcount()));
+        }
+        
         if (!loader)
         {
             NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "No loader found for extension %s.", extension.data()));
@@ -35,9 +54,6 @@ namespace Clean
     
     std::shared_ptr < Image > ImageManager::findFile(std::string const& filepath)
     {
-        std::scoped_lock < std::mutex > lck(managedListMutex);
-        auto it = std::find_if(managedList.begin(), managedList.end(), [filepath](auto p) { return p->getFile() == filepath; });
-        if (it == managedList.end()) return nullptr;
-        return *it;
+        return findIndexed(fileIndex, HashKey(filepath), [&filepath](Image const& image){ return image.getFile() == filepath; });
     }
 }
\ No newline at end of file
@@ -15,8 +15,14 @@ namespace Clean
 {
     class ImageManager : public Manager < Image >, public Singleton < ImageManager >
     {
+        //! @brief Index of images by file.
+        std::size_t fileIndex;
+        
     public:
         
+        /*! @brief Constructs the manager and its index by file. */
+        ImageManager();
+        
         /*! @brief Loads an image from a file. */
         std::shared_ptr < Image > load(std::string const& filepath);
         
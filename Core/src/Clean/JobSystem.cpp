@@ -0,0 +1,230 @@
+/** \file Core/JobSystem.cpp
+**/
+
+#include "JobSystem.h"
+#include "NotificationCenter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <exception>
+
+namespace Clean
+{
+    JobCounter::JobCounter() : count(0)
+    {
+
+    }
+
+    void JobCounter::add(std::size_t n)
+    {
+        count.fetch_add(n);
+    }
+
+    void JobCounter::done()
+    {
+        const std::size_t previous = count.fetch_sub(1);
+        assert(previous && "JobCounter::done() called more than the jobs added.");
+        if (previous != 1) return;
+
+        std::vector < std::function < void() > > fns;
+
+        {
+            std::lock_guard < std::mutex > lck(mutex);
+            fns.swap(continuations);
+            condition.notify_all();
+        }
+
+        for (auto const& fn : fns)
+            fn();
+    }
+
+    bool JobCounter::isDone() const
+    {
+        return count.load() == 0;
+    }
+
+    std::size_t JobCounter::getCount() const
+    {
+        return count.load();
+    }
+
+    void JobCounter::then(std::function < void() > fn)
+    {
+        {
+            std::lock_guard < std::mutex > lck(mutex);
+
+            if (count.load() != 0)
+            {
+                continuations.push_back(std::move(fn));
+                return;
+            }
+        }
+
+        fn();
+    }
+
+    JobSystem::JobSystem(std::size_t threadsCount) : pool(threadsCount), mainThread(std::this_thread::get_id())
+    {
+
+    }
+
+    JobSystem::~JobSystem()
+    {
+        while (runMainJob());
+    }
+
+    void JobSystem::run(std::function < void() > job, std::shared_ptr < JobCounter > const& counter)
+    {
+        if (counter) counter->add();
+
+        pool.submit([job = std::move(job), counter](){
+            Execute(job, counter.get());
+        });
+    }
+
+    std::shared_ptr < JobCounter > JobSystem::async(std::function < void() > job)
+    {
+        auto counter = std::make_shared < JobCounter >();
+        run(std::move(job), counter);
+        return counter;
+    }
+
+    void JobSystem::runAfter(std::shared_ptr < JobCounter > const& dependency, std::function < void() > job, std::shared_ptr < JobCounter > const& counter)
+    {
+        if (!dependency) {
+            run(std::move(job), counter);
+            return;
+        }
+
+        if (counter) counter->add();
+
+        dependency->then([this, job = std::move(job), counter](){
+            pool.submit([job, counter](){ Execute(job, counter.get()); });
+        });
+    }
+
+    void JobSystem::runOnMainThread(std::function < void() > job, std::shared_ptr < JobCounter > const& counter)
+    {
+        if (counter) counter->add();
+
+        std::scoped_lock < std::mutex > lck(mainJobsMutex);
+        mainJobs.push_back({ std::move(job), counter });
+    }
+
+    void JobSystem::wait(std::shared_ptr < JobCounter > const& counter)
+    {
+        if (!counter) return;
+
+        const bool onMainThread = isMainThread();
+
+        while (!counter->isDone())
+        {
+            if (onMainThread && runMainJob())
+                continue;
+
+            if (pool.runTask())
+                continue;
+
+            // Nothing to help with: the jobs left are running on workers. The timeout lets us help
+            // again with the jobs they submit meanwhile.
+
+            std::unique_lock < std::mutex > lck(counter->mutex);
+            counter->condition.wait_for(lck, std::chrono::milliseconds(1), [&counter](){ return counter->isDone(); });
+        }
+    }
+
+    void JobSystem::parallelFor(std::size_t begin, std::size_t end, std::size_t grain, std::function < void(std::size_t, std::size_t) > const& fn)
+    {
+        if (end <= begin) return;
+        const std::size_t size = end - begin;
+
+        if (!grain)
+            grain = std::max < std::size_t >(1, size / ((pool.getThreadsCount() + 1) * 4));
+
+        if (size <= grain) {
+            fn(begin, end);
+            return;
+        }
+
+        auto counter = std::make_shared < JobCounter >();
+
+        for (std::size_t first = begin + grain; first < end; first += grain)
+        {
+            const std::size_t last = std::min(first + grain, end);
+            run([&fn, first, last](){ fn(first, last); }, counter);
+        }
+
+        fn(begin, begin + grain);
+        wait(counter);
+    }
+
+    void JobSystem::update()
+    {
+        assert(isMainThread() && "JobSystem::update() must be called by the main thread.");
+
+        // Jobs queued by the jobs executed now wait for the next update, so a job requeuing itself
+        // doesn't keep the main thread here.
+
+        std::deque < MainJob > jobs;
+
+        {
+            std::scoped_lock < std::mutex > lck(mainJobsMutex);
+            jobs.swap(mainJobs);
+        }
+
+        for (auto const& mainJob : jobs)
+            Execute(mainJob.job, mainJob.counter.get());
+    }
+
+    bool JobSystem::isMainThread() const
+    {
+        return std::this_thread::get_id() == mainThread;
+    }
+
+    std::size_t JobSystem::getThreadsCount() const
+    {
+        return pool.getThreadsCount();
+    }
+
+    WorkerPool& JobSystem::getPool()
+    {
+        return pool;
+    }
+
+    void JobSystem::Execute(std::function < void() > const& job, JobCounter* counter)
+    {
+        try
+        {
+            job();
+        }
+
+        catch(std::exception const& e)
+        {
+            PostNotification(kNotificationLevelError, "Job failed with exception: %s", e.what());
+        }
+
+        catch(...)
+        {
+            PostNotification(kNotificationLevelError, "Job failed with exception: %s", "unknown");
+        }
+
+        if (counter) counter->done();
+    }
+
+    bool JobSystem::runMainJob()
+    {
+        MainJob mainJob;
+
+        {
+            std::scoped_lock < std::mutex > lck(mainJobsMutex);
+            if (mainJobs.empty()) return false;
+
+            mainJob = std::move(mainJobs.front());
+            mainJobs.pop_front();
+        }
+
+        Execute(mainJob.job, mainJob.counter.get());
+        return true;
+    }
+}
@@ -0,0 +1,162 @@
+/** \file Core/JobSystem.h
+**/
+
+#ifndef CLEAN_JOBSYSTEM_H
+#define CLEAN_JOBSYSTEM_H
+
+#include "Singleton.h"
+#include "WorkerPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Clean
+{
+    /** @brief Counts the jobs not done yet in a group of jobs.
+     *
+     * A counter is incremented for each job given to JobSystem with it, and decremented when the job
+     * is done. Jobs may depend on a counter with JobSystem::runAfter(): they start when it reaches zero.
+     *
+     * \ref then() registers a function called once the counter reaches zero. It is what a coroutine
+     * awaiting the counter or a fiber scheduler needs to resume without blocking a thread.
+     *
+    **/
+    class JobCounter
+    {
+        //! @brief Number of jobs not done.
+        std::atomic < std::size_t > count;
+
+        //! @brief Protects continuations and condition.
+        std::mutex mutex;
+
+        //! @brief Functions called when count reaches zero.
+        std::vector < std::function < void() > > continuations;
+
+        //! @brief Notified when count reaches zero.
+        std::condition_variable condition;
+
+        friend class JobSystem;
+
+    public:
+
+        /*! @brief Constructs a counter with no jobs. */
+        JobCounter();
+
+        /*! @brief Adds count jobs to the counter. */
+        void add(std::size_t count = 1);
+
+        /*! @brief Marks a job as done. When the counter reaches zero, continuations are called. */
+        void done();
+
+        /*! @brief Returns true if all jobs are done. */
+        bool isDone() const;
+
+        /*! @brief Returns the number of jobs not done. */
+        std::size_t getCount() const;
+
+        /*! @brief Calls fn when the counter reaches zero, or now if it is zero.
+         *  fn is called by the thread ending the last job and must be short. **/
+        void then(std::function < void() > fn);
+    };
+
+    /** @brief Runs jobs on a WorkerPool sized to the machine.
+     *
+     * The JobSystem is owned by Core and may be retrieved with JobSystem::Current(). Jobs are functions
+     * executed by the pool's workers, which steal jobs from each other when idle. A job may be given a
+     * JobCounter, to wait for a group of jobs or to start other jobs after them.
+     *
+     * Some jobs must run on the main thread, like driver calls on platforms where the context or the
+     * windows belong to it. \ref runOnMainThread() queues them until the main thread calls \ref update()
+     * (Driver::update() does it) or waits for a counter.
+     *
+     * \ref wait() never just blocks: the waiting thread executes other jobs until the counter reaches zero,
+     * so jobs may wait for the jobs they started.
+     *
+    **/
+    class JobSystem : public Singleton < JobSystem >
+    {
+        /** @brief A job queued for the main thread. */
+        struct MainJob
+        {
+            std::function < void() > job;
+            std::shared_ptr < JobCounter > counter;
+        };
+
+        //! @brief Workers executing the jobs.
+        WorkerPool pool;
+
+        //! @brief Thread which constructed the JobSystem.
+        const std::thread::id mainThread;
+
+        //! @brief Jobs waiting for the main thread.
+        std::deque < MainJob > mainJobs;
+
+        //! @brief Protects mainJobs.
+        std::mutex mainJobsMutex;
+
+    public:
+
+        /*! @brief Starts threadsCount workers, or one less than the number of hardware threads if zero.
+         *  The calling thread is considered the main thread. **/
+        explicit JobSystem(std::size_t threadsCount = 0);
+
+        /*! @brief Executes all jobs left and stops the workers. */
+        ~JobSystem();
+
+        JobSystem(JobSystem const&) = delete;
+        JobSystem& operator = (JobSystem const&) = delete;
+
+        /*! @brief Runs a job on a worker. */
+        void run(std::function < void() > job, std::shared_ptr < JobCounter > const& counter = nullptr);
+
+        /*! @brief Runs a job on a worker and returns a new counter for it. */
+        std::shared_ptr < JobCounter > async(std::function < void() > job);
+
+        /*! @brief Runs a job on a worker once dependency reaches zero. counter is incremented now. */
+        void runAfter(std::shared_ptr < JobCounter > const& dependency, std::function < void() > job, std::shared_ptr < JobCounter > const& counter = nullptr);
+
+        /*! @brief Queues a job executed by the main thread in update() or wait(). */
+        void runOnMainThread(std::function < void() > job, std::shared_ptr < JobCounter > const& counter = nullptr);
+
+        /*! @brief Waits until counter reaches zero, executing other jobs meanwhile. */
+        void wait(std::shared_ptr < JobCounter > const& counter);
+
+        /*! @brief Calls fn(first, last) on chunks of [begin, end) in parallel, and returns when all are done.
+         *
+         * \param grain Number of elements by chunk. If zero, the range is split in a few chunks by worker.
+         *
+         * The calling thread executes the first chunk itself.
+         *
+        **/
+        void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, std::function < void(std::size_t, std::size_t) > const& fn);
+
+        /*! @brief Executes the jobs queued for the main thread. Must be called by the main thread. */
+        void update();
+
+        /*! @brief Returns true if the calling thread is the main thread. */
+        bool isMainThread() const;
+
+        /*! @brief Returns the number of workers. */
+        std::size_t getThreadsCount() const;
+
+        /*! @brief Returns the pool of workers, to submit tasks without counters. */
+        WorkerPool& getPool();
+
+    private:
+
+        /*! @brief Executes job, reporting its exceptions, and marks it done in counter. */
+        static void Execute(std::function < void() > const& job, JobCounter* counter);
+
+        /*! @brief Executes one job queued for the main thread. Returns false if there was none. */
+        bool runMainJob();
+    };
+}
+
+#endif // CLEAN_JOBSYSTEM_H
@@ -4,155 +4,305 @@
 #ifndef CLEAN_MANAGER_H
 #define CLEAN_MANAGER_H
 
+#include "Hash.h"
+
+#include <cassert>
 #include <cstdint>
-#include <list>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
-namespace Clean 
+namespace Clean
 {
-    /** @brief Base class for Managers. */
-    template < class Managed > 
-    class Manager 
+    /** @brief Base class for Managers.
+     *
+     * Managers are read much more often than they are modified: drivers iterate their windows and
+     * queues every frame, loaders look for an already loaded file before loading it. Thus, objects are
+     * stored in an immutable snapshot: a dense vector of objects, a map from each object to its slot in
+     * the vector and hashed indexes. Readers load the current snapshot without locking and may keep it
+     * as long as they want. Each modification copies the snapshot, modifies the copy and swaps it in.
+     *
+     * Derived managers register their indexes with addIndex() in their constructor, and find objects
+     * with findIndexed() by a hash of their key. Keys must not change while an object is managed, or
+     * reindex() must be called after the change.
+     *
+    **/
+    template < class Managed >
+    class Manager
     {
-    protected:
+    public:
         
-        //! @brief List of objects managed. 
-        std::list < std::shared_ptr < Managed > > managedList;
+        //! @brief Objects managed, in the order they were added.
+        typedef std::vector < std::shared_ptr < Managed > > ManagedList;
         
-        //! @brief Protects managedList.
-        mutable std::mutex managedListMutex;
+        //! @brief Computes the hashed key of an object for an index.
+        typedef std::function < std::uint64_t(Managed const&) > IndexKey;
+    
+    private:
+        
+        /** @brief State of the manager at one time. Never modified once published. */
+        struct Snapshot
+        {
+            //! @brief Objects managed.
+            ManagedList objects;
+            
+            //! @brief Slot of each object in objects.
+            std::unordered_map < const Managed*, std::size_t > slots;
+            
+            //! @brief Slots of objects for each key, one map by index.
+            std::vector < std::unordered_multimap < std::uint64_t, std::size_t > > indexes;
+        };
+        
+        //! @brief Current snapshot. Never null.
+        std::shared_ptr < const Snapshot > snapshot;
+        
+        //! @brief Key function of each index.
+        std::vector < IndexKey > indexKeys;
+    
+    protected:
         
+        //! @brief Serializes modifications of snapshot and indexKeys.
+        mutable std::mutex managedListMutex;
+    
     public:
         
         /*! @brief Default constructor. */
-        Manager() = default;
+        Manager() : snapshot(std::make_shared < const Snapshot >())
+        {
+        
+        }
         
         /*! @brief Default destructor. */
         virtual ~Manager() = default;
         
-        /*! @brief Adds a managed object. */
+        /*! @brief Adds a managed object. An object already managed is not added twice. */
         virtual void add(std::shared_ptr < Managed > const& rhs)
         {
             std::lock_guard < std::mutex > lck(managedListMutex);
-            managedList.push_back(rhs);
+            auto copy = std::make_shared < Snapshot >(*std::atomic_load(&snapshot));
+            
+            if (insert(*copy, rhs))
+                publish(copy);
         }
         
         /*! @brief Adds a managed object and asserts it has not already been added. */
         virtual void addOnce(std::shared_ptr < Managed > const& rhs)
         {
-            std::lock_guard < std::mutex > lck(managedListMutex);
-            auto check = std::find(managedList.begin(), managedList.end(), rhs);
-            
-            if (check == managedList.end()) 
-                managedList.push_back(rhs);
+            add(rhs);
         }
         
-        /*! @brief Performs addOnce on multiple objects. */
-        virtual void batchAddOnce(std::vector < std::shared_ptr < Managed > > const& rhsList) 
+        /*! @brief Performs addOnce on multiple objects, publishing them all at once. */
+        virtual void batchAddOnce(std::vector < std::shared_ptr < Managed > > const& rhsList)
         {
             std::lock_guard < std::mutex > lck(managedListMutex);
+            auto copy = std::make_shared < Snapshot >(*std::atomic_load(&snapshot));
+            bool modified = false;
             
-            for (auto& rhs : rhsList)
-            {
-                auto check = std::find(managedList.begin(), managedList.end(), rhs);
+            for (auto const& rhs : rhsList)
+                modified |= insert(*copy, rhs);
             
-                if (check == managedList.end()) 
-                    managedList.push_back(rhs);
-            }
+            if (modified)
+                publish(copy);
         }
         
         /*! @brief Removes a managed object. */
         virtual void erase(std::shared_ptr < Managed > const& rhs)
         {
             std::lock_guard < std::mutex > lck(managedListMutex);
-            auto check = std::find(managedList.begin(), managedList.end(), rhs);
+            auto current = std::atomic_load(&snapshot);
+            
+            auto check = current->slots.find(rhs.get());
+            if (check == current->slots.end()) return;
+            
+            auto copy = std::make_shared < Snapshot >();
+            copy->objects.reserve(current->objects.size() - 1);
             
-            if (check != managedList.end()) 
-                managedList.erase(check);
+            for (std::size_t i = 0; i < current->objects.size(); ++i)
+            {
+                if (i != check->second)
+                    copy->objects.push_back(current->objects[i]);
+            }
+            
+            rebuild(*copy);
+            publish(copy);
         }
         
         /*! @brief Returns true if empty. */
-        virtual bool empty() const 
+        virtual bool empty() const
         {
-            std::lock_guard < std::mutex > lck(managedListMutex);
-            return managedList.empty();
+            return std::atomic_load(&snapshot)->objects.empty();
         }
         
         /*! @brief Returns number of objects. */
-        virtual std::size_t count() const 
+        virtual std::size_t count() const
         {
-            std::lock_guard < std::mutex > lck(managedListMutex);
-            return managedList.size();
+            return std::atomic_load(&snapshot)->objects.size();
         }
         
-        /*! @brief Returns a begin iterator. */
-        auto begin() -> decltype(managedList.begin()) { return managedList.begin(); }
-        /*! @brief Returns a begin iterator. */
-        auto begin() const -> decltype(managedList.begin()) { return managedList.begin(); }
-        /*! @brief Returns the end iterator. */
-        auto end() -> decltype(managedList.end()) { return managedList.end(); }
-        /*! @brief Returns the end iterator. */
-        auto end() const -> decltype(managedList.end()) { return managedList.end(); }
+        /*! @brief Returns the objects currently managed. The list is never modified and stays valid
+         *  after the manager is. **/
+        std::shared_ptr < const ManagedList > getManaged() const
+        {
+            auto current = std::atomic_load(&snapshot);
+            return std::shared_ptr < const ManagedList >(current, &current->objects);
+        }
         
-        /*! @brief Convenient function to call a callback for each managed object and locking the 
-         * managed list. */
+        /*! @brief Calls a callback for each object of the current snapshot.
+         *
+         * No lock is held while the callback runs: it may modify this manager, the modification is
+         * only visible to the next calls.
+         *
+        **/
         template < typename Callable >
-        void forEach(Callable cbk) 
+        void forEach(Callable cbk) const
         {
-            std::lock_guard < std::mutex > lck(managedListMutex);
+            auto current = std::atomic_load(&snapshot);
             
-            for (auto& managed : managedList)
+            for (auto const& managed : current->objects)
             {
                 cbk(managed);
             }
         }
         
-        /*! @brief Convenient function to call a callback for each managed object and locking the
-         * managed list. */
-        template < typename Callable >
-        void forEach(Callable cbk) const
+        /*! @brief Same as forEach(). Kept for code written when forEach() held the lock. */
+        template < typename Callback > void forEachCpy(Callback cbk) const
+        {
+            forEach(cbk);
+        }
+        
+        /*! @brief Returns true if the given managed object is already in this manager. */
+        virtual bool exists(std::shared_ptr < Managed > const& rhs) const
+        {
+            auto current = std::atomic_load(&snapshot);
+            return current->slots.count(rhs.get()) != 0;
+        }
+        
+        /*! @brief Clears the current list of objects. */
+        virtual void reset()
+        {
+            std::lock_guard < std::mutex > lck(managedListMutex);
+            auto copy = std::make_shared < Snapshot >();
+            copy->indexes.resize(indexKeys.size());
+            publish(copy);
+        }
+        
+        /*! @brief Recomputes the keys of all objects, after the key of one of them changed. */
+        void reindex()
+        {
+            std::lock_guard < std::mutex > lck(managedListMutex);
+            auto copy = std::make_shared < Snapshot >();
+            copy->objects = std::atomic_load(&snapshot)->objects;
+            
+            rebuild(*copy);
+            publish(copy);
+        }
+    
+    protected:
+        
+        /*! @brief Registers a new index and returns its identifier for findIndexed(). */
+        std::size_t addIndex(IndexKey key)
         {
             std::lock_guard < std::mutex > lck(managedListMutex);
+            indexKeys.push_back(std::move(key));
             
-            for (auto const& managed : managedList)
+            auto copy = std::make_shared < Snapshot >();
+            copy->objects = std::atomic_load(&snapshot)->objects;
+            
+            rebuild(*copy);
+            publish(copy);
+            
+            return indexKeys.size() - 1;
+        }
+        
+        /*! @brief Returns the first object whose key in index is key and for which pred returns true.
+         *  pred resolves collisions of hashed keys. **/
+        template < typename Predicate >
+        std::shared_ptr < Managed > findIndexed(std::size_t index, std::uint64_t key, Predicate pred) const
+        {
+            auto current = std::atomic_load(&snapshot);
+            assert(index < current->indexes.size() && "Invalid index given.");
+            
+            auto range = current->indexes[index].equal_range(key);
+            std::shared_ptr < Managed > result;
+            std::size_t slot = current->objects.size();
+            
+            // Multimap's order of equal keys is unspecified: keep the object added first.
+            for (auto it = range.first; it != range.second; ++it)
             {
-                cbk(managed);
+                if (it->second < slot && pred(*current->objects[it->second]))
+                {
+                    slot = it->second;
+                    result = current->objects[slot];
+                }
             }
+            
+            return result;
         }
         
-        /*! @brief Calls a callback on each managed objects in a non-blocking way.
-         *
-         * When this function is called, it copies the current list of managed objects and then call
-         * the given callback on each object of the copied list. Mutex is unlocked before calling the
-         * callback, thus liberating other objects to using this Manager. 
-         *
-        **/
-        template < typename Callback > void forEachCpy(Callback cbk)
+        /*! @brief Returns the first object for which pred returns true. Used for keys not indexed. */
+        template < typename Predicate >
+        std::shared_ptr < Managed > findIf(Predicate pred) const
         {
-            managedListMutex.lock();
-            auto listCopy = managedList;
-            managedListMutex.unlock();
+            auto current = std::atomic_load(&snapshot);
             
-            for (auto& managed : listCopy)
+            for (auto const& managed : current->objects)
             {
-                cbk(managed);
+                if (pred(*managed))
+                    return managed;
             }
+            
+            return nullptr;
         }
         
-        /*! @brief Returns true if the given managed object is already in this manager. */
-        virtual bool exists(std::shared_ptr < Managed > const& rhs) const 
+        /*! @brief Hashes a string key. */
+        static std::uint64_t HashKey(std::string const& value)
         {
-            std::lock_guard < std::mutex > lck(managedListMutex);
-            return std::find(managedList.begin(), managedList.end(), rhs) != managedList.end();
+            return Hash64(value.data(), value.size());
         }
+    
+    private:
         
-        /*! @brief Clears the current list of objects. */
-        virtual void reset()
+        /*! @brief Appends rhs to snapshot. Returns false if it is null or already there. */
+        bool insert(Snapshot& target, std::shared_ptr < Managed > const& rhs) const
         {
-            std::lock_guard < std::mutex > lck(managedListMutex);
-            managedList.clear();
+            if (!rhs || target.slots.count(rhs.get()))
+                return false;
+            
+            const std::size_t slot = target.objects.size();
+            target.objects.push_back(rhs);
+            target.slots.emplace(rhs.get(), slot);
+            
+            target.indexes.resize(indexKeys.size());
+            
+            for (std::size_t i = 0; i < indexKeys.size(); ++i)
+                target.indexes[i].emplace(indexKeys[i](*rhs), slot);
+            
+            return true;
+        }
+        
+        /*! @brief Recomputes slots and indexes of target from its objects. */
+        void rebuild(Snapshot& target) const
+        {
+            ManagedList objects;
+            objects.swap(target.objects);
+            
+            target.slots.clear();
+            target.indexes.assign(indexKeys.size(), {});
+            
+            target.objects.reserve(objects.size());
+            target.slots.reserve(objects.size());
+            
+            for (auto const& managed : objects)
+                insert(target, managed);
+        }
+        
+        /*! @brief Swaps target in as the current snapshot. */
+        void publish(std::shared_ptr < Snapshot > const& target)
+        {
+            std::atomic_store(&snapshot, std::shared_ptr < const Snapshot >(target));
         }
     };
 }
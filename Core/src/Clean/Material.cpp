@@ -24,6 +24,9 @@ namespace Clean
         emissiveColor = AllocateShared < EffectParameter >(kEffectMaterialEmissiveVec4, ShaderValue(), kShaderParamVec4);
         assert(emissiveColor);
         
+        diffuseUVTransform = AllocateShared < EffectParameter >(kEffectMaterialDiffuseUVVec4, ShaderValue{ .vec4 = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f) }, kShaderParamVec4);
+        assert(diffuseUVTransform);
+        
         diffuseTexture = AllocateShared < TexturedParameter >(kEffectMaterialDiffuseTexture, ShaderValue(), kShaderParamI32);
         ambientTexture = AllocateShared < TexturedParameter >(kEffectMaterialAmbientTexture, ShaderValue(), kShaderParamI32);
         specularTexture = AllocateShared < TexturedParameter >(kEffectMaterialSpecularTexture, ShaderValue(), kShaderParamI32);
@@ -47,6 +50,7 @@ namespace Clean
         SharedParameter param = std::atomic_load(&diffuseColor);
         std::lock_guard < std::mutex > lck(param->mutex);
         param->value.vec4 = color;
+        param->version = EffectParameterNextVersion();
     }
     
     glm::vec4 Material::getSpecularColor() const 
@@ -61,6 +65,7 @@ namespace Clean
         SharedParameter param = std::atomic_load(&specularColor);
         std::lock_guard < std::mutex > lck(param->mutex);
         param->value.vec4 = color;
+        param->version = EffectParameterNextVersion();
     }
     
     glm::vec4 Material::getAmbientColor() const 
@@ -75,6 +80,7 @@ namespace Clean
         SharedParameter param = std::atomic_load(&ambientColor);
         std::lock_guard < std::mutex > lck(param->mutex);
         param->value.vec4 = color;
+        param->version = EffectParameterNextVersion();
     }
     
     glm::vec4 Material::getEmissiveColor() const
@@ -89,6 +95,22 @@ namespace Clean
         SharedParameter param = std::atomic_load(&emissiveColor);
         std::lock_guard < std::mutex > lck(param->mutex);
         param->value.vec4 = color;
+        param->version = EffectParameterNextVersion();
+    }
+    
+    glm::vec4 Material::getDiffuseUVTransform() const
+    {
+        SharedParameter param = std::atomic_load(&diffuseUVTransform);
+        std::lock_guard < std::mutex > lck(param->mutex);
+        return param->value.vec4;
+    }
+    
+    void Material::setDiffuseUVTransform(glm::vec4 const& transform)
+    {
+        SharedParameter param = std::atomic_load(&diffuseUVTransform);
+        std::lock_guard < std::mutex > lck(param->mutex);
+        param->value.vec4 = transform;
+        param->version = EffectParameterNextVersion();
     }
     
     Material::SharedParameters Material::findAllParameters() const 
@@ -98,6 +120,7 @@ namespace Clean
         result.push_back(std::atomic_load(&diffuseColor));
         result.push_back(std::atomic_load(&specularColor));
         result.push_back(std::atomic_load(&emissiveColor));
+        result.push_back(std::atomic_load(&diffuseUVTransform));
         return result;
     }
     
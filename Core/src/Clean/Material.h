@@ -28,6 +28,10 @@ namespace Clean
         //! @brief Emissive color.
         SharedParameter emissiveColor;
         
+        //! @brief Transform applied to diffuse texture coordinates: uv * xy + zw. Identity unless the
+        //! diffuse texture is a region of a TextureAtlas page.
+        SharedParameter diffuseUVTransform;
+        
         //! @brief Diffuse texture.
         SharedTexParam diffuseTexture;
         
@@ -75,6 +79,12 @@ namespace Clean
         /*! @brief Sets the emissive color. */
         void setEmissiveColor(glm::vec4 const& color);
         
+        /*! @brief Returns the diffuse texture coordinates transform (scale in xy, offset in zw). */
+        glm::vec4 getDiffuseUVTransform() const;
+        
+        /*! @brief Sets the diffuse texture coordinates transform (scale in xy, offset in zw). */
+        void setDiffuseUVTransform(glm::vec4 const& transform);
+        
         /*! @brief Returns all EffectParameters. */
         SharedParameters findAllParameters() const;
         
@@ -8,6 +8,7 @@
 #include "Platform.h"
 #include "Core.h"
 #include "NotificationCenter.h"
+#include "Profiler.h"
 
 namespace Clean 
 {
@@ -20,8 +21,15 @@ namespace Clean
         return *manager;
     }
     
+    MaterialManager::MaterialManager()
+    {
+        nameIndex = addIndex([](Material const& material){ return HashKey(material.getName()); });
+    }
+    
     std::vector < std::shared_ptr < Material > > MaterialManager::load(std::string const& filepath)
     {
+        ProfileScope("MaterialManager::load");
+        
         std::string const extension = Platform::PathGetExtension(filepath);
         assert(!extension.empty() && "File must have an extension to be loaded.");
         
@@ -56,8 +64,6 @@ namespace Clean
     
     std::shared_ptr < Material > MaterialManager::findByName(std::string const& name) const
     {
-        std::lock_guard < std::mutex > lck(managedListMutex);
-        auto check = std::find_if(managedList.begin(), managedList.end(), [name](auto material) { return material->getName() == name; });
-        return (check == managedList.end()) ? nullptr : *check;
+        return findIndexed(nameIndex, HashKey(name), [&name](Material const& material){ return material.getName() == name; });
     }
 }
@@ -20,6 +20,9 @@ namespace Clean
         //! @brief Makes our Core class a friend. 
         friend class Core;
         
+        //! @brief Index of materials by name.
+        std::size_t nameIndex;
+        
     public:
         
         /*! @brief Returns the current manager or throw an exception if not found. */
@@ -27,8 +30,8 @@ namespace Clean
         
     public:
         
-        /*! @brief Default constructor. */
-        MaterialManager() = default;
+        /*! @brief Constructs the manager and its index by name. */
+        MaterialManager();
         
         /*! @brief Loads one or multiple materials from a file and returns them. */
         std::vector < std::shared_ptr < Material > > load(std::string const& filepath);
@@ -6,6 +6,14 @@
 #include "RenderCommand.h"
 #include "NotificationCenter.h"
 #include "Driver.h"
+#include "Profiler.h"
+#include "MeshSimplifier.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
 
 namespace Clean
 {
@@ -13,13 +21,14 @@ namespace Clean
     {
         std::shared_ptr < Buffer > buffer;
         std::uint8_t type;
+        SlotHandle slot;
     };
     
     typedef MeshTransactionAddBuffer MeshTransactionUpdateBuffer;
     
     struct MeshTransactionBatchAddBuffers 
     {
-        std::map < std::shared_ptr < Buffer >, std::uint8_t > buffers;
+        std::vector < MeshTransactionAddBuffer > buffers;
     };
     
     struct MeshTransactionBatchUpdateBuffers 
@@ -53,14 +62,17 @@ namespace Clean
         
     }
     
-    std::vector < VertexDescriptor > Mesh::findAssociatedDescriptors(Driver const& driver) const
+    std::vector < VertexDescriptor > Mesh::findAssociatedDescriptors(Driver const& driver, std::size_t level) const
     {
-        const std::uintptr_t driverOffset = reinterpret_cast < std::uintptr_t >(&driver);
         std::scoped_lock < std::mutex, std::mutex > lck(submeshesMutex, driverCachesMutex);
-        auto const& cacheIt = driverCaches.find(driverOffset);
+        DriverCache* cache = findDriverCache(driver);
         std::vector < VertexDescriptor > result;
         
-        for (auto& submesh : submeshes)
+        level = std::min(level, lods.size());
+        auto const& levelSubmeshes = level ? lods[level - 1].submeshes : submeshes;
+        result.reserve(levelSubmeshes.size());
+        
+        for (auto& submesh : levelSubmeshes)
         {
             assert(submesh.buffer && "No GenBuffer associated to SubMesh.");
             auto const& descriptor = submesh.descriptor;
@@ -71,16 +83,14 @@ namespace Clean
             finalDescriptor.localSubmesh.elements = submesh.elements;
             finalDescriptor.indexInfos = IndexedInfos(submesh.indexOffset, submesh.indexCount, submesh.indexBuffer);
             
-            if (cacheIt != driverCaches.end()) {
-                auto hardBufferIt = cacheIt->second.buffers.find(submesh.buffer->getHandle());
-                if (hardBufferIt != cacheIt->second.buffers.end()) {
-                    finalDescriptor.localSubmesh.buffer = hardBufferIt->second;
+            if (cache) {
+                if (auto hardBuffer = cache->buffers.find(submesh.bufferSlot)) {
+                    finalDescriptor.localSubmesh.buffer = *hardBuffer;
                 }
                 
                 if (submesh.indexBuffer) {
-                    hardBufferIt = cacheIt->second.buffers.find(submesh.indexBuffer->getHandle());
-                    if (hardBufferIt != cacheIt->second.buffers.end()) {
-                        finalDescriptor.indexInfos.buffer = hardBufferIt->second;
+                    if (auto hardBuffer = cache->buffers.find(submesh.indexBufferSlot)) {
+                        finalDescriptor.indexInfos.buffer = *hardBuffer;
                     }
                 }
             }
@@ -112,14 +122,20 @@ namespace Clean
         return result;
     }
     
-    void Mesh::populateRenderCommand(Driver const& driver, RenderCommand& command)
+    void Mesh::populateRenderCommand(Driver const& driver, RenderCommand& command, std::size_t level)
     {
         // When we must submit a render command, first try to see if we have pregenerated ShaderAttributesMap
         // for the pair driver/shader. 
         
         RenderPipeline const& shader = *(command.pipeline);
         shader.bind(driver);
-        auto attribs = findShaderAttributesMap(driver, shader);
+        
+        {
+            std::scoped_lock < std::mutex > lck(submeshesMutex);
+            level = std::min(level, lods.size());
+        }
+        
+        auto attribs = findShaderAttributesMap(driver, shader, level);
         
         if (!attribs.empty())
         {
@@ -130,68 +146,81 @@ namespace Clean
         
         // Tries to generate ShaderAttributesMap for each submesh. 
         
-        auto descriptors = findAssociatedDescriptors(driver);
+        auto descriptors = findAssociatedDescriptors(driver, level);
         attribs = shader.map(descriptors);
         
         if (attribs.empty())
         {
             // ShaderMapper couldn't map our VertexDescriptors to ShaderAttribute. This is an error
-            // and we must log it. However, this may be sent too much times, so do this only once.
-            static std::once_flag flag;
-            std::call_once(flag, [this](){
-                Notification errNotif = BuildNotification(kNotificationLevelError,
-                    "Mesh #%i: ShaderMapper::map() couldn't generate ShaderAttributesMap.",
-                    getHandle());
-                NotificationCenter::GetDefault()->send(errNotif);
-            });
+            // and we must log it. However, this is sent for each draw: the NotificationCenter's throttle
+            // coalesces the repeats. 
+            PostNotification(kNotificationLevelError,
+                "Mesh #%i: ShaderMapper::map() couldn't generate ShaderAttributesMap.",
+                getHandle());
             
             return;
         }
         
         // Stores our new ShaderCache. 
         ShaderCache newCache = { attribs };
-        shaderCacheStore(driver, shader, newCache);
+        shaderCacheStore(driver, shader, newCache, level);
         
         // Populate our RenderSubCommand with those infos. 
         command.batchSub(drawingMethod.load(), attribs);
     }
     
-    std::vector < ShaderAttributesMap > Mesh::findShaderAttributesMap(Driver const& driver, RenderPipeline const& shader)
+    void Mesh::populateRenderCommand(Driver const& driver, RenderCommand& command, MeshLodState const& state)
+    {
+        if (state.fade >= 1.0f || state.previous == state.level)
+        {
+            populateRenderCommand(driver, command, state.level);
+            return;
+        }
+        
+        // Both levels are drawn: each sub command tells the shader which part of the dither pattern it keeps.
+        
+        auto emit = [&](std::size_t level, float fade){
+            const std::size_t first = command.subCommands.size();
+            populateRenderCommand(driver, command, level);
+            
+            ShaderValue value;
+            value.fl = fade;
+            
+            for (std::size_t i = first; i < command.subCommands.size(); ++i)
+                command.subCommands[i].parameters.add(kEffectLodFadeFloat, value, kShaderParamFloat);
+        };
+        
+        emit(state.level, state.fade);
+        emit(state.previous, state.fade - 1.0f);
+    }
+    
+    std::vector < ShaderAttributesMap > Mesh::findShaderAttributesMap(Driver const& driver, RenderPipeline const& shader, std::size_t level)
     {
-        const std::uintptr_t driverOffset = reinterpret_cast < std::uintptr_t >(&driver);
-        const std::uintptr_t shaderOffset = reinterpret_cast < std::uintptr_t >(&shader);
         std::vector < ShaderAttributesMap > result;
         
         std::scoped_lock < std::mutex > lck(driverCachesMutex);
-        auto driverIt = driverCaches.find(driverOffset);
-        if (driverIt == driverCaches.end()) return result;
+        DriverCache* cache = findDriverCache(driver);
+        if (!cache) return result;
         
-        auto shaderIt = driverIt->second.shaderCaches.find(shaderOffset);
-        if (shaderIt == driverIt->second.shaderCaches.end()) return result;
+        auto shaderIt = cache->shaderCaches.find(MakeShaderKey(shader, level));
+        if (shaderIt == cache->shaderCaches.end()) return result;
         
         return shaderIt->second.shaderAttribs;
     }
     
-    void Mesh::shaderCacheStore(Driver const& driver, RenderPipeline const& shader, ShaderCache& cache)
+    void Mesh::shaderCacheStore(Driver const& driver, RenderPipeline const& shader, ShaderCache& cache, std::size_t level)
     {
-        const std::uintptr_t driverOffset = reinterpret_cast < std::uintptr_t >(&driver);
-        const std::uintptr_t shaderOffset = reinterpret_cast < std::uintptr_t >(&shader);
-        std::vector < ShaderAttributesMap > result;
-        
         std::scoped_lock < std::mutex > lck(driverCachesMutex);
-        auto driverIt = driverCaches.find(driverOffset);
-        if (driverIt != driverCaches.end()) driverIt->second.shaderCaches[shaderOffset] = cache;
+        DriverCache* driverCache = findDriverCache(driver);
+        if (driverCache) driverCache->shaderCaches[MakeShaderKey(shader, level)] = cache;
     }
     
     void Mesh::associate(Driver& driver)
     {
-        const std::uintptr_t driverOffset = reinterpret_cast < std::uintptr_t >(&driver);
-        
         {
             std::lock_guard < std::mutex > lck(driverCachesMutex);
-            auto driverCacheIt = driverCaches.find(driverOffset);
         
-            if (driverCacheIt != driverCaches.end()) {
+            if (findDriverCache(driver)) {
                 Notification warnNotif = BuildNotification(kNotificationLevelWarning,
                     "Driver %s was already associated to Mesh #%i.", 
                     driver.getName().data(), getHandle());
@@ -201,70 +230,58 @@ namespace Clean
         }
         
         DriverCache cache;
+        cache.driver = &driver;
         
         // For each buffer, do the same as kMeshTransactionAddBuffer.
         
         {
             std::lock_guard < std::mutex > lck(buffersMutex);
             
-            for (auto const& buffer : vertexBuffers)
+            for (std::size_t i = 0; i < buffers.size(); ++i)
             {
-                auto hardBuffer = driver.makeBuffer(buffer.second->getType(), buffer.second);
+                auto const& buffer = *(buffers.begin() + i);
+                auto hardBuffer = driver.makeBuffer(buffer.type, buffer.buffer);
                 if (!hardBuffer) {
                     Notification softNotif = BuildNotification(kNotificationLevelWarning, 
                         "Driver %s can't make Hardware Buffer of size %i.", 
-                        driver.getName().data(), buffer.second->getSize());
+                        driver.getName().data(), buffer.buffer->getSize());
                     NotificationCenter::GetDefault()->send(softNotif);
-                    hardBuffer = buffer.second;
+                    hardBuffer = buffer.buffer;
                 }
                 
-                // hardBuffer->retain();
-                cache.buffers.insert(std::make_pair(buffer.first, BufferAutorelease(hardBuffer)));
-            }
-            
-            for (auto const& buffer : indexBuffers)
-            {
-                auto hardBuffer = driver.makeBuffer(buffer.second->getType(), buffer.second);
-                if (!hardBuffer) {
-                    Notification softNotif = BuildNotification(kNotificationLevelWarning, 
-                        "Driver %s can't make Hardware Buffer of size %i.", 
-                        driver.getName().data(), buffer.second->getSize());
-                    NotificationCenter::GetDefault()->send(softNotif);
-                    hardBuffer = buffer.second;
-                }
-                
-                // hardBuffer->retain();
-                cache.buffers.insert(std::make_pair(buffer.first, BufferAutorelease(hardBuffer)));
+                cache.buffers.insert(buffers.handleAt(i), BufferAutorelease(hardBuffer));
             }
         }
         
         {
             std::lock_guard < std::mutex > lck(driverCachesMutex);
-            driverCaches.insert(std::make_pair(driverOffset, std::move(cache)));
+            driverCaches.push_back(std::move(cache));
         }
     }
     
     void Mesh::update(Driver& driver, std::chrono::milliseconds maxTime)
     { 
+        ProfileScope("Mesh::update");
+        
         using namespace std::chrono; 
         auto tnow = high_resolution_clock::now();
         milliseconds elapsed = duration_cast < milliseconds >(high_resolution_clock::now() - tnow);
         
         std::scoped_lock < std::mutex > lck0(driverCachesMutex);
-        const std::uintptr_t driverOffset = reinterpret_cast < std::uintptr_t >(&driver);
-        auto cacheIt = driverCaches.find(driverOffset);
+        DriverCache* driverCache = findDriverCache(driver);
         
-        if (cacheIt == driverCaches.end())
+        if (!driverCache)
         {
             Notification errorNotif = BuildNotificationAll(kNotificationLevelWarning, __FUNCTION__, __FILE__,
                 "Mesh::update() called from a Driver that is not associated to this mesh.");
             NotificationCenter::GetDefault()->send(errorNotif);
+            return;
         }
         
-        auto& driverQueue = cacheIt->second.transactions;
-        auto& cache = cacheIt->second;
+        auto& driverQueue = driverCache->transactions;
+        auto& cache = *driverCache;
         
-        while (!driverQueue.empty() || elapsed < maxTime)
+        while (!driverQueue.empty() && elapsed < maxTime)
         {
             Transaction tr = std::move(driverQueue.front());
             driverQueue.pop();
@@ -287,7 +304,10 @@ namespace Clean
                 MeshTransactionAddBuffer* data = static_cast < MeshTransactionAddBuffer* >(tr.data());
                 assert(data && "Null MeshTransactionAddBuffer.");
                 assert(data->buffer && "Null GenBuffer for MeshTransactionAddBuffer.");
-                    
+                
+                if (cache.buffers.contains(data->slot))
+                    continue;
+                
                 auto hardBuffer = driver.makeBuffer(data->type, data->buffer);
                 if (!hardBuffer) {
                     Notification softNotif = BuildNotification(kNotificationLevelWarning, 
@@ -297,8 +317,7 @@ namespace Clean
                     hardBuffer = data->buffer;
                 }
                 
-                hardBuffer->retain();
-                cache.buffers.insert(std::make_pair(data->buffer->getHandle(), hardBuffer));
+                cache.buffers.insert(data->slot, BufferAutorelease(hardBuffer));
             }
             
             // Updating a buffer is only updating with new data pre-existing buffer. 
@@ -309,8 +328,8 @@ namespace Clean
                 assert(data && "Null MeshTransactionUpdateBuffer.");
                 assert(data->buffer && "Null GenBuffer for MeshTransactionUpdateBuffer.");
                 
-                std::scoped_lock < std::mutex > lck(driverCachesMutex);
-                auto hardBuffer = cache.buffers.find(data->buffer->getHandle())->second;
+                SlotHandle slot = data->slot.valid() ? data->slot : findBufferSlot(*data->buffer);
+                auto hardBuffer = cache.buffers.find(slot);
                 
                 if (!hardBuffer) {
                     Notification errNotif = BuildNotification(kNotificationLevelError,
@@ -319,8 +338,8 @@ namespace Clean
                     NotificationCenter::GetDefault()->send(errNotif);
                 }
                 
-                else if (hardBuffer != data->buffer) {
-                    hardBuffer->update(data->buffer->getData(), data->buffer->getSize(), data->buffer->getUsage());
+                else if (*hardBuffer != data->buffer) {
+                    (*hardBuffer)->update(data->buffer->getData(), data->buffer->getSize(), data->buffer->getUsage());
                 }
             }
             
@@ -331,29 +350,26 @@ namespace Clean
                 MeshTransactionBatchAddBuffers* data = static_cast < MeshTransactionBatchAddBuffers* >(tr.data());
                 assert(data && "Null MeshTransactionBatchAddBuffers.");
                 
-                std::scoped_lock < std::mutex > lck(driverCachesMutex);
-                
-                for (auto const& pair : data->buffers)
+                for (auto const& added : data->buffers)
                 {
-                    assert(pair.first && "Null Buffer given.");
-                    auto hardBufferIt = cache.buffers.find(pair.first->getHandle());
+                    assert(added.buffer && "Null Buffer given.");
                     
-                    if (hardBufferIt == cache.buffers.end()) {
-                        auto hardBuffer = driver.makeBuffer(pair.second, pair.first);
-                        if (!hardBuffer) {
-                            Notification softNotif = BuildNotification(kNotificationLevelWarning, 
-                                "Driver %s can't make Hardware Buffer of size %i.", 
-                                driver.getName().data(), pair.first->getSize());
-                            NotificationCenter::GetDefault()->send(softNotif);
-                            hardBuffer = pair.first;
-                        }
-                        
-                        hardBuffer->retain();
-                        cache.buffers.insert(std::make_pair(pair.first->getHandle(), hardBuffer));
+                    // If the slot already has a hardware buffer, this means we already created this buffer. So
+                    // we do nothing. CQFD
+                    
+                    if (cache.buffers.contains(added.slot))
+                        continue;
+                    
+                    auto hardBuffer = driver.makeBuffer(added.type, added.buffer);
+                    if (!hardBuffer) {
+                        Notification softNotif = BuildNotification(kNotificationLevelWarning, 
+                            "Driver %s can't make Hardware Buffer of size %i.", 
+                            driver.getName().data(), added.buffer->getSize());
+                        NotificationCenter::GetDefault()->send(softNotif);
+                        hardBuffer = added.buffer;
                     }
                     
-                    // If hardBufferIt is not end(), this means we already created this buffer. So
-                    // we do nothing. CQFD
+                    cache.buffers.insert(added.slot, BufferAutorelease(hardBuffer));
                 }
             }
             
@@ -362,24 +378,20 @@ namespace Clean
                 MeshTransactionBatchUpdateBuffers* data = static_cast < MeshTransactionBatchUpdateBuffers* >(tr.data());
                 assert(data && "Null MeshTransactionBatchUpdateBuffers.");
                 
-                std::scoped_lock < std::mutex > lck(driverCachesMutex);
-                
                 for (auto const& buffer : data->buffers)
                 {
                     assert(buffer && "Null Buffer given for update of Mesh.");
-                    std::uint8_t const handle = buffer->getHandle();
-                    
-                    auto hardBuffer = cache.buffers.find(handle)->second;
+                    auto hardBuffer = cache.buffers.find(findBufferSlot(*buffer));
                 
                     if (!hardBuffer) {
                         Notification errNotif = BuildNotification(kNotificationLevelError,
                             "Buffer handle %i can't be found in Mesh's cache.",
-                            handle);
+                            buffer->getHandle());
                         NotificationCenter::GetDefault()->send(errNotif);
                     }
                 
-                    else if (hardBuffer != buffer) {
-                        hardBuffer->update(buffer->getData(), buffer->getSize(), buffer->getUsage());
+                    else if (*hardBuffer != buffer) {
+                        (*hardBuffer)->update(buffer->getData(), buffer->getSize(), buffer->getUsage());
                     }
                 }
             }
@@ -394,34 +406,38 @@ namespace Clean
     
     void Mesh::addSubMesh(SubMesh&& submesh)
     {
-        std::scoped_lock < std::mutex > lck(submeshesMutex);
-        submeshes.push_back(std::move(submesh));
+        {
+            if (submesh.bounds.empty()) {
+                submesh.bounds = ComputeBounds(submesh);
+                submesh.sphere = BoundingSphere::FromBox(submesh.bounds);
+            }
+            
+            std::scoped_lock < std::mutex, std::mutex > lck(submeshesMutex, buffersMutex);
+            resolveSlots(submesh);
+            bounds.extend(submesh.bounds);
+            submeshes.push_back(std::move(submesh));
+        }
+        
         submitTransaction(kMeshTransactionAddSubMesh);
     }
     
-    void Mesh::addBuffers(std::vector < std::shared_ptr < GenBuffer > > const& buffers)
+    void Mesh::addBuffers(std::vector < std::shared_ptr < GenBuffer > > const& newBuffers)
     {
         MeshTransactionBatchAddBuffers tr;
         
         {
-            std::lock_guard < std::mutex > lck(buffersMutex);
+            std::scoped_lock < std::mutex, std::mutex > lck(submeshesMutex, buffersMutex);
         
-            for (auto& buffer : buffers)
+            for (auto& buffer : newBuffers)
             {
                 if (buffer)
                 {
-                    if (buffer->getType() == kBufferTypeVertex)
-                    {
-                        auto buf = std::static_pointer_cast<Buffer>(buffer);
-                        vertexBuffers.insert(std::make_pair(buffer->getHandle(), buffer));
-                        tr.buffers.insert(std::make_pair(buf, kBufferTypeVertex));
-                    }
-                
-                    else if(buffer->getType() == kBufferTypeIndex)
+                    const std::uint8_t type = buffer->getType();
+                    
+                    if (type == kBufferTypeVertex || type == kBufferTypeIndex)
                     {
-                        auto buf = std::static_pointer_cast<Buffer>(buffer);
-                        indexBuffers.insert(std::make_pair(buffer->getHandle(), buffer));
-                        tr.buffers.insert(std::make_pair(buf, kBufferTypeIndex));
+                        SlotHandle slot = insertBuffer(buffer, type);
+                        tr.buffers.push_back({ std::static_pointer_cast < Buffer >(buffer), type, slot });
                     }
                 
                     else 
@@ -432,6 +448,13 @@ namespace Clean
                     }
                 }
             }
+            
+            for (auto& submesh : submeshes)
+                resolveSlots(submesh);
+            
+            for (auto& lod : lods)
+                for (auto& submesh : lod.submeshes)
+                    resolveSlots(submesh);
         }
         
         submitTransaction(kMeshTransactionBatchAddBuffers, tr);
@@ -443,8 +466,15 @@ namespace Clean
         MeshTransactionAddBuffer tr;
         
         {
-            std::lock_guard < std::mutex > lck(buffersMutex);
-            vertexBuffers.insert(std::make_pair(buffer->getHandle(), buffer));
+            std::scoped_lock < std::mutex, std::mutex > lck(submeshesMutex, buffersMutex);
+            tr.slot = insertBuffer(buffer, kBufferTypeVertex);
+            
+            for (auto& submesh : submeshes)
+                resolveSlots(submesh);
+            
+            for (auto& lod : lods)
+                for (auto& submesh : lod.submeshes)
+                    resolveSlots(submesh);
         }
         
         tr.buffer = buffer;
@@ -458,8 +488,15 @@ namespace Clean
         MeshTransactionAddBuffer tr;
         
         {
-            std::lock_guard < std::mutex > lck(buffersMutex);
-            indexBuffers.insert(std::make_pair(buffer->getHandle(), buffer));
+            std::scoped_lock < std::mutex, std::mutex > lck(submeshesMutex, buffersMutex);
+            tr.slot = insertBuffer(buffer, kBufferTypeIndex);
+            
+            for (auto& submesh : submeshes)
+                resolveSlots(submesh);
+            
+            for (auto& lod : lods)
+                for (auto& submesh : lod.submeshes)
+                    resolveSlots(submesh);
         }
         
         tr.buffer = buffer;
@@ -474,17 +511,37 @@ namespace Clean
         // For a Transaction to be valid, we must adds our Transaction to every driverCaches.transactions queue
         // (each driver will then process its transaction the way it wants to).
         
-        for (auto& pair : driverCaches)
+        for (auto& cache : driverCaches)
         {
             Transaction transaction(type, nullptr, tp);
-            pair.second.transactions.push(std::move(transaction));
+            cache.transactions.push(std::move(transaction));
         }
     }
     
     void Mesh::addSubMeshes(std::vector < SubMesh > const& sm)
     {
-        std::scoped_lock < std::mutex > lck(submeshesMutex);
-        submeshes.insert(submeshes.end(), sm.begin(), sm.end());
+        // Bounds are computed before locking: reading large buffers must not block the renderers.
+        
+        std::vector < SubMesh > added(sm);
+        
+        for (auto& submesh : added)
+        {
+            if (submesh.bounds.empty()) {
+                submesh.bounds = ComputeBounds(submesh);
+                submesh.sphere = BoundingSphere::FromBox(submesh.bounds);
+            }
+        }
+        
+        {
+            std::scoped_lock < std::mutex, std::mutex > lck(submeshesMutex, buffersMutex);
+            
+            for (auto& submesh : added) {
+                resolveSlots(submesh);
+                bounds.extend(submesh.bounds);
+                submeshes.push_back(std::move(submesh));
+            }
+        }
+        
         submitTransaction(kMeshTransactionAddSubMesh);
     }
     
@@ -498,6 +555,446 @@ namespace Clean
         origin.store(path);
     }
     
+    BoundingBox Mesh::getBounds() const
+    {
+        std::scoped_lock < std::mutex > lck(submeshesMutex);
+        return bounds;
+    }
+    
+    BoundingSphere Mesh::getBoundingSphere() const
+    {
+        return BoundingSphere::FromBox(getBounds());
+    }
+    
+    void Mesh::updateBounds()
+    {
+        std::scoped_lock < std::mutex > lck(submeshesMutex);
+        bounds = BoundingBox();
+        
+        for (auto& submesh : submeshes)
+        {
+            submesh.bounds = ComputeBounds(submesh);
+            submesh.sphere = BoundingSphere::FromBox(submesh.bounds);
+            bounds.extend(submesh.bounds);
+        }
+    }
+    
+    BoundingBox Mesh::ComputeBounds(SubMesh const& submesh)
+    {
+        BoundingBox result;
+        
+        if (!submesh.buffer || !submesh.descriptor.has(kVertexComponentPosition))
+            return result;
+        
+        const auto* data = static_cast < const unsigned char* >(submesh.buffer->getData());
+        if (!data) return result;
+        
+        VertexComponentPartialInfos infos = submesh.descriptor.components.at(kVertexComponentPosition);
+        const std::size_t stride = infos.stride ? static_cast < std::size_t >(infos.stride) : sizeof(float) * VertexComponentCount(kVertexComponentPosition);
+        const std::size_t size = submesh.buffer->getSize();
+        
+        auto extendWith = [&](std::size_t vertex){
+            const std::size_t position = vertex * stride + static_cast < std::size_t >(infos.offset);
+            if (position + sizeof(float) * 3 > size) return;
+            
+            float xyz[3];
+            std::memcpy(xyz, data + position, sizeof(xyz));
+            result.extend(glm::vec3(xyz[0], xyz[1], xyz[2]));
+        };
+        
+        const auto* indexes = submesh.indexBuffer ? static_cast < const unsigned char* >(submesh.indexBuffer->getData()) : nullptr;
+        
+        if (indexes && submesh.indexCount)
+        {
+            // Indexes are 32 bits, relative to the submesh's offset.
+            const std::size_t indexSize = submesh.indexBuffer->getSize() / sizeof(std::uint32_t);
+            const std::size_t last = std::min(submesh.indexOffset + submesh.indexCount, indexSize);
+            
+            for (std::size_t i = submesh.indexOffset; i < last; ++i)
+            {
+                std::uint32_t index;
+                std::memcpy(&index, indexes + i * sizeof(std::uint32_t), sizeof(index));
+                extendWith(submesh.offset + index);
+            }
+        }
+        
+        else
+        {
+            for (std::size_t i = 0; i < submesh.elements; ++i)
+                extendWith(submesh.offset + i);
+        }
+        
+        return result;
+    }
+    
+    namespace
+    {
+        /*! @brief Returns the triangle list of submesh, relative to its offset, or an empty list if its data isn't in RAM. */
+        std::vector < std::uint32_t > ReadSubMeshIndexes(SubMesh const& submesh)
+        {
+            std::vector < std::uint32_t > result;
+            
+            if (submesh.indexBuffer)
+            {
+                const auto* data = static_cast < const unsigned char* >(submesh.indexBuffer->getData());
+                if (!data) return result;
+                
+                const std::size_t indexSize = submesh.indexBuffer->getSize() / sizeof(std::uint32_t);
+                const std::size_t first = std::min(submesh.indexOffset, indexSize);
+                const std::size_t last = std::min(submesh.indexOffset + submesh.indexCount, indexSize);
+                
+                result.resize(last - first);
+                if (!result.empty()) std::memcpy(result.data(), data + first * sizeof(std::uint32_t), result.size() * sizeof(std::uint32_t));
+            }
+            
+            else
+            {
+                result.resize(submesh.elements);
+                for (std::size_t i = 0; i < submesh.elements; ++i) result[i] = static_cast < std::uint32_t >(i);
+            }
+            
+            result.resize(result.size() - result.size() % 3);
+            return result;
+        }
+        
+        /*! @brief Simplifies the triangles of submesh to target indexes. Returns an empty list if submesh has no
+         *  position in RAM. **/
+        std::vector < std::uint32_t > SimplifySubMesh(SubMesh const& submesh, std::vector < std::uint32_t > const& indexes,
+                                                      float reduction, float maxError, float& error)
+        {
+            error = 0.0f;
+            
+            if (!submesh.buffer || !submesh.descriptor.has(kVertexComponentPosition) || indexes.empty())
+                return {};
+            
+            const auto* data = static_cast < const unsigned char* >(submesh.buffer->getData());
+            if (!data) return {};
+            
+            VertexComponentPartialInfos infos = submesh.descriptor.components.at(kVertexComponentPosition);
+            const std::size_t stride = infos.stride ? static_cast < std::size_t >(infos.stride) : sizeof(float) * VertexComponentCount(kVertexComponentPosition);
+            const std::size_t first = submesh.offset * stride + static_cast < std::size_t >(infos.offset);
+            const std::size_t size = submesh.buffer->getSize();
+            if (first + sizeof(float) * 3 > size) return {};
+            
+            // Only the vertices within the buffer are simplified; triangles using others are dropped.
+            const std::size_t available = (size - first - sizeof(float) * 3) / stride + 1;
+            const std::size_t vertexCount = std::min(available, static_cast < std::size_t >(*std::max_element(indexes.begin(), indexes.end())) + 1);
+            
+            std::size_t target = static_cast < std::size_t >(static_cast < float >(indexes.size()) * reduction);
+            target -= target % 3;
+            
+            return SimplifyMesh(data + first, vertexCount, stride, indexes, target, maxError, &error);
+        }
+    }
+    
+    std::size_t Mesh::generateLods(std::size_t count, float reduction, float screenSize, float maxError)
+    {
+        ProfileScope("Mesh::generateLods");
+        
+        std::vector < SubMesh > source;
+        
+        {
+            std::scoped_lock < std::mutex > lck(submeshesMutex);
+            source = submeshes;
+        }
+        
+        count = std::min(count, kMeshMaxLods - 1);
+        
+        std::vector < std::vector < std::uint32_t > > sourceIndexes(source.size());
+        for (std::size_t i = 0; i < source.size(); ++i)
+            sourceIndexes[i] = ReadSubMeshIndexes(source[i]);
+        
+        std::vector < MeshLod > generated;
+        std::vector < std::shared_ptr < GenBuffer > > newBuffers;
+        float previousError = 0.0f;
+        
+        for (std::size_t level = 1; level <= count && !source.empty(); ++level)
+        {
+            // Submeshes are independent: each one is simplified by its own job.
+            
+            std::vector < std::vector < std::uint32_t > > results(source.size());
+            std::vector < float > errors(source.size(), 0.0f);
+            
+            auto fn = [&](std::size_t first, std::size_t last){
+                for (std::size_t i = first; i < last; ++i)
+                    results[i] = SimplifySubMesh(source[i], sourceIndexes[i], reduction, maxError, errors[i]);
+            };
+            
+            if (JobSystem* jobSystem = JobSystem::Find())
+                jobSystem->parallelFor(0, source.size(), 1, fn);
+            else
+                fn(0, source.size());
+            
+            // A level removing less than a tenth of the triangles isn't worth its memory.
+            
+            std::size_t before = 0, after = 0;
+            
+            for (std::size_t i = 0; i < source.size(); ++i)
+            {
+                before += sourceIndexes[i].size();
+                after += results[i].empty() ? sourceIndexes[i].size() : results[i].size();
+            }
+            
+            if (!after || after * 10 > before * 9)
+                break;
+            
+            // All the submeshes of the level share one index buffer. Submeshes that couldn't be simplified
+            // keep their own.
+            
+            std::vector < std::uint32_t > merged;
+            merged.reserve(after);
+            
+            // Errors add up, as each level is simplified from the previous one.
+            
+            MeshLod lod;
+            lod.screenSize = screenSize * std::pow(0.5f, static_cast < float >(level - 1));
+            lod.error = previousError;
+            lod.submeshes = source;
+            
+            for (std::size_t i = 0; i < source.size(); ++i)
+            {
+                if (results[i].empty()) continue;
+                
+                lod.submeshes[i].indexOffset = merged.size();
+                lod.submeshes[i].indexCount = results[i].size();
+                merged.insert(merged.end(), results[i].begin(), results[i].end());
+                lod.error = std::max(lod.error, previousError + errors[i]);
+            }
+            
+            if (!merged.empty())
+            {
+                auto indexBuffer = AllocateShared < GenBuffer >(merged.data(), merged.size() * sizeof(std::uint32_t),
+                                                               kBufferUsageStatic, kBufferTypeIndex);
+                newBuffers.push_back(indexBuffer);
+                
+                for (std::size_t i = 0; i < source.size(); ++i)
+                {
+                    if (results[i].empty()) continue;
+                    lod.submeshes[i].indexBuffer = indexBuffer;
+                    sourceIndexes[i] = std::move(results[i]);
+                }
+            }
+            
+            source = lod.submeshes;
+            previousError = lod.error;
+            generated.push_back(std::move(lod));
+        }
+        
+        if (!newBuffers.empty())
+            addBuffers(newBuffers);
+        
+        {
+            std::scoped_lock < std::mutex, std::mutex > lck(submeshesMutex, buffersMutex);
+            
+            for (auto& lod : generated)
+                for (auto& submesh : lod.submeshes)
+                    resolveSlots(submesh);
+            
+            lods = std::move(generated);
+        }
+        
+        submitTransaction(kMeshTransactionAddSubMesh);
+        return getLodCount() - 1;
+    }
+    
+    bool Mesh::addLod(MeshLod lod)
+    {
+        {
+            std::scoped_lock < std::mutex, std::mutex > lck(submeshesMutex, buffersMutex);
+            
+            if (lods.size() + 1 >= kMeshMaxLods || lod.submeshes.size() != submeshes.size())
+                return false;
+            
+            for (auto& submesh : lod.submeshes)
+                resolveSlots(submesh);
+            
+            auto it = std::find_if(lods.begin(), lods.end(), [&lod](MeshLod const& rhs){ return rhs.screenSize < lod.screenSize; });
+            lods.insert(it, std::move(lod));
+        }
+        
+        submitTransaction(kMeshTransactionAddSubMesh);
+        return true;
+    }
+    
+    void Mesh::clearLods()
+    {
+        {
+            std::scoped_lock < std::mutex > lck(submeshesMutex);
+            lods.clear();
+        }
+        
+        submitTransaction(kMeshTransactionRemoveSubMesh);
+    }
+    
+    std::size_t Mesh::getLodCount() const
+    {
+        std::scoped_lock < std::mutex > lck(submeshesMutex);
+        return lods.size() + 1;
+    }
+    
+    std::size_t Mesh::findLod(float screenSize) const
+    {
+        std::scoped_lock < std::mutex > lck(submeshesMutex);
+        std::size_t level = 0;
+        
+        while (level < lods.size() && screenSize < lods[level].screenSize)
+            level++;
+        
+        return level;
+    }
+    
+    bool Mesh::selectLod(MeshLodState& state, float screenSize, float elapsed, float fadeDuration, float hysteresis) const
+    {
+        std::size_t level = state.level;
+        
+        {
+            std::scoped_lock < std::mutex > lck(submeshesMutex);
+            level = std::min(level, lods.size());
+            
+            // Level n is drawn from lods[n - 1].screenSize up to lods[n - 2].screenSize. Moving to a coarser level
+            // needs to be below the threshold by hysteresis, and moving to a finer one above it by hysteresis.
+            
+            while (level < lods.size() && screenSize < lods[level].screenSize * (1.0f - hysteresis))
+                level++;
+            
+            while (level > 0 && screenSize >= lods[level - 1].screenSize * (1.0f + hysteresis))
+                level--;
+        }
+        
+        if (level != state.level)
+        {
+            state.previous = state.level;
+            state.level = static_cast < std::uint8_t >(level);
+            state.fade = 0.0f;
+        }
+        
+        if (state.fade < 1.0f)
+            state.fade = (fadeDuration > 0.0f) ? std::min(1.0f, state.fade + elapsed / fadeDuration) : 1.0f;
+        
+        return state.fade < 1.0f;
+    }
+    
+    void Mesh::findTriangles(std::vector < glm::vec3 >& positions, std::vector < std::uint32_t >& indexes, std::size_t level) const
+    {
+        std::vector < SubMesh > levelSubmeshes;
+        
+        {
+            std::scoped_lock < std::mutex > lck(submeshesMutex);
+            level = std::min(level, lods.size());
+            levelSubmeshes = level ? lods[level - 1].submeshes : submeshes;
+        }
+        
+        const std::size_t base = positions.size();
+        
+        for (auto const& submesh : levelSubmeshes)
+        {
+            if (!submesh.buffer || !submesh.descriptor.has(kVertexComponentPosition))
+                continue;
+            
+            const auto* data = static_cast < const unsigned char* >(submesh.buffer->getData());
+            if (!data) continue;
+            
+            VertexComponentPartialInfos infos = submesh.descriptor.components.at(kVertexComponentPosition);
+            const std::size_t stride = infos.stride ? static_cast < std::size_t >(infos.stride) : sizeof(float) * VertexComponentCount(kVertexComponentPosition);
+            const std::size_t size = submesh.buffer->getSize();
+            
+            // Each vertex of the submesh is appended once, the first time a triangle uses it.
+            
+            std::unordered_map < std::uint32_t, std::uint32_t > remap;
+            const std::vector < std::uint32_t > submeshIndexes = ReadSubMeshIndexes(submesh);
+            
+            for (std::size_t i = 0; i + 2 < submeshIndexes.size(); i += 3)
+            {
+                std::uint32_t triangle[3];
+                bool valid = true;
+                
+                for (std::size_t k = 0; k < 3 && valid; ++k)
+                {
+                    const std::uint32_t vertex = submeshIndexes[i + k];
+                    auto it = remap.find(vertex);
+                    
+                    if (it == remap.end())
+                    {
+                        const std::size_t position = (submesh.offset + vertex) * stride + static_cast < std::size_t >(infos.offset);
+                        if (position + sizeof(float) * 3 > size) { valid = false; break; }
+                        
+                        float xyz[3];
+                        std::memcpy(xyz, data + position, sizeof(xyz));
+                        positions.push_back(glm::vec3(xyz[0], xyz[1], xyz[2]));
+                        it = remap.emplace(vertex, static_cast < std::uint32_t >(positions.size() - 1 - base)).first;
+                    }
+                    
+                    triangle[k] = it->second;
+                }
+                
+                if (valid) indexes.insert(indexes.end(), triangle, triangle + 3);
+            }
+        }
+    }
+    
+    float Mesh::ProjectedScreenSize(BoundingSphere const& sphere, glm::vec3 const& eye, glm::mat4 const& projection)
+    {
+        if (sphere.empty())
+            return 0.0f;
+        
+        // projection[1][1] is the cotangent of half the vertical field of view: the sphere covers its diameter
+        // over the height of the view at its distance.
+        
+        const float distance = glm::length(sphere.center - eye);
+        if (distance <= sphere.radius)
+            return std::numeric_limits < float >::max();
+        
+        return sphere.radius * projection[1][1] / distance;
+    }
+    
+    Mesh::DriverCache* Mesh::findDriverCache(Driver const& driver) const
+    {
+        for (auto& cache : driverCaches)
+        {
+            if (cache.driver == &driver)
+                return &cache;
+        }
+        
+        return nullptr;
+    }
+    
+    SlotHandle Mesh::insertBuffer(std::shared_ptr < GenBuffer > const& buffer, std::uint8_t type)
+    {
+        auto it = bufferSlots.find(buffer->getHandle());
+        if (it != bufferSlots.end()) return it->second;
+        
+        SlotHandle slot = buffers.insert(MeshBuffer{ buffer, type });
+        bufferSlots.emplace(buffer->getHandle(), slot);
+        return slot;
+    }
+    
+    SlotHandle Mesh::findBufferSlot(Buffer const& buffer) const
+    {
+        std::scoped_lock < std::mutex > lck(buffersMutex);
+        auto it = bufferSlots.find(buffer.getHandle());
+        return (it == bufferSlots.end()) ? SlotHandle() : it->second;
+    }
+    
+    void Mesh::resolveSlots(SubMesh& submesh) const
+    {
+        // Slots are always looked up again: a SubMesh copied from another Mesh holds the slots of the other Mesh.
+        
+        if (submesh.buffer) {
+            auto it = bufferSlots.find(submesh.buffer->getHandle());
+            submesh.bufferSlot = (it == bufferSlots.end()) ? SlotHandle() : it->second;
+        }
+        
+        if (submesh.indexBuffer) {
+            auto it = bufferSlots.find(submesh.indexBuffer->getHandle());
+            submesh.indexBufferSlot = (it == bufferSlots.end()) ? SlotHandle() : it->second;
+        }
+    }
+    
+    Mesh::ShaderKey Mesh::MakeShaderKey(RenderPipeline const& shader, std::size_t level)
+    {
+        return (static_cast < ShaderKey >(shader.getHandle()) << 4) | level;
+    }
+    
     /*
     {
         Buffer buf = new GenBuffer(data, size*sizeof(Data), kBufferUsageStatic);
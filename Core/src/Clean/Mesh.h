@@ -13,11 +13,14 @@
 #include "FileLoader.h"
 #include "Material.h"
 #include "Property.h"
+#include "SlotMap.h"
+#include "Bounds.h"
 
 #include <cstdint>
 #include <cstddef>
 #include <memory>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <queue>
@@ -69,6 +72,57 @@ namespace Clean
         
         //! @brief Default material proposed for this SubMesh. 
         std::weak_ptr < Material > material;
+        
+        //! @brief Slot of buffer in the Mesh. Filled by the Mesh once both are added to it.
+        SlotHandle bufferSlot;
+        
+        //! @brief Slot of indexBuffer in the Mesh. Filled by the Mesh once both are added to it.
+        SlotHandle indexBufferSlot;
+        
+        //! @brief Box bounding the positions of the submesh, in the space of the mesh. Computed by
+        //! the Mesh when the submesh is added if left empty.
+        BoundingBox bounds;
+        
+        //! @brief Sphere containing bounds.
+        BoundingSphere sphere;
+    };
+    
+    //! @brief Maximum number of levels of detail of a Mesh, the full detail included.
+    static constexpr const std::size_t kMeshMaxLods = 16;
+    
+    //! @brief Default margin around the screen size thresholds before Mesh::selectLod() changes of level.
+    static constexpr const float kMeshLodHysteresis = 0.1f;
+    
+    /** @brief A coarser level of detail of a Mesh.
+     *
+     * A level holds one submesh for each submesh of the full detail, in the same order. Submeshes are
+     * usually generated by Mesh::generateLods(): they share the vertex buffers of the full detail and
+     * only have their own index buffer.
+     *
+    **/
+    struct MeshLod
+    {
+        //! @brief Submeshes drawn at this level. Their buffers must be added to the Mesh.
+        std::vector < SubMesh > submeshes;
+        
+        //! @brief Smallest screen size at which this level is drawn, as returned by Mesh::ProjectedScreenSize().
+        float screenSize = 0.0f;
+        
+        //! @brief Largest distance between this level and the full detail, relative to the size of the mesh.
+        float error = 0.0f;
+    };
+    
+    /** @brief Level of detail of one drawn instance of a Mesh, updated by Mesh::selectLod(). */
+    struct MeshLodState
+    {
+        //! @brief Level drawn.
+        std::uint8_t level = 0;
+        
+        //! @brief Level drawn before level, while the cross-fade between both isn't done.
+        std::uint8_t previous = 0;
+        
+        //! @brief Progress of the cross-fade from previous to level, from zero to one. One when done.
+        float fade = 1.0f;
     };
     
     static constexpr const std::uint8_t kMeshTransactionAddSubMesh = 1;
@@ -101,16 +155,32 @@ namespace Clean
      * to call EffectSession::addMaterial() with your material in your RenderCommand or RenderSubCommand to bind your material
      * onto the command/subcommand.
      *
+     * Levels of detail
+     * Besides its submeshes, which are the full detail (level zero), a Mesh may have coarser levels used when it
+     * covers a small part of the screen. Levels are generated at load with generateLods(), or built offline and
+     * added with addLod(). Each instance keeps a MeshLodState: selectLod() updates it from the projected screen
+     * size of the instance, and populateRenderCommand() emits the submeshes of the selected level.
+     *
     **/
     class Mesh final : public Handled < Mesh >
     {
-        //! @brief Stores all Vertex buffers for our mesh. Those are Generic buffers. See 
-        //! driverBuffers for VRAM buffers. 
-        std::map < std::size_t, std::shared_ptr < GenBuffer > > vertexBuffers;
+        /** @brief A Generic buffer of the mesh. */
+        struct MeshBuffer 
+        {
+            //! @brief Buffer in RAM.
+            std::shared_ptr < GenBuffer > buffer;
+            
+            //! @brief kBufferTypeVertex or kBufferTypeIndex.
+            std::uint8_t type;
+        };
         
-        //! @brief Stores all Index buffers for our mesh. Those are Generic buffers. See
-        //! driverBuffers for VRAM buffers. 
-        std::map < std::size_t, std::shared_ptr < GenBuffer > > indexBuffers;
+        //! @brief Stores all Vertex and Index buffers for our mesh. Those are Generic buffers. Each 
+        //! DriverCache stores its VRAM buffers by the same slots.
+        SlotMap < MeshBuffer > buffers;
+        
+        //! @brief Slot of each buffer in buffers, by Buffer handle. Only used when adding buffers or
+        //! submeshes: submeshes keep the slots of their buffers.
+        std::unordered_map < std::size_t, SlotHandle > bufferSlots;
         
         //! @brief Protects all operations on Generic buffers.
         mutable std::mutex buffersMutex;
@@ -118,11 +188,18 @@ namespace Clean
         //! @brief Stores all submeshes for this mesh.
         std::vector < SubMesh > submeshes;
         
-        //! @brief Protects submeshes.
+        //! @brief Protects submeshes and bounds.
         mutable std::mutex submeshesMutex;
         
-        typedef std::uintptr_t ShaderKey;
-        typedef std::uintptr_t DriverKey;
+        //! @brief Union of the bounds of all submeshes.
+        BoundingBox bounds;
+        
+        //! @brief Coarser levels of detail, by decreasing screenSize. Protected by submeshesMutex.
+        std::vector < MeshLod > lods;
+        
+        //! @brief Handle of the RenderPipeline, shifted left by 4 bits, or'ed with the level of detail. Unlike its
+        //! address, a handle is never reused by another pipeline.
+        typedef std::size_t ShaderKey;
         
         //! @brief Caches data for a shader. 
         struct ShaderCache 
@@ -134,18 +211,22 @@ namespace Clean
         //! @brief Caches data for the driver. 
         struct DriverCache
         {   
-            //! @brief Stores all buffers stored for a driver. (Key is handle of soft buffer, value is hard buffer)
-            std::map < std::uintptr_t, BufferAutorelease > buffers;
+            //! @brief Driver this cache belongs to.
+            Driver const* driver = nullptr;
+            
+            //! @brief Stores all buffers stored for a driver. (Key is slot of soft buffer, value is hard buffer)
+            SecondarySlotMap < BufferAutorelease > buffers;
             
             //! @brief Stores all caches for each pipeline for this driver. (1 ShaderCache for 1 RenderPipeline)
-            std::map < ShaderKey, ShaderCache > shaderCaches;
+            std::unordered_map < ShaderKey, ShaderCache > shaderCaches;
             
             //! @brief Stores all transactions pending for this driver. 
             std::queue < Transaction, std::list < Transaction > > transactions;
         };
         
-        //! @brief Stores caches for each driver. 
-        mutable std::map < DriverKey, DriverCache > driverCaches;
+        //! @brief Stores caches for each driver. There are rarely more than one or two drivers: a vector
+        //! is faster to search than a map.
+        mutable std::vector < DriverCache > driverCaches;
         
         //! @brief Protects all caches entrees.
         mutable std::mutex driverCachesMutex;
@@ -180,7 +261,7 @@ namespace Clean
          * unsassociated driver will never allocate caches in a Mesh. 
          *
         **/
-        std::vector < VertexDescriptor > findAssociatedDescriptors(Driver const& driver) const;
+        std::vector < VertexDescriptor > findAssociatedDescriptors(Driver const& driver, std::size_t level = 0) const;
 
         /*! @brief Returns a list of VertexDescriptor for each submeshes. */
         std::vector < VertexDescriptor > findDescriptors() const;
@@ -202,9 +283,19 @@ namespace Clean
          *
          * \param[in] driver A Driver already associated to this Mesh. 
          * \param[in] command The RenderCommand we want to fill with this Mesh RenderSubCommands.
+         * \param[in] level Level of detail to draw. Clamped to the coarsest level.
+         *
+        **/
+        void populateRenderCommand(Driver const& driver, RenderCommand& command, std::size_t level = 0);
+        
+        /*! @brief Populates a RenderCommand with the level of detail of state.
+         *
+         * While state is cross-fading, the submeshes of both levels are emitted. Each of their RenderSubCommand
+         * has a kEffectLodFadeFloat parameter: state.fade for the new level, and state.fade - 1 for the previous
+         * one. Shaders discard a dithered part of the fragments from it, so the sum of both levels looks opaque.
          *
         **/
-        void populateRenderCommand(Driver const& driver, RenderCommand& command);
+        void populateRenderCommand(Driver const& driver, RenderCommand& command, MeshLodState const& state);
         
         /*! @brief Finds ShaderAttributesMap cached for given Driver and RenderPipeline.
          *
@@ -213,10 +304,10 @@ namespace Clean
          * populate your RenderCommand. 
          *
         **/
-        std::vector < ShaderAttributesMap > findShaderAttributesMap(Driver const& driver, RenderPipeline const& shader);
+        std::vector < ShaderAttributesMap > findShaderAttributesMap(Driver const& driver, RenderPipeline const& shader, std::size_t level = 0);
         
         /*! @brief Stores the given ShaderCache. */
-        void shaderCacheStore(Driver const& driver, RenderPipeline const& shader, ShaderCache& cache);
+        void shaderCacheStore(Driver const& driver, RenderPipeline const& shader, ShaderCache& cache, std::size_t level = 0);
 
         /*! @brief Associates this mesh to a driver.
          *
@@ -268,7 +359,7 @@ namespace Clean
          * the same GenBuffer is added twice in a Mesh, only one hardware buffer will be created. 
          *
         **/
-        void addBuffers(std::vector < std::shared_ptr < GenBuffer > > const& buffers);
+        void addBuffers(std::vector < std::shared_ptr < GenBuffer > > const& newBuffers);
         
         /*! @brief Adds the given buffer to vertex buffers. 
          *
@@ -304,11 +395,11 @@ namespace Clean
             // For a Transaction to be valid, we must adds our Transaction to every driverCaches.transactions queue
             // (each driver will then process its transaction the way it wants to). 
             
-            for (auto& pair : driverCaches)
+            for (auto& cache : driverCaches)
             {
                 TransactionData* trData = Allocate < TransactionData >(1, data);
                 Transaction transaction(type, (void*) trData, tp);
-                pair.second.transactions.push(std::move(transaction));
+                cache.transactions.push(std::move(transaction));
             }
         }
         
@@ -323,6 +414,93 @@ namespace Clean
         
         /*! @brief Sets the file path associated to this mesh. */
         void setFilePath(std::string const& path);
+        
+        /*! @brief Returns the box bounding all submeshes. */
+        BoundingBox getBounds() const;
+        
+        /*! @brief Returns the sphere containing getBounds(). */
+        BoundingSphere getBoundingSphere() const;
+        
+        /*! @brief Recomputes the bounds of all submeshes from their buffers. Call it after modifying
+         *  the positions in a vertex buffer. **/
+        void updateBounds();
+        
+        /*! @brief Computes the box bounding the positions used by submesh.
+         *
+         * Positions are read from the submesh's buffer as floats, with the offset and stride of
+         * kVertexComponentPosition in its descriptor. If the submesh has an index buffer, only the
+         * vertices it references are used, else all its elements are. The box is empty if there is no
+         * position or no data in RAM.
+         *
+        **/
+        static BoundingBox ComputeBounds(SubMesh const& submesh);
+        
+        /*! @brief Generates coarser levels of detail from the full detail, replacing the current ones.
+         *
+         * Each level is simplified from the previous one with SimplifyMesh(), to reduction times its number of
+         * triangles, on the JobSystem when there is one. Each level gets one new index buffer for all its submeshes
+         * and keeps the vertex buffers. The first level is used below screenSize, and each next one below half the
+         * screen size of the previous one. Generation stops early when a level can't remove enough triangles
+         * without exceeding maxError.
+         *
+         * \return The number of levels generated.
+         *
+        **/
+        std::size_t generateLods(std::size_t count = 3, float reduction = 0.5f, float screenSize = 0.25f, float maxError = 0.05f);
+        
+        /*! @brief Adds a level of detail. Its buffers must be added with addBuffers(). Returns false if the Mesh
+         *  already has kMeshMaxLods levels or if lod doesn't have one submesh per submesh of the Mesh. **/
+        bool addLod(MeshLod lod);
+        
+        /*! @brief Removes all levels of detail but the full detail. */
+        void clearLods();
+        
+        /*! @brief Returns the number of levels of detail, the full detail included. */
+        std::size_t getLodCount() const;
+        
+        /*! @brief Returns the level drawn at screenSize, without hysteresis. */
+        std::size_t findLod(float screenSize) const;
+        
+        /*! @brief Updates the level of detail of an instance from its screen size.
+         *
+         * The level only changes when screenSize is past the threshold of the level by more than hysteresis
+         * (relatively), so an instance at the threshold doesn't switch levels each frame. When fadeDuration is
+         * not zero, a change of level starts a cross-fade lasting fadeDuration seconds; elapsed is the time in
+         * seconds since the previous call. Returns true while cross-fading.
+         *
+        **/
+        bool selectLod(MeshLodState& state, float screenSize, float elapsed = 0.0f, float fadeDuration = 0.0f,
+                       float hysteresis = kMeshLodHysteresis) const;
+        
+        /*! @brief Appends the positions and the triangles of a level of detail to positions and indexes.
+         *
+         * level is clamped to the coarsest level. Only the vertices used by the triangles are appended, and
+         * indexes are relative to the first position appended. Submeshes without data in RAM are skipped.
+         * Used to give a Mesh to CPU algorithms, like OcclusionBuffer::addOccluder().
+         *
+        **/
+        void findTriangles(std::vector < glm::vec3 >& positions, std::vector < std::uint32_t >& indexes, std::size_t level = 0) const;
+        
+        /*! @brief Returns the fraction of the viewport height covered by sphere, seen from eye with projection.
+         *  Returns a huge value if eye is inside the sphere. **/
+        static float ProjectedScreenSize(BoundingSphere const& sphere, glm::vec3 const& eye, glm::mat4 const& projection);
+        
+    private:
+        
+        /*! @brief Returns the cache of driver, or null. driverCachesMutex must be locked. */
+        DriverCache* findDriverCache(Driver const& driver) const;
+        
+        /*! @brief Inserts buffer in buffers if not already there, and returns its slot. buffersMutex must be locked. */
+        SlotHandle insertBuffer(std::shared_ptr < GenBuffer > const& buffer, std::uint8_t type);
+        
+        /*! @brief Returns the slot of buffer, or a null handle. Locks buffersMutex. */
+        SlotHandle findBufferSlot(Buffer const& buffer) const;
+        
+        /*! @brief Fills the slots of submesh from its buffers. buffersMutex must be locked. */
+        void resolveSlots(SubMesh& submesh) const;
+        
+        /*! @brief Returns the key of the ShaderCache of shader for a level of detail. */
+        static ShaderKey MakeShaderKey(RenderPipeline const& shader, std::size_t level);
     };
     
     /** @brief Interface for all Mesh loaders. */
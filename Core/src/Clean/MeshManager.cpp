@@ -7,6 +7,7 @@
 #include "MeshManager.h"
 #include "Core.h"
 #include "Platform.h"
+#include "Profiler.h"
 
 namespace Clean 
 {
@@ -19,8 +20,15 @@ namespace Clean
         return *manager;
     }
     
+    MeshManager::MeshManager()
+    {
+        fileIndex = addIndex([](Mesh const& mesh){ return HashKey(mesh.getFilePath()); });
+    }
+    
     std::shared_ptr < Mesh > MeshManager::load(std::string const& filepath, std::function < bool(FileLoader<Mesh>const&) > checker)
     {
+        ProfileScope("MeshManager::load");
+        
         auto checked = findByFile(filepath);
         if (checked) return checked;
         
@@ -64,9 +72,6 @@ namespace Clean
         std::string const realPath = Core::Get().getCurrentFileSystem().findRealPath(filepath);
         if (realPath.empty()) return nullptr;
         
-        std::lock_guard < std::mutex > lck(managedListMutex);
-        auto it = std::find_if(managedList.begin(), managedList.end(), [realPath](auto mesh){ return mesh->getFilePath() == realPath; });
-        
-        return (it == managedList.end()) ? nullptr : *it;
+        return findIndexed(fileIndex, HashKey(realPath), [&realPath](Mesh const& mesh){ return mesh.getFilePath() == realPath; });
     }
 }
@@ -22,6 +22,9 @@ namespace Clean
         //! @brief Makes our Core class a friend. 
         friend class Core;
         
+        //! @brief Index of meshes by file path.
+        std::size_t fileIndex;
+        
     public:
         
         /*! @brief Returns the current manager or throw an exception if not found. */
@@ -29,8 +32,8 @@ namespace Clean
         
     public:
         
-        /*! @brief Default constructor. */
-        MeshManager() = default;
+        /*! @brief Constructs the manager and its index by file. */
+        MeshManager();
         
         /*! @brief Loads a file. 
          *
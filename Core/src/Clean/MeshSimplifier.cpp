@@ -0,0 +1,359 @@
+/** \file Core/MeshSimplifier.cpp
+**/
+
+#include "MeshSimplifier.h"
+#include "Profiler.h"
+
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+namespace Clean
+{
+    namespace
+    {
+        /** @brief Symmetric 4x4 matrix giving the sum of the squared distances of a point to a set of planes. */
+        struct Quadric
+        {
+            // a00 a01 a02 a03 a11 a12 a13 a22 a23 a33
+            double a[10] = { 0.0 };
+
+            void addPlane(glm::dvec3 const& n, double d, double weight)
+            {
+                a[0] += weight * n.x * n.x; a[1] += weight * n.x * n.y; a[2] += weight * n.x * n.z; a[3] += weight * n.x * d;
+                a[4] += weight * n.y * n.y; a[5] += weight * n.y * n.z; a[6] += weight * n.y * d;
+                a[7] += weight * n.z * n.z; a[8] += weight * n.z * d;
+                a[9] += weight * d * d;
+            }
+
+            Quadric& operator += (Quadric const& rhs)
+            {
+                for (std::size_t i = 0; i < 10; ++i) a[i] += rhs.a[i];
+                return *this;
+            }
+
+            double evaluate(glm::dvec3 const& p) const
+            {
+                const double result = a[0] * p.x * p.x + 2.0 * a[1] * p.x * p.y + 2.0 * a[2] * p.x * p.z + 2.0 * a[3] * p.x
+                                    + a[4] * p.y * p.y + 2.0 * a[5] * p.y * p.z + 2.0 * a[6] * p.y
+                                    + a[7] * p.z * p.z + 2.0 * a[8] * p.z
+                                    + a[9];
+
+                // Rounding may give a slightly negative distance.
+                return std::max(result, 0.0);
+            }
+        };
+
+        /** @brief A collapse of an edge, valid while the versions of both its vertices are unchanged. */
+        struct Collapse
+        {
+            double cost;
+            std::uint32_t from, to;
+            std::uint32_t fromVersion, toVersion;
+
+            bool operator > (Collapse const& rhs) const { return cost > rhs.cost; }
+        };
+
+        std::uint64_t EdgeKey(std::uint32_t a, std::uint32_t b)
+        {
+            if (a > b) std::swap(a, b);
+            return (static_cast < std::uint64_t >(a) << 32) | b;
+        }
+
+        glm::dvec3 TriangleNormal(glm::dvec3 const& p0, glm::dvec3 const& p1, glm::dvec3 const& p2)
+        {
+            return glm::cross(p1 - p0, p2 - p0);
+        }
+    }
+
+    std::vector < std::uint32_t > SimplifyMesh(const void* positions, std::size_t vertexCount, std::size_t stride,
+                                               std::vector < std::uint32_t > const& indexes,
+                                               std::size_t targetIndexCount, float maxError,
+                                               float* resultError)
+    {
+        ProfileScope("SimplifyMesh");
+
+        if (resultError) *resultError = 0.0f;
+        if (!positions || !vertexCount || indexes.size() < 3 || indexes.size() <= targetIndexCount)
+            return indexes;
+
+        if (!stride) stride = sizeof(float) * 3;
+        const auto* data = static_cast < const unsigned char* >(positions);
+
+        // Positions are normalized in the unit cube, so the errors are relative to the size of the mesh.
+
+        std::vector < glm::dvec3 > points(vertexCount);
+        glm::dvec3 lower(HUGE_VAL), upper(-HUGE_VAL);
+
+        for (std::size_t i = 0; i < vertexCount; ++i)
+        {
+            float xyz[3];
+            std::memcpy(xyz, data + i * stride, sizeof(xyz));
+            points[i] = glm::dvec3(xyz[0], xyz[1], xyz[2]);
+            lower = glm::min(lower, points[i]);
+            upper = glm::max(upper, points[i]);
+        }
+
+        const glm::dvec3 extents = upper - lower;
+        const double scale = std::max(extents.x, std::max(extents.y, extents.z));
+        if (!(scale > 0.0)) return indexes;
+
+        for (auto& point : points)
+            point = (point - lower) / scale;
+
+        // Welds vertices by position: each vertex is simplified as the first vertex sharing its position.
+
+        struct PositionHash
+        {
+            std::size_t operator () (std::array < std::uint32_t, 3 > const& key) const
+            {
+                return (key[0] * 73856093u) ^ (key[1] * 19349663u) ^ (key[2] * 83492791u);
+            }
+        };
+
+        std::vector < std::uint32_t > canonical(vertexCount);
+        std::unordered_map < std::array < std::uint32_t, 3 >, std::uint32_t, PositionHash > welds;
+        welds.reserve(vertexCount);
+
+        for (std::size_t i = 0; i < vertexCount; ++i)
+        {
+            std::array < std::uint32_t, 3 > key;
+            std::memcpy(key.data(), data + i * stride, sizeof(float) * 3);
+            canonical[i] = welds.emplace(key, static_cast < std::uint32_t >(i)).first->second;
+        }
+
+        // Triangles are stored twice: with their original corners, to keep the attributes of the vertices
+        // that are never collapsed, and with the welded vertices that are simplified.
+
+        const std::size_t triangleCount = indexes.size() / 3;
+        std::vector < std::array < std::uint32_t, 3 > > corners, triangles;
+        corners.reserve(triangleCount);
+        triangles.reserve(triangleCount);
+
+        for (std::size_t i = 0; i < triangleCount; ++i)
+        {
+            const std::uint32_t a = indexes[i * 3], b = indexes[i * 3 + 1], c = indexes[i * 3 + 2];
+            if (a >= vertexCount || b >= vertexCount || c >= vertexCount) continue;
+
+            const std::uint32_t wa = canonical[a], wb = canonical[b], wc = canonical[c];
+            if (wa == wb || wb == wc || wa == wc) continue;
+
+            corners.push_back({ a, b, c });
+            triangles.push_back({ wa, wb, wc });
+        }
+
+        std::vector < std::vector < std::uint32_t > > vertexTriangles(vertexCount);
+        std::unordered_map < std::uint64_t, std::uint32_t > edgeUses;
+        edgeUses.reserve(triangles.size() * 2);
+
+        for (std::size_t t = 0; t < triangles.size(); ++t)
+        {
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                vertexTriangles[triangles[t][k]].push_back(static_cast < std::uint32_t >(t));
+                edgeUses[EdgeKey(triangles[t][k], triangles[t][(k + 1) % 3])]++;
+            }
+        }
+
+        // Each vertex gets the planes of its triangles, weighted by their area, and the planes perpendicular
+        // to its border edges so borders resist moving.
+
+        std::vector < Quadric > quadrics(vertexCount);
+        std::vector < std::uint8_t > border(vertexCount, 0);
+
+        for (auto const& triangle : triangles)
+        {
+            glm::dvec3 const& p0 = points[triangle[0]];
+            glm::dvec3 normal = TriangleNormal(p0, points[triangle[1]], points[triangle[2]]);
+            const double length = glm::length(normal);
+            if (length <= 0.0) continue;
+
+            normal /= length;
+            Quadric quadric;
+            quadric.addPlane(normal, -glm::dot(normal, p0), length * 0.5);
+
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                const std::uint32_t a = triangle[k], b = triangle[(k + 1) % 3];
+                quadrics[a] += quadric;
+
+                if (edgeUses[EdgeKey(a, b)] != 1) continue;
+
+                const glm::dvec3 edge = points[b] - points[a];
+                glm::dvec3 side = glm::cross(edge, normal);
+                const double sideLength = glm::length(side);
+                if (sideLength <= 0.0) continue;
+
+                side /= sideLength;
+                Quadric borderQuadric;
+                borderQuadric.addPlane(side, -glm::dot(side, points[a]), glm::dot(edge, edge) * kMeshSimplifierBorderWeight);
+                quadrics[a] += borderQuadric;
+                quadrics[b] += borderQuadric;
+                border[a] = border[b] = 1;
+            }
+        }
+
+        std::vector < std::uint32_t > collapsedTo(vertexCount);
+        std::vector < std::uint32_t > versions(vertexCount, 0);
+        std::vector < std::uint8_t > alive(triangles.size(), 1);
+        std::size_t aliveCount = triangles.size();
+
+        for (std::size_t i = 0; i < vertexCount; ++i)
+            collapsedTo[i] = static_cast < std::uint32_t >(i);
+
+        std::priority_queue < Collapse, std::vector < Collapse >, std::greater < Collapse > > heap;
+
+        // Pushes the cheapest direction of the edge. A border vertex may only move onto another border vertex.
+
+        auto pushEdge = [&](std::uint32_t a, std::uint32_t b){
+            Quadric sum = quadrics[a];
+            sum += quadrics[b];
+
+            const bool aToB = !border[a] || border[b];
+            const bool bToA = !border[b] || border[a];
+            if (!aToB && !bToA) return;
+
+            const double costAToB = aToB ? sum.evaluate(points[b]) : HUGE_VAL;
+            const double costBToA = bToA ? sum.evaluate(points[a]) : HUGE_VAL;
+
+            if (costAToB <= costBToA)
+                heap.push({ costAToB, a, b, versions[a], versions[b] });
+            else
+                heap.push({ costBToA, b, a, versions[b], versions[a] });
+        };
+
+        for (auto const& edge : edgeUses)
+            pushEdge(static_cast < std::uint32_t >(edge.first >> 32), static_cast < std::uint32_t >(edge.first & 0xFFFFFFFF));
+
+        const double maxCost = static_cast < double >(maxError) * static_cast < double >(maxError);
+        double reachedCost = 0.0;
+        std::vector < std::uint32_t > neighbours;
+
+        while (aliveCount * 3 > targetIndexCount && !heap.empty())
+        {
+            const Collapse collapse = heap.top();
+            heap.pop();
+
+            if (collapse.cost > maxCost)
+                break;
+
+            const std::uint32_t from = collapse.from, to = collapse.to;
+
+            if (collapsedTo[from] != from || collapsedTo[to] != to ||
+                versions[from] != collapse.fromVersion || versions[to] != collapse.toVersion)
+                continue;
+
+            // Refuses the collapse if a remaining triangle around from would flip or become degenerate.
+
+            bool valid = true;
+
+            for (std::uint32_t t : vertexTriangles[from])
+            {
+                if (!alive[t]) continue;
+
+                auto const& triangle = triangles[t];
+                if (triangle[0] == to || triangle[1] == to || triangle[2] == to) continue;
+
+                glm::dvec3 before[3], after[3];
+
+                for (std::size_t k = 0; k < 3; ++k) {
+                    before[k] = points[triangle[k]];
+                    after[k] = (triangle[k] == from) ? points[to] : before[k];
+                }
+
+                const glm::dvec3 normalBefore = TriangleNormal(before[0], before[1], before[2]);
+                const glm::dvec3 normalAfter = TriangleNormal(after[0], after[1], after[2]);
+
+                // Besides flipping, refuses rotating a triangle by more than about 80 degrees: a series of such
+                // collapses could flip it too.
+                const double lengths = glm::length(normalBefore) * glm::length(normalAfter);
+
+                if (glm::dot(normalBefore, normalAfter) <= lengths * kMeshSimplifierMinCosine) {
+                    valid = false;
+                    break;
+                }
+            }
+
+            if (!valid) continue;
+
+            quadrics[to] += quadrics[from];
+            collapsedTo[from] = to;
+            border[to] = border[to] || border[from];
+            versions[from]++;
+            versions[to]++;
+            reachedCost = std::max(reachedCost, collapse.cost);
+
+            for (std::uint32_t t : vertexTriangles[from])
+            {
+                if (!alive[t]) continue;
+
+                auto& triangle = triangles[t];
+                bool degenerate = false;
+
+                for (std::size_t k = 0; k < 3; ++k)
+                {
+                    if (triangle[k] == from) triangle[k] = to;
+                    else if (triangle[k] == to) degenerate = true;
+                }
+
+                if (degenerate) {
+                    alive[t] = 0;
+                    aliveCount--;
+                }
+
+                else {
+                    vertexTriangles[to].push_back(t);
+                }
+            }
+
+            vertexTriangles[from].clear();
+
+            // Drops the dead triangles of to, and pushes its edges again with the new quadric.
+
+            auto& around = vertexTriangles[to];
+            around.erase(std::remove_if(around.begin(), around.end(), [&alive](std::uint32_t t){ return !alive[t]; }), around.end());
+
+            neighbours.clear();
+
+            for (std::uint32_t t : around)
+            {
+                for (std::uint32_t vertex : triangles[t])
+                    if (vertex != to) neighbours.push_back(vertex);
+            }
+
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+            for (std::uint32_t neighbour : neighbours)
+                pushEdge(to, neighbour);
+        }
+
+        if (resultError) *resultError = static_cast < float >(std::sqrt(reachedCost));
+
+        // Corners that were never collapsed keep their original vertex; the others use the vertex they
+        // collapsed onto.
+
+        std::vector < std::uint32_t > result;
+        result.reserve(aliveCount * 3);
+
+        for (std::size_t t = 0; t < triangles.size(); ++t)
+        {
+            if (!alive[t]) continue;
+
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                const std::uint32_t corner = corners[t][k];
+                result.push_back(canonical[corner] == triangles[t][k] ? corner : triangles[t][k]);
+            }
+        }
+
+        return result;
+    }
+}
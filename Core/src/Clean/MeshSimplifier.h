@@ -0,0 +1,47 @@
+/** \file Core/MeshSimplifier.h
+**/
+
+#ifndef CLEAN_MESHSIMPLIFIER_H
+#define CLEAN_MESHSIMPLIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Clean
+{
+    //! @brief Weight of the planes added along open borders, relative to the planes of the triangles.
+    static constexpr const float kMeshSimplifierBorderWeight = 10.0f;
+
+    //! @brief Smallest cosine of the angle between the normals of a triangle before and after a collapse.
+    static constexpr const double kMeshSimplifierMinCosine = 0.2;
+
+    /*! @brief Simplifies a triangle list with the quadric error metric.
+     *
+     * Edges are collapsed by increasing error until the list has no more than targetIndexCount indexes,
+     * or until the next collapse would move the surface further than maxError. Each collapse moves a vertex
+     * onto one of its neighbours, so the result only references existing vertices: it is a new index buffer
+     * over the same vertex buffer. Collapses flipping a triangle are refused, and open borders are kept.
+     *
+     * Vertices sharing a position, like the ones duplicated along texture seams, are simplified as one
+     * vertex so seams don't open.
+     *
+     * \param[in] positions Position of the first vertex, as three floats.
+     * \param[in] vertexCount Number of vertices. Indexes must be lower.
+     * \param[in] stride Bytes between two positions. 12 if zero.
+     * \param[in] indexes Triangle list to simplify.
+     * \param[in] targetIndexCount Number of indexes to reach.
+     * \param[in] maxError Maximum distance between the surfaces, relative to the largest extent of the mesh.
+     * \param[out] resultError If not null, receives the largest relative error of the collapses done.
+     *
+     * \return The simplified triangle list. It has more than targetIndexCount indexes when maxError is reached
+     *      first, or when no valid collapse remains.
+     *
+    **/
+    std::vector < std::uint32_t > SimplifyMesh(const void* positions, std::size_t vertexCount, std::size_t stride,
+                                               std::vector < std::uint32_t > const& indexes,
+                                               std::size_t targetIndexCount, float maxError = 1.0f,
+                                               float* resultError = nullptr);
+}
+
+#endif // CLEAN_MESHSIMPLIFIER_H
@@ -0,0 +1,388 @@
+/** =======================================================
+ *  \file Core/MipmapGenerator.cpp
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#include "MipmapGenerator.h"
+#include "Allocate.h"
+#include "JobSystem.h"
+#include "NotificationCenter.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define CLEAN_MIPMAP_SSE2
+#endif
+
+namespace Clean
+{
+    /** @brief Describes one downsampling step, from a level to the next one. */
+    struct MipmapStep
+    {
+        const unsigned char* src;
+        std::size_t srcPitch;
+        std::size_t srcWidth;
+        std::size_t srcHeight;
+        unsigned char* dest;
+        std::size_t destWidth;
+        std::size_t destHeight;
+        std::size_t channels;
+        bool srgb;
+    };
+
+    /*! @brief Returns a table converting sRGB bytes to linear values in [0, 1]. */
+    static float const* MipmapSRGBToLinearTable()
+    {
+        static const std::array < float, 256 > table = []() {
+            std::array < float, 256 > result;
+            for (std::size_t i = 0; i < 256; ++i) {
+                const float c = static_cast < float >(i) / 255.0f;
+                result[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return result;
+        }();
+
+        return table.data();
+    }
+
+    /*! @brief Converts a linear value in [0, 1] to a sRGB byte, with a 4096 entries table. */
+    static std::uint8_t MipmapLinearToSRGB(float value)
+    {
+        static const std::array < std::uint8_t, 4096 > table = []() {
+            std::array < std::uint8_t, 4096 > result;
+            for (std::size_t i = 0; i < 4096; ++i) {
+                const float l = static_cast < float >(i) / 4095.0f;
+                const float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                result[i] = static_cast < std::uint8_t >(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+            return result;
+        }();
+
+        const std::size_t index = static_cast < std::size_t >(std::clamp(value, 0.0f, 1.0f) * 4095.0f + 0.5f);
+        return table[index];
+    }
+
+    /*! @brief Calls fn(first, last) on chunks of [0, rows) distributed between threads.
+     *  Chunks run on the JobSystem when Core exists, on threads of their own otherwise. **/
+    static void MipmapParallelRows(std::size_t rows, std::size_t threads, std::function < void(std::size_t, std::size_t) > const& fn)
+    {
+        if (!rows) return;
+
+        if (!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        // Small levels are not worth a thread.
+        threads = std::min(threads, std::max < std::size_t >(1, rows / 16));
+        const std::size_t rowsPerThread = (rows + threads - 1) / threads;
+
+        if (JobSystem* jobSystem = JobSystem::Find())
+        {
+            jobSystem->parallelFor(0, rows, rowsPerThread, fn);
+            return;
+        }
+
+        std::vector < std::thread > workers;
+        workers.reserve(threads);
+
+        for (std::size_t first = rowsPerThread; first < rows; first += rowsPerThread)
+            workers.emplace_back(fn, first, std::min(first + rowsPerThread, rows));
+
+        fn(0, std::min(rowsPerThread, rows));
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    /*! @brief Box filters rows [first, last) of the destination level. */
+    static void MipmapBoxRows(MipmapStep const& step, std::size_t first, std::size_t last)
+    {
+        float const* toLinear = MipmapSRGBToLinearTable();
+        const std::size_t channels = step.channels;
+
+        for (std::size_t y = first; y < last; ++y)
+        {
+            const unsigned char* row0 = step.src + std::min(2 * y, step.srcHeight - 1) * step.srcPitch;
+            const unsigned char* row1 = step.src + std::min(2 * y + 1, step.srcHeight - 1) * step.srcPitch;
+            unsigned char* out = step.dest + y * step.destWidth * channels;
+            std::size_t x = 0;
+
+#           ifdef CLEAN_MIPMAP_SSE2
+            // Two RGBA8 destination pixels per iteration: four source pixels from each row are widened
+            // to 16 bits, summed vertically then horizontally, and rounded back to 8 bits.
+            if (channels == 4 && !step.srgb && step.srcWidth == 2 * step.destWidth)
+            {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i two = _mm_set1_epi16(2);
+
+                for (; x + 2 <= step.destWidth; x += 2)
+                {
+                    const __m128i a = _mm_loadu_si128(reinterpret_cast < const __m128i* >(row0 + x * 8));
+                    const __m128i b = _mm_loadu_si128(reinterpret_cast < const __m128i* >(row1 + x * 8));
+                    const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                    const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                    const __m128i loSum = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+                    const __m128i hiSum = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+                    const __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(loSum, hiSum), two), 2);
+                    _mm_storel_epi64(reinterpret_cast < __m128i* >(out + x * 4), _mm_packus_epi16(sum, zero));
+                }
+            }
+#           endif
+
+            for (; x < step.destWidth; ++x)
+            {
+                const std::size_t x0 = std::min(2 * x, step.srcWidth - 1) * channels;
+                const std::size_t x1 = std::min(2 * x + 1, step.srcWidth - 1) * channels;
+
+                for (std::size_t c = 0; c < channels; ++c)
+                {
+                    if (step.srgb && c < 3)
+                    {
+                        const float sum = toLinear[row0[x0 + c]] + toLinear[row0[x1 + c]] + toLinear[row1[x0 + c]] + toLinear[row1[x1 + c]];
+                        out[x * channels + c] = MipmapLinearToSRGB(sum * 0.25f);
+                    }
+
+                    else
+                    {
+                        const unsigned sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                        out[x * channels + c] = static_cast < unsigned char >((sum + 2) / 4);
+                    }
+                }
+            }
+        }
+    }
+
+    /*! @brief Modified Bessel function of the first kind, order zero. */
+    static double MipmapBesselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    //! @brief Number of taps of the Kaiser filter, for a 2x downsampling.
+    static constexpr const std::size_t kMipmapKaiserTaps = 6;
+
+    /*! @brief Returns the normalized weights of the Kaiser filter. */
+    static float const* MipmapKaiserWeights()
+    {
+        static const std::array < float, kMipmapKaiserTaps > weights = []() {
+            constexpr double pi = 3.14159265358979323846;
+            constexpr double beta = 4.0;
+            constexpr double radius = 3.0;
+            std::array < float, kMipmapKaiserTaps > result;
+            double total = 0.0;
+
+            for (std::size_t k = 0; k < kMipmapKaiserTaps; ++k)
+            {
+                // Distance between the source pixel center and the destination pixel center, in source pixels.
+                const double d = static_cast < double >(k) - 2.5;
+                const double x = d / 2.0;
+                const double sinc = std::sin(pi * x) / (pi * x);
+                const double ratio = d / radius;
+                const double window = MipmapBesselI0(beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / MipmapBesselI0(beta);
+                result[k] = static_cast < float >(sinc * window);
+                total += result[k];
+            }
+
+            for (auto& w : result) w = static_cast < float >(w / total);
+            return result;
+        }();
+
+        return weights.data();
+    }
+
+    /*! @brief Filters with the separable Kaiser kernel: horizontally to a float buffer, then vertically. */
+    static void MipmapKaiser(MipmapStep const& step, std::size_t threads)
+    {
+        float const* weights = MipmapKaiserWeights();
+        float const* toLinear = MipmapSRGBToLinearTable();
+        const std::size_t channels = step.channels;
+        const std::size_t tmpPitch = step.destWidth * channels;
+        std::vector < float > tmp(tmpPitch * step.srcHeight);
+
+        MipmapParallelRows(step.srcHeight, threads, [&](std::size_t first, std::size_t last) {
+            for (std::size_t y = first; y < last; ++y)
+            {
+                const unsigned char* row = step.src + y * step.srcPitch;
+                float* out = tmp.data() + y * tmpPitch;
+
+                for (std::size_t x = 0; x < step.destWidth; ++x)
+                {
+                    for (std::size_t c = 0; c < channels; ++c)
+                    {
+                        float sum = 0.0f;
+
+                        for (std::size_t k = 0; k < kMipmapKaiserTaps; ++k)
+                        {
+                            const std::ptrdiff_t sx = static_cast < std::ptrdiff_t >(2 * x + k) - 2;
+                            const std::size_t clamped = static_cast < std::size_t >(std::clamp < std::ptrdiff_t >(sx, 0, step.srcWidth - 1));
+                            const unsigned char value = row[clamped * channels + c];
+                            sum += weights[k] * ((step.srgb && c < 3) ? toLinear[value] : value / 255.0f);
+                        }
+
+                        out[x * channels + c] = sum;
+                    }
+                }
+            }
+        });
+
+        MipmapParallelRows(step.destHeight, threads, [&](std::size_t first, std::size_t last) {
+            for (std::size_t y = first; y < last; ++y)
+            {
+                unsigned char* out = step.dest + y * tmpPitch;
+
+                for (std::size_t i = 0; i < tmpPitch; ++i)
+                {
+                    float sum = 0.0f;
+
+                    for (std::size_t k = 0; k < kMipmapKaiserTaps; ++k)
+                    {
+                        const std::ptrdiff_t sy = static_cast < std::ptrdiff_t >(2 * y + k) - 2;
+                        const std::size_t clamped = static_cast < std::size_t >(std::clamp < std::ptrdiff_t >(sy, 0, step.srcHeight - 1));
+                        sum += weights[k] * tmp[clamped * tmpPitch + i];
+                    }
+
+                    const std::size_t c = i % channels;
+                    out[i] = (step.srgb && c < 3) ? MipmapLinearToSRGB(sum)
+                                                  : static_cast < unsigned char >(std::clamp(sum, 0.0f, 1.0f) * 255.0f + 0.5f);
+                }
+            }
+        });
+    }
+
+    std::size_t MipmapGetLevelsCount(std::size_t width, std::size_t height)
+    {
+        std::size_t count = 1;
+        std::size_t size = std::max(width, height);
+
+        while (size > 1) {
+            size /= 2;
+            count++;
+        }
+
+        return count;
+    }
+
+    std::shared_ptr < PixelSet > MipmapGenerate(std::shared_ptr < PixelSet > const& src, std::uint8_t filter, bool srgb, std::size_t threads)
+    {
+        assert(src && src->data && "Null PixelSet given.");
+        const std::size_t channels = PixelFormatGetSize(src->format);
+
+        if (PixelFormatIsCompressed(src->format) || (channels != 3 && channels != 4))
+        {
+            NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "Can't generate mipmaps for PixelFormat %s.",
+                PixelFormatToString(src->format).data()));
+            return nullptr;
+        }
+
+        std::size_t width, height, pitch;
+        const unsigned char* base = src->data;
+
+        if (!src->levels.empty())
+        {
+            width = src->levels[0].width;
+            height = src->levels[0].height;
+            pitch = width * channels;
+            base += src->levels[0].offset;
+        }
+
+        else
+        {
+            width = src->lineWidth / channels;
+            height = src->columnsCount;
+            pitch = src->lineWidth;
+        }
+
+        if (!width || !height)
+            return nullptr;
+
+        auto result = AllocateShared < PixelSet >();
+        result->format = src->format;
+        result->lineWidth = width * channels;
+        result->columnsCount = height;
+
+        const std::size_t count = MipmapGetLevelsCount(width, height);
+        result->levels.reserve(count);
+        std::size_t totalSize = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            PixelSetLevel level;
+            level.width = std::max < std::size_t >(1, width >> i);
+            level.height = std::max < std::size_t >(1, height >> i);
+            level.offset = totalSize;
+            level.size = level.width * level.height * channels;
+            totalSize += level.size;
+            result->levels.push_back(level);
+        }
+
+        result->data = Allocate < unsigned char >(totalSize);
+
+        for (std::size_t y = 0; y < height; ++y)
+            memcpy(result->data + y * result->lineWidth, base + y * pitch, result->lineWidth);
+
+        for (std::size_t i = 1; i < count; ++i)
+        {
+            PixelSetLevel const& previous = result->levels[i - 1];
+            PixelSetLevel const& current = result->levels[i];
+
+            MipmapStep step;
+            step.src = result->data + previous.offset;
+            step.srcPitch = previous.width * channels;
+            step.srcWidth = previous.width;
+            step.srcHeight = previous.height;
+            step.dest = result->data + current.offset;
+            step.destWidth = current.width;
+            step.destHeight = current.height;
+            step.channels = channels;
+            step.srgb = srgb;
+
+            if (filter == kMipmapFilterKaiser)
+                MipmapKaiser(step, threads);
+
+            else
+                MipmapParallelRows(step.destHeight, threads, [&step](std::size_t first, std::size_t last) {
+                    MipmapBoxRows(step, first, last); });
+        }
+
+        return result;
+    }
+
+    std::shared_ptr < PixelSet > MipmapMakeLevelsView(std::shared_ptr < PixelSet > const& src, std::size_t firstLevel)
+    {
+        assert(src && src->data && "Null PixelSet given.");
+        assert(firstLevel < src->levels.size() && "Invalid level.");
+
+        PixelSetLevel const& first = src->levels[firstLevel];
+
+        auto result = AllocateShared < PixelSet >();
+        result->format = src->format;
+        result->data = src->data + first.offset;
+        result->columnsCount = first.height;
+        result->lineWidth = PixelFormatIsCompressed(src->format) ? PixelFormatGetLevelSize(src->format, first.width, 4)
+                                                                 : first.width * PixelFormatGetSize(src->format);
+
+        result->levels.reserve(src->levels.size() - firstLevel);
+
+        for (std::size_t i = firstLevel; i < src->levels.size(); ++i)
+        {
+            PixelSetLevel level = src->levels[i];
+            level.offset -= first.offset;
+            result->levels.push_back(level);
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,61 @@
+/** =======================================================
+ *  \file Core/MipmapGenerator.h
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#ifndef CLEAN_MIPMAPGENERATOR_H
+#define CLEAN_MIPMAPGENERATOR_H
+
+#include "PixelSet.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace Clean
+{
+    /** @defgroup MipmapFilters Mipmap filters
+     *  @brief Filters used to downsample one level to the next one.
+     *  @{
+    **/
+
+    //! @brief 2x2 average. Fastest, SIMD accelerated for linear RGBA8.
+    static constexpr const std::uint8_t kMipmapFilterBox = 0;
+
+    //! @brief 6x6 Kaiser-windowed sinc. Sharper levels, with less aliasing than box.
+    static constexpr const std::uint8_t kMipmapFilterKaiser = 1;
+
+    /** @} */
+
+    /*! @brief Returns the number of levels of a full mipmaps chain, down to 1x1. */
+    std::size_t MipmapGetLevelsCount(std::size_t width, std::size_t height);
+
+    /*! @brief Generates the full mipmaps chain of an RGB8 or RGBA8 PixelSet.
+     *
+     * Each level is filtered from the previous one. Rows of each level are split in the given
+     * number of chunks, filtered on the JobSystem's workers.
+     *
+     * \param src Source PixelSet. Only its base level is used: it is described by lineWidth (in bytes)
+     *      and columnsCount (number of rows), or by levels[0] if present.
+     * \param filter One of kMipmapFilterBox or kMipmapFilterKaiser.
+     * \param srgb If true, color channels are converted to linear space before filtering and back to
+     *      sRGB afterwards. Alpha is always filtered linearly.
+     * \param threads Number of chunks. Zero uses std::thread::hardware_concurrency().
+     *
+     * \return A new PixelSet with the same format and every level tightly packed, or nullptr if the
+     *      format is not supported.
+     *
+    **/
+    std::shared_ptr < PixelSet > MipmapGenerate(std::shared_ptr < PixelSet > const& src, std::uint8_t filter = kMipmapFilterBox,
+                                                bool srgb = false, std::size_t threads = 0);
+
+    /*! @brief Returns a PixelSet viewing levels [firstLevel, end) of another PixelSet, without copying.
+     *
+     * firstLevel becomes the base level of the view. As PixelSet does not own its data, the source
+     * PixelSet must stay alive as long as the view is used.
+     *
+    **/
+    std::shared_ptr < PixelSet > MipmapMakeLevelsView(std::shared_ptr < PixelSet > const& src, std::size_t firstLevel);
+}
+
+#endif // CLEAN_MIPMAPGENERATOR_H
@@ -5,23 +5,19 @@
 
 namespace Clean 
 {
+    ModuleManager::ModuleManager()
+    {
+        nameIndex = addIndex([](Module const& module){ return HashKey(module.name()); });
+        uuidIndex = addIndex([](Module const& module){ return std::hash < sole::uuid >()(module.uuid()); });
+    }
+    
     std::shared_ptr < Module > ModuleManager::findByName(std::string const& name)
     {
-        std::lock_guard < std::mutex > lck(managedListMutex);
-        auto check = std::find_if(managedList.begin(), managedList.end(), [name](std::shared_ptr < Module > const& managed) {
-            return managed->name() == name;
-        });
-        
-        return (check == managedList.end()) ? *check : nullptr;
+        return findIndexed(nameIndex, HashKey(name), [&name](Module const& module){ return module.name() == name; });
     }
     
     std::shared_ptr < Module > ModuleManager::findByUUID(sole::uuid const& uuid)
     {
-        std::lock_guard < std::mutex > lck(managedListMutex);
-        auto check = std::find_if(managedList.begin(), managedList.end(), [uuid](std::shared_ptr < Module > const& managed) {
-            return managed->uuid() == uuid;
-        });
-        
-        return (check == managedList.end()) ? *check : nullptr;
+        return findIndexed(uuidIndex, std::hash < sole::uuid >()(uuid), [&uuid](Module const& module){ return module.uuid() == uuid; });
     }
 }
@@ -18,10 +18,16 @@ namespace Clean
     **/
     class ModuleManager final : public Manager < Module >
     {
+        //! @brief Index of modules by name.
+        std::size_t nameIndex;
+        
+        //! @brief Index of modules by UUID.
+        std::size_t uuidIndex;
+        
     public:
         
-        /*! @brief Default constructor. */
-        ModuleManager() = default;
+        /*! @brief Constructs the manager and its indexes. */
+        ModuleManager();
         
         /*! @brief Default destructor. */
         ~ModuleManager() = default;
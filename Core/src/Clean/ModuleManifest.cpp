@@ -0,0 +1,125 @@
+/** \file Core/ModuleManifest.cpp
+**/
+
+#include "ModuleManifest.h"
+#include "FileLoaderRegistry.h"
+#include "NotificationCenter.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+namespace Clean
+{
+    ModuleManifest::ModuleManifest(std::string const& dynlibFile) : file(dynlibFile)
+    {
+
+    }
+
+    bool ModuleManifest::load(std::string const& path)
+    {
+        std::ifstream stream(path);
+        if (!stream) return false;
+
+        std::string line;
+        std::size_t lineNumber = 0;
+
+        while (std::getline(stream, line))
+        {
+            lineNumber++;
+
+            std::istringstream tokens(line);
+            std::string keyword, value;
+            if (!(tokens >> keyword) || keyword[0] == '#') continue;
+
+            if (keyword == "magic")
+            {
+                FileLoaderMagic magic;
+
+                if (!(tokens >> value) || !ParseMagic(value, magic.bytes) || ((tokens >> magic.offset).fail() && !tokens.eof()))
+                {
+                    NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelWarning,
+                        "Module manifest %s: invalid magic at line %zu.", path.data(), lineNumber));
+                    return false;
+                }
+
+                magics.push_back(std::move(magic));
+                continue;
+            }
+
+            std::vector < std::string >* values = nullptr;
+            if (keyword == "loader") values = &extensions;
+            else if (keyword == "driver") values = &drivers;
+
+            if (!values)
+            {
+                NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelWarning,
+                    "Module manifest %s: unknown keyword '%s' at line %zu.", path.data(), keyword.data(), lineNumber));
+                return false;
+            }
+
+            while (tokens >> value)
+                values->push_back(values == &extensions ? Platform::StringToLower(value) : value);
+        }
+
+        return true;
+    }
+
+    std::string const& ModuleManifest::getFile() const
+    {
+        return file;
+    }
+
+    bool ModuleManifest::providesExtension(std::string const& extension) const
+    {
+        return std::find(extensions.begin(), extensions.end(), Platform::StringToLower(extension)) != extensions.end();
+    }
+
+    bool ModuleManifest::providesContent(const void* bytes, std::size_t size) const
+    {
+        return std::any_of(magics.begin(), magics.end(), [bytes, size](FileLoaderMagic const& magic){
+            return FileLoaderRegistry::Matches(magic, bytes, size);
+        });
+    }
+
+    bool ModuleManifest::providesDriver(std::string const& name) const
+    {
+        return std::find(drivers.begin(), drivers.end(), name) != drivers.end();
+    }
+
+    bool ModuleManifest::providesLoaders() const
+    {
+        return !extensions.empty();
+    }
+
+    bool ModuleManifest::ParseMagic(std::string const& hex, std::string& bytes)
+    {
+        if (hex.empty() || hex.size() % 2)
+            return false;
+
+        bytes.clear();
+
+        for (std::size_t i = 0; i < hex.size(); i += 2)
+        {
+            if (!std::isxdigit(static_cast < unsigned char >(hex[i])) || !std::isxdigit(static_cast < unsigned char >(hex[i + 1])))
+                return false;
+
+            bytes.push_back(static_cast < char >(std::stoi(hex.substr(i, 2), nullptr, 16)));
+        }
+
+        return true;
+    }
+
+    std::string ModuleManifest::PathFor(std::string const& dynlibFile)
+    {
+        std::size_t dot = dynlibFile.find_last_of('.');
+        std::size_t separator = dynlibFile.find_last_of("/\\");
+
+        if (dot == std::string::npos || (separator != std::string::npos && dot < separator))
+            return dynlibFile + "." + kModuleManifestExtension;
+
+        return dynlibFile.substr(0, dot + 1) + kModuleManifestExtension;
+    }
+}
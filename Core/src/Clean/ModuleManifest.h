@@ -0,0 +1,87 @@
+/** \file Core/ModuleManifest.h
+**/
+
+#ifndef CLEAN_MODULEMANIFEST_H
+#define CLEAN_MODULEMANIFEST_H
+
+#include "FileLoader.h"
+
+#include <string>
+#include <vector>
+
+namespace Clean
+{
+    //! @brief Extension of a module manifest. It replaces the extension of the dynamic library it describes:
+    //! 'Modules/libGlDriver.so' is described by 'Modules/libGlDriver.module'.
+    static constexpr const char* kModuleManifestExtension = "module";
+
+    /** @brief Lists what the modules of a dynamic library provide, without loading it.
+     *
+     * Core::loadAllModules() reads the manifest next to each dynamic library. A library with a manifest
+     * is not loaded: it is loaded by the first Core::findFileLoader() or Core::findDriver() asking for
+     * something it provides. A library without one, or with an invalid one, is loaded at once.
+     *
+     * A manifest is a text file. Each line is a keyword followed by values separated by spaces, and lines
+     * starting with '#' are ignored:
+     * \code
+     *  # libOBJMeshLoader.module
+     *  loader obj mtl
+     *  magic 89504e47
+     *  driver Clean.MyDriver
+     * \endcode
+     *
+     * 'loader' lists the file extensions loaded by the FileLoaders the modules add, compared without case.
+     * 'magic' gives the bytes, in hexadecimal, found at the start of the files they load, optionally followed
+     * by their offset in the file: Core::findFileLoaderByContent() loads the library when they match.
+     * 'driver' lists the names of the Drivers the modules add.
+     *
+    **/
+    class ModuleManifest final
+    {
+        //! @brief Dynamic library described by this manifest.
+        std::string file;
+
+        //! @brief Extensions loadable by the library's FileLoaders, in lower case.
+        std::vector < std::string > extensions;
+
+        //! @brief Signatures of the files loadable by the library's FileLoaders.
+        std::vector < FileLoaderMagic > magics;
+
+        //! @brief Names of the library's Drivers.
+        std::vector < std::string > drivers;
+
+    public:
+
+        /*! @brief Constructs an empty manifest for the given dynamic library. */
+        ModuleManifest(std::string const& dynlibFile);
+
+        /*! @brief Reads the manifest at path. Returns false if it doesn't exist, or if a line is not valid, in
+         *  which case a notification is sent. */
+        bool load(std::string const& path);
+
+        /*! @brief Returns the dynamic library described by this manifest. */
+        std::string const& getFile() const;
+
+        /*! @brief Returns true if a FileLoader of the library loads extension. */
+        bool providesExtension(std::string const& extension) const;
+
+        /*! @brief Returns true if a FileLoader of the library loads files starting with bytes. */
+        bool providesContent(const void* bytes, std::size_t size) const;
+
+        /*! @brief Returns true if the library adds a Driver named name. */
+        bool providesDriver(std::string const& name) const;
+
+        /*! @brief Returns true if the library adds FileLoaders. */
+        bool providesLoaders() const;
+
+        /*! @brief Returns the path of the manifest describing a dynamic library. */
+        static std::string PathFor(std::string const& dynlibFile);
+
+    private:
+
+        /*! @brief Reads bytes written in hexadecimal. Returns false if hex is empty or not hexadecimal. */
+        static bool ParseMagic(std::string const& hex, std::string& bytes);
+    };
+}
+
+#endif // CLEAN_MODULEMANIFEST_H
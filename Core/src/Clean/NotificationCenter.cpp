@@ -3,33 +3,71 @@
 
 #include "NotificationCenter.h"
 
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+
+#include "Hash.h"
+
 namespace Clean
 {
     std::shared_ptr < NotificationCenter > NotificationCenter::defaultCenter = nullptr;
 
-    NotificationCenter::NotificationCenter(std::uint8_t m) : mode(m)
+    /*! @brief Returns the file name of a path given by __FILE__. */
+    static const char* NotificationSourceName(const char* file)
     {
-        if (mode == kNotificationCenterModeAsynchroneous)
+        const char* name = file;
+
+        for (const char* it = file; *it; ++it)
         {
-            exitLoopThread.store(false);
+            if (*it == '/' || *it == '\\')
+                name = it + 1;
+        }
 
-            loopThread = std::thread([this](){
+        return name;
+    }
 
-                while (!exitLoopThread)
-                {
-                    Notification notif;
-                    cachedNotifications.pop(notif);
+    /*! @brief Formats a message into a string, without allocating if its capacity is enough. */
+    static void NotificationFormat(std::string& message, const char* format, va_list args)
+    {
+        message.resize(kNotificationMessageCapacity);
+        int length = vsnprintf(&message[0], kNotificationMessageCapacity, format, args);
 
-                    std::lock_guard < std::mutex > lock(listenersMutex);
+        if (length < 0) length = 0;
+        if (length >= (int)kNotificationMessageCapacity) length = kNotificationMessageCapacity - 1;
 
-                    for (auto& listener : listeners)
-                    {
-                        assert(listener && "Null listener stored.");
-                        listener->process(notif);
-                    }
-                }
+        message.resize(static_cast < std::size_t >(length));
+    }
+
+    NotificationCenter::NotificationCenter(std::uint8_t m, std::size_t capacity)
+        : mode(m), slotsMask(0), enqueuePosition(0), dequeuePosition(0), droppedCount(0), droppedReported(0)
+        , minimumLevel(kNotificationLevelInfo)
+    {
+        exitLoopThread.store(false);
+        loopWaiting.store(false);
+        std::atomic_store(&listeners, std::make_shared < const std::vector < std::shared_ptr < NotificationListener > > >());
 
-            });
+        if (mode == kNotificationCenterModeAsynchroneous)
+        {
+            std::size_t count = 2;
+            while (count < capacity) count <<= 1;
+
+            // All notifications of the ring are allocated here: sending a notification only copies
+            // into a slot's strings, which keep their capacity.
+
+            slots.reset(new Slot[count]);
+            slotsMask = count - 1;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+                slots[i].notification.function.reserve(128);
+                slots[i].notification.file.reserve(256);
+                slots[i].notification.message.reserve(kNotificationMessageCapacity);
+            }
+
+            loopThread = std::thread([this](){ loop(); });
         }
     }
 
@@ -39,43 +77,325 @@ namespace Clean
     }
 
     void NotificationCenter::send(Notification const& notif)
+    {
+        if (isEnabled(notif.level, notif.file.data()))
+            dispatch(notif);
+    }
+
+    void NotificationCenter::dispatch(Notification const& notif)
     {
         if (mode)
         {
-            cachedNotifications.push(notif);
+            std::size_t position;
+            Slot* slot = acquireSlot(position);
+            if (!slot) return;
+
+            slot->notification.level = notif.level;
+            slot->notification.function.assign(notif.function);
+            slot->notification.file.assign(notif.file);
+            slot->notification.message.assign(notif.message);
+            publishSlot(*slot, position);
         }
 
         else
         {
             std::lock_guard < std::mutex > lock(listenersMutex);
+            deliver(notif);
+        }
+    }
 
-            for (auto& listener : listeners)
-            {
-                assert(listener && "Null listener stored.");
-                listener->process(notif);
-            }
+    void NotificationCenter::post(std::uint8_t level, const char* function, const char* file, const char* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        vpost(level, function, file, format, args);
+        va_end(args);
+    }
+
+    void NotificationCenter::vpost(std::uint8_t level, const char* function, const char* file, const char* format, va_list args)
+    {
+        assert(function && file && format && "Null string given to Clean::NotificationCenter::vpost.");
+
+        if (!isEnabled(level, file))
+            return;
+
+        Notification summary;
+        bool hasSummary = false;
+        bool accepted = throttle.accept(level, function, file, format, summary, hasSummary);
+
+        if (hasSummary)
+            dispatch(summary);
+
+        if (!accepted)
+            return;
+
+        if (mode)
+        {
+            std::size_t position;
+            Slot* slot = acquireSlot(position);
+            if (!slot) return;
+
+            slot->notification.level = level;
+            slot->notification.function.assign(function);
+            slot->notification.file.assign(file);
+            NotificationFormat(slot->notification.message, format, args);
+            publishSlot(*slot, position);
         }
+
+        else
+        {
+            Notification notif;
+            notif.level = level;
+            notif.function = function;
+            notif.file = file;
+            NotificationFormat(notif.message, format, args);
+
+            std::lock_guard < std::mutex > lock(listenersMutex);
+            deliver(notif);
+        }
+    }
+
+    void NotificationCenter::PostDefault(std::uint8_t level, const char* function, const char* file, const char* format, ...)
+    {
+        std::shared_ptr < NotificationCenter > center = GetDefault();
+        if (!center) return;
+
+        va_list args;
+        va_start(args, format);
+        center->vpost(level, function, file, format, args);
+        va_end(args);
+    }
+
+    bool NotificationCenter::isEnabled(std::uint8_t level, const char* file) const
+    {
+        std::shared_ptr < const SourceLevels > levels = std::atomic_load(&sourceLevels);
+
+        if (levels && file)
+        {
+            const char* name = NotificationSourceName(file);
+            auto it = levels->find(Hash64(name));
+            if (it != levels->end()) return level >= it->second;
+        }
+
+        return level >= minimumLevel.load(std::memory_order_relaxed);
+    }
+
+    void NotificationCenter::setLevel(std::uint8_t level)
+    {
+        minimumLevel.store(level);
+    }
+
+    std::uint8_t NotificationCenter::getLevel() const
+    {
+        return minimumLevel.load();
+    }
+
+    void NotificationCenter::setSourceLevel(std::string const& source, std::uint8_t level)
+    {
+        std::lock_guard < std::mutex > lock(listenersMutex);
+        std::shared_ptr < const SourceLevels > current = std::atomic_load(&sourceLevels);
+
+        auto levels = current ? std::make_shared < SourceLevels >(*current) : std::make_shared < SourceLevels >();
+        (*levels)[Hash64(source.data())] = level;
+        std::atomic_store(&sourceLevels, std::shared_ptr < const SourceLevels >(levels));
+    }
+
+    void NotificationCenter::resetSourceLevel(std::string const& source)
+    {
+        std::lock_guard < std::mutex > lock(listenersMutex);
+        std::shared_ptr < const SourceLevels > current = std::atomic_load(&sourceLevels);
+        if (!current) return;
+
+        auto levels = std::make_shared < SourceLevels >(*current);
+        levels->erase(Hash64(source.data()));
+
+        std::shared_ptr < const SourceLevels > result;
+        if (!levels->empty()) result = levels;
+        std::atomic_store(&sourceLevels, result);
+    }
+
+    std::uint64_t NotificationCenter::getDroppedCount() const
+    {
+        return droppedCount.load();
+    }
+
+    NotificationThrottle& NotificationCenter::getThrottle()
+    {
+        return throttle;
+    }
+
+    void NotificationCenter::flush()
+    {
+        std::vector < Notification > summaries;
+        throttle.collect(summaries, true);
+
+        for (auto const& summary : summaries)
+            dispatch(summary);
     }
 
     void NotificationCenter::addListener(std::shared_ptr < NotificationListener > const& listener)
     {
         std::lock_guard < std::mutex > lock(listenersMutex);
-        listeners.push_back(listener);
+        std::shared_ptr < const std::vector < std::shared_ptr < NotificationListener > > > current = std::atomic_load(&listeners);
+
+        auto result = std::make_shared < std::vector < std::shared_ptr < NotificationListener > > >(*current);
+        result->push_back(listener);
+        std::atomic_store(&listeners, std::shared_ptr < const std::vector < std::shared_ptr < NotificationListener > > >(result));
     }
 
     std::shared_ptr < NotificationCenter > NotificationCenter::GetDefault()
     {
         return std::atomic_load(&defaultCenter);
     }
-    
+
     void NotificationCenter::terminate()
     {
         if (mode && loopThread.joinable())
         {
-            exitLoopThread.store(true);
-            cachedNotifications.push(Notification());
-            
+            {
+                std::lock_guard < std::mutex > lock(loopMutex);
+                exitLoopThread.store(true);
+            }
+
+            loopCondition.notify_one();
             loopThread.join();
         }
     }
+
+    NotificationCenter::Slot* NotificationCenter::acquireSlot(std::size_t& position)
+    {
+        position = enqueuePosition.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            Slot& slot = slots[position & slotsMask];
+            std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            std::intptr_t difference = (std::intptr_t)sequence - (std::intptr_t)position;
+
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    return &slot;
+            }
+
+            else if (difference < 0)
+            {
+                // The loop thread has not delivered this slot yet: the ring is full.
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            else
+            {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void NotificationCenter::publishSlot(Slot& slot, std::size_t position)
+    {
+        slot.sequence.store(position + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (loopWaiting.load())
+        {
+            std::lock_guard < std::mutex > lock(loopMutex);
+            loopCondition.notify_one();
+        }
+    }
+
+    void NotificationCenter::deliver(Notification const& notif)
+    {
+        std::shared_ptr < const std::vector < std::shared_ptr < NotificationListener > > > current = std::atomic_load(&listeners);
+
+        for (auto const& listener : *current)
+        {
+            assert(listener && "Null listener stored.");
+            listener->process(notif);
+        }
+    }
+
+    bool NotificationCenter::deliverPublished()
+    {
+        bool delivered = false;
+
+        while (true)
+        {
+            Slot& slot = slots[dequeuePosition & slotsMask];
+            std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+            // Slots are published in any order by senders: stop at the first one not published yet.
+            if (sequence != dequeuePosition + 1)
+                break;
+
+            deliver(slot.notification);
+
+            slot.sequence.store(dequeuePosition + slotsMask + 1, std::memory_order_release);
+            ++dequeuePosition;
+            delivered = true;
+        }
+
+        return delivered;
+    }
+
+    void NotificationCenter::reportDropped()
+    {
+        std::uint64_t dropped = droppedCount.load();
+        if (dropped == droppedReported) return;
+
+        Notification notif = BuildNotification(kNotificationLevelWarning, "%llu notifications dropped: NotificationCenter's ring is full.",
+            static_cast < unsigned long long >(dropped - droppedReported));
+        droppedReported = dropped;
+
+        deliver(notif);
+    }
+
+    void NotificationCenter::loop()
+    {
+        std::chrono::steady_clock::time_point lastCollect = std::chrono::steady_clock::now();
+        std::vector < Notification > summaries;
+
+        while (true)
+        {
+            bool delivered = deliverPublished();
+            reportDropped();
+
+            // Summaries of notifications coalesced by the throttle are delivered here, so a notification
+            // sent in a burst and never again is still summarized.
+
+            const bool exiting = !delivered && exitLoopThread.load();
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            if (exiting || now - lastCollect >= std::chrono::milliseconds(250))
+            {
+                lastCollect = now;
+                throttle.collect(summaries, exiting);
+
+                for (auto const& summary : summaries)
+                    deliver(summary);
+
+                summaries.clear();
+            }
+
+            if (delivered)
+                continue;
+
+            if (exiting)
+                break;
+
+            // loopWaiting is set before checking the ring again, so a sender publishing now notifies us. The
+            // timeout only bounds the latency of a notification published between the check and the wait.
+
+            std::unique_lock < std::mutex > lock(loopMutex);
+            loopWaiting.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            Slot& slot = slots[dequeuePosition & slotsMask];
+
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1 && !exitLoopThread.load())
+                loopCondition.wait_for(lock, std::chrono::milliseconds(50));
+
+            loopWaiting.store(false);
+        }
+    }
 }
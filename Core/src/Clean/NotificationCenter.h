@@ -6,13 +6,17 @@
 
 #include "NotificationListener.h"
 #include "Notification.h"
-#include "ConcurrentQueue.h"
+#include "NotificationThrottle.h"
 
+#include <cstdarg>
 #include <cstdint>
 #include <memory>
-#include <list>
+#include <vector>
+#include <unordered_map>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 namespace Clean
 {
@@ -24,6 +28,21 @@ namespace Clean
     //! @brief Asynchroneous mode for NotificationCenter.
     static constexpr const std::uint8_t kNotificationCenterModeAsynchroneous = 1;
 
+    //! @brief Default number of notifications the asynchroneous ring can hold.
+    static constexpr const std::size_t kNotificationCenterDefaultCapacity = 1024;
+
+    //! @brief Size reserved for each notification's message in the ring. Longer messages are truncated.
+    static constexpr const std::size_t kNotificationMessageCapacity = 1024;
+
+    /*! @brief Sends a notification through the default center, if its level and source are enabled.
+     *
+     * Unlike sending BuildNotification(), the message is not formatted when the notification is filtered
+     * out, and in asynchroneous mode it is formatted directly into the center's ring. Prefer it in code
+     * called every frame.
+     *
+    **/
+#   define PostNotification(level, format, ...) ::Clean::NotificationCenter::PostDefault(level, __FUNCTION__, __FILE__, format, __VA_ARGS__)
+
     /*! @brief Manages NotificationListener and groups notifications.
      *
      * NotificationCenter is a rally point for all notifications in the engine. A
@@ -36,13 +55,36 @@ namespace Clean
      *
      * To send a notification, you can use NotificationCenter::send() with the appropriate
      * Notification object. A Notification can be built with BuildNotification() defined in
-     * \ref Notification.h.
+     * \ref Notification.h. PostNotification() filters and formats it in one call.
+     *
+     * In multithreaded mode, notifications are stored in a bounded ring allocated with the center.
+     * Senders never lock: when the ring is full, the notification is dropped and counted, and the loop
+     * thread reports the number of dropped notifications to listeners.
+     *
+     * Notifications below the center's level, or below the level set for their source file with
+     * \ref setSourceLevel(), are discarded before being formatted. Notifications sent with PostNotification()
+     * are then given to the center's NotificationThrottle, which coalesces repeated notifications.
      *
     **/
     class NotificationCenter final
     {
-        //! @brief Listeners associated to this center.
-        std::list < std::shared_ptr < NotificationListener > > listeners;
+        /** @brief A notification stored in the ring. */
+        struct Slot
+        {
+            //! @brief Position of the slot in the ring: equal to the enqueue position when free, and to
+            //! this position + 1 once the notification is published.
+            std::atomic < std::size_t > sequence;
+
+            //! @brief Notification stored. Its strings keep their capacity between uses.
+            Notification notification;
+        };
+
+        //! @brief Table of levels by source, keyed by the Hash64 of the source's file name.
+        typedef std::unordered_map < std::uint64_t, std::uint8_t > SourceLevels;
+
+        //! @brief Listeners associated to this center. Replaced by addListener(), so delivering
+        //! notifications only needs to load the current list.
+        std::shared_ptr < const std::vector < std::shared_ptr < NotificationListener > > > listeners;
 
         //! @brief Mode actually used to send notifications. 1 is asynchroneous (multithreaded),
         //! 0 is synchroneous (monothreaded). While asynchroneous is faster on multiple CPUs,
@@ -52,14 +94,48 @@ namespace Clean
         //! @brief When multithreaded, holds the emitting thread loop.
         std::thread loopThread;
 
-        //! @brief Mutex to protect listeners.
+        //! @brief Mutex to protect listeners and sourceLevels modifications, and to serialize listeners in
+        //! synchroneous mode.
         std::mutex listenersMutex;
 
         //! @brief Flag to exit the loop thread.
         std::atomic_bool exitLoopThread;
 
-        //! @brief In multithreaded mode, stores notifications to send.
-        ConcurrentQueue < Notification > cachedNotifications;
+        //! @brief In multithreaded mode, slots of the ring.
+        std::unique_ptr < Slot[] > slots;
+
+        //! @brief Number of slots minus one. The number of slots is a power of two.
+        std::size_t slotsMask;
+
+        //! @brief Next position to enqueue a notification.
+        std::atomic < std::size_t > enqueuePosition;
+
+        //! @brief Next position read by the loop thread.
+        std::size_t dequeuePosition;
+
+        //! @brief True while the loop thread waits for notifications.
+        std::atomic_bool loopWaiting;
+
+        //! @brief Protects loopCondition.
+        std::mutex loopMutex;
+
+        //! @brief Notified when a notification is published while the loop thread waits.
+        std::condition_variable loopCondition;
+
+        //! @brief Number of notifications dropped because the ring was full.
+        std::atomic < std::uint64_t > droppedCount;
+
+        //! @brief Number of dropped notifications already reported by the loop thread.
+        std::uint64_t droppedReported;
+
+        //! @brief Lowest level sent to listeners.
+        std::atomic < std::uint8_t > minimumLevel;
+
+        //! @brief Levels by source. Null when no source has its level.
+        std::shared_ptr < const SourceLevels > sourceLevels;
+
+        //! @brief Coalesces notifications sent by post().
+        NotificationThrottle throttle;
 
         //! @brief Default NotificationCenter registered by Core.
         static std::shared_ptr < NotificationCenter > defaultCenter;
@@ -69,10 +145,10 @@ namespace Clean
 
     public:
 
-        /*! @brief Constructs the center. If mode is multithreaded, actually launches the
-         * loop thread.
+        /*! @brief Constructs the center. If mode is multithreaded, allocates a ring of at least
+         * capacity notifications and actually launches the loop thread.
         **/
-        NotificationCenter(std::uint8_t m = kNotificationCenterModeAsynchroneous);
+        NotificationCenter(std::uint8_t m = kNotificationCenterModeAsynchroneous, std::size_t capacity = kNotificationCenterDefaultCapacity);
 
         /*! @brief Destruct the center.
          * If in multithreaded mode, wait for the loop thread to exit.
@@ -82,14 +158,77 @@ namespace Clean
         /*! @brief Sends given notification through all listeners. */
         void send(Notification const& notif);
 
+        /*! @brief Formats and sends a notification if enabled. See PostNotification(). */
+        void post(std::uint8_t level, const char* function, const char* file, const char* format, ...);
+
+        /*! @brief Formats and sends a notification if enabled. */
+        void vpost(std::uint8_t level, const char* function, const char* file, const char* format, va_list args);
+
+        /*! @brief Calls post() on the default center, if any. */
+        static void PostDefault(std::uint8_t level, const char* function, const char* file, const char* format, ...);
+
+        /*! @brief Returns true if a notification of this level, sent from this file, reaches listeners. */
+        bool isEnabled(std::uint8_t level, const char* file) const;
+
+        /*! @brief Sets the lowest level sent to listeners. Default is kNotificationLevelInfo. */
+        void setLevel(std::uint8_t level);
+
+        /*! @brief Returns the lowest level sent to listeners. */
+        std::uint8_t getLevel() const;
+
+        /*! @brief Sets the lowest level sent to listeners for notifications sent from a source file.
+         *
+         * \param source File name of the source, without its directory (for example 'GlDriver.cpp').
+         * \param level Lowest level for this source. It replaces the center's level for this source.
+         *
+        **/
+        void setSourceLevel(std::string const& source, std::uint8_t level);
+
+        /*! @brief Removes the level set for a source file. */
+        void resetSourceLevel(std::string const& source);
+
+        /*! @brief Returns the number of notifications dropped because the ring was full. */
+        std::uint64_t getDroppedCount() const;
+
+        /*! @brief Returns the throttle of notifications sent by post(), to change its limits or read its counters. */
+        NotificationThrottle& getThrottle();
+
+        /*! @brief Sends the summaries of all notifications coalesced by the throttle.
+         *  In asynchroneous mode, the loop thread sends them periodically.
+        **/
+        void flush();
+
         /*! @brief Adds a listener to notifications. */
         void addListener(std::shared_ptr < NotificationListener > const& listener);
 
         /*! @brief Returns defaultCenter. */
         static std::shared_ptr < NotificationCenter > GetDefault();
-        
-        /*! @brief Terminates the notification loop. */
+
+        /*! @brief Terminates the notification loop. Notifications already in the ring are delivered. */
         void terminate();
+
+    private:
+
+        /*! @brief Sends a notification without filtering it. */
+        void dispatch(Notification const& notif);
+
+        /*! @brief Reserves a slot in the ring. Returns null and counts a drop if the ring is full. */
+        Slot* acquireSlot(std::size_t& position);
+
+        /*! @brief Makes a slot acquired by acquireSlot() visible to the loop thread. */
+        void publishSlot(Slot& slot, std::size_t position);
+
+        /*! @brief Delivers a notification to all listeners. */
+        void deliver(Notification const& notif);
+
+        /*! @brief Delivers all published notifications. Returns false if the ring was empty. */
+        bool deliverPublished();
+
+        /*! @brief Delivers a notification counting the drops since the last call, if any. */
+        void reportDropped();
+
+        /*! @brief Runs the loop thread. */
+        void loop();
     };
 }
 
@@ -0,0 +1,164 @@
+/** \file Core/NotificationThrottle.cpp
+**/
+
+#include "NotificationThrottle.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include "Hash.h"
+
+namespace Clean
+{
+    NotificationThrottle::NotificationThrottle(std::chrono::milliseconds p, std::uint32_t b)
+        : period(p.count()), burst(b)
+    {
+
+    }
+
+    bool NotificationThrottle::accept(std::uint8_t level, const char* function, const char* file, const char* format, Notification& summary, bool& summaryFilled)
+    {
+        assert(function && file && format && "Null string given to Clean::NotificationThrottle::accept.");
+        summaryFilled = false;
+
+        const std::uint32_t limit = burst.load(std::memory_order_relaxed);
+        if (!limit) return true;
+
+        const std::uint64_t key = MakeKey(file, format);
+        const Clock::time_point now = Clock::now();
+        const std::chrono::milliseconds duration(period.load(std::memory_order_relaxed));
+
+        Shard& shard = shards[key & (kShardsCount - 1)];
+        std::scoped_lock < std::mutex > lck(shard.mutex);
+
+        auto it = shard.entries.find(key);
+
+        if (it == shard.entries.end())
+        {
+            Entry entry;
+            entry.level = level;
+            entry.function = function;
+            entry.counter.file = file;
+            entry.counter.format = format;
+            entry.periodStart = now;
+            it = shard.entries.emplace(key, std::move(entry)).first;
+        }
+
+        Entry& entry = it->second;
+
+        if (now - entry.periodStart >= duration)
+        {
+            if (entry.periodCount > limit)
+            {
+                Summarize(entry, limit, now, summary);
+                summaryFilled = true;
+            }
+
+            entry.periodStart = now;
+            entry.periodCount = 0;
+        }
+
+        entry.counter.occurrences++;
+        entry.periodCount++;
+
+        if (entry.periodCount <= limit)
+            return true;
+
+        entry.counter.suppressed++;
+        return false;
+    }
+
+    void NotificationThrottle::collect(std::vector < Notification >& summaries, bool force)
+    {
+        const std::uint32_t limit = burst.load(std::memory_order_relaxed);
+        const Clock::time_point now = Clock::now();
+        const std::chrono::milliseconds duration(period.load(std::memory_order_relaxed));
+
+        for (Shard& shard : shards)
+        {
+            std::scoped_lock < std::mutex > lck(shard.mutex);
+
+            for (auto& pair : shard.entries)
+            {
+                Entry& entry = pair.second;
+
+                if (entry.periodCount > limit && (force || now - entry.periodStart >= duration))
+                {
+                    Notification summary;
+                    Summarize(entry, limit, now, summary);
+                    summaries.push_back(std::move(summary));
+                }
+            }
+        }
+    }
+
+    void NotificationThrottle::setLimits(std::chrono::milliseconds p, std::uint32_t b)
+    {
+        period.store(p.count());
+        burst.store(b);
+    }
+
+    std::chrono::milliseconds NotificationThrottle::getPeriod() const
+    {
+        return std::chrono::milliseconds(period.load());
+    }
+
+    std::vector < NotificationThrottleCounter > NotificationThrottle::getCounters() const
+    {
+        std::vector < NotificationThrottleCounter > result;
+
+        for (Shard& shard : shards)
+        {
+            std::scoped_lock < std::mutex > lck(shard.mutex);
+
+            for (auto const& pair : shard.entries)
+                result.push_back(pair.second.counter);
+        }
+
+        return result;
+    }
+
+    std::uint64_t NotificationThrottle::getOccurrences(const char* file, const char* format) const
+    {
+        const std::uint64_t key = MakeKey(file, format);
+        Shard& shard = shards[key & (kShardsCount - 1)];
+        std::scoped_lock < std::mutex > lck(shard.mutex);
+
+        auto it = shard.entries.find(key);
+        return it != shard.entries.end() ? it->second.counter.occurrences : 0;
+    }
+
+    void NotificationThrottle::clear()
+    {
+        for (Shard& shard : shards)
+        {
+            std::scoped_lock < std::mutex > lck(shard.mutex);
+            shard.entries.clear();
+        }
+    }
+
+    std::uint64_t NotificationThrottle::MakeKey(const char* file, const char* format)
+    {
+        return (Hash64(file) * HashDetail::Prime64Const) ^ Hash64(format);
+    }
+
+    void NotificationThrottle::Summarize(Entry& entry, std::uint32_t limit, Clock::time_point now, Notification& summary)
+    {
+        const double seconds = std::chrono::duration < double >(now - entry.periodStart).count();
+        const unsigned long long count = static_cast < unsigned long long >(entry.periodCount);
+        const unsigned long long suppressed = static_cast < unsigned long long >(entry.periodCount - limit);
+
+        char buffer[1024];
+        snprintf(buffer, sizeof(buffer), "%llu occurrences in the last %.1f seconds (%llu not delivered): %s",
+            count, seconds, suppressed, entry.counter.format.data());
+
+        summary.level = entry.level;
+        summary.function = entry.function;
+        summary.file = entry.counter.file;
+        summary.message = buffer;
+
+        entry.periodStart = now;
+        entry.periodCount = 0;
+    }
+}
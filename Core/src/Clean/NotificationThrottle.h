@@ -0,0 +1,144 @@
+/** \file Core/NotificationThrottle.h
+**/
+
+#ifndef CLEAN_NOTIFICATIONTHROTTLE_H
+#define CLEAN_NOTIFICATIONTHROTTLE_H
+
+#include "Notification.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Clean
+{
+    //! @brief Default period during which repeated notifications are coalesced.
+    static constexpr const std::chrono::milliseconds kNotificationThrottleDefaultPeriod = std::chrono::milliseconds(5000);
+
+    //! @brief Default number of notifications with the same fingerprint delivered in each period.
+    static constexpr const std::uint32_t kNotificationThrottleDefaultBurst = 1;
+
+    /** @brief Counters of a notification fingerprint, as returned by NotificationThrottle::getCounters(). */
+    struct NotificationThrottleCounter
+    {
+        //! @brief Source file of the notification.
+        std::string file;
+
+        //! @brief Format string of the notification.
+        std::string format;
+
+        //! @brief Number of notifications sent with this fingerprint.
+        std::uint64_t occurrences = 0;
+
+        //! @brief Number of those notifications not delivered to listeners.
+        std::uint64_t suppressed = 0;
+    };
+
+    /** @brief Coalesces repeated notifications.
+     *
+     * A notification is fingerprinted by its source file and its format string, so the same message sent
+     * for different objects has one fingerprint. In each period, only the first 'burst' notifications of a
+     * fingerprint are delivered. When the period ends, the others are summarized by one notification
+     * telling how many occurred.
+     *
+     * NotificationCenter throttles notifications sent with PostNotification(). Its loop thread sends the
+     * summaries of fingerprints not sent anymore; in synchroneous mode, they are sent with the next
+     * notification of the same fingerprint, or by NotificationCenter::flush().
+     *
+    **/
+    class NotificationThrottle
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        /** @brief State of a fingerprint. */
+        struct Entry
+        {
+            //! @brief Level of the first notification with this fingerprint.
+            std::uint8_t level = 0;
+
+            //! @brief Function of the first notification with this fingerprint.
+            std::string function;
+
+            //! @brief Counters and strings of the fingerprint.
+            NotificationThrottleCounter counter;
+
+            //! @brief Start of the current period.
+            Clock::time_point periodStart;
+
+            //! @brief Notifications sent in the current period.
+            std::uint64_t periodCount = 0;
+        };
+
+        /** @brief Part of the fingerprints, with its own mutex so threads sending different
+         *  notifications rarely wait for each other. */
+        struct Shard
+        {
+            std::mutex mutex;
+            std::unordered_map < std::uint64_t, Entry > entries;
+        };
+
+        //! @brief Number of shards. Must be a power of two.
+        static constexpr const std::size_t kShardsCount = 16;
+
+        //! @brief Fingerprints, by shard.
+        mutable std::array < Shard, kShardsCount > shards;
+
+        //! @brief Period in milliseconds.
+        std::atomic < std::int64_t > period;
+
+        //! @brief Notifications delivered by fingerprint in each period. Zero disables throttling.
+        std::atomic < std::uint32_t > burst;
+
+    public:
+
+        /*! @brief Constructs a throttle. */
+        NotificationThrottle(std::chrono::milliseconds period = kNotificationThrottleDefaultPeriod, std::uint32_t burst = kNotificationThrottleDefaultBurst);
+
+        /*! @brief Counts a notification and returns true if it must be delivered.
+         *
+         * \param level Level of the notification.
+         * \param function Function sending the notification.
+         * \param file Source file sending the notification.
+         * \param format Format string of the notification.
+         * \param summary If the previous period of this fingerprint suppressed notifications, filled with
+         *      their summary and the function returns with summaryFilled set to true.
+         *
+        **/
+        bool accept(std::uint8_t level, const char* function, const char* file, const char* format, Notification& summary, bool& summaryFilled);
+
+        /*! @brief Fills summaries of the fingerprints whose period ended with suppressed notifications.
+         *  If force is true, the current periods are ended too.
+        **/
+        void collect(std::vector < Notification >& summaries, bool force = false);
+
+        /*! @brief Sets the period and the number of notifications delivered in each period. */
+        void setLimits(std::chrono::milliseconds period, std::uint32_t burst);
+
+        /*! @brief Returns the period. */
+        std::chrono::milliseconds getPeriod() const;
+
+        /*! @brief Returns the counters of all fingerprints. */
+        std::vector < NotificationThrottleCounter > getCounters() const;
+
+        /*! @brief Returns the number of notifications sent with this file and format. */
+        std::uint64_t getOccurrences(const char* file, const char* format) const;
+
+        /*! @brief Removes all fingerprints and their counters. */
+        void clear();
+
+    private:
+
+        /*! @brief Returns the fingerprint of a notification. */
+        static std::uint64_t MakeKey(const char* file, const char* format);
+
+        /*! @brief Fills a summary of the current period of entry, and starts a new period. */
+        static void Summarize(Entry& entry, std::uint32_t burst, Clock::time_point now, Notification& summary);
+    };
+}
+
+#endif // CLEAN_NOTIFICATIONTHROTTLE_H
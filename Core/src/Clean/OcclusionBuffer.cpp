@@ -0,0 +1,363 @@
+/** \file Core/OcclusionBuffer.cpp
+**/
+
+#include "OcclusionBuffer.h"
+#include "Mesh.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <glm/vec4.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define CLEAN_OCCLUSION_SSE2
+#endif
+
+namespace Clean
+{
+    OcclusionBuffer::OcclusionBuffer(std::size_t w, std::size_t h)
+    : width((std::max < std::size_t >(w, 4) + 3) & ~std::size_t(3)), height(std::max < std::size_t >(h, 1)), viewProjection(1.0f)
+    {
+        // Each level halves the size of the previous one, rounded up, down to a single texel.
+
+        std::size_t levelWidth = width, levelHeight = height;
+
+        while (true)
+        {
+            levelWidths.push_back(levelWidth);
+            levelHeights.push_back(levelHeight);
+            levels.emplace_back(levelWidth * levelHeight, 1.0f);
+
+            if (levelWidth == 1 && levelHeight == 1) break;
+            levelWidth = (levelWidth + 1) / 2;
+            levelHeight = (levelHeight + 1) / 2;
+        }
+    }
+
+    void OcclusionBuffer::begin(glm::mat4 const& vp)
+    {
+        viewProjection = vp;
+        triangles.clear();
+
+        for (auto& level : levels)
+            std::fill(level.begin(), level.end(), 1.0f);
+    }
+
+    void OcclusionBuffer::addOccluder(std::vector < glm::vec3 > const& positions, std::vector < std::uint32_t > const& indexes, glm::mat4 const& model)
+    {
+        const glm::mat4 matrix = viewProjection * model;
+
+        std::vector < glm::vec4 > clip(positions.size());
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            clip[i] = matrix * glm::vec4(positions[i], 1.0f);
+
+        for (std::size_t i = 0; i + 2 < indexes.size(); i += 3)
+        {
+            const std::uint32_t a = indexes[i], b = indexes[i + 1], c = indexes[i + 2];
+            if (a >= clip.size() || b >= clip.size() || c >= clip.size()) continue;
+
+            addClipTriangle(clip[a], clip[b], clip[c]);
+        }
+    }
+
+    void OcclusionBuffer::addOccluder(Mesh const& mesh, glm::mat4 const& model)
+    {
+        std::vector < glm::vec3 > positions;
+        std::vector < std::uint32_t > indexes;
+        // Simplified levels of detail may extend past the original silhouette: only the full mesh hides
+        // exactly what it covers.
+        mesh.findTriangles(positions, indexes, 0);
+        addOccluder(positions, indexes, model);
+    }
+
+    void OcclusionBuffer::rasterize()
+    {
+        ProfileScope("OcclusionBuffer::rasterize");
+        ProfileCount("occluderTriangles", static_cast < std::int64_t >(triangles.size()));
+
+        // Triangles are binned by bands of rows, so each job only walks the triangles crossing its band.
+
+        const std::size_t bandCount = (height + kOcclusionBufferBandHeight - 1) / kOcclusionBufferBandHeight;
+        std::vector < std::vector < std::uint32_t > > bins(bandCount);
+
+        for (std::size_t i = 0; i < triangles.size(); ++i)
+        {
+            auto const& v = triangles[i].vertices;
+            const float minY = std::min(v[0].y, std::min(v[1].y, v[2].y));
+            const float maxY = std::max(v[0].y, std::max(v[1].y, v[2].y));
+            if (maxY < 0.0f || minY >= static_cast < float >(height)) continue;
+
+            const std::size_t first = static_cast < std::size_t >(std::max(minY, 0.0f)) / kOcclusionBufferBandHeight;
+            const std::size_t last = static_cast < std::size_t >(std::min(maxY, static_cast < float >(height - 1))) / kOcclusionBufferBandHeight;
+
+            for (std::size_t band = first; band <= last; ++band)
+                bins[band].push_back(static_cast < std::uint32_t >(i));
+        }
+
+        auto fn = [this, &bins](std::size_t first, std::size_t last){
+            for (std::size_t band = first; band < last; ++band)
+                rasterizeBand(bins[band], band * kOcclusionBufferBandHeight, std::min((band + 1) * kOcclusionBufferBandHeight, height));
+        };
+
+        if (JobSystem* jobSystem = JobSystem::Find())
+            jobSystem->parallelFor(0, bandCount, 1, fn);
+        else
+            fn(0, bandCount);
+
+        buildHierarchy();
+    }
+
+    bool OcclusionBuffer::isVisible(BoundingBox const& box) const
+    {
+        if (box.empty())
+            return true;
+
+        // The rectangle covering the projected corners, at the depth of the nearest one. A box crossing the
+        // near plane can't be projected: it is visible.
+
+        float minX = HUGE_VALF, minY = HUGE_VALF, maxX = -HUGE_VALF, maxY = -HUGE_VALF, minDepth = HUGE_VALF;
+
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            const glm::vec3 corner((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z);
+            const glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+
+            if (clip.w <= 1e-6f || clip.z < -clip.w)
+                return true;
+
+            const float invW = 1.0f / clip.w;
+            minX = std::min(minX, clip.x * invW); maxX = std::max(maxX, clip.x * invW);
+            minY = std::min(minY, clip.y * invW); maxY = std::max(maxY, clip.y * invW);
+            minDepth = std::min(minDepth, clip.z * invW * 0.5f + 0.5f);
+        }
+
+        const float fw = static_cast < float >(width), fh = static_cast < float >(height);
+        const float x0 = (minX * 0.5f + 0.5f) * fw, x1 = (maxX * 0.5f + 0.5f) * fw;
+        const float y0 = (minY * 0.5f + 0.5f) * fh, y1 = (maxY * 0.5f + 0.5f) * fh;
+
+        if (x1 < 0.0f || y1 < 0.0f || x0 >= fw || y0 >= fh)
+            return true;
+
+        const std::size_t left = static_cast < std::size_t >(std::max(x0, 0.0f));
+        const std::size_t right = static_cast < std::size_t >(std::min(x1, fw - 1.0f));
+        const std::size_t bottom = static_cast < std::size_t >(std::max(y0, 0.0f));
+        const std::size_t top = static_cast < std::size_t >(std::min(y1, fh - 1.0f));
+
+        // Goes up the hierarchy until the rectangle covers a few texels.
+
+        std::size_t level = 0;
+        std::size_t size = std::max(right - left, top - bottom) + 1;
+
+        while (size > kOcclusionBufferTestSize && level + 1 < levels.size())
+        {
+            size = (size + 1) / 2;
+            level++;
+        }
+
+        auto const& depths = levels[level];
+        const std::size_t levelWidth = levelWidths[level];
+
+        for (std::size_t y = bottom >> level; y <= (top >> level); ++y)
+        {
+            for (std::size_t x = left >> level; x <= (right >> level); ++x)
+            {
+                if (depths[y * levelWidth + x] >= minDepth)
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    float OcclusionBuffer::getDepth(std::size_t x, std::size_t y) const
+    {
+        assert(x < width && y < height && "Pixel out of OcclusionBuffer.");
+        return levels[0][y * width + x];
+    }
+
+    std::size_t OcclusionBuffer::getWidth() const
+    {
+        return width;
+    }
+
+    std::size_t OcclusionBuffer::getHeight() const
+    {
+        return height;
+    }
+
+    std::size_t OcclusionBuffer::getTriangleCount() const
+    {
+        return triangles.size();
+    }
+
+    void OcclusionBuffer::addClipTriangle(glm::vec4 const& a, glm::vec4 const& b, glm::vec4 const& c)
+    {
+        // Triangles entirely outside one of the side or far planes are dropped.
+
+        for (std::size_t axis = 0; axis < 3; ++axis)
+        {
+            if (a[axis] > a.w && b[axis] > b.w && c[axis] > c.w) return;
+            if (axis < 2 && a[axis] < -a.w && b[axis] < -b.w && c[axis] < -c.w) return;
+        }
+
+        // Clips against the near plane z = -w, which gives up to four vertices.
+
+        const glm::vec4 input[3] = { a, b, c };
+        glm::vec4 polygon[4];
+        std::size_t count = 0;
+
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            glm::vec4 const& current = input[i];
+            glm::vec4 const& next = input[(i + 1) % 3];
+            const float dc = current.z + current.w;
+            const float dn = next.z + next.w;
+
+            if (dc >= 0.0f) polygon[count++] = current;
+            if ((dc >= 0.0f) != (dn >= 0.0f)) polygon[count++] = current + (next - current) * (dc / (dc - dn));
+        }
+
+        if (count < 3) return;
+
+        glm::vec3 screen[4];
+        const float fw = static_cast < float >(width), fh = static_cast < float >(height);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float w = std::max(polygon[i].w, 1e-6f);
+            screen[i] = glm::vec3((polygon[i].x / w * 0.5f + 0.5f) * fw,
+                                  (polygon[i].y / w * 0.5f + 0.5f) * fh,
+                                  polygon[i].z / w * 0.5f + 0.5f);
+        }
+
+        // Both faces are rasterized, so open occluders like walls hide whatever their winding. Triangles are
+        // stored counter-clockwise.
+
+        for (std::size_t i = 1; i + 1 < count; ++i)
+        {
+            Triangle triangle = { { screen[0], screen[i], screen[i + 1] } };
+            glm::vec3 const* v = triangle.vertices;
+
+            const float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+            if (std::fabs(area) < 1e-8f) continue;
+            if (area < 0.0f) std::swap(triangle.vertices[1], triangle.vertices[2]);
+
+            triangles.push_back(triangle);
+        }
+    }
+
+    void OcclusionBuffer::rasterizeBand(std::vector < std::uint32_t > const& bin, std::size_t first, std::size_t last)
+    {
+        float* depths = levels[0].data();
+
+        for (std::uint32_t index : bin)
+        {
+            glm::vec3 const* v = triangles[index].vertices;
+
+            // Edge functions are positive inside: E(x, y) = A x + B y + C for each edge.
+
+            float ea[3], eb[3], ec[3];
+
+            for (std::size_t e = 0; e < 3; ++e)
+            {
+                glm::vec3 const& p = v[e];
+                glm::vec3 const& q = v[(e + 1) % 3];
+                ea[e] = p.y - q.y;
+                eb[e] = q.x - p.x;
+                ec[e] = -(ea[e] * p.x + eb[e] * p.y);
+            }
+
+            const float x10 = v[1].x - v[0].x, y10 = v[1].y - v[0].y, z10 = v[1].z - v[0].z;
+            const float x20 = v[2].x - v[0].x, y20 = v[2].y - v[0].y, z20 = v[2].z - v[0].z;
+            const float area = x10 * y20 - x20 * y10;
+            const float dzdx = (z10 * y20 - z20 * y10) / area;
+            const float dzdy = (x10 * z20 - x20 * z10) / area;
+            const float z0 = v[0].z - dzdx * v[0].x - dzdy * v[0].y;
+
+            const float minX = std::min(v[0].x, std::min(v[1].x, v[2].x));
+            const float maxX = std::max(v[0].x, std::max(v[1].x, v[2].x));
+            const float minY = std::min(v[0].y, std::min(v[1].y, v[2].y));
+            const float maxY = std::max(v[0].y, std::max(v[1].y, v[2].y));
+
+            const float fw = static_cast < float >(width), fh = static_cast < float >(height);
+            if (maxX < 0.0f || minX >= fw) continue;
+
+            // Columns start on a multiple of four so each SIMD iteration covers four pixels of the row.
+
+            const std::size_t left = static_cast < std::size_t >(std::max(minX, 0.0f)) & ~std::size_t(3);
+            const std::size_t right = static_cast < std::size_t >(std::min(maxX, fw - 1.0f)) + 1;
+            const std::size_t bottom = std::max(first, static_cast < std::size_t >(std::max(minY, 0.0f)));
+            const std::size_t top = std::min(last, static_cast < std::size_t >(std::min(std::max(maxY, 0.0f), fh - 1.0f)) + 1);
+
+            for (std::size_t y = bottom; y < top; ++y)
+            {
+                const float py = static_cast < float >(y) + 0.5f;
+                float* row = depths + y * width;
+                std::size_t x = left;
+
+#           ifdef CLEAN_OCCLUSION_SSE2
+                const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+                const __m128 zero = _mm_setzero_ps();
+
+                for (; x < right; x += 4)
+                {
+                    const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast < float >(x)), offsets);
+                    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+                    for (std::size_t e = 0; e < 3; ++e)
+                    {
+                        const __m128 value = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(ea[e]), px), _mm_set1_ps(eb[e] * py + ec[e]));
+                        inside = _mm_and_ps(inside, _mm_cmpge_ps(value, zero));
+                    }
+
+                    if (_mm_movemask_ps(inside) == 0) continue;
+
+                    const __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), px), _mm_set1_ps(dzdy * py + z0));
+                    const __m128 old = _mm_loadu_ps(row + x);
+                    const __m128 nearest = _mm_min_ps(old, z);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+                }
+#           endif
+
+                for (; x < right; ++x)
+                {
+                    const float px = static_cast < float >(x) + 0.5f;
+
+                    if (ea[0] * px + eb[0] * py + ec[0] >= 0.0f &&
+                        ea[1] * px + eb[1] * py + ec[1] >= 0.0f &&
+                        ea[2] * px + eb[2] * py + ec[2] >= 0.0f)
+                    {
+                        row[x] = std::min(row[x], z0 + dzdx * px + dzdy * py);
+                    }
+                }
+            }
+        }
+    }
+
+    void OcclusionBuffer::buildHierarchy()
+    {
+        for (std::size_t level = 1; level < levels.size(); ++level)
+        {
+            auto const& below = levels[level - 1];
+            auto& depths = levels[level];
+            const std::size_t belowWidth = levelWidths[level - 1], belowHeight = levelHeights[level - 1];
+            const std::size_t levelWidth = levelWidths[level], levelHeight = levelHeights[level];
+
+            for (std::size_t y = 0; y < levelHeight; ++y)
+            {
+                const std::size_t y0 = y * 2, y1 = std::min(y * 2 + 1, belowHeight - 1);
+
+                for (std::size_t x = 0; x < levelWidth; ++x)
+                {
+                    const std::size_t x0 = x * 2, x1 = std::min(x * 2 + 1, belowWidth - 1);
+                    depths[y * levelWidth + x] = std::max(std::max(below[y0 * belowWidth + x0], below[y0 * belowWidth + x1]),
+                                                          std::max(below[y1 * belowWidth + x0], below[y1 * belowWidth + x1]));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/** \file Core/OcclusionBuffer.h
+**/
+
+#ifndef CLEAN_OCCLUSIONBUFFER_H
+#define CLEAN_OCCLUSIONBUFFER_H
+
+#include "Bounds.h"
+
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Clean
+{
+    class Mesh;
+
+    //! @brief Default size of an OcclusionBuffer, in pixels.
+    static constexpr const std::size_t kOcclusionBufferWidth = 256;
+    static constexpr const std::size_t kOcclusionBufferHeight = 128;
+
+    //! @brief Number of rows rasterized by a job of OcclusionBuffer::rasterize().
+    static constexpr const std::size_t kOcclusionBufferBandHeight = 16;
+
+    //! @brief Largest size, in texels of the tested level, of the rectangle tested by OcclusionBuffer::isVisible().
+    static constexpr const std::size_t kOcclusionBufferTestSize = 4;
+
+    /** @brief Small depth buffer rasterized on the CPU from occluders, to find objects hidden behind them.
+     *
+     * Occluders are meshes hiding large parts of the scene, like walls and floors, with few triangles. They must
+     * stay inside the shape they stand for: a coarse level of detail may cover more than the original mesh and
+     * hide visible objects. Each frame, begin() clears the buffer with the view projection of the camera, addOccluder()
+     * transforms and clips the occluders' triangles, and rasterize() draws them: rows are split in bands rasterized
+     * by the jobs of the JobSystem, four pixels at a time with SSE when available. Then a hierarchy of depths is
+     * built, where each texel holds the farthest depth of the four texels below it.
+     *
+     * isVisible() projects a box and compares its nearest depth with the farthest depths of the few texels its
+     * rectangle covers, at the level where it covers at most kOcclusionBufferTestSize texels. The test is
+     * conservative: an object is reported hidden only when it is behind the occluders everywhere.
+     *
+     * Depths are the normalized device depths of the projection, mapped to [0, 1]. Queries may be done by several
+     * threads at once after rasterize(), but the buffer must not be modified meanwhile.
+     *
+    **/
+    class OcclusionBuffer
+    {
+        /** @brief A triangle in screen space: x and y in pixels, z is the depth. */
+        struct Triangle
+        {
+            glm::vec3 vertices[3];
+        };
+
+        //! @brief Size of the buffer. width is a multiple of 4.
+        std::size_t width, height;
+
+        //! @brief View projection of the camera.
+        glm::mat4 viewProjection;
+
+        //! @brief Triangles added since begin().
+        std::vector < Triangle > triangles;
+
+        //! @brief Depth of each level, from the full buffer to a single texel. The full buffer is levels[0].
+        std::vector < std::vector < float > > levels;
+
+        //! @brief Size of each level.
+        std::vector < std::size_t > levelWidths, levelHeights;
+
+    public:
+
+        /*! @brief Constructs a buffer of the given size. width is rounded up to a multiple of 4. */
+        OcclusionBuffer(std::size_t width = kOcclusionBufferWidth, std::size_t height = kOcclusionBufferHeight);
+
+        /*! @brief Clears the buffer and the occluders, and sets the view projection used for the frame. */
+        void begin(glm::mat4 const& viewProjection);
+
+        /*! @brief Adds the triangles of an occluder, in the space given by model. */
+        void addOccluder(std::vector < glm::vec3 > const& positions, std::vector < std::uint32_t > const& indexes, glm::mat4 const& model);
+
+        /*! @brief Adds the full level of detail of mesh as an occluder. */
+        void addOccluder(Mesh const& mesh, glm::mat4 const& model);
+
+        /*! @brief Rasterizes the occluders added since begin() and builds the hierarchy of depths. */
+        void rasterize();
+
+        /*! @brief Returns false if box, in world space, is hidden by the occluders. */
+        bool isVisible(BoundingBox const& box) const;
+
+        /*! @brief Returns the depth of a pixel of the full buffer. */
+        float getDepth(std::size_t x, std::size_t y) const;
+
+        /*! @brief Returns the width of the buffer. */
+        std::size_t getWidth() const;
+
+        /*! @brief Returns the height of the buffer. */
+        std::size_t getHeight() const;
+
+        /*! @brief Returns the number of triangles added since begin(), after clipping. */
+        std::size_t getTriangleCount() const;
+
+    private:
+
+        /*! @brief Clips the triangle against the near plane, and adds the remaining triangles in screen space. */
+        void addClipTriangle(glm::vec4 const& a, glm::vec4 const& b, glm::vec4 const& c);
+
+        /*! @brief Rasterizes the triangles whose indexes are in bin into rows [first, last). */
+        void rasterizeBand(std::vector < std::uint32_t > const& bin, std::size_t first, std::size_t last);
+
+        /*! @brief Builds the levels above levels[0]. */
+        void buildHierarchy();
+    };
+}
+
+#endif // CLEAN_OCCLUSIONBUFFER_H
@@ -0,0 +1,53 @@
+/** \file Core/OcclusionQuery.h
+**/
+
+#ifndef CLEAN_OCCLUSIONQUERY_H
+#define CLEAN_OCCLUSIONQUERY_H
+
+#include <atomic>
+
+namespace Clean
+{
+    /** @brief Asks the GPU whether the draws of an object passed the depth test.
+     *
+     * A query is made by Driver::makeOcclusionQuery() for drivers supporting them, and is usually given to the
+     * RenderCommand of one object: the driver then counts the samples of the command's draws between begin()
+     * and end(). Results come back a frame or more later: the driver reads them in its update() and stores them,
+     * so isOccluded() never waits for the GPU and may be called from any thread.
+     *
+     * An object hidden by its query is not drawn anymore, so its query must be issued on a proxy instead, like
+     * its bounding box drawn without writing color or depth: see CullingBatch::findOcclusionProxies().
+     *
+    **/
+    class OcclusionQuery
+    {
+    protected:
+
+        //! @brief True if the last result read says no sample passed.
+        std::atomic < bool > occluded = { false };
+
+        //! @brief True between begin() and the reading of its result.
+        std::atomic < bool > pending = { false };
+
+    public:
+
+        virtual ~OcclusionQuery() = default;
+
+        /*! @brief Starts counting the samples passing the depth test. Must be called by the driver's thread. */
+        virtual void begin() = 0;
+
+        /*! @brief Stops counting. Must be called by the driver's thread. */
+        virtual void end() = 0;
+
+        /*! @brief Reads the result of the last end() if the GPU has it, without waiting. Called by the driver. */
+        virtual void fetch() = 0;
+
+        /*! @brief Returns true if the last result read says the draws were completely hidden. */
+        bool isOccluded() const { return occluded.load(std::memory_order_relaxed); }
+
+        /*! @brief Returns true if a query was issued and its result is not read yet. */
+        bool isPending() const { return pending.load(std::memory_order_relaxed); }
+    };
+}
+
+#endif // CLEAN_OCCLUSIONQUERY_H
@@ -0,0 +1,261 @@
+/** =======================================================
+ *  \file Core/ParameterBlock.cpp
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#include "ParameterBlock.h"
+#include "ShaderParameter.h"
+#include "EffectParameterProvider.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Clean
+{
+    /*! @brief Returns the number of columns and rows of a matrix type, or 0 if type is not a matrix. */
+    static std::size_t ParameterBlockGetMatrix(std::uint8_t type, std::size_t& rows)
+    {
+        switch (type)
+        {
+            case kShaderParamMat2: rows = 2; return 2;
+            case kShaderParamMat3: rows = 3; return 3;
+            case kShaderParamMat4: rows = 4; return 4;
+            case kShaderParamMat2x3: rows = 3; return 2;
+            case kShaderParamMat3x2: rows = 2; return 3;
+            case kShaderParamMat2x4: rows = 4; return 2;
+            case kShaderParamMat4x2: rows = 2; return 4;
+            case kShaderParamMat3x4: rows = 4; return 3;
+            case kShaderParamMat4x3: rows = 3; return 4;
+            default: rows = 0; return 0;
+        }
+    }
+
+    std::size_t ParameterBlockGetAlignment(std::uint8_t type)
+    {
+        switch (type)
+        {
+            case kShaderParamU32:
+            case kShaderParamI32:
+            case kShaderParamFloat:
+            return 4;
+
+            case kShaderParamVec2:
+            case kShaderParamUVec2:
+            case kShaderParamIVec2:
+            return 8;
+
+            case kShaderParamVec3:
+            case kShaderParamUVec3:
+            case kShaderParamIVec3:
+            case kShaderParamVec4:
+            case kShaderParamUVec4:
+            case kShaderParamIVec4:
+            return 16;
+
+            default:
+            {
+                std::size_t rows;
+                return ParameterBlockGetMatrix(type, rows) ? 16 : 0;
+            }
+        }
+    }
+
+    std::size_t ParameterBlockGetSize(std::uint8_t type)
+    {
+        switch (type)
+        {
+            case kShaderParamU32:
+            case kShaderParamI32:
+            case kShaderParamFloat:
+            return 4;
+
+            case kShaderParamVec2:
+            case kShaderParamUVec2:
+            case kShaderParamIVec2:
+            return 8;
+
+            case kShaderParamVec3:
+            case kShaderParamUVec3:
+            case kShaderParamIVec3:
+            return 12;
+
+            case kShaderParamVec4:
+            case kShaderParamUVec4:
+            case kShaderParamIVec4:
+            return 16;
+
+            default:
+            {
+                // Matrices are arrays of column vectors, and array elements are aligned to 16 bytes.
+                std::size_t rows;
+                return ParameterBlockGetMatrix(type, rows) * 16;
+            }
+        }
+    }
+
+    void ParameterBlockWrite(unsigned char* dest, std::uint8_t type, ShaderValue const& value)
+    {
+        std::size_t rows;
+        const std::size_t columns = ParameterBlockGetMatrix(type, rows);
+
+        if (!columns)
+        {
+            memcpy(dest, &value, ParameterBlockGetSize(type));
+            return;
+        }
+
+        // glm stores matrices column by column, each column being 'rows' floats.
+        const float* src = reinterpret_cast < const float* >(&value);
+
+        for (std::size_t c = 0; c < columns; ++c)
+        {
+            memcpy(dest + c * 16, src + c * rows, rows * sizeof(float));
+            memset(dest + c * 16 + rows * sizeof(float), 0, (4 - rows) * sizeof(float));
+        }
+    }
+
+    bool ParameterBlockLayout::add(std::uint64_t hash, std::uint8_t type)
+    {
+        const std::size_t alignment = ParameterBlockGetAlignment(type);
+        if (!alignment || findMember(hash)) return false;
+
+        std::size_t end = 0;
+
+        if (!members.empty())
+            end = members.back().offset + ParameterBlockGetSize(members.back().type);
+
+        ParameterBlockMember member;
+        member.hash = hash;
+        member.type = type;
+        member.offset = (end + alignment - 1) / alignment * alignment;
+        members.push_back(member);
+
+        size = (member.offset + ParameterBlockGetSize(type) + 15) / 16 * 16;
+        return true;
+    }
+
+    ParameterBlockMember const* ParameterBlockLayout::findMember(std::uint64_t hash) const
+    {
+        auto it = std::find_if(members.begin(), members.end(), [hash](auto const& m){ return m.hash == hash; });
+        return it != members.end() ? &(*it) : nullptr;
+    }
+
+    std::vector < ParameterBlockMember > const& ParameterBlockLayout::getMembers() const
+    {
+        return members;
+    }
+
+    std::size_t ParameterBlockLayout::getSize() const
+    {
+        return size;
+    }
+
+    bool ParameterBlockLayout::isEmpty() const
+    {
+        return members.empty();
+    }
+
+    ParameterBlock::ParameterBlock(std::string const& n, std::uint8_t b, ParameterBlockLayout const& l, std::uint8_t f)
+    : name(n), binding(b), frequency(f), layout(l), version(EffectParameterNextVersion())
+    {
+        sources.resize(layout.getMembers().size());
+        sourceVersions.resize(layout.getMembers().size(), 0);
+        data.resize(layout.getSize(), 0);
+    }
+
+    std::string const& ParameterBlock::getName() const
+    {
+        return name;
+    }
+
+    std::uint8_t ParameterBlock::getBinding() const
+    {
+        return binding;
+    }
+
+    std::uint8_t ParameterBlock::getFrequency() const
+    {
+        return frequency;
+    }
+
+    ParameterBlockLayout const& ParameterBlock::getLayout() const
+    {
+        return layout;
+    }
+
+    bool ParameterBlock::set(std::shared_ptr < EffectParameter > const& source)
+    {
+        if (!source) return false;
+
+        ParameterBlockMember const* member = layout.findMember(source->hash);
+        if (!member) return false;
+
+        const std::size_t index = static_cast < std::size_t >(member - layout.getMembers().data());
+
+        std::scoped_lock < std::mutex > lck(mutex);
+        sources[index] = source;
+        sourceVersions[index] = 0;
+        return true;
+    }
+
+    std::size_t ParameterBlock::set(EffectParameterProvider const& provider)
+    {
+        std::size_t count = 0;
+
+        for (auto const& parameter : provider.findAllParameters())
+            count += set(parameter) ? 1 : 0;
+
+        return count;
+    }
+
+    std::uint64_t ParameterBlock::update()
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        auto const& members = layout.getMembers();
+        bool changed = false;
+
+        for (std::size_t i = 0; i < members.size(); ++i)
+        {
+            if (!sources[i]) continue;
+
+            std::lock_guard < std::mutex > sourceLock(sources[i]->mutex);
+            if (sources[i]->version == sourceVersions[i]) continue;
+
+            ParameterBlockWrite(data.data() + members[i].offset, members[i].type, sources[i]->value);
+            sourceVersions[i] = sources[i]->version;
+            changed = true;
+        }
+
+        if (changed)
+            version = EffectParameterNextVersion();
+
+        return version;
+    }
+
+    std::uint64_t ParameterBlock::getVersion() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return version;
+    }
+
+    std::uint64_t ParameterBlock::copy(void* dest) const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        memcpy(dest, data.data(), data.size());
+        return version;
+    }
+
+    std::uint64_t ParameterBlock::assign(ParameterBlock& source)
+    {
+        if (&source == this) return update();
+        source.update();
+
+        std::scoped_lock < std::mutex, std::mutex > lck(mutex, source.mutex);
+        if (source.data.size() != data.size()) return version;
+
+        data = source.data;
+        version = source.version;
+        return version;
+    }
+}
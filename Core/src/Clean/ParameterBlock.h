@@ -0,0 +1,182 @@
+/** =======================================================
+ *  \file Core/ParameterBlock.h
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#ifndef CLEAN_PARAMETERBLOCK_H
+#define CLEAN_PARAMETERBLOCK_H
+
+#include "Handled.h"
+#include "EffectParameter.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Clean
+{
+    class EffectParameterProvider;
+
+    /** @defgroup ParameterBlockFrequencies Parameter blocks update frequencies
+     *  @brief Hints how often a block changes. Drivers may store blocks differently for each frequency.
+     *  @{
+    **/
+
+    //! @brief Block changing once per frame, like camera matrices.
+    static constexpr const std::uint8_t kParameterBlockPerFrame = 1;
+
+    //! @brief Block changing with the material, like material colors.
+    static constexpr const std::uint8_t kParameterBlockPerMaterial = 2;
+
+    //! @brief Block changing with each object drawn, like the model matrix.
+    static constexpr const std::uint8_t kParameterBlockPerObject = 3;
+
+    /** @} */
+
+    /*! @brief Returns the std140 base alignment of a kShaderParam* type, or 0 if not supported. */
+    std::size_t ParameterBlockGetAlignment(std::uint8_t type);
+
+    /*! @brief Returns the number of bytes a kShaderParam* type uses in a std140 block, or 0 if not supported.
+     *  Matrices columns are padded to 16 bytes. */
+    std::size_t ParameterBlockGetSize(std::uint8_t type);
+
+    /*! @brief Writes a value in std140 layout at dest. dest must have ParameterBlockGetSize(type) bytes. */
+    void ParameterBlockWrite(unsigned char* dest, std::uint8_t type, ShaderValue const& value);
+
+    /** @brief One EffectParameter stored in a ParameterBlock. */
+    struct ParameterBlockMember
+    {
+        //! @brief Hash of the EffectParameter.
+        std::uint64_t hash = 0;
+
+        //! @brief kShaderParam* type of the member.
+        std::uint8_t type = 0;
+
+        //! @brief Offset of the member in the block, in bytes.
+        std::size_t offset = 0;
+    };
+
+    /** @brief Offsets of EffectParameters in a block, packed with the std140 rules.
+     *
+     * std140 lets the engine compute offsets without querying the program: members are laid out in the
+     * order they are added, so the shader must declare its block members in the same order. Usually a
+     * layout is made by BuildableShaderMapper::makeBlockLayout() from the constants of a block.
+     *
+    **/
+    class ParameterBlockLayout
+    {
+        //! @brief Members, by increasing offset.
+        std::vector < ParameterBlockMember > members;
+
+        //! @brief Size of the block, rounded to 16 bytes.
+        std::size_t size = 0;
+
+    public:
+
+        /*! @brief Appends a member. Returns false if the type is not supported or the hash already present. */
+        bool add(std::uint64_t hash, std::uint8_t type);
+
+        /*! @brief Returns the member with the given hash, or null. */
+        ParameterBlockMember const* findMember(std::uint64_t hash) const;
+
+        /*! @brief Returns every member. */
+        std::vector < ParameterBlockMember > const& getMembers() const;
+
+        /*! @brief Returns the size of the block, in bytes. */
+        std::size_t getSize() const;
+
+        /*! @brief Returns true if there is no member. */
+        bool isEmpty() const;
+    };
+
+    /** @brief Groups EffectParameters uploaded at once to a shader's constant block.
+     *
+     * Instead of one upload call per EffectParameter, a ParameterBlock copies the values of its sources
+     * in a std140 buffer, which the driver uploads in one call and binds by its binding index. Blocks are
+     * added to an EffectSession (the Driver's one for per-frame blocks, a RenderCommand's for per-material
+     * blocks, a RenderSubCommand's for per-object blocks). When the RenderPipeline uses the block, the
+     * parameters of the block are not uploaded one by one anymore.
+     *
+     * \ref update() compares the versions of the sources with the ones last copied, and copies only if one
+     * of them changed. The block then gets a new version, so the driver uploads it only when needed.
+     *
+    **/
+    class ParameterBlock : public Handled < ParameterBlock >
+    {
+        //! @brief Name of the block in shaders.
+        const std::string name;
+
+        //! @brief Binding index of the block.
+        const std::uint8_t binding;
+
+        //! @brief One of the kParameterBlockPer* constants.
+        const std::uint8_t frequency;
+
+        //! @brief Members of the block.
+        const ParameterBlockLayout layout;
+
+        //! @brief Source of each member, by member index. May be null.
+        std::vector < std::shared_ptr < EffectParameter > > sources;
+
+        //! @brief Version of each source when last copied.
+        std::vector < std::uint64_t > sourceVersions;
+
+        //! @brief Block's data in std140 layout.
+        std::vector < unsigned char > data;
+
+        //! @brief Version of data.
+        std::uint64_t version;
+
+        //! @brief Protects sources, sourceVersions, data and version.
+        mutable std::mutex mutex;
+
+    public:
+
+        /*! @brief Constructs a block.
+         *
+         * \param name Name of the block in the shaders.
+         * \param binding Binding index the block is bound to.
+         * \param layout Members of the block.
+         * \param frequency One of the kParameterBlockPer* constants.
+         *
+        **/
+        ParameterBlock(std::string const& name, std::uint8_t binding, ParameterBlockLayout const& layout,
+                       std::uint8_t frequency = kParameterBlockPerObject);
+
+        /*! @brief Returns the name of the block. */
+        std::string const& getName() const;
+
+        /*! @brief Returns the binding index of the block. */
+        std::uint8_t getBinding() const;
+
+        /*! @brief Returns the update frequency of the block. */
+        std::uint8_t getFrequency() const;
+
+        /*! @brief Returns the layout of the block. */
+        ParameterBlockLayout const& getLayout() const;
+
+        /*! @brief Sets the source of the member with the same hash. Returns false if there is no such member. */
+        bool set(std::shared_ptr < EffectParameter > const& source);
+
+        /*! @brief Sets every member provided by the given provider. Returns the number of members set. */
+        std::size_t set(EffectParameterProvider const& provider);
+
+        /*! @brief Copies sources changed since last update, and returns the version of the data. */
+        std::uint64_t update();
+
+        /*! @brief Returns the version of the data. */
+        std::uint64_t getVersion() const;
+
+        /*! @brief Copies the data to dest, which must have getLayout().getSize() bytes, and returns its version. */
+        std::uint64_t copy(void* dest) const;
+
+        /*! @brief Updates source, and copies its data and version if this block has the same size. Used by
+         *  EffectSession::snapshot(): a block without sources keeps the data last assigned. Returns the version. */
+        std::uint64_t assign(ParameterBlock& source);
+    };
+}
+
+#endif // CLEAN_PARAMETERBLOCK_H
@@ -0,0 +1,137 @@
+/** =======================================================
+ *  \file Core/PipelineCache.cpp
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#include "PipelineCache.h"
+#include "Platform.h"
+#include "NotificationCenter.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "Hash.h"
+
+namespace Clean
+{
+    /** @brief Header of a FilePipelineCache file. */
+    struct FilePipelineCacheHeader
+    {
+        //! @brief Always 'CLPC'.
+        char magic[4];
+
+        //! @brief kFilePipelineCacheVersion when written.
+        std::uint32_t version;
+
+        //! @brief PipelineCacheEntry::format.
+        std::uint32_t format;
+
+        //! @brief Size of the data following the header.
+        std::uint64_t size;
+
+        //! @brief Hash64 of the data.
+        std::uint64_t checksum;
+    };
+
+    static constexpr const char kFilePipelineCacheMagic[4] = { 'C', 'L', 'P', 'C' };
+    static constexpr const std::uint64_t kFilePipelineCacheMaxSize = 256 * 1024 * 1024;
+
+    std::uint64_t PipelineCacheMakeKey(std::vector < std::uint64_t > const& sources, std::string const& identity)
+    {
+        std::vector < std::uint64_t > hashes(sources);
+        hashes.push_back(Hash64(identity.data(), identity.size()));
+        return Hash64(hashes.data(), hashes.size() * sizeof(std::uint64_t));
+    }
+
+    FilePipelineCache::FilePipelineCache(std::string const& dir) : directory(dir)
+    {
+
+    }
+
+    bool FilePipelineCache::load(std::uint64_t key, PipelineCacheEntry& entry) const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        std::ifstream stream(makePath(key), std::ios::in | std::ios::binary);
+        if (!stream) return false;
+
+        FilePipelineCacheHeader header;
+        stream.read(reinterpret_cast < char* >(&header), sizeof(header));
+
+        if (!stream || memcmp(header.magic, kFilePipelineCacheMagic, 4) || header.version != kFilePipelineCacheVersion)
+            return false;
+
+        // A corrupted size must not allocate the whole memory. 
+        if (header.size > kFilePipelineCacheMaxSize)
+            return false;
+
+        std::vector < unsigned char > data(static_cast < std::size_t >(header.size));
+        stream.read(reinterpret_cast < char* >(data.data()), static_cast < std::streamsize >(data.size()));
+
+        if (!stream || Hash64(data.data(), data.size()) != header.checksum) {
+            NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelWarning, "Pipeline cache file %s is corrupted.",
+                makePath(key).data()));
+            return false;
+        }
+
+        entry.format = header.format;
+        entry.data = std::move(data);
+        return true;
+    }
+
+    bool FilePipelineCache::store(std::uint64_t key, PipelineCacheEntry const& entry)
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        const std::string path = makePath(key);
+        const std::string temporary = path + ".tmp";
+
+        FilePipelineCacheHeader header;
+        memcpy(header.magic, kFilePipelineCacheMagic, 4);
+        header.version = kFilePipelineCacheVersion;
+        header.format = entry.format;
+        header.size = entry.data.size();
+        header.checksum = Hash64(entry.data.data(), entry.data.size());
+
+        {
+            std::ofstream stream(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+
+            if (!stream) {
+                NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelWarning, "Can't write pipeline cache file %s.",
+                    temporary.data()));
+                return false;
+            }
+
+            stream.write(reinterpret_cast < const char* >(&header), sizeof(header));
+            stream.write(reinterpret_cast < const char* >(entry.data.data()), static_cast < std::streamsize >(entry.data.size()));
+
+            if (!stream) {
+                stream.close();
+                std::remove(temporary.data());
+                return false;
+            }
+        }
+
+        // rename() doesn't replace an existing file on every platform.
+        std::remove(path.data());
+        return std::rename(temporary.data(), path.data()) == 0;
+    }
+
+    void FilePipelineCache::remove(std::uint64_t key)
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        std::remove(makePath(key).data());
+    }
+
+    std::string const& FilePipelineCache::getDirectory() const
+    {
+        return directory;
+    }
+
+    std::string FilePipelineCache::makePath(std::uint64_t key) const
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.cpc", static_cast < unsigned long long >(key));
+        return Platform::PathConcatenate(directory, name);
+    }
+}
@@ -0,0 +1,107 @@
+/** =======================================================
+ *  \file Core/PipelineCache.h
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#ifndef CLEAN_PIPELINECACHE_H
+#define CLEAN_PIPELINECACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Clean
+{
+    /** @brief A compiled pipeline, as given by the driver that compiled it. */
+    struct PipelineCacheEntry
+    {
+        //! @brief Driver's format of data, like the binary format returned by glGetProgramBinary.
+        std::uint32_t format = 0;
+
+        //! @brief Compiled pipeline.
+        std::vector < unsigned char > data;
+    };
+
+    /*! @brief Computes the key of a pipeline.
+     *
+     * \param sources Hashes of the source of each stage, in stage order. Defines are part of the sources.
+     * \param identity String identifying the compiler, like the driver's name with the renderer and its
+     *      version. Compiled pipelines can't be used by another compiler.
+     *
+    **/
+    std::uint64_t PipelineCacheMakeKey(std::vector < std::uint64_t > const& sources, std::string const& identity);
+
+    /** @brief Stores compiled pipelines, so a driver loads them instead of compiling them again.
+     *
+     * A Driver uses the PipelineCache set with Driver::setPipelineCache(). When linking a pipeline, it
+     * computes its key with PipelineCacheMakeKey() and loads the entry if present. Otherwise, it compiles the
+     * pipeline and stores what its compiler gives. An entry the driver can't use anymore (new driver version
+     * for example) is removed by the driver.
+     *
+     * Implementations must be thread-safe: pipelines may be compiled by multiple threads.
+     *
+    **/
+    class PipelineCache
+    {
+    public:
+
+        /*! @brief Default destructor. */
+        virtual ~PipelineCache() = default;
+
+        /*! @brief Loads the entry for key. Returns false if there is no valid entry. */
+        virtual bool load(std::uint64_t key, PipelineCacheEntry& entry) const = 0;
+
+        /*! @brief Stores the entry for key, replacing any previous one. */
+        virtual bool store(std::uint64_t key, PipelineCacheEntry const& entry) = 0;
+
+        /*! @brief Removes the entry for key. */
+        virtual void remove(std::uint64_t key) = 0;
+    };
+
+    //! @brief Version of the files written by FilePipelineCache. Files with another version are ignored.
+    static constexpr const std::uint32_t kFilePipelineCacheVersion = 1;
+
+    /** @brief PipelineCache storing one file per entry in a directory.
+     *
+     * Each file is named after the key in hexadecimal, with the extension '.cpc'. It starts with a header
+     * holding the version of the store, the driver's format, the size and a hash of the data: truncated or
+     * corrupted files are ignored. Files are written to a temporary file first, and renamed when complete.
+     *
+     * \note The directory is not created: it must exist before storing entries.
+     *
+    **/
+    class FilePipelineCache : public PipelineCache
+    {
+        //! @brief Directory where entries are stored.
+        const std::string directory;
+
+        //! @brief Serializes file operations.
+        mutable std::mutex mutex;
+
+    public:
+
+        /*! @brief Constructs a cache in the given directory. */
+        explicit FilePipelineCache(std::string const& directory);
+
+        /*! @brief Loads the entry for key from its file. */
+        bool load(std::uint64_t key, PipelineCacheEntry& entry) const;
+
+        /*! @brief Writes the entry for key to its file. */
+        bool store(std::uint64_t key, PipelineCacheEntry const& entry);
+
+        /*! @brief Removes the file of key. */
+        void remove(std::uint64_t key);
+
+        /*! @brief Returns the directory. */
+        std::string const& getDirectory() const;
+
+    private:
+
+        /*! @brief Returns the path of the file for key. */
+        std::string makePath(std::uint64_t key) const;
+    };
+}
+
+#endif // CLEAN_PIPELINECACHE_H
@@ -0,0 +1,57 @@
+/** =======================================================
+ *  \file Core/PipelineCompilation.cpp
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#include "PipelineCompilation.h"
+
+#include <cassert>
+
+namespace Clean
+{
+    PipelineCompilation::PipelineCompilation(std::size_t c) : count(c), pending(c), failed(0)
+    {
+
+    }
+
+    void PipelineCompilation::done(bool success)
+    {
+        if (!success)
+            failed.fetch_add(1);
+
+        const std::size_t previous = pending.fetch_sub(1);
+        assert(previous && "PipelineCompilation::done() called more than once for a pipeline.");
+
+        if (previous == 1) {
+            std::lock_guard < std::mutex > lck(mutex);
+            condition.notify_all();
+        }
+    }
+
+    bool PipelineCompilation::isDone() const
+    {
+        return pending.load() == 0;
+    }
+
+    void PipelineCompilation::wait() const
+    {
+        std::unique_lock < std::mutex > lck(mutex);
+        condition.wait(lck, [this](){ return pending.load() == 0; });
+    }
+
+    std::size_t PipelineCompilation::getCount() const
+    {
+        return count;
+    }
+
+    std::size_t PipelineCompilation::getPendingCount() const
+    {
+        return pending.load();
+    }
+
+    std::size_t PipelineCompilation::getFailedCount() const
+    {
+        return failed.load();
+    }
+}
@@ -0,0 +1,66 @@
+/** =======================================================
+ *  \file Core/PipelineCompilation.h
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#ifndef CLEAN_PIPELINECOMPILATION_H
+#define CLEAN_PIPELINECOMPILATION_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace Clean
+{
+    /** @brief Progress of pipelines compiled by Driver::compilePipelines().
+     *
+     * The driver calls \ref done() once for each pipeline, from any thread, when the pipeline is compiled
+     * or failed to compile. Users may poll \ref isDone() every frame, or \ref wait() for all pipelines
+     * at a loading screen.
+     *
+    **/
+    class PipelineCompilation
+    {
+        //! @brief Number of pipelines to compile.
+        const std::size_t count;
+
+        //! @brief Number of pipelines not done yet.
+        std::atomic < std::size_t > pending;
+
+        //! @brief Number of pipelines that failed to compile.
+        std::atomic < std::size_t > failed;
+
+        //! @brief Protects condition.
+        mutable std::mutex mutex;
+
+        //! @brief Notified when the last pipeline is done.
+        mutable std::condition_variable condition;
+
+    public:
+
+        /*! @brief Constructs a compilation of count pipelines. */
+        explicit PipelineCompilation(std::size_t count);
+
+        /*! @brief Marks one pipeline as done. */
+        void done(bool success);
+
+        /*! @brief Returns true if all pipelines are done. */
+        bool isDone() const;
+
+        /*! @brief Waits until all pipelines are done. */
+        void wait() const;
+
+        /*! @brief Returns the number of pipelines to compile. */
+        std::size_t getCount() const;
+
+        /*! @brief Returns the number of pipelines not done yet. */
+        std::size_t getPendingCount() const;
+
+        /*! @brief Returns the number of pipelines that failed to compile. */
+        std::size_t getFailedCount() const;
+    };
+}
+
+#endif // CLEAN_PIPELINECOMPILATION_H
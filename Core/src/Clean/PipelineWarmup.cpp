@@ -0,0 +1,173 @@
+/** =======================================================
+ *  \file Core/PipelineWarmup.cpp
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#include "PipelineWarmup.h"
+#include "RenderPipeline.h"
+#include "Driver.h"
+#include "FileSystem.h"
+#include "Platform.h"
+#include "NotificationCenter.h"
+#include "Allocate.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace Clean
+{
+    PipelineWarmup::PipelineWarmup() : recording(false)
+    {
+
+    }
+
+    void PipelineWarmup::startRecording()
+    {
+        recording.store(true);
+    }
+
+    void PipelineWarmup::stopRecording()
+    {
+        recording.store(false);
+    }
+
+    bool PipelineWarmup::isRecording() const
+    {
+        return recording.load();
+    }
+
+    void PipelineWarmup::record(RenderPipeline const& pipeline)
+    {
+        if (!recording.load()) return;
+
+        {
+            std::scoped_lock < std::mutex > lck(mutex);
+            if (!seenPipelines.insert(pipeline.getHandle()).second) return;
+        }
+
+        PipelineWarmupEntry entry;
+
+        for (auto const& shader : pipeline.getShaders())
+        {
+            std::string path = shader->getOriginPath();
+            if (path.empty()) return;
+
+            entry.push_back(std::make_pair(shader->getType(), path));
+        }
+
+        if (!entry.empty())
+            add(entry);
+    }
+
+    void PipelineWarmup::add(PipelineWarmupEntry const& entry)
+    {
+        PipelineWarmupEntry sorted(entry);
+        std::sort(sorted.begin(), sorted.end());
+
+        std::string key = MakeKey(sorted);
+        std::scoped_lock < std::mutex > lck(mutex);
+
+        if (keys.insert(key).second)
+            entries.push_back(sorted);
+    }
+
+    std::vector < PipelineWarmupEntry > PipelineWarmup::getEntries() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return entries;
+    }
+
+    void PipelineWarmup::clear()
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        entries.clear();
+        keys.clear();
+        seenPipelines.clear();
+    }
+
+    bool PipelineWarmup::save(std::string const& filepath) const
+    {
+        std::fstream stream = FileSystem::Current().open(filepath, std::ios::out | std::ios::trunc);
+
+        if (!stream) {
+            NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "Can't write pipeline warm-up list %s.", filepath.data()));
+            return false;
+        }
+
+        std::scoped_lock < std::mutex > lck(mutex);
+
+        for (auto const& entry : entries)
+            stream << MakeKey(entry) << '\n';
+
+        return (bool)stream;
+    }
+
+    bool PipelineWarmup::load(std::string const& filepath)
+    {
+        std::fstream stream = FileSystem::Current().open(filepath, std::ios::in);
+        if (!stream) return false;
+
+        std::string line;
+
+        while (std::getline(stream, line))
+        {
+            auto tokens = Platform::Split(line, '\t');
+            if (tokens.empty() || tokens.size() % 2) continue;
+
+            PipelineWarmupEntry entry;
+
+            for (auto it = tokens.begin(); it != tokens.end(); ++it)
+            {
+                std::uint8_t stage = static_cast < std::uint8_t >(std::strtoul(it->data(), nullptr, 10));
+                ++it;
+                entry.push_back(std::make_pair(stage, *it));
+            }
+
+            add(entry);
+        }
+
+        return true;
+    }
+
+    std::shared_ptr < PipelineCompilation > PipelineWarmup::replay(Driver& driver) const
+    {
+        std::vector < std::shared_ptr < RenderPipeline > > pipelines;
+
+        for (auto const& entry : getEntries())
+        {
+            auto shaders = driver.makeShaders(entry);
+
+            if (shaders.size() != entry.size()) {
+                NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelWarning, "Pipeline warm-up entry with shader %s skipped: not all its shaders can be loaded.",
+                    entry.front().second.data()));
+                continue;
+            }
+
+            auto pipeline = driver.makeRenderPipeline();
+            if (!pipeline) continue;
+
+            for (auto const& shader : shaders)
+                pipeline->shader(shader->getType(), shader);
+
+            pipelines.push_back(pipeline);
+        }
+
+        return driver.compilePipelines(pipelines);
+    }
+
+    std::string PipelineWarmup::MakeKey(PipelineWarmupEntry const& entry)
+    {
+        std::ostringstream stream;
+
+        for (std::size_t i = 0; i < entry.size(); ++i)
+        {
+            if (i) stream << '\t';
+            stream << static_cast < unsigned >(entry[i].first) << '\t' << entry[i].second;
+        }
+
+        return stream.str();
+    }
+}
@@ -0,0 +1,107 @@
+/** =======================================================
+ *  \file Core/PipelineWarmup.h
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#ifndef CLEAN_PIPELINEWARMUP_H
+#define CLEAN_PIPELINEWARMUP_H
+
+#include "PipelineCompilation.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Clean
+{
+    class Driver;
+    class RenderPipeline;
+
+    /** @brief Shader files of a pipeline, by stage, sorted by stage. */
+    typedef std::vector < std::pair < std::uint8_t, std::string > > PipelineWarmupEntry;
+
+    /** @brief Records the pipelines used in a session, and compiles them at the next startup.
+     *
+     * While recording, Driver::renderCommand() gives each RenderPipeline it draws with to \ref record().
+     * A pipeline is recorded by the files of its shaders (see Shader::getOriginPath()), so pipelines whose
+     * shaders were not loaded from files are not recorded. The list is written with \ref save().
+     *
+     * At next startup, \ref load() reads the list and \ref replay() makes a pipeline for each entry with
+     * the same shaders, and compiles them with Driver::compilePipelines(). Shaders are shared by path by
+     * the driver, and with a PipelineCache the programs binaries are stored: pipelines made later with the
+     * same shaders don't compile them again.
+     *
+     * File format is one pipeline by line, with the stage and the path of each shader separated by tabs.
+     *
+    **/
+    class PipelineWarmup
+    {
+        //! @brief True while recording.
+        std::atomic < bool > recording;
+
+        //! @brief Pipelines recorded or loaded.
+        std::vector < PipelineWarmupEntry > entries;
+
+        //! @brief Entries serialized, to record each pipeline once.
+        std::set < std::string > keys;
+
+        //! @brief Handles of pipelines already given to record().
+        std::unordered_set < std::size_t > seenPipelines;
+
+        //! @brief Protects entries, keys and seenPipelines.
+        mutable std::mutex mutex;
+
+    public:
+
+        /*! @brief Constructs an empty list, not recording. */
+        PipelineWarmup();
+
+        /*! @brief Starts recording the pipelines given to record(). */
+        void startRecording();
+
+        /*! @brief Stops recording. */
+        void stopRecording();
+
+        /*! @brief Returns true while recording. */
+        bool isRecording() const;
+
+        /*! @brief Adds the pipeline to the list if recording and not already present. */
+        void record(RenderPipeline const& pipeline);
+
+        /*! @brief Adds an entry if not already present. */
+        void add(PipelineWarmupEntry const& entry);
+
+        /*! @brief Returns the entries. */
+        std::vector < PipelineWarmupEntry > getEntries() const;
+
+        /*! @brief Removes all entries. */
+        void clear();
+
+        /*! @brief Writes the entries to a file. */
+        bool save(std::string const& filepath) const;
+
+        /*! @brief Adds the entries of a file. Returns false if the file can't be read. */
+        bool load(std::string const& filepath);
+
+        /*! @brief Makes a pipeline for each entry and compiles them with the driver.
+         *
+         * \return The compilation of the pipelines made. Entries whose shaders can't be loaded are skipped.
+         *
+        **/
+        std::shared_ptr < PipelineCompilation > replay(Driver& driver) const;
+
+    private:
+
+        /*! @brief Returns the line of an entry in the file. */
+        static std::string MakeKey(PipelineWarmupEntry const& entry);
+    };
+}
+
+#endif // CLEAN_PIPELINEWARMUP_H
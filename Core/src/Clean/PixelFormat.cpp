@@ -23,12 +23,54 @@ namespace Clean
         }
     }
     
+    bool PixelFormatIsCompressed(std::uint8_t format)
+    {
+        return PixelFormatGetBlockSize(format) != 0;
+    }
+    
+    std::size_t PixelFormatGetBlockSize(std::uint8_t format)
+    {
+        switch(format)
+        {
+            case kPixelFormatBC1:
+            case kPixelFormatETC2RGB8:
+            return 8;
+            
+            case kPixelFormatBC3:
+            case kPixelFormatBC7:
+            case kPixelFormatETC2RGBA8:
+            return 16;
+            
+            default:
+            return 0;
+        }
+    }
+    
+    std::size_t PixelFormatGetLevelSize(std::uint8_t format, std::size_t width, std::size_t height)
+    {
+        const std::size_t blockSize = PixelFormatGetBlockSize(format);
+        
+        if (blockSize)
+        {
+            const std::size_t blocksX = (width + 3) / 4;
+            const std::size_t blocksY = (height + 3) / 4;
+            return blocksX * blocksY * blockSize;
+        }
+        
+        return width * height * PixelFormatGetSize(format);
+    }
+    
     std::string PixelFormatToString(std::uint8_t format)
     {
         switch (format)
         {
             case kPixelFormatRGB8: return "RGB8";
             case kPixelFormatRGBA8: return "RGBA8";
+            case kPixelFormatBC1: return "BC1";
+            case kPixelFormatBC3: return "BC3";
+            case kPixelFormatBC7: return "BC7";
+            case kPixelFormatETC2RGB8: return "ETC2RGB8";
+            case kPixelFormatETC2RGBA8: return "ETC2RGBA8";
             
             default:
             return std::string();
@@ -80,9 +80,43 @@ namespace Clean
     static constexpr const std::uint8_t kPixelFormatRGB8 = 1;
     static constexpr const std::uint8_t kPixelFormatRGBA8 = 2;
     
-    /*! @brief Returns the size of the given PixelFormat's pixel, in bytes. */
+    //! @brief BC1 (DXT1): 4x4 blocks of 8 bytes, RGB with 1-bit alpha.
+    static constexpr const std::uint8_t kPixelFormatBC1 = 3;
+    
+    //! @brief BC3 (DXT5): 4x4 blocks of 16 bytes, RGB with interpolated alpha.
+    static constexpr const std::uint8_t kPixelFormatBC3 = 4;
+    
+    //! @brief BC7: 4x4 blocks of 16 bytes, high quality RGBA.
+    static constexpr const std::uint8_t kPixelFormatBC7 = 5;
+    
+    //! @brief ETC2 RGB8: 4x4 blocks of 8 bytes, mostly used by mobile hardware.
+    static constexpr const std::uint8_t kPixelFormatETC2RGB8 = 6;
+    
+    //! @brief ETC2 RGBA8 (EAC alpha): 4x4 blocks of 16 bytes.
+    static constexpr const std::uint8_t kPixelFormatETC2RGBA8 = 7;
+    
+    /*! @brief Returns the size of the given PixelFormat's pixel, in bytes. 
+     *
+     * \note Block-compressed formats have no per-pixel size and return 0. Use 
+     * \ref PixelFormatGetBlockSize and \ref PixelFormatGetLevelSize instead.
+     *
+    **/
     std::size_t PixelFormatGetSize(std::uint8_t const format);
     
+    /*! @brief Returns true if the given format is a block-compressed format. */
+    bool PixelFormatIsCompressed(std::uint8_t const format);
+    
+    /*! @brief Returns the size of one 4x4 block, in bytes, or 0 if format is not compressed. */
+    std::size_t PixelFormatGetBlockSize(std::uint8_t const format);
+    
+    /*! @brief Returns the number of bytes needed to store an image of given dimensions. 
+     *
+     * For uncompressed formats, this is width * height * PixelFormatGetSize(). For block-compressed
+     * formats, dimensions are rounded up to a multiple of 4 pixels.
+     *
+    **/
+    std::size_t PixelFormatGetLevelSize(std::uint8_t const format, std::size_t width, std::size_t height);
+    
     /*! @brief Returns a very brief description of the pixel format. */
     std::string PixelFormatToString(std::uint8_t const format);
     
@@ -8,9 +8,26 @@
 #define CLEAN_PIXELSET_H
 
 #include "PixelFormat.h"
+#include <vector>
 
 namespace Clean 
 {
+    /*! @brief Describes one mipmap level stored in a PixelSet. */
+    struct PixelSetLevel 
+    {
+        //! @brief Width of the level, in pixels.
+        std::size_t width = 0;
+        
+        //! @brief Height of the level, in pixels.
+        std::size_t height = 0;
+        
+        //! @brief Offset of the first byte of this level in PixelSet::data.
+        std::size_t offset = 0;
+        
+        //! @brief Number of bytes used by this level.
+        std::size_t size = 0;
+    };
+    
     /*! @brief Holds a set of raw pixels. */
     struct PixelSet 
     {
@@ -27,6 +44,11 @@ namespace Clean
         
         //! @brief Pixels used.
         unsigned char* data = nullptr;
+        
+        //! @brief Mipmap levels stored contiguously in data, base level first. 
+        //! When empty, data only holds the base level described by lineWidth and columnsCount. 
+        //! Block-compressed PixelSets always fill this array, as lineWidth is meaningless for them.
+        std::vector < PixelSetLevel > levels;
     };
 }
 
@@ -8,24 +8,31 @@
 #include "Allocate.h"
 
 #include "RGB8TORGBA8Converter.h"
+#include "BlockEncoder.h"
 
 namespace Clean 
 {
+    /*! @brief Returns the key of a conversion in PixelSetConverterManager::formatsIndex. */
+    static std::uint64_t PixelSetConversionKey(std::uint8_t src, std::uint8_t dest)
+    {
+        return (std::uint64_t(src) << 8) | dest;
+    }
+    
     PixelSetConverterManager::PixelSetConverterManager()
     {
+        formatsIndex = addIndex([](PixelSetConverter const& converter){ 
+            return PixelSetConversionKey(converter.srcFormat(), converter.destFormat()); });
+        
         auto RGB8TORGBA8 = AllocateShared < RGB8TORGBA8Converter >();
         add(RGB8TORGBA8);
+        
+        add(AllocateShared < BlockEncoderConverter >(kPixelFormatBC1));
+        add(AllocateShared < BlockEncoderConverter >(kPixelFormatBC3));
     }
     
     std::shared_ptr < PixelSetConverter > PixelSetConverterManager::findConverter(std::uint8_t src, std::uint8_t dest) const 
     {
-        std::lock_guard < std::mutex > lck(managedListMutex);
-        
-        auto it = std::find_if(managedList.begin(), managedList.end(), [src, dest](auto c) { 
-            assert(c && "Null PixelSetConverter stored.");
-            return c->srcFormat() == src && c->destFormat() == dest; });
-            
-        if (it != managedList.end()) return *it;
-        return nullptr;
+        return findIndexed(formatsIndex, PixelSetConversionKey(src, dest), [src, dest](PixelSetConverter const& converter){ 
+            return converter.srcFormat() == src && converter.destFormat() == dest; });
     }
 }
\ No newline at end of file
@@ -15,6 +15,9 @@ namespace Clean
 {
     class PixelSetConverterManager : public Singleton < PixelSetConverterManager >, public Manager < PixelSetConverter >
     {
+        //! @brief Index of converters by source and destination formats.
+        std::size_t formatsIndex;
+        
     public:
         /*! @brief Constructs the manager and registers all included converters. */
         PixelSetConverterManager();
@@ -2,6 +2,8 @@
 **/
 
 #include "Platform.h"
+#include <algorithm>
+#include <cctype>
 #include <sstream>
 
 #ifdef CLEAN_PLATFORM_WIN32
@@ -190,6 +192,12 @@ namespace Clean
             return path.substr(path.find_last_of('.') + 1, std::string::npos);
         }
         
+        std::string StringToLower(std::string str)
+        {
+            std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c){ return (char) std::tolower(c); });
+            return str;
+        }
+        
         void StreamGetContent(std::istream& stream, std::string& out) 
         {
             // See: https://stackoverflow.com/a/2602060
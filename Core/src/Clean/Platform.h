@@ -76,6 +76,9 @@ namespace Clean
         /*! @brief Returns the given file extension. */
         std::string PathGetExtension(std::string const& path);
         
+        /*! @brief Returns str with its ASCII letters in lower case. */
+        std::string StringToLower(std::string str);
+        
         /*! @brief Reads the whole stream into a std string. */
         void StreamGetContent(std::istream& stream, std::string& out);
     }
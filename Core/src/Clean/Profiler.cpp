@@ -0,0 +1,419 @@
+/** \file Core/Profiler.cpp
+**/
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+namespace Clean
+{
+    /*! @brief Writes value as a JSON string. */
+    static void WriteJsonString(std::ostream& stream, std::string const& value)
+    {
+        stream << '"';
+
+        for (char c : value)
+        {
+            switch (c)
+            {
+                case '"': stream << "\\\""; break;
+                case '\\': stream << "\\\\"; break;
+                case '\n': stream << "\\n"; break;
+                case '\t': stream << "\\t"; break;
+
+                default:
+                if (static_cast < unsigned char >(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    stream << escaped;
+                } else {
+                    stream << c;
+                }
+            }
+        }
+
+        stream << '"';
+    }
+
+    /*! @brief Converts nanoseconds to the microseconds of the trace format. */
+    static double TraceTime(std::uint64_t ns)
+    {
+        return static_cast < double >(ns) / 1000.0;
+    }
+
+    ProfileCounter::ProfileCounter(const char* counterName) : name(counterName), value(0)
+    {
+        Profiler::Get().addCounter(this);
+    }
+
+    ProfileCounter::~ProfileCounter()
+    {
+        Profiler::Get().removeCounter(this);
+    }
+
+    Profiler& Profiler::Get()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    std::uint64_t Profiler::Now()
+    {
+        using namespace std::chrono;
+        return static_cast < std::uint64_t >(duration_cast < nanoseconds >(steady_clock::now().time_since_epoch()).count());
+    }
+
+    Profiler::Profiler()
+    : enabled(true), epoch(Now()), nextThread(0), dropped(0), ringNext(0), counterRingNext(0)
+    , ringSize(kProfilerDefaultRingSize), historySize(kProfilerDefaultHistorySize), lastFrame(epoch)
+    {
+
+    }
+
+    void Profiler::setEnabled(bool value)
+    {
+        enabled.store(value);
+    }
+
+    void Profiler::record(const char* name, std::uint64_t start, std::uint64_t end)
+    {
+        ThreadBuffer& buffer = threadBuffer();
+
+        const std::uint32_t head = buffer.head.load(std::memory_order_relaxed);
+        const std::uint32_t tail = buffer.tail.load(std::memory_order_acquire);
+
+        if (head - tail >= kProfilerThreadBufferSize) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer.events[head % kProfilerThreadBufferSize] = ProfileEvent{ name, start, end };
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    void Profiler::endFrame()
+    {
+        const std::uint64_t now = Now();
+
+        std::vector < std::shared_ptr < ThreadBuffer > > threads;
+
+        {
+            std::lock_guard < std::mutex > lck(buffersMutex);
+            threads = buffers;
+        }
+
+        std::lock_guard < std::mutex > lck(mutex);
+        std::unordered_map < std::uint32_t, double > frameTotals;
+
+        // Drains the events of each thread, even when disabled, so they don't appear in the next frame.
+
+        for (auto const& buffer : threads)
+        {
+            const std::uint32_t tail = buffer->tail.load(std::memory_order_relaxed);
+            const std::uint32_t head = buffer->head.load(std::memory_order_acquire);
+
+            for (std::uint32_t i = tail; i != head; ++i)
+            {
+                ProfileEvent const& event = buffer->events[i % kProfilerThreadBufferSize];
+                const std::uint32_t name = nameId(event.name);
+
+                frameTotals[name] += static_cast < double >(event.end - event.start) / 1e6;
+
+                if (ringSize) {
+                    TraceEvent traced = { name, buffer->thread, event.start - epoch, event.end - epoch };
+                    if (ring.size() < ringSize) ring.push_back(traced);
+                    else ring[ringNext] = traced;
+                    ringNext = (ringNext + 1) % ringSize;
+                }
+            }
+
+            buffer->tail.store(head, std::memory_order_release);
+        }
+
+        // Sums counters with the same name, and resets them for the next frame.
+
+        std::unordered_map < std::uint32_t, std::int64_t > counterTotals;
+
+        {
+            std::lock_guard < std::mutex > lckCounters(countersMutex);
+
+            for (ProfileCounter* counter : counters)
+                counterTotals[nameId(counter->name)] += counter->value.exchange(0, std::memory_order_relaxed);
+        }
+
+        if (!isEnabled()) {
+            lastFrame = now;
+            return;
+        }
+
+        pushValue(nameId("Frame"), static_cast < double >(now - lastFrame) / 1e6, false);
+        lastFrame = now;
+
+        for (auto const& total : frameTotals)
+            pushValue(total.first, total.second, false);
+
+        for (auto const& total : counterTotals)
+        {
+            pushValue(total.first, static_cast < double >(total.second), true);
+
+            if (ringSize) {
+                TraceCounter traced = { total.first, now - epoch, total.second };
+                if (counterRing.size() < ringSize) counterRing.push_back(traced);
+                else counterRing[counterRingNext] = traced;
+                counterRingNext = (counterRingNext + 1) % ringSize;
+            }
+        }
+
+        // Retired threads are removed once drained.
+
+        std::lock_guard < std::mutex > lckBuffers(buffersMutex);
+
+        buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](std::shared_ptr < ThreadBuffer > const& buffer){
+            return buffer->retired.load() && buffer->head.load() == buffer->tail.load();
+        }), buffers.end());
+    }
+
+    std::vector < ProfileStats > Profiler::getScopeStats() const
+    {
+        std::lock_guard < std::mutex > lck(mutex);
+        return makeStats(false);
+    }
+
+    std::vector < ProfileStats > Profiler::getCounterStats() const
+    {
+        std::lock_guard < std::mutex > lck(mutex);
+        return makeStats(true);
+    }
+
+    std::uint64_t Profiler::getDroppedCount() const
+    {
+        return dropped.load();
+    }
+
+    void Profiler::writeChromeTrace(std::ostream& stream) const
+    {
+        std::lock_guard < std::mutex > lck(mutex);
+
+        // Timestamps are in microseconds since the profiler creation: keep nanoseconds after hours of run.
+        const std::ios::fmtflags flags = stream.flags();
+        const std::streamsize precision = stream.precision();
+        stream << std::fixed << std::setprecision(3);
+
+        stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+
+        // Oldest events first: when the ring is full, they start at ringNext.
+
+        const std::size_t ringStart = ring.size() < ringSize ? 0 : ringNext;
+
+        for (std::size_t i = 0; i < ring.size(); ++i)
+        {
+            TraceEvent const& event = ring[(ringStart + i) % ring.size()];
+
+            stream << (first ? "\n" : ",\n") << "{\"name\":";
+            WriteJsonString(stream, names[event.name]);
+            stream << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+                   << ",\"ts\":" << TraceTime(event.start) << ",\"dur\":" << TraceTime(event.end - event.start) << "}";
+
+            first = false;
+        }
+
+        const std::size_t counterStart = counterRing.size() < ringSize ? 0 : counterRingNext;
+
+        for (std::size_t i = 0; i < counterRing.size(); ++i)
+        {
+            TraceCounter const& counter = counterRing[(counterStart + i) % counterRing.size()];
+
+            stream << (first ? "\n" : ",\n") << "{\"name\":";
+            WriteJsonString(stream, names[counter.name]);
+            stream << ",\"ph\":\"C\",\"pid\":0,\"ts\":" << TraceTime(counter.time) << ",\"args\":{\"value\":" << counter.value << "}}";
+
+            first = false;
+        }
+
+        stream << "\n]}\n";
+
+        stream.flags(flags);
+        stream.precision(precision);
+    }
+
+    bool Profiler::saveChromeTrace(std::string const& filepath) const
+    {
+        std::ofstream stream(filepath, std::ios::out | std::ios::trunc);
+        if (!stream) return false;
+
+        writeChromeTrace(stream);
+        return static_cast < bool >(stream);
+    }
+
+    void Profiler::writeReport(std::ostream& stream) const
+    {
+        std::vector < ProfileStats > scopes, values;
+
+        {
+            std::lock_guard < std::mutex > lck(mutex);
+            scopes = makeStats(false);
+            values = makeStats(true);
+        }
+
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-32s %10s %10s %10s %10s\n", "Scope (ms)", "min", "avg", "p99", "max");
+        stream << line;
+
+        for (ProfileStats const& stats : scopes) {
+            std::snprintf(line, sizeof(line), "%-32s %10.3f %10.3f %10.3f %10.3f\n", stats.name.data(), stats.min, stats.avg, stats.p99, stats.max);
+            stream << line;
+        }
+
+        std::snprintf(line, sizeof(line), "%-32s %10s %10s %10s %10s\n", "Counter", "min", "avg", "p99", "max");
+        stream << line;
+
+        for (ProfileStats const& stats : values) {
+            std::snprintf(line, sizeof(line), "%-32s %10.0f %10.1f %10.0f %10.0f\n", stats.name.data(), stats.min, stats.avg, stats.p99, stats.max);
+            stream << line;
+        }
+    }
+
+    void Profiler::setHistorySize(std::size_t frames)
+    {
+        std::lock_guard < std::mutex > lck(mutex);
+        historySize = std::max < std::size_t >(1, frames);
+
+        for (Series& values : series)
+        {
+            while (values.values.size() > historySize)
+                values.values.pop_front();
+        }
+    }
+
+    void Profiler::setRingSize(std::size_t events)
+    {
+        std::lock_guard < std::mutex > lck(mutex);
+        ringSize = events;
+        ring.clear();
+        counterRing.clear();
+        ringNext = counterRingNext = 0;
+    }
+
+    void Profiler::clear()
+    {
+        std::lock_guard < std::mutex > lck(mutex);
+
+        for (Series& values : series)
+            values.values.clear();
+
+        ring.clear();
+        counterRing.clear();
+        ringNext = counterRingNext = 0;
+    }
+
+    Profiler::ThreadBuffer& Profiler::threadBuffer()
+    {
+        /** @brief Owns the buffer of a thread, and retires it when the thread exits. */
+        struct Holder
+        {
+            std::shared_ptr < ThreadBuffer > buffer;
+            ~Holder() { if (buffer) buffer->retired.store(true); }
+        };
+
+        thread_local Holder holder;
+
+        if (!holder.buffer)
+        {
+            auto buffer = std::make_shared < ThreadBuffer >();
+            buffer->events.resize(kProfilerThreadBufferSize);
+            buffer->head.store(0);
+            buffer->tail.store(0);
+            buffer->retired.store(false);
+
+            std::lock_guard < std::mutex > lck(buffersMutex);
+            buffer->thread = nextThread++;
+            buffers.push_back(buffer);
+            holder.buffer = buffer;
+        }
+
+        return *holder.buffer;
+    }
+
+    std::uint32_t Profiler::nameId(const char* name)
+    {
+        auto pointer = namePointers.find(name);
+        if (pointer != namePointers.end()) return pointer->second;
+
+        // The same literal may have different addresses in different modules.
+
+        std::string value(name);
+        auto id = nameIds.find(value);
+
+        std::uint32_t result;
+
+        if (id != nameIds.end()) {
+            result = id->second;
+        } else {
+            result = static_cast < std::uint32_t >(names.size());
+            names.push_back(value);
+            series.emplace_back();
+            nameIds.emplace(std::move(value), result);
+        }
+
+        namePointers.emplace(name, result);
+        return result;
+    }
+
+    void Profiler::pushValue(std::uint32_t name, double value, bool counter)
+    {
+        Series& values = series[name];
+        values.counter = counter;
+        values.values.push_back(value);
+
+        if (values.values.size() > historySize)
+            values.values.pop_front();
+    }
+
+    std::vector < ProfileStats > Profiler::makeStats(bool counter) const
+    {
+        std::vector < ProfileStats > result;
+
+        for (std::size_t i = 0; i < series.size(); ++i)
+        {
+            Series const& values = series[i];
+            if (values.values.empty() || values.counter != counter) continue;
+
+            ProfileStats stats;
+            stats.name = names[i];
+            stats.frames = values.values.size();
+            stats.last = values.values.back();
+
+            std::vector < double > sorted(values.values.begin(), values.values.end());
+            std::sort(sorted.begin(), sorted.end());
+
+            double sum = 0.0;
+            for (double value : sorted) sum += value;
+
+            stats.min = sorted.front();
+            stats.max = sorted.back();
+            stats.avg = sum / static_cast < double >(sorted.size());
+            stats.p99 = sorted[std::min(sorted.size() - 1, (sorted.size() * 99) / 100)];
+
+            result.push_back(std::move(stats));
+        }
+
+        return result;
+    }
+
+    void Profiler::addCounter(ProfileCounter* counter)
+    {
+        std::lock_guard < std::mutex > lck(countersMutex);
+        counters.push_back(counter);
+    }
+
+    void Profiler::removeCounter(ProfileCounter* counter)
+    {
+        std::lock_guard < std::mutex > lck(countersMutex);
+        counters.erase(std::remove(counters.begin(), counters.end(), counter), counters.end());
+    }
+}
@@ -0,0 +1,335 @@
+/** \file Core/Profiler.h
+**/
+
+#ifndef CLEAN_PROFILER_H
+#define CLEAN_PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Clean
+{
+    //! @brief Default number of frames kept to compute the statistics.
+    static constexpr const std::size_t kProfilerDefaultHistorySize = 120;
+
+    //! @brief Default number of events kept in the rolling ring.
+    static constexpr const std::size_t kProfilerDefaultRingSize = 65536;
+
+    //! @brief Number of events a thread may record between two frames. Events beyond are dropped.
+    static constexpr const std::uint32_t kProfilerThreadBufferSize = 8192;
+
+    /** @brief A scope recorded by a thread. */
+    struct ProfileEvent
+    {
+        //! @brief Name of the scope. Must be a string literal.
+        const char* name;
+
+        //! @brief Start of the scope, as returned by Profiler::Now().
+        std::uint64_t start;
+
+        //! @brief End of the scope, as returned by Profiler::Now().
+        std::uint64_t end;
+    };
+
+    /** @brief Statistics of a scope or a counter over the last frames. */
+    struct ProfileStats
+    {
+        //! @brief Name of the scope or counter.
+        std::string name;
+
+        //! @brief Number of frames the statistics are computed from.
+        std::size_t frames = 0;
+
+        //! @brief Minimum value. Milliseconds spent in the scope during a frame, or counter value.
+        double min = 0.0;
+
+        //! @brief Average value.
+        double avg = 0.0;
+
+        //! @brief 99th percentile of the values.
+        double p99 = 0.0;
+
+        //! @brief Maximum value.
+        double max = 0.0;
+
+        //! @brief Value of the last frame.
+        double last = 0.0;
+    };
+
+    /** @brief A named value accumulated during a frame, like the number of draw calls.
+     *
+     * Counters are usually function-static objects created by ProfileCount(). Counters with the same name
+     * are summed. Adding to a counter is a relaxed atomic add.
+     *
+    **/
+    class ProfileCounter
+    {
+        //! @brief Name of the counter. Must be a string literal.
+        const char* name;
+
+        //! @brief Value accumulated since the last frame.
+        std::atomic < std::int64_t > value;
+
+        friend class Profiler;
+
+    public:
+
+        /*! @brief Registers the counter to the profiler. */
+        explicit ProfileCounter(const char* name);
+
+        /*! @brief Unregisters the counter. */
+        ~ProfileCounter();
+
+        ProfileCounter(ProfileCounter const&) = delete;
+        ProfileCounter& operator = (ProfileCounter const&) = delete;
+
+        /*! @brief Adds amount to the counter. */
+        void add(std::int64_t amount = 1)
+        {
+            value.fetch_add(amount, std::memory_order_relaxed);
+        }
+    };
+
+    /** @brief Collects CPU scopes and counters, and aggregates them per frame.
+     *
+     * The profiler is always compiled: a scope costs two clock reads and a write in the buffer of the
+     * calling thread, which is a single-producer single-consumer ring. No lock is taken while recording,
+     * except the first time a thread records a scope.
+     *
+     * \ref endFrame() is called once per frame by Driver::update(). It drains the buffers of all threads,
+     * computes the time spent in each scope and the value of each counter during the frame, and keeps them
+     * for the last frames. Drained events go to a rolling ring which can be written at any time in the
+     * Chrome trace-event format, to be opened with chrome://tracing or Perfetto.
+     *
+    **/
+    class Profiler
+    {
+        /** @brief Events recorded by one thread and not drained yet. */
+        struct ThreadBuffer
+        {
+            //! @brief Ring of events.
+            std::vector < ProfileEvent > events;
+
+            //! @brief Number of events written. Modified by the recording thread only.
+            std::atomic < std::uint32_t > head;
+
+            //! @brief Number of events drained. Modified by endFrame() only.
+            std::atomic < std::uint32_t > tail;
+
+            //! @brief True when the thread has exited.
+            std::atomic < bool > retired;
+
+            //! @brief Identifier of the thread in the traces.
+            std::uint32_t thread;
+        };
+
+        /** @brief An event drained from a thread buffer. */
+        struct TraceEvent
+        {
+            std::uint32_t name;
+            std::uint32_t thread;
+            std::uint64_t start;
+            std::uint64_t end;
+        };
+
+        /** @brief The value of a counter at the end of a frame. */
+        struct TraceCounter
+        {
+            std::uint32_t name;
+            std::uint64_t time;
+            std::int64_t value;
+        };
+
+        /** @brief Values of a scope or counter over the last frames. */
+        struct Series
+        {
+            std::deque < double > values;
+            bool counter = false;
+        };
+
+        //! @brief True if scopes are recorded.
+        std::atomic < bool > enabled;
+
+        //! @brief Time of the profiler creation, origin of the traces.
+        const std::uint64_t epoch;
+
+        //! @brief Buffers of the threads having recorded a scope.
+        std::vector < std::shared_ptr < ThreadBuffer > > buffers;
+
+        //! @brief Identifier of the next thread buffer.
+        std::uint32_t nextThread;
+
+        //! @brief Protects buffers and nextThread.
+        std::mutex buffersMutex;
+
+        //! @brief Counters alive.
+        std::vector < ProfileCounter* > counters;
+
+        //! @brief Protects counters.
+        std::mutex countersMutex;
+
+        //! @brief Number of events dropped because a thread buffer was full.
+        std::atomic < std::uint64_t > dropped;
+
+        //! @brief Names of scopes and counters, by identifier.
+        std::vector < std::string > names;
+
+        //! @brief Identifier of each name pointer met.
+        std::unordered_map < const char*, std::uint32_t > namePointers;
+
+        //! @brief Identifier of each name.
+        std::unordered_map < std::string, std::uint32_t > nameIds;
+
+        //! @brief Values of each name over the last frames, by identifier.
+        std::vector < Series > series;
+
+        //! @brief Rolling ring of the last events drained.
+        std::vector < TraceEvent > ring;
+
+        //! @brief Position of the next event in ring.
+        std::size_t ringNext;
+
+        //! @brief Rolling ring of the last counter values.
+        std::vector < TraceCounter > counterRing;
+
+        //! @brief Position of the next value in counterRing.
+        std::size_t counterRingNext;
+
+        //! @brief Maximum number of events in ring.
+        std::size_t ringSize;
+
+        //! @brief Number of frames kept in series.
+        std::size_t historySize;
+
+        //! @brief Time of the last endFrame().
+        std::uint64_t lastFrame;
+
+        //! @brief Protects names, series, rings and history parameters.
+        mutable std::mutex mutex;
+
+    public:
+
+        /*! @brief Returns the process-wide profiler. */
+        static Profiler& Get();
+
+        /*! @brief Returns the current time in nanoseconds of a monotonic clock. */
+        static std::uint64_t Now();
+
+        /*! @brief Constructs an enabled profiler. */
+        Profiler();
+
+        Profiler(Profiler const&) = delete;
+        Profiler& operator = (Profiler const&) = delete;
+
+        /*! @brief Enables or disables the recording of scopes. Counters are always accumulated. */
+        void setEnabled(bool value);
+
+        /*! @brief Returns true if scopes are recorded. */
+        bool isEnabled() const
+        {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        /*! @brief Records a scope for the calling thread. name must be a string literal. */
+        void record(const char* name, std::uint64_t start, std::uint64_t end);
+
+        /*! @brief Ends the current frame: drains the threads buffers and aggregates scopes and counters. */
+        void endFrame();
+
+        /*! @brief Returns the statistics of each scope over the last frames, in milliseconds. */
+        std::vector < ProfileStats > getScopeStats() const;
+
+        /*! @brief Returns the statistics of each counter over the last frames. */
+        std::vector < ProfileStats > getCounterStats() const;
+
+        /*! @brief Returns the number of events dropped because a thread recorded too many between two frames. */
+        std::uint64_t getDroppedCount() const;
+
+        /*! @brief Writes the events and counters of the rolling ring in the Chrome trace-event JSON format. */
+        void writeChromeTrace(std::ostream& stream) const;
+
+        /*! @brief Writes the rolling ring to a Chrome trace file. Returns false if the file can't be opened. */
+        bool saveChromeTrace(std::string const& filepath) const;
+
+        /*! @brief Writes the statistics of scopes and counters as a text table. */
+        void writeReport(std::ostream& stream) const;
+
+        /*! @brief Changes the number of frames kept for the statistics. */
+        void setHistorySize(std::size_t frames);
+
+        /*! @brief Changes the number of events kept in the rolling ring. The ring is cleared. */
+        void setRingSize(std::size_t events);
+
+        /*! @brief Clears the statistics and the rolling ring. */
+        void clear();
+
+    private:
+
+        friend class ProfileCounter;
+
+        /*! @brief Returns the buffer of the calling thread, creating it the first time. */
+        ThreadBuffer& threadBuffer();
+
+        /*! @brief Returns the identifier of a name. mutex must be locked. */
+        std::uint32_t nameId(const char* name);
+
+        /*! @brief Adds a value to the series of a name. mutex must be locked. */
+        void pushValue(std::uint32_t name, double value, bool counter);
+
+        /*! @brief Computes the statistics of counters or scopes. mutex must be locked. */
+        std::vector < ProfileStats > makeStats(bool counter) const;
+
+        /*! @brief Registers a counter. */
+        void addCounter(ProfileCounter* counter);
+
+        /*! @brief Unregisters a counter. */
+        void removeCounter(ProfileCounter* counter);
+    };
+
+    /** @brief Records the time spent between its construction and its destruction. */
+    class ProfilerScope
+    {
+        //! @brief Name of the scope, or null if the profiler was disabled at construction.
+        const char* name;
+
+        //! @brief Start of the scope.
+        std::uint64_t start;
+
+    public:
+
+        /*! @brief Starts the scope. name must be a string literal. */
+        explicit ProfilerScope(const char* scopeName)
+        : name(Profiler::Get().isEnabled() ? scopeName : nullptr), start(name ? Profiler::Now() : 0)
+        {
+
+        }
+
+        /*! @brief Ends the scope and records it. */
+        ~ProfilerScope()
+        {
+            if (name) Profiler::Get().record(name, start, Profiler::Now());
+        }
+
+        ProfilerScope(ProfilerScope const&) = delete;
+        ProfilerScope& operator = (ProfilerScope const&) = delete;
+    };
+}
+
+#define CleanProfilerConcat2(a, b) a##b
+#define CleanProfilerConcat(a, b) CleanProfilerConcat2(a, b)
+
+/*! @brief Records the time spent until the end of the current block. name must be a string literal. */
+#define ProfileScope(name) ::Clean::ProfilerScope CleanProfilerConcat(profilerScope, __LINE__)(name)
+
+/*! @brief Adds amount to the counter name for the current frame. name must be a string literal. */
+#define ProfileCount(name, amount) do { static ::Clean::ProfileCounter profileCounter(name); profileCounter.add(amount); } while(0)
+
+#endif // CLEAN_PROFILER_H
@@ -9,6 +9,7 @@
 #include "RenderSubCommand.h"
 #include "ShaderAttribute.h"
 #include "EffectSession.h"
+#include "OcclusionQuery.h"
 
 #include <cstdint>
 #include <memory>
@@ -52,6 +53,14 @@ namespace Clean
         //! @brief Lists EffectParameters set for this command. 
         EffectSession parameters;
         
+        //! @brief If not null, counts the samples drawn by the sub commands. \sa Driver::makeOcclusionQuery()
+        std::shared_ptr < OcclusionQuery > occlusionQuery = nullptr;
+        
+        //! @brief Size, in pixels, of the object drawn on screen: Mesh::ProjectedScreenSize() times the viewport's 
+        //! height. When not zero, the driver requests the textures of the command's parameters at this size to its 
+        //! TextureStreamer. \sa TextureStreamer::request()
+        float screenSize = 0.0f;
+        
         /*! @brief Creates a new sub command with its type and its ShaderAttributesMap.
          *
          * \param[in] type SubCommand type, can be kRenderSubCommandVertex, kRenderSubCommandIndexed. Default 
@@ -0,0 +1,515 @@
+/** \file Core/RenderGraph.cpp
+**/
+
+#include "RenderGraph.h"
+#include "Driver.h"
+#include "NotificationCenter.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Clean
+{
+    RenderGraphBuilder::RenderGraphBuilder(RenderGraph& g, std::uint32_t p) : graph(g), pass(p)
+    {
+
+    }
+
+    RenderGraphResource RenderGraphBuilder::create(std::string const& name, RenderTextureDescriptor const& descriptor)
+    {
+        if (!descriptor.width || !descriptor.height || (descriptor.colorFormat == kPixelFormatNull && !descriptor.depth))
+            return kRenderGraphInvalid;
+
+        RenderGraph::Resource resource;
+        resource.name = name;
+        resource.kind = kRenderGraphTransient;
+        resource.descriptor = descriptor;
+
+        return write(graph.add(std::move(resource)));
+    }
+
+    RenderGraphResource RenderGraphBuilder::read(RenderGraphResource resource)
+    {
+        if (resource >= graph.resources.size())
+            return kRenderGraphInvalid;
+
+        // An imported target is only drawn into: it can't be sampled.
+        if (graph.resources[resource].kind == kRenderGraphImportedTarget)
+            return kRenderGraphInvalid;
+
+        auto& reads = graph.passes[pass].reads;
+        if (std::find(reads.begin(), reads.end(), resource) == reads.end())
+            reads.push_back(resource);
+
+        return resource;
+    }
+
+    RenderGraphResource RenderGraphBuilder::write(RenderGraphResource resource)
+    {
+        if (resource >= graph.resources.size())
+            return kRenderGraphInvalid;
+
+        RenderGraph::Pass& current = graph.passes[pass];
+        RenderGraph::Resource& written = graph.resources[resource];
+
+        if (std::find(current.writes.begin(), current.writes.end(), resource) == current.writes.end())
+        {
+            current.writes.push_back(resource);
+            written.writers.push_back(pass);
+        }
+
+        if (current.target == kRenderGraphInvalid && written.kind != kRenderGraphImportedBuffer)
+            current.target = resource;
+
+        return resource;
+    }
+
+    void RenderGraphBuilder::setSideEffect()
+    {
+        graph.passes[pass].sideEffect = true;
+    }
+
+    RenderGraphContext::RenderGraphContext(Driver& d, RenderGraph const& g, std::shared_ptr < RenderTarget > const& t)
+        : driver(d), graph(g), target(t)
+    {
+
+    }
+
+    Driver& RenderGraphContext::getDriver() const
+    {
+        return driver;
+    }
+
+    std::shared_ptr < RenderTarget > const& RenderGraphContext::getTarget() const
+    {
+        return target;
+    }
+
+    std::shared_ptr < RenderTexture > RenderGraphContext::getTexture(RenderGraphResource resource) const
+    {
+        return graph.findTexture(resource);
+    }
+
+    std::shared_ptr < Buffer > RenderGraphContext::getBuffer(RenderGraphResource resource) const
+    {
+        if (resource >= graph.resources.size()) return nullptr;
+        return graph.resources[resource].buffer;
+    }
+
+    void RenderGraphContext::render(RenderCommand& command) const
+    {
+        if (!command.target) command.target = target;
+        if (!command.target || !command.pipeline) return;
+        driver.renderCommand(command);
+    }
+
+    void RenderGraph::addPass(std::string const& name, std::function < void(RenderGraphBuilder&) > const& setup,
+                              std::function < void(RenderGraphContext&) > const& execute)
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+
+        Pass pass;
+        pass.name = name;
+        pass.execute = execute;
+        passes.push_back(std::move(pass));
+
+        RenderGraphBuilder builder(*this, static_cast < std::uint32_t >(passes.size() - 1));
+        if (setup) setup(builder);
+
+        dirty = true;
+    }
+
+    RenderGraphResource RenderGraph::importTarget(std::string const& name, std::shared_ptr < RenderTarget > const& target)
+    {
+        if (!target) return kRenderGraphInvalid;
+
+        Resource resource;
+        resource.name = name;
+        resource.kind = kRenderGraphImportedTarget;
+        resource.target = target;
+
+        std::scoped_lock < std::mutex > lck(mutex);
+        return add(std::move(resource));
+    }
+
+    RenderGraphResource RenderGraph::importTexture(std::string const& name, std::shared_ptr < RenderTexture > const& texture)
+    {
+        if (!texture) return kRenderGraphInvalid;
+
+        Resource resource;
+        resource.name = name;
+        resource.kind = kRenderGraphImportedTexture;
+        resource.descriptor = texture->getDescriptor();
+        resource.texture = texture;
+
+        std::scoped_lock < std::mutex > lck(mutex);
+        return add(std::move(resource));
+    }
+
+    RenderGraphResource RenderGraph::importBuffer(std::string const& name, std::shared_ptr < Buffer > const& buffer)
+    {
+        if (!buffer) return kRenderGraphInvalid;
+
+        Resource resource;
+        resource.name = name;
+        resource.kind = kRenderGraphImportedBuffer;
+        resource.buffer = buffer;
+
+        std::scoped_lock < std::mutex > lck(mutex);
+        return add(std::move(resource));
+    }
+
+    RenderGraphResource RenderGraph::find(std::string const& name) const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+
+        for (std::size_t i = 0; i < resources.size(); ++i)
+        {
+            if (resources[i].name == name)
+                return static_cast < RenderGraphResource >(i);
+        }
+
+        return kRenderGraphInvalid;
+    }
+
+    void RenderGraph::clear()
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        passes.clear();
+        resources.clear();
+        order.clear();
+        physicals.clear();
+        dirty = true;
+        valid = false;
+    }
+
+    bool RenderGraph::compile()
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return compileLocked();
+    }
+
+    void RenderGraph::execute(Driver& driver)
+    {
+        ProfileScope("RenderGraph::execute");
+        std::scoped_lock < std::mutex > lck(mutex);
+
+        if (dirty && !compileLocked())
+            return;
+
+        if (!valid)
+            return;
+
+        executions++;
+
+        // Each physical texture takes a pooled RenderTexture with its descriptor, not taken yet.
+
+        for (Physical& physical : physicals)
+        {
+            physical.texture.reset();
+
+            for (Pooled& pooled : pool)
+            {
+                if (pooled.lastUse != executions && pooled.texture->getDescriptor() == physical.descriptor)
+                {
+                    pooled.lastUse = executions;
+                    physical.texture = pooled.texture;
+                    break;
+                }
+            }
+
+            if (!physical.texture)
+            {
+                physical.texture = driver.makeRenderTexture(physical.descriptor);
+
+                if (!physical.texture)
+                {
+                    NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError,
+                        "Driver %s can't make a RenderTexture of %zux%zu.", driver.getName().data(),
+                        physical.descriptor.width, physical.descriptor.height));
+                    continue;
+                }
+
+                pool.push_back({ physical.texture, executions });
+            }
+        }
+
+        auto expired = std::remove_if(pool.begin(), pool.end(), [this](Pooled const& pooled){
+            return executions - pooled.lastUse > kRenderGraphPoolFrames;
+        });
+
+        pool.erase(expired, pool.end());
+
+        for (std::size_t position = 0; position < order.size(); ++position)
+        {
+            Pass& pass = passes[order[position]];
+            ProfileScope("RenderGraph::pass");
+
+            for (RenderGraphBarrier barrier : pass.barriers)
+            {
+                barrier.texture = findTexture(barrier.resource);
+                barrier.buffer = resources[barrier.resource].buffer;
+                driver.insertBarrier(barrier);
+            }
+
+            std::shared_ptr < RenderTarget > target = findTarget(pass.target);
+
+            if (pass.target != kRenderGraphInvalid)
+            {
+                // Without its target, the pass would draw into the target bound before it.
+                if (!target) continue;
+
+                Resource const& resource = resources[pass.target];
+                if (resource.kind == kRenderGraphTransient && resource.first == position)
+                    target->prepare(driver);
+            }
+
+            RenderGraphContext context(driver, *this, target);
+            if (pass.execute) pass.execute(context);
+        }
+
+        ProfileCount("renderGraphPasses", order.size());
+    }
+
+    std::size_t RenderGraph::getPassCount() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return passes.size();
+    }
+
+    std::size_t RenderGraph::getCulledPassCount() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return valid ? passes.size() - order.size() : 0;
+    }
+
+    std::size_t RenderGraph::getPhysicalCount() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return physicals.size();
+    }
+
+    std::size_t RenderGraph::getTransientMemory() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        std::size_t result = 0;
+
+        for (Resource const& resource : resources)
+        {
+            if (resource.kind == kRenderGraphTransient && resource.alive)
+                result += resource.descriptor.getMemorySize();
+        }
+
+        return result;
+    }
+
+    std::size_t RenderGraph::getAliasedMemory() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        std::size_t result = 0;
+
+        for (Physical const& physical : physicals)
+            result += physical.descriptor.getMemorySize();
+
+        return result;
+    }
+
+    RenderGraphResource RenderGraph::add(Resource&& resource)
+    {
+        resources.push_back(std::move(resource));
+        dirty = true;
+        return static_cast < RenderGraphResource >(resources.size() - 1);
+    }
+
+    bool RenderGraph::compileLocked()
+    {
+        ProfileScope("RenderGraph::compile");
+
+        dirty = false;
+        valid = false;
+        order.clear();
+        physicals.clear();
+
+        // Checks that each pass reads resources written before it, or imported.
+
+        for (std::uint32_t p = 0; p < passes.size(); ++p)
+        {
+            for (RenderGraphResource r : passes[p].reads)
+            {
+                Resource const& resource = resources[r];
+                if (resource.kind != kRenderGraphTransient) continue;
+
+                if (resource.writers.empty() || resource.writers.front() >= p)
+                {
+                    NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError,
+                        "RenderGraph pass '%s' reads '%s' before it is written.", passes[p].name.data(), resource.name.data()));
+                    return false;
+                }
+            }
+        }
+
+        // Culling: a pass is kept while one of its written resources is read, or imported. Transient resources
+        // read by nobody release their writers, which release the resources they read, and so on.
+
+        for (Resource& resource : resources)
+            resource.refCount = 0;
+
+        for (Pass& pass : passes)
+        {
+            pass.culled = false;
+            pass.refCount = pass.writes.size();
+
+            for (RenderGraphResource r : pass.reads)
+                resources[r].refCount++;
+        }
+
+        std::vector < RenderGraphResource > unused;
+
+        for (RenderGraphResource r = 0; r < resources.size(); ++r)
+        {
+            if (resources[r].kind == kRenderGraphTransient && !resources[r].refCount)
+                unused.push_back(r);
+        }
+
+        while (!unused.empty())
+        {
+            Resource& resource = resources[unused.back()];
+            unused.pop_back();
+
+            for (std::uint32_t writer : resource.writers)
+            {
+                Pass& pass = passes[writer];
+                if (pass.culled || !pass.refCount || --pass.refCount || pass.sideEffect) continue;
+
+                pass.culled = true;
+
+                for (RenderGraphResource r : pass.reads)
+                {
+                    if (!--resources[r].refCount && resources[r].kind == kRenderGraphTransient)
+                        unused.push_back(r);
+                }
+            }
+        }
+
+        // Passes with nothing written and no side effect are culled too: they can't change the frame.
+
+        for (std::uint32_t p = 0; p < passes.size(); ++p)
+        {
+            Pass& pass = passes[p];
+            if (pass.writes.empty() && !pass.sideEffect) pass.culled = true;
+            if (!pass.culled) order.push_back(p);
+        }
+
+        // Lifetimes and barriers, in execution order.
+
+        std::vector < std::uint8_t > states(resources.size(), kRenderGraphStateUndefined);
+
+        for (Resource& resource : resources)
+            resource.alive = false;
+
+        auto access = [&](Pass& pass, RenderGraphResource r, std::uint8_t state, std::size_t position) {
+            Resource& resource = resources[r];
+
+            if (!resource.alive) {
+                resource.alive = true;
+                resource.first = position;
+            }
+
+            resource.last = position;
+
+            if (states[r] != kRenderGraphStateUndefined && states[r] != state) {
+                RenderGraphBarrier barrier;
+                barrier.resource = r;
+                barrier.before = states[r];
+                barrier.after = state;
+                pass.barriers.push_back(barrier);
+            }
+
+            states[r] = state;
+        };
+
+        for (std::size_t position = 0; position < order.size(); ++position)
+        {
+            Pass& pass = passes[order[position]];
+            pass.barriers.clear();
+
+            for (RenderGraphResource r : pass.reads)
+            {
+                const bool buffer = resources[r].kind == kRenderGraphImportedBuffer;
+                access(pass, r, buffer ? kRenderGraphStateBufferRead : kRenderGraphStateSampled, position);
+            }
+
+            for (RenderGraphResource r : pass.writes)
+            {
+                const bool buffer = resources[r].kind == kRenderGraphImportedBuffer;
+                access(pass, r, buffer ? kRenderGraphStateBufferWrite : kRenderGraphStateTarget, position);
+            }
+        }
+
+        // Aliasing: transient textures, by first use, take the first physical texture of their descriptor
+        // free before their first pass.
+
+        std::vector < RenderGraphResource > transients;
+
+        for (RenderGraphResource r = 0; r < resources.size(); ++r)
+        {
+            if (resources[r].alive && resources[r].kind == kRenderGraphTransient)
+                transients.push_back(r);
+        }
+
+        std::stable_sort(transients.begin(), transients.end(), [this](RenderGraphResource lhs, RenderGraphResource rhs){
+            return resources[lhs].first < resources[rhs].first;
+        });
+
+        for (RenderGraphResource r : transients)
+        {
+            Resource& resource = resources[r];
+            std::size_t index = 0;
+
+            while (index < physicals.size())
+            {
+                Physical const& physical = physicals[index];
+                if (physical.descriptor == resource.descriptor && physical.last < resource.first) break;
+                index++;
+            }
+
+            if (index == physicals.size())
+            {
+                Physical physical;
+                physical.descriptor = resource.descriptor;
+                physicals.push_back(physical);
+            }
+
+            physicals[index].last = resource.last;
+            resource.physical = index;
+        }
+
+        valid = true;
+        return true;
+    }
+
+    std::shared_ptr < RenderTexture > RenderGraph::findTexture(RenderGraphResource r) const
+    {
+        if (r >= resources.size()) return nullptr;
+        Resource const& resource = resources[r];
+
+        if (resource.kind == kRenderGraphImportedTexture)
+            return resource.texture;
+
+        if (resource.kind == kRenderGraphTransient && valid && resource.physical < physicals.size())
+            return physicals[resource.physical].texture;
+
+        return nullptr;
+    }
+
+    std::shared_ptr < RenderTarget > RenderGraph::findTarget(RenderGraphResource r) const
+    {
+        if (r >= resources.size()) return nullptr;
+
+        if (resources[r].kind == kRenderGraphImportedTarget)
+            return resources[r].target;
+
+        return findTexture(r);
+    }
+}
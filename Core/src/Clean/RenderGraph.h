@@ -0,0 +1,320 @@
+/** \file Core/RenderGraph.h
+**/
+
+#ifndef CLEAN_RENDERGRAPH_H
+#define CLEAN_RENDERGRAPH_H
+
+#include "RenderTexture.h"
+#include "RenderCommand.h"
+#include "Buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Clean
+{
+    class Driver;
+    class RenderGraph;
+
+    //! @brief Index of a resource in a RenderGraph.
+    typedef std::uint32_t RenderGraphResource;
+
+    //! @brief Resource returned when a resource can't be declared.
+    static constexpr const RenderGraphResource kRenderGraphInvalid = std::numeric_limits < RenderGraphResource >::max();
+
+    //! @brief Number of executions a pooled RenderTexture is kept without being used.
+    static constexpr const std::uint64_t kRenderGraphPoolFrames = 3;
+
+    //! @brief Kinds of resources in a RenderGraph. @{
+    static constexpr const std::uint8_t kRenderGraphTransient = 0;
+    static constexpr const std::uint8_t kRenderGraphImportedTarget = 1;
+    static constexpr const std::uint8_t kRenderGraphImportedTexture = 2;
+    static constexpr const std::uint8_t kRenderGraphImportedBuffer = 3;
+    //! @}
+
+    //! @brief How a pass uses a resource. @{
+    static constexpr const std::uint8_t kRenderGraphStateUndefined = 0;
+    static constexpr const std::uint8_t kRenderGraphStateTarget = 1;
+    static constexpr const std::uint8_t kRenderGraphStateSampled = 2;
+    static constexpr const std::uint8_t kRenderGraphStateBufferRead = 3;
+    static constexpr const std::uint8_t kRenderGraphStateBufferWrite = 4;
+    //! @}
+
+    /** @brief A change of use of a resource between two passes. \sa Driver::insertBarrier() */
+    struct RenderGraphBarrier
+    {
+        //! @brief Resource changing of use.
+        RenderGraphResource resource = kRenderGraphInvalid;
+
+        //! @brief kRenderGraphState* before and after the barrier.
+        std::uint8_t before = kRenderGraphStateUndefined;
+        std::uint8_t after = kRenderGraphStateUndefined;
+
+        //! @brief Texture of the resource when executed, or null for a buffer or an imported target.
+        std::shared_ptr < RenderTexture > texture;
+
+        //! @brief Buffer of the resource when executed, or null.
+        std::shared_ptr < Buffer > buffer;
+    };
+
+    /** @brief Given to the setup function of a pass, to declare the resources it uses. */
+    class RenderGraphBuilder
+    {
+        friend class RenderGraph;
+
+        //! @brief Graph being built.
+        RenderGraph& graph;
+
+        //! @brief Index of the pass being set up.
+        std::uint32_t pass;
+
+        RenderGraphBuilder(RenderGraph& graph, std::uint32_t pass);
+
+    public:
+
+        /*! @brief Declares a transient texture, written by this pass. Its memory may be shared with other
+         *  transient textures of the same descriptor, used by passes not overlapping its lifetime. */
+        RenderGraphResource create(std::string const& name, RenderTextureDescriptor const& descriptor);
+
+        /*! @brief Declares a resource read by this pass: sampled for a texture. Returns resource. */
+        RenderGraphResource read(RenderGraphResource resource);
+
+        /*! @brief Declares a resource written by this pass: drawn into for a texture or a target. Returns resource. */
+        RenderGraphResource write(RenderGraphResource resource);
+
+        /*! @brief Keeps the pass even if nothing reads what it writes. */
+        void setSideEffect();
+    };
+
+    /** @brief Given to the execute function of a pass, to find its resources. */
+    class RenderGraphContext
+    {
+        friend class RenderGraph;
+
+        //! @brief Driver executing the graph.
+        Driver& driver;
+
+        //! @brief Graph executed.
+        RenderGraph const& graph;
+
+        //! @brief Target of the pass: the first texture or target it writes. May be null.
+        std::shared_ptr < RenderTarget > target;
+
+        RenderGraphContext(Driver& driver, RenderGraph const& graph, std::shared_ptr < RenderTarget > const& target);
+
+    public:
+
+        /*! @brief Returns the driver executing the graph. */
+        Driver& getDriver() const;
+
+        /*! @brief Returns the target of the pass, or null if it writes none. */
+        std::shared_ptr < RenderTarget > const& getTarget() const;
+
+        /*! @brief Returns the texture of a resource, transient or imported, or null. */
+        std::shared_ptr < RenderTexture > getTexture(RenderGraphResource resource) const;
+
+        /*! @brief Returns the buffer of an imported buffer resource, or null. */
+        std::shared_ptr < Buffer > getBuffer(RenderGraphResource resource) const;
+
+        /*! @brief Renders command into the pass's target. command.target is set if null. */
+        void render(RenderCommand& command) const;
+    };
+
+    /** @brief Describes a frame as passes using resources, and draws it with as few textures as possible.
+     *
+     * Each pass is given a setup function, called by addPass() to declare the resources it reads and writes,
+     * and an execute function, called by execute() to render it. Passes create transient textures, or use
+     * resources imported in the graph: targets like RenderWindows, persistent RenderTextures and Buffers.
+     * A pass only reads resources written by passes added before it, so passes run in the order they are
+     * added.
+     *
+     * compile() prepares the execution:
+     *  - Passes whose written resources are never read are culled, unless they write an imported resource or
+     *    have a side effect: an unused shadow map is never drawn.
+     *  - The lifetime of each transient texture goes from the first to the last pass using it. Transient textures
+     *    with the same descriptor whose lifetimes don't overlap share one RenderTexture: a bloom chain and a
+     *    shadow map of the same size use the same memory.
+     *  - A RenderGraphBarrier is inserted before a pass using a resource differently from the pass before, like
+     *    sampling a texture drawn before. Drivers with explicit synchronization use it with Driver::insertBarrier().
+     *
+     * execute() compiles the graph if it changed, takes RenderTextures from a pool kept between executions, or makes
+     * them with Driver::makeRenderTexture(), and runs the passes. Transient textures are cleared by their first pass.
+     * A Driver executes its graph in Driver::update(), before its RenderQueues, see Driver::setRenderGraph().
+     *
+     * The graph is thread-safe, but setup and execute functions must not call its functions: they are called
+     * with the graph locked, and use their RenderGraphBuilder or RenderGraphContext instead.
+     *
+    **/
+    class RenderGraph
+    {
+        friend class RenderGraphBuilder;
+        friend class RenderGraphContext;
+
+        /** @brief A pass of the graph. */
+        struct Pass
+        {
+            std::string name;
+            std::function < void(RenderGraphContext&) > execute;
+
+            //! @brief Resources read and written by the pass.
+            std::vector < RenderGraphResource > reads, writes;
+
+            //! @brief First texture or target written, used as the pass's target.
+            RenderGraphResource target = kRenderGraphInvalid;
+
+            //! @brief True if the pass may not be culled.
+            bool sideEffect = false;
+
+            //! @brief Written resources still read by a pass. Zero if the pass is culled.
+            std::size_t refCount = 0;
+
+            //! @brief True if culled by the last compile().
+            bool culled = false;
+
+            //! @brief Barriers inserted before the pass.
+            std::vector < RenderGraphBarrier > barriers;
+        };
+
+        /** @brief A resource of the graph. */
+        struct Resource
+        {
+            std::string name;
+            std::uint8_t kind = kRenderGraphTransient;
+            RenderTextureDescriptor descriptor;
+
+            //! @brief Imported objects, depending on kind.
+            std::shared_ptr < RenderTarget > target;
+            std::shared_ptr < RenderTexture > texture;
+            std::shared_ptr < Buffer > buffer;
+
+            //! @brief Passes writing the resource.
+            std::vector < std::uint32_t > writers;
+
+            //! @brief Passes not culled reading the resource.
+            std::size_t refCount = 0;
+
+            //! @brief True if a pass not culled uses the resource.
+            bool alive = false;
+
+            //! @brief Positions, in the execution order, of the first and last passes using the resource.
+            std::size_t first = 0, last = 0;
+
+            //! @brief Index of the RenderTexture used by a transient, in physicals.
+            std::size_t physical = 0;
+        };
+
+        /** @brief A RenderTexture shared by transient textures. */
+        struct Physical
+        {
+            RenderTextureDescriptor descriptor;
+
+            //! @brief Position of the last pass using it.
+            std::size_t last = 0;
+
+            //! @brief Texture used by the current execution.
+            std::shared_ptr < RenderTexture > texture;
+        };
+
+        /** @brief A RenderTexture kept between executions. */
+        struct Pooled
+        {
+            std::shared_ptr < RenderTexture > texture;
+
+            //! @brief Last execution using it.
+            std::uint64_t lastUse = 0;
+        };
+
+        //! @brief Passes, in the order they were added.
+        std::vector < Pass > passes;
+
+        //! @brief Resources, by RenderGraphResource.
+        std::vector < Resource > resources;
+
+        //! @brief Passes not culled, in execution order.
+        std::vector < std::uint32_t > order;
+
+        //! @brief RenderTextures needed by the compiled graph.
+        std::vector < Physical > physicals;
+
+        //! @brief RenderTextures kept between executions.
+        std::vector < Pooled > pool;
+
+        //! @brief Number of executions done.
+        std::uint64_t executions = 0;
+
+        //! @brief True if passes or resources changed since the last compile().
+        bool dirty = true;
+
+        //! @brief True if the last compile() succeeded.
+        bool valid = false;
+
+        //! @brief Protects every field above.
+        mutable std::mutex mutex;
+
+    public:
+
+        /*! @brief Constructs an empty graph. */
+        RenderGraph() = default;
+
+        /*! @brief Adds a pass. setup is called now to declare the pass's resources. */
+        void addPass(std::string const& name, std::function < void(RenderGraphBuilder&) > const& setup,
+                     std::function < void(RenderGraphContext&) > const& execute);
+
+        /*! @brief Imports a target drawn by the graph, like a RenderWindow. Passes writing it are never culled. */
+        RenderGraphResource importTarget(std::string const& name, std::shared_ptr < RenderTarget > const& target);
+
+        /*! @brief Imports a RenderTexture kept by its owner between frames, like the history of a temporal filter. */
+        RenderGraphResource importTexture(std::string const& name, std::shared_ptr < RenderTexture > const& texture);
+
+        /*! @brief Imports a Buffer read or written by passes. */
+        RenderGraphResource importBuffer(std::string const& name, std::shared_ptr < Buffer > const& buffer);
+
+        /*! @brief Finds a resource by name, or returns kRenderGraphInvalid. */
+        RenderGraphResource find(std::string const& name) const;
+
+        /*! @brief Removes every pass and resource. The pool of RenderTextures is kept. */
+        void clear();
+
+        /*! @brief Culls passes, computes lifetimes and barriers, and assigns RenderTextures to transient textures.
+         *  Returns false, and sends a notification, if a pass reads a resource not written before it. */
+        bool compile();
+
+        /*! @brief Compiles the graph if it changed, and executes its passes with the given driver. Must be called
+         *  by the driver's thread. */
+        void execute(Driver& driver);
+
+        /*! @brief Returns the number of passes, and the number of passes culled by the last compile(). */
+        std::size_t getPassCount() const;
+        std::size_t getCulledPassCount() const;
+
+        /*! @brief Returns the number of RenderTextures needed by the transient textures. */
+        std::size_t getPhysicalCount() const;
+
+        /*! @brief Returns the memory needed by the transient textures of the passes not culled, without and with
+         *  aliasing, in bytes. */
+        std::size_t getTransientMemory() const;
+        std::size_t getAliasedMemory() const;
+
+    private:
+
+        /*! @brief Adds a resource and returns its index. mutex must be locked. */
+        RenderGraphResource add(Resource&& resource);
+
+        /*! @brief Implementation of compile(). mutex must be locked. */
+        bool compileLocked();
+
+        /*! @brief Returns the texture of a resource, or null. mutex must be locked. */
+        std::shared_ptr < RenderTexture > findTexture(RenderGraphResource resource) const;
+
+        /*! @brief Returns the target of a resource, or null. mutex must be locked. */
+        std::shared_ptr < RenderTarget > findTarget(RenderGraphResource resource) const;
+    };
+}
+
+#endif // CLEAN_RENDERGRAPH_H
@@ -4,10 +4,13 @@
 #include "RenderPipeline.h"
 #include "VertexDescriptor.h"
 #include "NotificationCenter.h"
+#include "Allocate.h"
 
 #include "Platform.h"
 #include "Core.h"
 
+#include <algorithm>
+
 namespace Clean 
 {
     RenderPipeline::RenderPipeline(Driver* driver) 
@@ -37,6 +40,23 @@ namespace Clean
         }
     }
     
+    std::vector < std::shared_ptr < Shader > > RenderPipeline::getShaders() const
+    {
+        std::scoped_lock < std::mutex > lck(shadersMutex);
+        std::vector < std::shared_ptr < Shader > > result;
+        result.reserve(shaders.size());
+        
+        for (auto const& pair : shaders)
+            result.push_back(pair.second);
+        
+        return result;
+    }
+    
+    bool RenderPipeline::compile()
+    {
+        return true;
+    }
+    
     void RenderPipeline::bindEffectParameters(std::vector < std::shared_ptr < EffectParameter > > const& parameters) const 
     {
         if (!parameters.size()) return;
@@ -49,14 +69,53 @@ namespace Clean
             return;
         }
         
-        for (auto parameter : parameters)
+        std::scoped_lock < std::mutex > uploadedLock(uploadedParametersMutex);
+        pruneParameterBlocks();
+        
+        for (auto const& parameter : parameters)
         {
             std::lock_guard < std::mutex > lck(parameter->mutex);
+            if (!shouldUpload(*parameter)) continue;
+            
             ShaderParameter sparam = loadedMapper->map(*parameter, *this);
             bindParameter(sparam);
         }
     }
     
+    void RenderPipeline::bindEffectParameters(std::vector < std::shared_ptr < EffectParameter > > const& parameters, std::uint64_t layout) const 
+    {
+        if (!parameters.size()) return;
+        
+        std::shared_ptr < ShaderMapper > loadedMapper = std::atomic_load(&mapper);
+        
+        if (!loadedMapper) {
+            Notification notif = BuildNotification(kNotificationLevelError, "Null ShaderMapper or EffectParameters given to pipeline #%i.", getHandle());
+            NotificationCenter::GetDefault()->send(notif);
+            return;
+        }
+        
+        std::shared_ptr < const BindingPlan > plan = findPlan(parameters, layout, *loadedMapper);
+        
+        if (!plan) {
+            bindEffectParameters(parameters);
+            return;
+        }
+        
+        std::scoped_lock < std::mutex > uploadedLock(uploadedParametersMutex);
+        
+        for (BindingPlanEntry const& entry : plan->entries)
+        {
+            EffectParameter const& parameter = *parameters[entry.slot];
+            std::lock_guard < std::mutex > lck(parameter.mutex);
+            
+            UploadedParameter& uploaded = uploadedParameters[entry.cache];
+            if (uploaded.version == parameter.version) continue;
+            
+            uploaded.version = parameter.version;
+            bindParameterAt(entry.location, entry.type, parameter.value);
+        }
+    }
+    
     void RenderPipeline::bindEffectParameter(std::shared_ptr < EffectParameter > const& parameter) const 
     {
         std::shared_ptr < ShaderMapper > loadedMapper = std::atomic_load(&mapper);
@@ -67,7 +126,10 @@ namespace Clean
             return;
         }
         
+        std::scoped_lock < std::mutex > uploadedLock(uploadedParametersMutex);
         std::lock_guard < std::mutex > lck(parameter->mutex);
+        if (!shouldUpload(*parameter)) return;
+        
         ShaderParameter sparam = loadedMapper->map(*parameter, *this);
         bindParameter(sparam);
     }
@@ -83,6 +145,7 @@ namespace Clean
     {
         std::shared_ptr < ShaderMapper > nullPtr;
         std::atomic_store(&mapper, nullPtr);
+        invalidateUploadedParameters();
         
         // If we already are linked, we can't modify the mapper or any of the shaders
         // present in this pipeline. A ShaderMapper must be present before linking the
@@ -226,4 +289,177 @@ namespace Clean
         ShaderParameter sparam = loadedMapper->map(param->param, *this);
         bindTexture(sparam, *param->texture);
     }
+    
+    void RenderPipeline::invalidateUploadedParameters() const
+    {
+        std::scoped_lock < std::mutex > lck(uploadedParametersMutex);
+        uploadedParameters.clear();
+        uploadedIndex.clear();
+        coveredBlocks.clear();
+        coveredPending = false;
+        blockParameters.clear();
+        coverageKey = 0;
+        plans.clear();
+    }
+    
+    bool RenderPipeline::bindParameterBlock(ParameterBlock&) const
+    {
+        return false;
+    }
+    
+    void RenderPipeline::resetParameterBlocks() const
+    {
+        std::scoped_lock < std::mutex > lck(uploadedParametersMutex);
+        
+        for (CoveredBlock& block : coveredBlocks)
+            block.bound = false;
+        
+        coveredPending = !coveredBlocks.empty();
+    }
+    
+    void RenderPipeline::coverParameters(std::uint8_t binding, ParameterBlockLayout const& layout) const
+    {
+        // FNV-1a over the members' hashes, as EffectSession::getLayout().
+        std::uint64_t key = 14695981039346656037ULL;
+        
+        for (auto const& member : layout.getMembers())
+            key = (key ^ member.hash) * 1099511628211ULL;
+        
+        std::scoped_lock < std::mutex > lck(uploadedParametersMutex);
+        
+        auto it = std::find_if(coveredBlocks.begin(), coveredBlocks.end(), 
+                               [binding](CoveredBlock const& block){ return block.binding == binding; });
+        
+        if (it != coveredBlocks.end() && it->key == key) {
+            it->bound = true;
+            return;
+        }
+        
+        if (it == coveredBlocks.end())
+            it = coveredBlocks.insert(coveredBlocks.end(), CoveredBlock());
+        
+        it->binding = binding;
+        it->key = key;
+        it->bound = true;
+        it->hashes.clear();
+        
+        for (auto const& member : layout.getMembers())
+            it->hashes.push_back(member.hash);
+        
+        updateCoverage();
+    }
+    
+    void RenderPipeline::uncoverParameters(std::uint8_t binding) const
+    {
+        std::scoped_lock < std::mutex > lck(uploadedParametersMutex);
+        
+        auto it = std::find_if(coveredBlocks.begin(), coveredBlocks.end(), 
+                               [binding](CoveredBlock const& block){ return block.binding == binding; });
+        
+        if (it == coveredBlocks.end()) return;
+        
+        coveredBlocks.erase(it);
+        updateCoverage();
+    }
+    
+    void RenderPipeline::pruneParameterBlocks() const
+    {
+        if (!coveredPending) return;
+        coveredPending = false;
+        
+        auto removed = std::remove_if(coveredBlocks.begin(), coveredBlocks.end(), [](CoveredBlock const& block){ return !block.bound; });
+        if (removed == coveredBlocks.end()) return;
+        
+        coveredBlocks.erase(removed, coveredBlocks.end());
+        updateCoverage();
+    }
+    
+    void RenderPipeline::updateCoverage() const
+    {
+        std::unordered_set < std::uint64_t > covered;
+        coverageKey = 0;
+        
+        // Order independent: blocks may be bound in another order by the next command. 
+        for (CoveredBlock const& block : coveredBlocks) 
+        {
+            coverageKey ^= block.key * (block.binding + 1);
+            covered.insert(block.hashes.begin(), block.hashes.end());
+        }
+        
+        // A parameter uncovered holds no value in the program: it must be uploaded at its next bind. 
+        for (std::uint64_t hash : blockParameters)
+        {
+            if (covered.count(hash)) continue;
+            
+            auto it = uploadedIndex.find(hash);
+            if (it != uploadedIndex.end()) uploadedParameters[it->second].version = 0;
+        }
+        
+        blockParameters = std::move(covered);
+    }
+    
+    bool RenderPipeline::shouldUpload(EffectParameter const& parameter) const
+    {
+        if (blockParameters.count(parameter.hash)) return false;
+        
+        UploadedParameter& uploaded = uploadedParameters[findUploadedIndex(parameter.hash)];
+        
+        if (uploaded.version == parameter.version)
+            return false;
+        
+        uploaded.version = parameter.version;
+        return true;
+    }
+    
+    std::size_t RenderPipeline::findUploadedIndex(std::uint64_t hash) const
+    {
+        auto result = uploadedIndex.emplace(hash, uploadedParameters.size());
+        if (result.second) uploadedParameters.emplace_back();
+        return result.first->second;
+    }
+    
+    std::shared_ptr < const BindingPlan > RenderPipeline::findPlan(std::vector < std::shared_ptr < EffectParameter > > const& parameters, 
+                                                                   std::uint64_t layout, ShaderMapper const& mapper) const
+    {
+        std::shared_ptr < const BindingPlan > plan;
+        std::uint64_t key = 0;
+        
+        {
+            std::scoped_lock < std::mutex > lck(uploadedParametersMutex);
+            pruneParameterBlocks();
+            
+            key = layout ^ (coverageKey * 0x9E3779B97F4A7C15ULL);
+            auto it = plans.find(key);
+            if (it != plans.end()) plan = it->second;
+        }
+        
+        if (!plan)
+        {
+            // Compiled out of the lock: the mapper locks the parameters and the pipeline may query its program. 
+            BindingPlan compiled = mapper.compile(parameters, *this);
+            
+            std::scoped_lock < std::mutex > lck(uploadedParametersMutex);
+            auto covered = std::remove_if(compiled.entries.begin(), compiled.entries.end(), 
+                                          [this](auto const& entry){ return blockParameters.count(entry.hash) > 0; });
+            compiled.entries.erase(covered, compiled.entries.end());
+            
+            for (BindingPlanEntry& entry : compiled.entries)
+                entry.cache = static_cast < std::uint32_t >(findUploadedIndex(entry.hash));
+            
+            plan = AllocateShared < BindingPlan >(std::move(compiled));
+            plans.insert_or_assign(key, plan);
+        }
+        
+        // Layouts are hashes: a different list with the same layout must not use this plan. 
+        
+        if (plan->parametersCount != parameters.size())
+            return nullptr;
+        
+        for (BindingPlanEntry const& entry : plan->entries) {
+            if (parameters[entry.slot]->hash != entry.hash) 
+                return nullptr;
+        }
+        
+        return plan;
+    }
 }
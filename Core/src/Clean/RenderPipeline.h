@@ -9,12 +9,16 @@
 #include "ShaderParameter.h"
 #include "DriverResource.h"
 #include "EffectParameter.h"
+#include "ParameterBlock.h"
+#include "BindingPlan.h"
 #include "Texture.h"
 
 #include <cstdint>
 #include <map>
 #include <mutex>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Clean 
 {
@@ -61,6 +65,57 @@ namespace Clean
         //! @brief ShaderMapper associated to this shader. 
         std::shared_ptr < ShaderMapper > mapper;
         
+        /** @brief Identifies the last value uploaded for a parameter's hash. */
+        struct UploadedParameter 
+        {
+            //! @brief EffectParameter::version when uploaded. 
+            std::uint64_t version = 0;
+        };
+        
+        //! @brief Last value uploaded for each parameter's hash. As versions are never reused, but by the snapshots
+        //! of a parameter which hold its value (see EffectSession::snapshot()), a parameter with the same version
+        //! is already in the program and is not mapped nor uploaded again.
+        mutable std::vector < UploadedParameter > uploadedParameters;
+        
+        //! @brief Index of each hash in uploadedParameters. BindingPlanEntry::cache holds this index.
+        mutable std::unordered_map < std::uint64_t, std::size_t > uploadedIndex;
+        
+        /** @brief A ParameterBlock bound for the current command. */
+        struct CoveredBlock 
+        {
+            //! @brief Binding index of the block.
+            std::uint8_t binding = 0;
+            
+            //! @brief Hash of the members' hashes, in order.
+            std::uint64_t key = 0;
+            
+            //! @brief Hashes of the members.
+            std::vector < std::uint64_t > hashes;
+            
+            //! @brief True if bound since the last resetParameterBlocks().
+            bool bound = false;
+        };
+        
+        //! @brief Blocks bound and uploaded for the current command. 
+        mutable std::vector < CoveredBlock > coveredBlocks;
+        
+        //! @brief True after resetParameterBlocks(), until the blocks not bound again are dropped. 
+        mutable bool coveredPending = false;
+        
+        //! @brief Hashes of parameters held by coveredBlocks. They are uploaded with their block, and 
+        //! bindEffectParameters() skips them. 
+        mutable std::unordered_set < std::uint64_t > blockParameters;
+        
+        //! @brief Hash of the keys of coveredBlocks. Plans are compiled by layout and by coverage. 
+        mutable std::uint64_t coverageKey = 0;
+        
+        //! @brief BindingPlans compiled for this pipeline, by parameters list layout and coverageKey. 
+        mutable std::unordered_map < std::uint64_t, std::shared_ptr < const BindingPlan > > plans;
+        
+        //! @brief Protects uploadedParameters, uploadedIndex, the covered blocks and plans. Must be locked
+        //! before an EffectParameter's mutex. 
+        mutable std::mutex uploadedParametersMutex;
+        
     public:
         
         /*! @brief Default constructor. */
@@ -80,12 +135,47 @@ namespace Clean
         /*! @brief Registers multiple shaders for their given stage. */
         virtual void batchShaders(std::vector < std::shared_ptr < Shader > > const& shaders);
         
+        /*! @brief Returns the shaders registered. */
+        virtual std::vector < std::shared_ptr < Shader > > getShaders() const;
+        
+        /*! @brief Compiles the pipeline if not already done, and returns true if it is ready to be bound. 
+         *  Default implementation returns true. Derived classes must allow calls from any thread. */
+        virtual bool compile();
+        
         /*! @brief Binds this pipeline onto the given Driver. */
         virtual void bind(Driver const& driver) const = 0;
         
-        /*! @brief Binds multiple EffectParameters onto this pipeline. */
+        /*! @brief Binds multiple EffectParameters onto this pipeline. A parameter is skipped if it was 
+         *  the last one uploaded for its hash and its version did not change since. */
         virtual void bindEffectParameters(std::vector < std::shared_ptr < EffectParameter > > const& parameters) const;
         
+        /*! @brief Binds multiple EffectParameters with the BindingPlan compiled for their layout.
+         *
+         * The first time a layout is bound with the current ParameterBlocks, the ShaderMapper compiles its 
+         * BindingPlan, which is kept until the mapper changes or the program is linked again. Next binds only
+         * upload the parameters whose version changed, at their precomputed location. 
+         *
+         * \param parameters Parameters to bind.
+         * \param layout Hash of the parameters' hashes in order, like EffectSession::getLayout(). Lists with 
+         *      the same layout must hold the same hashes in the same order.
+         *
+        **/
+        virtual void bindEffectParameters(std::vector < std::shared_ptr < EffectParameter > > const& parameters, std::uint64_t layout) const;
+        
+        /*! @brief Uploads a ParameterBlock if needed and binds it onto this pipeline. 
+         *
+         * \return True if the pipeline uses the block. False if it does not, or if the driver doesn't support
+         *      blocks: the block's parameters must then be bound one by one. Default implementation always
+         *      returns false. 
+         *
+        **/
+        virtual bool bindParameterBlock(ParameterBlock& block) const;
+        
+        /*! @brief Starts the binding of a new command's parameters. Parameters of blocks not bound again by 
+         *  the command, because they were removed from their EffectSession for example, are bound one by one
+         *  again. Called by Driver::renderCommand(). */
+        void resetParameterBlocks() const;
+        
         /*! @brief Binds one EffectParameter onto this pipeline. */
         virtual void bindEffectParameter(std::shared_ptr < EffectParameter > const& parameter) const;
         
@@ -95,6 +185,13 @@ namespace Clean
         /*! @brief Bind one parameter onto this pipeline. */
         virtual void bindParameter(ShaderParameter const& parameter) const = 0;
         
+        /*! @brief Returns the location of a parameter in this pipeline, or -1 if the pipeline doesn't use it. */
+        virtual std::int32_t findParameterLocation(ShaderParameter const& parameter) const = 0;
+        
+        /*! @brief Uploads a value at a location returned by findParameterLocation(). Used by BindingPlans: 
+         *  it is called only from bindEffectParameters(), which may be overriden to prepare the uploads. */
+        virtual void bindParameterAt(std::int32_t location, std::uint8_t type, ShaderValue const& value) const = 0;
+        
         /*! @brief Binds multiple ShaderAttribute onto this pipeline. */
         virtual void bindShaderAttributes(ShaderAttributesMap const& attributes) const = 0;
         
@@ -162,6 +259,42 @@ namespace Clean
         
         /*! @brief Returns true if this RenderPipeline can be modified, false otherwise. */
         virtual bool isModifiable() const = 0;
+        
+    protected:
+        
+        /*! @brief Forgets values uploaded by bindEffectParameters(). Derived classes must call it when
+         *  the program's values are lost, for example when it is linked again. */
+        void invalidateUploadedParameters() const;
+        
+        /*! @brief Marks the parameters of a block bound and uploaded at binding for the current command, so they 
+         *  are not bound one by one. */
+        void coverParameters(std::uint8_t binding, ParameterBlockLayout const& layout) const;
+        
+        /*! @brief Forgets the block at binding, whose upload failed: its parameters are bound one by one again. */
+        void uncoverParameters(std::uint8_t binding) const;
+        
+    private:
+        
+        /*! @brief Drops the blocks not bound since resetParameterBlocks(). uploadedParametersMutex must be locked. */
+        void pruneParameterBlocks() const;
+        
+        /*! @brief Computes blockParameters and coverageKey from coveredBlocks. Parameters which are not covered 
+         *  anymore are uploaded again. uploadedParametersMutex must be locked. */
+        void updateCoverage() const;
+        
+        /*! @brief Returns true if the parameter is not held by a bound block and differs from the last one 
+         *  uploaded for its hash, and records it as uploaded. uploadedParametersMutex and parameter's mutex 
+         *  must be locked. */
+        bool shouldUpload(EffectParameter const& parameter) const;
+        
+        /*! @brief Returns the index of a hash in uploadedParameters, adding it if needed. 
+         *  uploadedParametersMutex must be locked. */
+        std::size_t findUploadedIndex(std::uint64_t hash) const;
+        
+        /*! @brief Returns the BindingPlan for the given layout, compiling it with mapper if needed. 
+         *  Returns null if a plan compiled for this layout doesn't match the parameters. */
+        std::shared_ptr < const BindingPlan > findPlan(std::vector < std::shared_ptr < EffectParameter > > const& parameters, 
+                                                       std::uint64_t layout, ShaderMapper const& mapper) const;
     };
 }
 
@@ -6,6 +6,18 @@
 
 namespace Clean 
 {
+    /*! @brief Copies command with snapshots of its parameters, and of its sub commands' ones. */
+    static RenderCommand SnapshotCommand(RenderCommand const& command)
+    {
+        RenderCommand copy = command;
+        copy.parameters.snapshot(command.parameters);
+        
+        for (std::size_t i = 0; i < copy.subCommands.size(); ++i)
+            copy.subCommands[i].parameters.snapshot(command.subCommands[i].parameters);
+        
+        return copy;
+    }
+    
     RenderQueue::RenderQueue(std::uint8_t t) 
     {
         type.store(t);
@@ -54,9 +66,45 @@ namespace Clean
         commitedCommands.fetch_add(1);
     }
     
+    void RenderQueue::addCommand(RenderCommand const& command, std::uint64_t frame)
+    {
+        RenderCommand copy = SnapshotCommand(command);
+        
+        std::scoped_lock < std::mutex > lck(commandsMutex);
+        frameCommands[FramePipeline::SlotOf(frame)].push_back(std::move(copy));
+    }
+    
+    void RenderQueue::addCommands(std::vector < RenderCommand > const& list, std::uint64_t frame)
+    {
+        std::vector < RenderCommand > copies;
+        copies.reserve(list.size());
+        
+        for (RenderCommand const& command : list)
+            copies.push_back(SnapshotCommand(command));
+        
+        std::scoped_lock < std::mutex > lck(commandsMutex);
+        auto& destination = frameCommands[FramePipeline::SlotOf(frame)];
+        destination.reserve(destination.size() + copies.size());
+        
+        for (RenderCommand& command : copies)
+            destination.push_back(std::move(command));
+    }
+    
+    void RenderQueue::takeFrameCommands(std::uint64_t frame, std::vector < RenderCommand >& out)
+    {
+        out.clear();
+        
+        std::scoped_lock < std::mutex > lck(commandsMutex);
+        std::swap(out, frameCommands[FramePipeline::SlotOf(frame)]);
+    }
+    
     bool RenderQueue::isEmpty() const 
     {
         std::scoped_lock < std::mutex > lck(commandsMutex);
+        
+        for (auto const& list : frameCommands)
+            if (!list.empty()) return false;
+        
         return commands.empty();
     }
     
@@ -6,11 +6,13 @@
 
 #include "Handled.h"
 #include "RenderCommand.h"
+#include "FramePipeline.h"
 
 #include <cstdint>
 #include <atomic>
 #include <queue>
 #include <mutex>
+#include <vector>
 
 namespace Clean 
 {
@@ -27,6 +29,10 @@ namespace Clean
      * will be draw under different priorities. For example, transparent objects should be draw after opaque objects,
      * so their RenderCommand objects must be pushed in a queue that will have a lower priority than opaque objects. 
      *
+     * Commands may also be added for a frame of the Driver's FramePipeline. They are kept apart, by frame, and
+     * rendered once when the driver submits this frame, whatever the queue's type. This lets the next frame be 
+     * recorded while the driver still renders the previous one.
+     *
     **/
     class RenderQueue : public Handled < RenderQueue >
     {
@@ -49,6 +55,9 @@ namespace Clean
         //! process only this current number of commands. 
         std::atomic < std::size_t > commitedCommands;
         
+        //! @brief Commands added for a frame of the FramePipeline, by FramePipeline::SlotOf(). 
+        std::vector < RenderCommand > frameCommands[kFramePipelineMaxFrames];
+        
     public:
         
         /*! @brief Constructs the queue. */
@@ -66,6 +75,18 @@ namespace Clean
         /*! @brief Adds a RenderCommand to the back of the queue. */
         virtual void addCommand(RenderCommand const& command);
         
+        /*! @brief Adds a RenderCommand rendered when the driver submits the given frame. The command's parameters,
+         *  and its sub commands' ones, are snapshots taken now (see EffectSession::snapshot()). */
+        void addCommand(RenderCommand const& command, std::uint64_t frame);
+        
+        /*! @brief Adds RenderCommands rendered when the driver submits the given frame. Jobs recording
+         *  commands should fill their own vector and add it at once, to take the lock only once. */
+        void addCommands(std::vector < RenderCommand > const& commands, std::uint64_t frame);
+        
+        /*! @brief Swaps the commands of the given frame with out, which is cleared before. 
+         *  Called by the driver when it submits the frame. */
+        void takeFrameCommands(std::uint64_t frame, std::vector < RenderCommand >& out);
+        
         /*! @brief Releases queue's internal resource. */
         virtual void release() = 0;
         
@@ -6,6 +6,11 @@
 
 namespace Clean 
 {
+    RenderQueueManager::RenderQueueManager() : snapshot(std::make_shared < const Snapshot >())
+    {
+        
+    }
+    
     RenderQueueManager::~RenderQueueManager() 
     {
         // NOTES: Destructors should not be thread-safe. A destructor should be called only when the object
@@ -29,6 +34,7 @@ namespace Clean
         
         std::scoped_lock < std::mutex > lck(queuesMutex);
         queues[priority].push_back(queue);
+        publish();
     }
     
     void RenderQueueManager::remove(std::shared_ptr < RenderQueue > const& queue)
@@ -42,6 +48,7 @@ namespace Clean
             if (it != pair.second.end())
             {
                 pair.second.erase(it);
+                publish();
                 return;
             }
         }
@@ -61,6 +68,7 @@ namespace Clean
         }
         
         vector.clear();
+        publish();
     }
     
     void RenderQueueManager::clear()
@@ -77,21 +85,30 @@ namespace Clean
         }
         
         queues.clear();
+        publish();
     }
     
     std::shared_ptr < RenderQueue > RenderQueueManager::findByHandle(std::uint16_t handle)
     {
-        std::scoped_lock < std::mutex > lck(queuesMutex);
+        auto current = std::atomic_load(&snapshot);
+        auto it = current->handles.find(handle);
+        return (it == current->handles.end()) ? nullptr : it->second;
+    }
+    
+    void RenderQueueManager::publish()
+    {
+        auto result = std::make_shared < Snapshot >();
         
-        for (auto& pair : queues) 
+        for (auto const& pair : queues) 
         {
-            for (auto& queue : pair.second)
+            for (auto const& queue : pair.second)
             {
                 assert(queue && "Null RenderQueue stored.");
-                if (queue->getHandle() == handle) return queue;
+                result->ordered.push_back(queue);
+                result->handles.emplace(queue->getHandle(), queue);
             }
         }
         
-        return nullptr;
+        std::atomic_store(&snapshot, std::shared_ptr < const Snapshot >(result));
     }
 }
@@ -11,6 +11,7 @@
 #include <vector>
 #include <map>
 #include <mutex>
+#include <unordered_map>
 
 namespace Clean 
 {
@@ -30,7 +31,10 @@ namespace Clean
      * Queues are stored for each priority in a classic std::vector. When accessing a priority,
      * all queues are iterated. To go to the next priority, all queues in the first priority must 
      * have been iterated over. This way, queue with the highest priority are always first. 
-     * \see RenderQueueManager::iterator
+     * 
+     * Queues are iterated every frame but rarely added: each modification publishes an immutable 
+     * snapshot of all queues in priority order, with an index by handle. forEach() and findByHandle()
+     * only load the current snapshot.
      *
     **/
     class RenderQueueManager 
@@ -45,10 +49,23 @@ namespace Clean
         //! @brief Mutex to protect queues. 
         mutable std::mutex queuesMutex;
         
+        /** @brief Queues of all priorities, published after each modification. */
+        struct Snapshot 
+        {
+            //! @brief Queues from the highest priority to the lowest.
+            RQPtrVec ordered;
+            
+            //! @brief Queues by handle.
+            std::unordered_map < std::size_t, RQPtr > handles;
+        };
+        
+        //! @brief Current snapshot. Never null.
+        std::shared_ptr < const Snapshot > snapshot;
+        
     public:
         
         /*! @brief Constructs a RenderQueueManager. */
-        RenderQueueManager() = default;
+        RenderQueueManager();
         
         /*! @brief Destructs the manager. 
          *
@@ -80,39 +97,28 @@ namespace Clean
         /*! @brief Finds the queue with given handle, or return null. */
         std::shared_ptr < RenderQueue > findByHandle(std::uint16_t handle);
         
-        /*! @brief Convenient function to call a callback for each managed object and locking the
-         * managed list. */
+        /*! @brief Calls a callback for each queue of the current snapshot, by priority. No lock is
+         * held while the callback runs. */
         template < typename Callable >
-        void forEach(Callable cbk)
+        void forEach(Callable cbk) const
         {
-            std::lock_guard < std::mutex > lck(queuesMutex);
+            auto current = std::atomic_load(&snapshot);
             
-            for (auto& pair : queues) {
-                for (auto& queue : pair.second) {
-                    cbk(queue);
-                }
+            for (auto const& queue : current->ordered) {
+                cbk(queue);
             }
         }
         
-        /*! @brief Calls a callback on each managed objects in a non-blocking way.
-         *
-         * When this function is called, it copies the current list of managed objects and then call
-         * the given callback on each object of the copied list. Mutex is unlocked before calling the
-         * callback, thus liberating other objects to using this Manager.
-         *
-         **/
-        template < typename Callback > void forEachCpy(Callback cbk)
+        /*! @brief Same as forEach(). Kept for code written when forEach() held the lock. */
+        template < typename Callback > void forEachCpy(Callback cbk) const
         {
-            queuesMutex.lock();
-            auto listCopy = queues;
-            queuesMutex.unlock();
-            
-            for (auto& pair : listCopy) {
-                for (auto& queue : pair.second) {
-                    cbk(queue);
-                }
-            }
+            forEach(cbk);
         }
+        
+    private:
+        
+        /*! @brief Publishes a new snapshot of queues. queuesMutex must be locked. */
+        void publish();
     };
 }
 
@@ -0,0 +1,89 @@
+/** \file Core/RenderTexture.h
+**/
+
+#ifndef CLEAN_RENDERTEXTURE_H
+#define CLEAN_RENDERTEXTURE_H
+
+#include "RenderTarget.h"
+#include "Texture.h"
+#include "PixelFormat.h"
+
+#include <glm/vec4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Clean
+{
+    /** @brief Size and attachments of a RenderTexture. */
+    struct RenderTextureDescriptor
+    {
+        //! @brief Size of the attachments, in pixels.
+        std::size_t width = 0;
+        std::size_t height = 0;
+
+        //! @brief kPixelFormat* of the color attachment, or kPixelFormatNull for a depth only target.
+        std::uint8_t colorFormat = kPixelFormatRGBA8;
+
+        //! @brief True if the target has a depth attachment.
+        bool depth = true;
+
+        bool operator == (RenderTextureDescriptor const& rhs) const
+        {
+            return width == rhs.width && height == rhs.height && colorFormat == rhs.colorFormat && depth == rhs.depth;
+        }
+
+        bool operator != (RenderTextureDescriptor const& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+        /*! @brief Returns the number of bytes used by the attachments, with 4 bytes per depth pixel. */
+        std::size_t getMemorySize() const
+        {
+            const std::size_t pixels = width * height;
+            return pixels * (colorFormat != kPixelFormatNull ? PixelFormatGetSize(colorFormat) : 0) + (depth ? pixels * 4 : 0);
+        }
+    };
+
+    /** @brief A RenderTarget drawing into textures, made by Driver::makeRenderTexture().
+     *
+     * Its attachments are textures that can be bound to pipelines once drawn, like a shadow map or the
+     * scene given to a post-process. prepare() binds the target, sets the viewport to its size and clears
+     * its attachments with the clear color and a depth of one.
+     *
+    **/
+    class RenderTexture : public RenderTarget
+    {
+    protected:
+
+        //! @brief Size and attachments of this target.
+        RenderTextureDescriptor descriptor;
+
+        //! @brief Color used by prepare() to clear the color attachment.
+        glm::vec4 clearColor = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+    public:
+
+        /*! @brief Constructs the target. */
+        RenderTexture(RenderTextureDescriptor const& desc) : descriptor(desc) {}
+
+        /*! @brief Default destructor. */
+        virtual ~RenderTexture() = default;
+
+        /*! @brief Returns the size and attachments of this target. */
+        RenderTextureDescriptor const& getDescriptor() const { return descriptor; }
+
+        /*! @brief Changes the color used to clear the color attachment. */
+        void setClearColor(glm::vec4 const& color) { clearColor = color; }
+
+        /*! @brief Returns the color attachment, or null for a depth only target. */
+        virtual std::shared_ptr < Texture > getColorTexture() const = 0;
+
+        /*! @brief Returns the depth attachment, or null if the target has none. */
+        virtual std::shared_ptr < Texture > getDepthTexture() const = 0;
+    };
+}
+
+#endif // CLEAN_RENDERTEXTURE_H
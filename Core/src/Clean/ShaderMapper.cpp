@@ -8,6 +8,8 @@
 #include "EffectParameter.h"
 #include "RenderPipeline.h"
 
+#include <mutex>
+
 namespace Clean 
 {
     ShaderParameter ShaderMapper::map(EffectParameter const& param, RenderPipeline const& pipeline) const 
@@ -15,6 +17,32 @@ namespace Clean
         return ShaderParameter(param.type, param.name, -1, param.value);
     }
     
+    BindingPlan ShaderMapper::compile(std::vector < std::shared_ptr < EffectParameter > > const& parameters, RenderPipeline const& pipeline) const
+    {
+        BindingPlan plan;
+        plan.parametersCount = parameters.size();
+        
+        for (std::size_t slot = 0; slot < parameters.size(); ++slot)
+        {
+            std::unique_lock < std::mutex > lck(parameters[slot]->mutex);
+            const ShaderParameter sparam = map(*parameters[slot], pipeline);
+            lck.unlock();
+            
+            if (!sparam.type) continue;
+            
+            BindingPlanEntry entry;
+            entry.slot = static_cast < std::uint32_t >(slot);
+            entry.hash = parameters[slot]->hash;
+            entry.location = pipeline.findParameterLocation(sparam);
+            entry.type = sparam.type;
+            
+            if (entry.location >= 0)
+                plan.entries.push_back(entry);
+        }
+        
+        return plan;
+    }
+    
     bool ShaderMapper::hasPredefinedShaders() const
     {
         return false;
@@ -7,6 +7,10 @@
 #include "ShaderAttribute.h"
 #include "ShaderParameter.h"
 #include "FileLoader.h"
+#include "BindingPlan.h"
+
+#include <memory>
+#include <vector>
 
 namespace Clean
 {
@@ -108,6 +112,15 @@ namespace Clean
         /*! @brief Maps an Effect name to the correct shader's parameter name or index. */
         virtual ShaderParameter map(EffectParameter const& param, RenderPipeline const& pipeline) const;
         
+        /*! @brief Compiles the binding of a parameters list to the given pipeline. 
+         *
+         * Default implementation maps each parameter with \ref map() and resolves its location with 
+         * RenderPipeline::findParameterLocation(). Parameters without a location are not in the plan. 
+         * Cache indices of the entries are set by the pipeline. 
+         *
+        **/
+        virtual BindingPlan compile(std::vector < std::shared_ptr < EffectParameter > > const& parameters, RenderPipeline const& pipeline) const;
+        
         /*! @brief Returns true if this mapper has some predefined shaders. */
         virtual bool hasPredefinedShaders() const;
         
@@ -37,6 +37,12 @@ namespace Clean
             assert(instance && "Null Current instance. Perhaps Core class is not created yet.");
             return *instance;
         }
+        
+        /*! @brief Returns the current instance, or null if Core has not set it. */
+        static Derived* Find()
+        {
+            return currentInstance.load();
+        }
     };
     
     template < class Derived >
@@ -0,0 +1,282 @@
+/** \file Core/SlotMap.h
+**/
+
+#ifndef CLEAN_SLOTMAP_H
+#define CLEAN_SLOTMAP_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace Clean
+{
+    /** @brief Handle to an object stored in a SlotMap.
+     *
+     * A handle is the index of a slot and the generation of the slot when the object was inserted.
+     * When the object is erased, the generation of its slot is incremented: the handle is then stale
+     * and does not resolve anymore, even if the slot is reused. A default-constructed handle is null.
+     *
+    **/
+    struct SlotHandle
+    {
+        //! @brief Index of the slot.
+        std::uint32_t index = 0;
+
+        //! @brief Generation of the slot. Zero for the null handle.
+        std::uint32_t generation = 0;
+
+        /*! @brief Returns true if this handle is not null. It may still be stale. */
+        bool valid() const { return generation != 0; }
+
+        bool operator == (SlotHandle const& rhs) const { return index == rhs.index && generation == rhs.generation; }
+        bool operator != (SlotHandle const& rhs) const { return !(*this == rhs); }
+    };
+
+    /** @brief Stores objects contiguously and resolves their handles in constant time.
+     *
+     * Objects live in a dense vector, iterated without holes. Slots map handles to positions in this
+     * vector: erasing an object moves the last object to its position and updates the slot of the
+     * moved object, so handles stay valid while pointers to objects don't.
+     *
+     * A SlotMap is not thread-safe: its owner protects it like any other container.
+     *
+    **/
+    template < class T >
+    class SlotMap
+    {
+        //! @brief Marks the end of the free slots list.
+        static constexpr const std::uint32_t kNoSlot = std::numeric_limits < std::uint32_t >::max();
+
+        /** @brief Position of an object, or next free slot if the slot is free. */
+        struct Slot
+        {
+            std::uint32_t dense;
+            std::uint32_t generation;
+        };
+
+        //! @brief Objects, contiguous.
+        std::vector < T > values;
+
+        //! @brief Slot of each object in values.
+        std::vector < std::uint32_t > valueSlots;
+
+        //! @brief All slots ever allocated.
+        std::vector < Slot > slots;
+
+        //! @brief First free slot, or kNoSlot.
+        std::uint32_t freeSlot = kNoSlot;
+
+    public:
+
+        typedef typename std::vector < T >::iterator iterator;
+        typedef typename std::vector < T >::const_iterator const_iterator;
+
+        /*! @brief Inserts an object and returns its handle. */
+        SlotHandle insert(T value)
+        {
+            return emplace(std::move(value));
+        }
+
+        /*! @brief Constructs an object in place and returns its handle. */
+        template < class... Args >
+        SlotHandle emplace(Args&&... args)
+        {
+            std::uint32_t index = freeSlot;
+
+            if (index == kNoSlot)
+            {
+                assert(slots.size() < kNoSlot && "SlotMap is full.");
+                index = static_cast < std::uint32_t >(slots.size());
+                slots.push_back(Slot{ 0, 1 });
+            }
+
+            else
+            {
+                freeSlot = slots[index].dense;
+            }
+
+            Slot& slot = slots[index];
+            slot.dense = static_cast < std::uint32_t >(values.size());
+
+            values.emplace_back(std::forward < Args >(args)...);
+            valueSlots.push_back(index);
+
+            return SlotHandle{ index, slot.generation };
+        }
+
+        /*! @brief Returns the object designated by handle, or null if the handle is null or stale. */
+        T* find(SlotHandle const& handle)
+        {
+            if (!contains(handle)) return nullptr;
+            return &values[slots[handle.index].dense];
+        }
+
+        /*! @brief Returns the object designated by handle, or null if the handle is null or stale. */
+        T const* find(SlotHandle const& handle) const
+        {
+            if (!contains(handle)) return nullptr;
+            return &values[slots[handle.index].dense];
+        }
+
+        /*! @brief Returns true if handle designates an object of this map. */
+        bool contains(SlotHandle const& handle) const
+        {
+            return handle.valid() && handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+        }
+
+        /*! @brief Erases the object designated by handle. Returns false if the handle is null or stale. */
+        bool erase(SlotHandle const& handle)
+        {
+            if (!contains(handle)) return false;
+
+            Slot& slot = slots[handle.index];
+            const std::uint32_t dense = slot.dense;
+            const std::uint32_t last = static_cast < std::uint32_t >(values.size() - 1);
+
+            if (dense != last)
+            {
+                values[dense] = std::move(values[last]);
+                valueSlots[dense] = valueSlots[last];
+                slots[valueSlots[dense]].dense = dense;
+            }
+
+            values.pop_back();
+            valueSlots.pop_back();
+
+            release(handle.index);
+            return true;
+        }
+
+        /*! @brief Erases all objects. Their handles become stale. */
+        void clear()
+        {
+            for (std::uint32_t index : valueSlots)
+                release(index);
+
+            values.clear();
+            valueSlots.clear();
+        }
+
+        /*! @brief Reserves storage for count objects. */
+        void reserve(std::size_t count)
+        {
+            values.reserve(count);
+            valueSlots.reserve(count);
+            slots.reserve(count);
+        }
+
+        /*! @brief Returns the number of objects. */
+        std::size_t size() const { return values.size(); }
+
+        /*! @brief Returns true if there is no object. */
+        bool empty() const { return values.empty(); }
+
+        /*! @brief Returns the handle of the object at position i of the iteration. */
+        SlotHandle handleAt(std::size_t i) const
+        {
+            assert(i < valueSlots.size() && "Invalid position.");
+            const std::uint32_t index = valueSlots[i];
+            return SlotHandle{ index, slots[index].generation };
+        }
+
+        iterator begin() { return values.begin(); }
+        iterator end() { return values.end(); }
+        const_iterator begin() const { return values.begin(); }
+        const_iterator end() const { return values.end(); }
+
+    private:
+
+        /*! @brief Makes a slot stale and adds it to the free list. */
+        void release(std::uint32_t index)
+        {
+            Slot& slot = slots[index];
+
+            // Generation zero is the null handle's.
+            if (++slot.generation == 0)
+                slot.generation = 1;
+
+            slot.dense = freeSlot;
+            freeSlot = index;
+        }
+    };
+
+    /** @brief Associates values to the handles of a SlotMap, without owning the handles.
+     *
+     * Values are stored by slot index, so resolving a handle is an index and a generation check. A value
+     * stored for a handle is not returned for another handle of the same slot: a stale value is never
+     * returned, and it is replaced when a value is inserted for the new handle.
+     *
+    **/
+    template < class T >
+    class SecondarySlotMap
+    {
+        /** @brief Value stored for one slot. */
+        struct Entry
+        {
+            std::uint32_t generation = 0;
+            std::optional < T > value;
+        };
+
+        //! @brief Entries by slot index.
+        std::vector < Entry > entries;
+
+    public:
+
+        /*! @brief Stores value for handle, replacing any previous value of its slot. Returns the stored value. */
+        T& insert(SlotHandle const& handle, T value)
+        {
+            assert(handle.valid() && "Null SlotHandle given.");
+
+            if (handle.index >= entries.size())
+                entries.resize(handle.index + 1);
+
+            Entry& entry = entries[handle.index];
+            entry.generation = handle.generation;
+            entry.value.reset();
+            entry.value.emplace(std::move(value));
+
+            return *entry.value;
+        }
+
+        /*! @brief Returns the value stored for handle, or null. */
+        T* find(SlotHandle const& handle)
+        {
+            if (!contains(handle)) return nullptr;
+            return &*entries[handle.index].value;
+        }
+
+        /*! @brief Returns the value stored for handle, or null. */
+        T const* find(SlotHandle const& handle) const
+        {
+            if (!contains(handle)) return nullptr;
+            return &*entries[handle.index].value;
+        }
+
+        /*! @brief Returns true if a value is stored for handle. */
+        bool contains(SlotHandle const& handle) const
+        {
+            return handle.valid() && handle.index < entries.size()
+                && entries[handle.index].generation == handle.generation && entries[handle.index].value.has_value();
+        }
+
+        /*! @brief Destroys the value stored for handle. */
+        bool erase(SlotHandle const& handle)
+        {
+            if (!contains(handle)) return false;
+            entries[handle.index].value.reset();
+            return true;
+        }
+
+        /*! @brief Destroys all values. */
+        void clear()
+        {
+            entries.clear();
+        }
+    };
+}
+
+#endif // CLEAN_SLOTMAP_H
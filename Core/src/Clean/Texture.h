@@ -9,6 +9,7 @@
 
 #include "DriverResource.h"
 #include "Handled.h"
+#include "Image.h"
 
 namespace Clean 
 {
@@ -36,6 +37,15 @@ namespace Clean
         
         /*! @brief Binds the texture. */
         virtual void bind() const = 0;
+        
+        /*! @brief Replaces the content of the texture with the given Image. 
+         *
+         * If the Image's PixelSet holds mipmaps levels, every level is uploaded and the texture 
+         * only keeps those levels: uploading a shorter chain frees the memory of the previous 
+         * one. This is used by TextureStreamer to change resident levels.
+         *
+        **/
+        virtual bool upload(std::shared_ptr < Image > const& image) = 0;
     };
 }
 
@@ -0,0 +1,457 @@
+/** =======================================================
+ *  \file Core/TextureAtlas.cpp
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#include "TextureAtlas.h"
+#include "Driver.h"
+#include "Material.h"
+#include "RenderCommand.h"
+#include "ImageManager.h"
+#include "PixelSetConverterManager.h"
+#include "MipmapGenerator.h"
+#include "ShaderParameter.h"
+#include "Allocate.h"
+#include "NotificationCenter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace Clean
+{
+    TextureAtlasPacker::TextureAtlasPacker(std::size_t w, std::size_t h)
+    : width(w), height(h), usedArea(0)
+    {
+        clear();
+    }
+
+    bool TextureAtlasPacker::insert(std::size_t w, std::size_t h, TextureAtlasRect& result)
+    {
+        std::size_t bestIndex = skyline.size();
+        std::size_t bestTop = std::numeric_limits < std::size_t >::max();
+        std::size_t bestWaste = std::numeric_limits < std::size_t >::max();
+        std::size_t bestY = 0;
+
+        for (std::size_t i = 0; i < skyline.size(); ++i)
+        {
+            std::size_t y, waste;
+            if (!fits(i, w, h, y, waste)) continue;
+
+            if (y + h < bestTop || (y + h == bestTop && waste < bestWaste))
+            {
+                bestIndex = i;
+                bestTop = y + h;
+                bestWaste = waste;
+                bestY = y;
+            }
+        }
+
+        if (bestIndex == skyline.size())
+            return false;
+
+        result = { skyline[bestIndex].x, bestY, w, h };
+        skyline.insert(skyline.begin() + bestIndex, Node{ result.x, bestY + h, w });
+
+        // Nodes covered by the new one are shrunk or removed.
+        for (std::size_t i = bestIndex + 1; i < skyline.size(); )
+        {
+            Node const& previous = skyline[i - 1];
+            const std::size_t previousEnd = previous.x + previous.width;
+
+            if (skyline[i].x >= previousEnd)
+                break;
+
+            const std::size_t shrink = previousEnd - skyline[i].x;
+
+            if (skyline[i].width <= shrink) {
+                skyline.erase(skyline.begin() + i);
+                continue;
+            }
+
+            skyline[i].x += shrink;
+            skyline[i].width -= shrink;
+            break;
+        }
+
+        // Merges neighbour nodes at the same height.
+        for (std::size_t i = 0; i + 1 < skyline.size(); )
+        {
+            if (skyline[i].y == skyline[i + 1].y) {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+            }
+
+            else ++i;
+        }
+
+        usedArea += w * h;
+        return true;
+    }
+
+    void TextureAtlasPacker::clear()
+    {
+        skyline.clear();
+        skyline.push_back(Node{ 0, 0, width });
+        usedArea = 0;
+    }
+
+    float TextureAtlasPacker::getOccupancy() const
+    {
+        return (width && height) ? static_cast < float >(usedArea) / static_cast < float >(width * height) : 0.0f;
+    }
+
+    bool TextureAtlasPacker::fits(std::size_t index, std::size_t w, std::size_t h, std::size_t& y, std::size_t& waste) const
+    {
+        if (skyline[index].x + w > width)
+            return false;
+
+        y = 0;
+
+        for (std::size_t i = index, left = w; left && i < skyline.size(); ++i)
+        {
+            y = std::max(y, skyline[i].y);
+            left -= std::min(left, skyline[i].width);
+        }
+
+        if (y + h > height)
+            return false;
+
+        waste = 0;
+
+        for (std::size_t i = index, left = w; left && i < skyline.size(); ++i)
+        {
+            const std::size_t covered = std::min(left, skyline[i].width);
+            waste += (y - skyline[i].y) * covered;
+            left -= covered;
+        }
+
+        return true;
+    }
+
+    TextureAtlas::TextureAtlas(std::size_t ps, std::size_t mis, std::size_t l)
+    : pageSize(ps), maxImageSize(mis), levels(std::max < std::size_t >(1, l))
+    {
+        assert(pageSize && maxImageSize && "Null page size or image size given.");
+    }
+
+    TextureAtlas::~TextureAtlas()
+    {
+        clear();
+    }
+
+    bool TextureAtlas::add(std::shared_ptr < Image > const& image)
+    {
+        assert(image && "Null image given.");
+        auto pixels = image->getPixelSet();
+        SizePair const size = image->getSize();
+
+        if (!pixels || !size.x || !size.y || size.x > maxImageSize || size.y > maxImageSize)
+            return false;
+
+        if (PixelFormatIsCompressed(pixels->format))
+            return false;
+
+        Entry entry;
+        entry.image = image;
+        entry.handle = image->getHandle();
+
+        if (pixels->format != kPixelFormatRGBA8)
+        {
+            auto converter = PixelSetConverterManager::Current().findConverter(pixels->format, kPixelFormatRGBA8);
+
+            if (!converter)
+            {
+                NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelWarning, "Image #%i can't be converted from %s to RGBA8 for TextureAtlas.",
+                    image->getHandle(), PixelFormatToString(pixels->format).data()));
+                return false;
+            }
+
+            auto converted = converter->convert(pixels);
+            if (!converted) return false;
+
+            entry.image = AllocateShared < Image >(converted, image->getOrigin(), size);
+            entry.ownsPixels = true;
+        }
+
+        std::scoped_lock < std::mutex > lck(mutex);
+        pendings.push_back(std::move(entry));
+        return true;
+    }
+
+    std::shared_ptr < Image > TextureAtlas::add(std::string const& filepath)
+    {
+        auto image = ImageManager::Current().load(filepath);
+
+        if (!image) {
+            NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "Image file %s not found.", filepath.data()));
+            return nullptr;
+        }
+
+        return add(image) ? image : nullptr;
+    }
+
+    std::size_t TextureAtlas::pack()
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return packPendings();
+    }
+
+    std::size_t TextureAtlas::build(Driver& driver)
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        const std::size_t packed = packPendings();
+
+        for (std::size_t i = 0; i < packers.size(); ++i)
+        {
+            if (!modifiedPages[i]) continue;
+
+            pages[i] = makePage(driver, i);
+            modifiedPages[i] = false;
+        }
+
+        return packed;
+    }
+
+    std::size_t TextureAtlas::packPendings()
+    {
+        if (pendings.empty()) return 0;
+
+        // Cells hold the image and its gutter on each side, rounded up to the alignment. As every cell and
+        // the page size are multiples of the alignment, the skyline keeps every cell aligned.
+        const std::size_t alignment = findAlignment();
+        const std::size_t gutter = alignment;
+        const std::size_t page = (pageSize / alignment) * alignment;
+
+        auto cellSize = [alignment, gutter](std::size_t size) {
+            return ((size + 2 * gutter + alignment - 1) / alignment) * alignment; };
+
+        std::stable_sort(pendings.begin(), pendings.end(), [](Entry const& lhs, Entry const& rhs) {
+            return lhs.image->getSize().y > rhs.image->getSize().y; });
+
+        std::size_t packed = 0;
+
+        for (Entry& entry : pendings)
+        {
+            SizePair const size = entry.image->getSize();
+            const std::size_t w = cellSize(size.x);
+            const std::size_t h = cellSize(size.y);
+
+            if (w > page || h > page)
+            {
+                NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelWarning, "Image #%i is too large for TextureAtlas page size %i.",
+                    entry.handle, (int) pageSize));
+                Release(entry);
+                continue;
+            }
+
+            TextureAtlasRect cell;
+            std::size_t index = 0;
+
+            while (index < packers.size() && !packers[index].insert(w, h, cell))
+                ++index;
+
+            if (index == packers.size())
+            {
+                packers.emplace_back(page, page);
+                modifiedPages.push_back(false);
+                packers.back().insert(w, h, cell);
+            }
+
+            const float scale = 1.0f / static_cast < float >(page);
+
+            entry.region.page = index;
+            entry.region.rect = { cell.x + gutter, cell.y + gutter, size.x, size.y };
+            entry.region.uvTransform = glm::vec4(size.x * scale, size.y * scale, (cell.x + gutter) * scale, (cell.y + gutter) * scale);
+
+            // An image added twice replaces its previous entry, whose pixels are already in its page.
+            auto it = entries.find(entry.handle);
+            if (it != entries.end()) Release(it->second);
+
+            entries[entry.handle] = std::move(entry);
+            modifiedPages[index] = true;
+            packed++;
+        }
+
+        pendings.clear();
+        pages.resize(packers.size());
+        pagesData.resize(packers.size());
+        return packed;
+    }
+
+    bool TextureAtlas::findRegion(Image const& image, TextureAtlasRegion& region) const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        auto it = entries.find(image.getHandle());
+        if (it == entries.end()) return false;
+
+        region = it->second.region;
+        return true;
+    }
+
+    std::shared_ptr < Texture > TextureAtlas::findTexture(Image const& image) const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        auto it = entries.find(image.getHandle());
+        if (it == entries.end()) return nullptr;
+
+        return pages[it->second.region.page];
+    }
+
+    std::shared_ptr < EffectParameter > TextureAtlas::makeUVParameter(Image const& image) const
+    {
+        TextureAtlasRegion region;
+        if (!findRegion(image, region)) return nullptr;
+
+        return AllocateShared < EffectParameter >(kEffectMaterialDiffuseUVVec4, ShaderValue{ .vec4 = region.uvTransform }, kShaderParamVec4);
+    }
+
+    bool TextureAtlas::apply(Image const& image, Material& material) const
+    {
+        TextureAtlasRegion region;
+        auto texture = findTexture(image);
+
+        if (!texture || !findRegion(image, region))
+            return false;
+
+        material.setDiffuseTexture(texture);
+        material.setDiffuseUVTransform(region.uvTransform);
+        return true;
+    }
+
+    bool TextureAtlas::sub(Image const& image, RenderCommand& command, std::uint8_t type, ShaderAttributesMap const& attributes) const
+    {
+        auto parameter = makeUVParameter(image);
+        if (!parameter) return false;
+
+        command.sub(type, attributes);
+        command.subCommands.back().parameters.add(parameter);
+        return true;
+    }
+
+    std::size_t TextureAtlas::getPagesCount() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return pages.size();
+    }
+
+    std::size_t TextureAtlas::getImagesCount() const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return entries.size();
+    }
+
+    float TextureAtlas::getOccupancy(std::size_t page) const
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+        return page < packers.size() ? packers[page].getOccupancy() : 0.0f;
+    }
+
+    void TextureAtlas::clear()
+    {
+        std::scoped_lock < std::mutex > lck(mutex);
+
+        for (Entry& entry : pendings)
+            Release(entry);
+
+        for (auto& pair : entries)
+            Release(pair.second);
+
+        pendings.clear();
+        entries.clear();
+        packers.clear();
+        pages.clear();
+        pagesData.clear();
+        modifiedPages.clear();
+    }
+
+    std::size_t TextureAtlas::findAlignment() const
+    {
+        return std::size_t(1) << (levels - 1);
+    }
+
+    std::shared_ptr < Texture > TextureAtlas::makePage(Driver& driver, std::size_t index)
+    {
+        const std::size_t alignment = findAlignment();
+        const std::size_t gutter = alignment;
+        const std::size_t page = (pageSize / alignment) * alignment;
+        const std::size_t pitch = page * 4;
+
+        std::vector < unsigned char >& data = pagesData[index];
+        if (data.empty()) data.resize(pitch * page, 0);
+
+        // Copies each new image and extends its edge pixels in its gutter, so bilinear filtering and mipmaps
+        // sample the image's own border instead of its neighbours. Images copied are released.
+        for (auto& pair : entries)
+        {
+            Entry& entry = pair.second;
+            if (entry.region.page != index || !entry.image) continue;
+
+            TextureAtlasRect const& rect = entry.region.rect;
+            const unsigned char* src = entry.image->raw();
+            const std::size_t srcPitch = entry.image->findRowLength() * 4;
+
+            for (std::size_t row = 0; row < rect.height + 2 * gutter; ++row)
+            {
+                const std::size_t srcRow = std::min(rect.height - 1, row > gutter ? row - gutter : 0);
+                const unsigned char* srcLine = src + srcRow * srcPitch;
+                unsigned char* destLine = data.data() + (rect.y - gutter + row) * pitch + (rect.x - gutter) * 4;
+
+                for (std::size_t i = 0; i < gutter; ++i)
+                    memcpy(destLine + i * 4, srcLine, 4);
+
+                memcpy(destLine + gutter * 4, srcLine, rect.width * 4);
+
+                for (std::size_t i = 0; i < gutter; ++i)
+                    memcpy(destLine + (gutter + rect.width + i) * 4, srcLine + (rect.width - 1) * 4, 4);
+            }
+
+            Release(entry);
+        }
+
+        PixelSet base;
+        base.lineWidth = pitch;
+        base.columnsCount = page;
+        base.format = kPixelFormatRGBA8;
+        base.data = data.data();
+
+        // Box filter keeps each texel of the last level inside one aligned cell. Pages are filtered in sRGB
+        // space, as textures loaded by the Driver.
+        auto chain = MipmapGenerate(std::make_shared < PixelSet >(base), kMipmapFilterBox, true);
+        if (!chain) return pages[index];
+
+        if (chain->levels.size() > levels)
+            chain->levels.resize(levels);
+
+        auto image = AllocateShared < Image >(chain, SizePair{ 0, 0 }, SizePair{ page, page });
+        std::shared_ptr < Texture > texture = pages[index];
+
+        if (texture)
+        {
+            if (!texture->upload(image))
+            {
+                NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "TextureAtlas page %i can't be uploaded to Texture #%i.",
+                    (int) index, texture->getHandle()));
+            }
+        }
+
+        else
+        {
+            texture = driver.makeTexture(image);
+        }
+
+        // The texture holds its own copy now.
+        Free(chain->data);
+        return texture;
+    }
+
+    void TextureAtlas::Release(Entry& entry)
+    {
+        if (entry.ownsPixels && entry.image && entry.image->getPixelSet())
+            Free(entry.image->getPixelSet()->data);
+
+        entry.ownsPixels = false;
+        entry.image.reset();
+    }
+}
@@ -0,0 +1,277 @@
+/** =======================================================
+ *  \file Core/TextureAtlas.h
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#ifndef CLEAN_TEXTUREATLAS_H
+#define CLEAN_TEXTUREATLAS_H
+
+#include "Image.h"
+#include "Texture.h"
+#include "EffectParameter.h"
+
+#include <glm/vec4.hpp>
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Clean
+{
+    class Driver;
+    class Material;
+    class ShaderAttributesMap;
+    struct RenderCommand;
+
+    //! @brief Default width and height of an atlas page, in pixels.
+    static constexpr const std::size_t kTextureAtlasDefaultPageSize = 2048;
+
+    //! @brief Default largest dimension of an image accepted by TextureAtlas, in pixels.
+    static constexpr const std::size_t kTextureAtlasDefaultMaxImageSize = 256;
+
+    //! @brief Default number of mipmaps levels generated for a page. Regions never bleed in each
+    //! other up to the last level.
+    static constexpr const std::size_t kTextureAtlasDefaultLevels = 4;
+
+    /** @brief A rectangle in an atlas page, in pixels. */
+    struct TextureAtlasRect
+    {
+        std::size_t x = 0;
+        std::size_t y = 0;
+        std::size_t width = 0;
+        std::size_t height = 0;
+    };
+
+    /** @brief Skyline bottom-left rectangle packer.
+     *
+     * The skyline is the list of top edges of every rectangle already packed, from left to right. A new
+     * rectangle is placed where its top edge is the lowest (ties are broken by the smallest wasted area
+     * below it), and the skyline is updated. It packs nearly as tight as maxrects for rectangles inserted
+     * by decreasing height, at a fraction of its cost.
+     *
+    **/
+    class TextureAtlasPacker
+    {
+        /** @brief One segment of the skyline. */
+        struct Node
+        {
+            std::size_t x;
+            std::size_t y;
+            std::size_t width;
+        };
+
+        //! @brief Width of the packed area.
+        std::size_t width;
+
+        //! @brief Height of the packed area.
+        std::size_t height;
+
+        //! @brief Skyline segments, sorted by x.
+        std::vector < Node > skyline;
+
+        //! @brief Sum of the areas of every rectangle packed.
+        std::size_t usedArea;
+
+    public:
+
+        /*! @brief Constructs an empty packer. */
+        TextureAtlasPacker(std::size_t width, std::size_t height);
+
+        /*! @brief Places a rectangle of the given size.
+         *
+         * \param w Width of the rectangle.
+         * \param h Height of the rectangle.
+         * \param result Filled with the position of the rectangle if it was placed.
+         *
+         * \return True if the rectangle was placed, false if it does not fit anymore.
+         *
+        **/
+        bool insert(std::size_t w, std::size_t h, TextureAtlasRect& result);
+
+        /*! @brief Removes every rectangle. */
+        void clear();
+
+        /*! @brief Returns the ratio of the area used by rectangles, between 0 and 1. */
+        float getOccupancy() const;
+
+    private:
+
+        /*! @brief Returns true if a rectangle fits at node index, and the y it would be placed at. */
+        bool fits(std::size_t index, std::size_t w, std::size_t h, std::size_t& y, std::size_t& waste) const;
+    };
+
+    /** @brief Where an Image was packed in a TextureAtlas. */
+    struct TextureAtlasRegion
+    {
+        //! @brief Index of the page holding the image.
+        std::size_t page = 0;
+
+        //! @brief Pixels of the image in the page, without its gutter.
+        TextureAtlasRect rect;
+
+        //! @brief Transforms image's texture coordinates to page's ones: uv * xy + zw.
+        glm::vec4 uvTransform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+    };
+
+    /** @brief Packs small images in a few large textures, to merge draws that only differ by their texture.
+     *
+     * Images are added with \ref add() at load time, and \ref build() packs them in pages of pageSize
+     * pixels, uploaded as RGBA8 textures by the Driver. Each image then has a region in a page, and its
+     * texture coordinates are transformed with the vec4 parameter kEffectMaterialDiffuseUVVec4 (scale in
+     * xy, offset in zw). \ref apply() replaces a Material's diffuse texture with the page and sets this
+     * parameter: Materials using the same page bind the same texture, so their commands only differ by
+     * a uniform and can be batched. \ref sub() does so: every image of a page is drawn by a sub command
+     * of the same RenderCommand, which only changes the UV transform between two draws.
+     *
+     * Mipmaps safety: regions are surrounded by a gutter made of their edge pixels, and are aligned on
+     * blocks of 2^(levels-1) pixels. With the box filter, a texel of the last level is built only from
+     * one region and its gutter, so filtering never samples a neighbour image. Levels after this one are
+     * not generated.
+     *
+     * \note Texture arrays are not supported by Texture yet, thus every page is a separate 2D texture.
+     *
+    **/
+    class TextureAtlas
+    {
+        /** @brief An image copied in a page. */
+        struct Entry
+        {
+            //! @brief RGBA8 image copied in the page. Released once copied in its page's data.
+            std::shared_ptr < Image > image;
+
+            //! @brief True if image's pixels were converted by add(), and must be freed.
+            bool ownsPixels = false;
+
+            //! @brief Handle of the image given to add().
+            std::size_t handle = 0;
+
+            //! @brief Region of the image.
+            TextureAtlasRegion region;
+        };
+
+        //! @brief Width and height of a page.
+        std::size_t pageSize;
+
+        //! @brief Largest dimension of an accepted image.
+        std::size_t maxImageSize;
+
+        //! @brief Number of mipmaps levels of a page.
+        std::size_t levels;
+
+        //! @brief Images added but not packed yet.
+        std::vector < Entry > pendings;
+
+        //! @brief Packed images, by handle of the image given to add().
+        std::unordered_map < std::size_t, Entry > entries;
+
+        //! @brief Packers of each page.
+        std::vector < TextureAtlasPacker > packers;
+
+        //! @brief Textures of each page.
+        std::vector < std::shared_ptr < Texture > > pages;
+
+        //! @brief First level of each page, where images are copied once. Keeps the images packed by previous
+        //! builds when a page is uploaded again.
+        std::vector < std::vector < unsigned char > > pagesData;
+
+        //! @brief Pages modified since their last upload.
+        std::vector < bool > modifiedPages;
+
+        //! @brief Protects every field above.
+        mutable std::mutex mutex;
+
+    public:
+
+        /*! @brief Constructs an empty atlas.
+         *
+         * \param pageSize Width and height of a page, in pixels.
+         * \param maxImageSize Images larger than this (on any dimension) are refused.
+         * \param levels Number of mipmaps levels of pages. At least 1.
+         *
+        **/
+        TextureAtlas(std::size_t pageSize = kTextureAtlasDefaultPageSize, std::size_t maxImageSize = kTextureAtlasDefaultMaxImageSize,
+                     std::size_t levels = kTextureAtlasDefaultLevels);
+
+        /*! @brief Releases the images not packed yet. */
+        ~TextureAtlas();
+
+        /*! @brief Queues an image to be packed by the next build().
+         *
+         * \return False if the image is too large, compressed, or can't be converted to RGBA8.
+         *
+        **/
+        bool add(std::shared_ptr < Image > const& image);
+
+        /*! @brief Loads an image with ImageManager and queues it. */
+        std::shared_ptr < Image > add(std::string const& filepath);
+
+        /*! @brief Packs every queued image, without uploading the pages. Regions are known from now on, and
+         *  the next build() uploads the pages modified. Returns the number of images packed. */
+        std::size_t pack();
+
+        /*! @brief Packs every queued image and uploads the pages modified.
+         *
+         * Images are packed by decreasing height in existing pages first, then in new pages. A page
+         * modified by this build is fully composed again and re-uploaded, so build() is best called once,
+         * after every image is added.
+         *
+         * \return The number of images packed.
+         *
+        **/
+        std::size_t build(Driver& driver);
+
+        /*! @brief Finds the region of an image. Returns false if the image was not packed. */
+        bool findRegion(Image const& image, TextureAtlasRegion& region) const;
+
+        /*! @brief Returns the page texture holding an image, or null. */
+        std::shared_ptr < Texture > findTexture(Image const& image) const;
+
+        /*! @brief Returns a new kEffectMaterialDiffuseUVVec4 parameter for an image, or null if it was not packed. */
+        std::shared_ptr < EffectParameter > makeUVParameter(Image const& image) const;
+
+        /*! @brief Sets a Material's diffuse texture to the image's page, and its diffuse UV transform to the
+         *  image's region. Returns false if the image was not packed. */
+        bool apply(Image const& image, Material& material) const;
+
+        /*! @brief Adds a sub command drawing an image packed in the atlas to a command.
+         *
+         * The sub command holds the image's kEffectMaterialDiffuseUVVec4 parameter, bound after the command's
+         * ones. Thus one RenderCommand, whose diffuse texture is the image's page (see apply()), draws every
+         * object textured by an image of this page, instead of one command by texture.
+         *
+         * \return False if the image was not packed, in which case nothing is added.
+         *
+        **/
+        bool sub(Image const& image, RenderCommand& command, std::uint8_t type, ShaderAttributesMap const& attributes) const;
+
+        /*! @brief Returns the number of pages. */
+        std::size_t getPagesCount() const;
+
+        /*! @brief Returns the number of images packed. */
+        std::size_t getImagesCount() const;
+
+        /*! @brief Returns the occupancy of a page, between 0 and 1. */
+        float getOccupancy(std::size_t page) const;
+
+        /*! @brief Removes every image and page. Textures already used by Materials stay alive. */
+        void clear();
+
+    private:
+
+        /*! @brief Returns the alignment of regions, in pixels. */
+        std::size_t findAlignment() const;
+
+        /*! @brief Packs every queued image. mutex must be locked. */
+        std::size_t packPendings();
+
+        /*! @brief Copies the images not copied yet in a page's data, releases them, and uploads the page. */
+        std::shared_ptr < Texture > makePage(Driver& driver, std::size_t page);
+
+        /*! @brief Frees the pixels converted for an entry, and releases its image. */
+        static void Release(Entry& entry);
+    };
+}
+
+#endif // CLEAN_TEXTUREATLAS_H
@@ -0,0 +1,298 @@
+/** =======================================================
+ *  \file Core/TextureStreamer.cpp
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#include "TextureStreamer.h"
+#include "MipmapGenerator.h"
+#include "Allocate.h"
+#include "NotificationCenter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Clean
+{
+    TextureStreamer::TextureStreamer()
+    : budget(kTextureStreamerDefaultBudget), uploadLimit(kTextureStreamerDefaultUploadLimit), coarseSize(kTextureStreamerDefaultCoarseSize)
+    {
+
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+        clear();
+    }
+
+    bool TextureStreamer::add(std::shared_ptr < Texture > const& texture, std::shared_ptr < Image > const& image, std::uint8_t flags)
+    {
+        assert(texture && image && "Null texture or image given.");
+        auto pixels = image->getPixelSet();
+
+        if (!pixels || pixels->levels.empty())
+        {
+            NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelWarning, "Image #%i has no mipmaps: Texture #%i can't be streamed.",
+                image->getHandle(), texture->getHandle()));
+            return false;
+        }
+
+        TextureStreamerEntry entry;
+        entry.texture = texture;
+        entry.image = image;
+        entry.chainBytes.resize(pixels->levels.size() + 1, 0);
+
+        for (std::size_t i = pixels->levels.size(); i > 0; --i)
+            entry.chainBytes[i - 1] = entry.chainBytes[i] + pixels->levels[i - 1].size;
+
+        entry.coarseLevel = findCoarseLevel(*pixels);
+        entry.residentLevel = entry.coarseLevel;
+        entry.ownsPixels = (flags & kTextureStreamerOwnsPixels);
+
+        if (!(flags & kTextureStreamerUploaded) && !UploadLevels(*texture, *image, entry.coarseLevel))
+            return false;
+
+        std::scoped_lock < std::mutex, std::mutex > lck(uploadMutex, entriesMutex);
+        auto it = entries.find(texture->getHandle());
+
+        if (it != entries.end())
+        {
+            if (it->second.ownsPixels && it->second.image->getPixelSet() != pixels)
+                Release(it->second);
+
+            it->second = std::move(entry);
+            return true;
+        }
+
+        entries.emplace(texture->getHandle(), std::move(entry));
+        return true;
+    }
+
+    std::size_t TextureStreamer::findCoarseLevel(PixelSet const& pixels) const
+    {
+        if (pixels.levels.empty())
+            return 0;
+
+        const std::size_t coarse = coarseSize.load();
+
+        for (std::size_t i = 0; i < pixels.levels.size(); ++i)
+        {
+            if (std::max(pixels.levels[i].width, pixels.levels[i].height) <= coarse)
+                return i;
+        }
+
+        return pixels.levels.size() - 1;
+    }
+
+    void TextureStreamer::remove(Texture const& texture)
+    {
+        std::scoped_lock < std::mutex, std::mutex > lck(uploadMutex, entriesMutex);
+        auto it = entries.find(texture.getHandle());
+        if (it == entries.end()) return;
+
+        Release(it->second);
+        entries.erase(it);
+    }
+
+    void TextureStreamer::clear()
+    {
+        std::scoped_lock < std::mutex, std::mutex > lck(uploadMutex, entriesMutex);
+
+        for (auto& pair : entries)
+            Release(pair.second);
+
+        entries.clear();
+    }
+
+    void TextureStreamer::request(Texture const& texture, float screenSize)
+    {
+        std::scoped_lock < std::mutex > lck(entriesMutex);
+        auto it = entries.find(texture.getHandle());
+
+        if (it != entries.end())
+            it->second.demand = std::max(it->second.demand, screenSize);
+    }
+
+    void TextureStreamer::update()
+    {
+        // Chains can't be freed while uploadMutex is locked. Levels are chosen under entriesMutex, and
+        // uploaded without it, so request() is never blocked by an upload.
+        std::scoped_lock < std::mutex > lck(uploadMutex);
+        std::vector < TextureStreamerUpload > uploads;
+
+        {
+            std::scoped_lock < std::mutex > entriesLck(entriesMutex);
+            planUploads(uploads);
+        }
+
+        for (TextureStreamerUpload const& upload : uploads)
+        {
+            if (!UploadLevels(*upload.texture, *upload.image, upload.level))
+                continue;
+
+            std::scoped_lock < std::mutex > entriesLck(entriesMutex);
+            auto it = entries.find(upload.texture->getHandle());
+
+            if (it != entries.end() && it->second.image == upload.image)
+                it->second.residentLevel = upload.level;
+        }
+    }
+
+    void TextureStreamer::planUploads(std::vector < TextureStreamerUpload >& uploads)
+    {
+        struct Candidate
+        {
+            TextureStreamerEntry* entry;
+            std::size_t wanted;
+        };
+
+        if (entries.empty()) return;
+
+        std::vector < Candidate > candidates;
+        candidates.reserve(entries.size());
+        std::size_t total = 0;
+
+        // Wanted level gives one texel per screen pixel. Textures not requested fall back to their coarse level.
+        for (auto& pair : entries)
+        {
+            TextureStreamerEntry& entry = pair.second;
+            std::size_t wanted = entry.coarseLevel;
+
+            if (entry.demand > 0.0f)
+            {
+                auto pixels = entry.image->getPixelSet();
+                const float size = static_cast < float >(std::max(pixels->levels[0].width, pixels->levels[0].height));
+                const float level = std::floor(std::log2(std::max(1.0f, size / entry.demand)));
+                wanted = std::min(entry.coarseLevel, static_cast < std::size_t >(level));
+            }
+
+            total += entry.chainBytes[wanted];
+            candidates.push_back({ &entry, wanted });
+        }
+
+        // Over budget: downgrades least requested textures first, one level at a time.
+        const std::size_t maxBytes = budget.load();
+
+        if (total > maxBytes)
+        {
+            std::sort(candidates.begin(), candidates.end(), [](Candidate const& lhs, Candidate const& rhs) {
+                return lhs.entry->demand < rhs.entry->demand; });
+
+            for (auto& candidate : candidates)
+            {
+                while (total > maxBytes && candidate.wanted < candidate.entry->coarseLevel)
+                {
+                    total -= candidate.entry->chainBytes[candidate.wanted] - candidate.entry->chainBytes[candidate.wanted + 1];
+                    candidate.wanted++;
+                }
+
+                if (total <= maxBytes)
+                    break;
+            }
+        }
+
+        // Downgrades free memory: they are always applied, first.
+        for (auto& candidate : candidates)
+        {
+            if (candidate.wanted > candidate.entry->residentLevel)
+                uploads.push_back({ candidate.entry->texture, candidate.entry->image, candidate.wanted });
+        }
+
+        // Upgrades are applied from the most requested texture, up to uploadLimit bytes. The first upgrade
+        // is always applied, so a texture larger than the limit is not starved forever.
+        std::sort(candidates.begin(), candidates.end(), [](Candidate const& lhs, Candidate const& rhs) {
+            return lhs.entry->demand > rhs.entry->demand; });
+
+        const std::size_t maxUpload = uploadLimit.load();
+        std::size_t uploaded = 0;
+
+        for (auto& candidate : candidates)
+        {
+            if (candidate.wanted >= candidate.entry->residentLevel)
+                continue;
+
+            const std::size_t cost = candidate.entry->chainBytes[candidate.wanted];
+            if (uploaded && uploaded + cost > maxUpload)
+                continue;
+
+            uploads.push_back({ candidate.entry->texture, candidate.entry->image, candidate.wanted });
+            uploaded += cost;
+        }
+
+        for (auto& pair : entries)
+            pair.second.demand = 0.0f;
+    }
+
+    std::size_t TextureStreamer::getResidentBytes() const
+    {
+        std::scoped_lock < std::mutex > lck(entriesMutex);
+        std::size_t result = 0;
+
+        for (auto const& pair : entries)
+            result += pair.second.chainBytes[pair.second.residentLevel];
+
+        return result;
+    }
+
+    std::size_t TextureStreamer::findResidentLevel(Texture const& texture) const
+    {
+        std::scoped_lock < std::mutex > lck(entriesMutex);
+        auto it = entries.find(texture.getHandle());
+        return it != entries.end() ? it->second.residentLevel : 0;
+    }
+
+    void TextureStreamer::setBudget(std::size_t bytes)
+    {
+        budget.store(bytes);
+    }
+
+    std::size_t TextureStreamer::getBudget() const
+    {
+        return budget.load();
+    }
+
+    void TextureStreamer::setUploadLimit(std::size_t bytes)
+    {
+        uploadLimit.store(bytes);
+    }
+
+    std::size_t TextureStreamer::getUploadLimit() const
+    {
+        return uploadLimit.load();
+    }
+
+    void TextureStreamer::setCoarseSize(std::size_t pixels)
+    {
+        coarseSize.store(pixels);
+    }
+
+    std::size_t TextureStreamer::getCoarseSize() const
+    {
+        return coarseSize.load();
+    }
+
+    void TextureStreamer::Release(TextureStreamerEntry& entry)
+    {
+        if (!entry.ownsPixels)
+            return;
+
+        Free(entry.image->getPixelSet()->data);
+        entry.ownsPixels = false;
+    }
+
+    bool TextureStreamer::UploadLevels(Texture& texture, Image const& source, std::size_t level)
+    {
+        auto pixels = source.getPixelSet();
+        auto view = MipmapMakeLevelsView(pixels, level);
+        auto image = AllocateShared < Image >(view, SizePair{ 0, 0 }, SizePair{ pixels->levels[level].width, pixels->levels[level].height });
+
+        if (!texture.upload(image))
+        {
+            NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "Texture #%i can't upload level %i.",
+                texture.getHandle(), (int) level));
+            return false;
+        }
+
+        return true;
+    }
+}
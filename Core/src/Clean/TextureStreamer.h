@@ -0,0 +1,191 @@
+/** =======================================================
+ *  \file Core/TextureStreamer.h
+ *  \date 10/18/2026
+ *  \author luk2010
+    ======================================================= **/
+
+#ifndef CLEAN_TEXTURESTREAMER_H
+#define CLEAN_TEXTURESTREAMER_H
+
+#include "Texture.h"
+#include "Image.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Clean
+{
+    //! @brief Default memory budget for streamed textures: 256 MiB.
+    static constexpr const std::size_t kTextureStreamerDefaultBudget = 256 * 1024 * 1024;
+
+    //! @brief Default maximum number of bytes uploaded by one TextureStreamer::update(): 8 MiB.
+    static constexpr const std::size_t kTextureStreamerDefaultUploadLimit = 8 * 1024 * 1024;
+
+    //! @brief Default size, in pixels, of the coarse level uploaded when a texture is added.
+    static constexpr const std::size_t kTextureStreamerDefaultCoarseSize = 64;
+
+    //! @brief Flags of TextureStreamer::add(). @{
+    
+    //! @brief The texture already holds the coarse levels: they are not uploaded again.
+    static constexpr const std::uint8_t kTextureStreamerUploaded = 1 << 0;
+    
+    //! @brief The streamer frees the PixelSet data of the image when the texture stops being streamed.
+    static constexpr const std::uint8_t kTextureStreamerOwnsPixels = 1 << 1;
+    
+    //! @}
+
+    /** @brief A texture managed by TextureStreamer. */
+    struct TextureStreamerEntry
+    {
+        //! @brief Texture whose levels are streamed.
+        std::shared_ptr < Texture > texture;
+
+        //! @brief Image holding the full mipmaps chain in CPU memory.
+        std::shared_ptr < Image > image;
+
+        //! @brief Number of bytes of the chain starting at each level (chainBytes[i] is the size
+        //! of levels [i, end)).
+        std::vector < std::size_t > chainBytes;
+
+        //! @brief First level currently resident in the texture.
+        std::size_t residentLevel = 0;
+
+        //! @brief Coarsest level allowed. This is the first level uploaded, and it is never evicted.
+        std::size_t coarseLevel = 0;
+
+        //! @brief Largest screen size requested since last update, in pixels. Zero if not requested.
+        float demand = 0.0f;
+
+        //! @brief True if the PixelSet data of image is freed with the entry.
+        bool ownsPixels = false;
+    };
+
+    /** @brief Levels chosen by TextureStreamer::update() for a texture. */
+    struct TextureStreamerUpload
+    {
+        //! @brief Texture whose levels change.
+        std::shared_ptr < Texture > texture;
+
+        //! @brief Image holding the full mipmaps chain.
+        std::shared_ptr < Image > image;
+
+        //! @brief First level uploaded.
+        std::size_t level = 0;
+    };
+
+    /** @brief Streams mipmaps levels of textures by screen demand, under a memory budget.
+     *
+     * A streamed texture is first uploaded with its coarse levels only (the first level smaller than
+     * the coarse size, and every level after it). Each frame, rendering code calls \ref request() with
+     * the size, in pixels, the texture covers on the screen: Driver::renderCommand() does so for the textures
+     * of commands with a RenderCommand::screenSize. \ref update() then computes the level needed by each texture: one texel per pixel, i.e. log2(textureSize / screenSize).
+     *
+     * When the wanted levels do not fit in the budget, the least requested textures are downgraded
+     * first. Downgrades are applied immediately (they free memory), and upgrades are applied from the
+     * most requested texture, limited to a number of bytes per update so a frame is never stalled by
+     * too many uploads. Textures not requested during a frame fall back to their coarse level.
+     *
+     * Levels are changed with Texture::upload(), using a view of the full chain held by the Image: this
+     * object must keep the Image alive as long as the texture is streamed.
+     *
+     * \note request() can be called from any thread. update() must be called from the thread owning the
+     * driver's context, which is done by Driver::update(). Uploads are done without locking the entries, so
+     * request() doesn't wait for them. remove(), clear() and add() do, as they may free a chain.
+     *
+    **/
+    class TextureStreamer
+    {
+        //! @brief Streamed textures, by texture handle.
+        std::unordered_map < std::size_t, TextureStreamerEntry > entries;
+
+        //! @brief Protects entries.
+        mutable std::mutex entriesMutex;
+
+        //! @brief Held by update() while uploading, and by functions freeing chains. Locked before entriesMutex.
+        std::mutex uploadMutex;
+
+        //! @brief Maximum number of bytes for all resident levels.
+        std::atomic < std::size_t > budget;
+
+        //! @brief Maximum number of bytes uploaded by one update.
+        std::atomic < std::size_t > uploadLimit;
+
+        //! @brief Size, in pixels, of the coarse level.
+        std::atomic < std::size_t > coarseSize;
+
+    public:
+
+        /*! @brief Constructs a streamer with default budget and limits. */
+        TextureStreamer();
+
+        /*! @brief Frees the chains owned by the streamer. */
+        ~TextureStreamer();
+
+        /*! @brief Registers a texture and uploads its coarse levels.
+         *
+         * \param texture Texture to stream. Its previous content is replaced.
+         * \param image Image holding the full mipmaps chain. Its PixelSet must have levels.
+         * \param flags kTextureStreamerUploaded if the texture was made from the levels starting at
+         *      \ref findCoarseLevel(), and kTextureStreamerOwnsPixels to free the chain with the entry.
+         *
+         * \return True if the texture is now streamed. If not, the chain is never freed by the streamer.
+         *
+        **/
+        bool add(std::shared_ptr < Texture > const& texture, std::shared_ptr < Image > const& image, std::uint8_t flags = 0);
+
+        /*! @brief Returns the coarse level of a chain: the first level not larger than the coarse size, or its
+         *  last level. Returns 0 if it has no levels. */
+        std::size_t findCoarseLevel(PixelSet const& pixels) const;
+
+        /*! @brief Stops streaming a texture. Its resident levels are kept as-is. */
+        void remove(Texture const& texture);
+
+        /*! @brief Removes all textures. */
+        void clear();
+
+        /*! @brief Notifies the streamer the texture is drawn on screenSize pixels (largest dimension). */
+        void request(Texture const& texture, float screenSize);
+
+        /*! @brief Computes wanted levels and uploads or evicts levels. */
+        void update();
+
+        /*! @brief Returns the number of bytes currently resident for all streamed textures. */
+        std::size_t getResidentBytes() const;
+
+        /*! @brief Returns the first resident level of a texture, or 0 if it is not streamed. */
+        std::size_t findResidentLevel(Texture const& texture) const;
+
+        /*! @brief Changes the memory budget, in bytes. */
+        void setBudget(std::size_t bytes);
+
+        /*! @brief Returns the memory budget, in bytes. */
+        std::size_t getBudget() const;
+
+        /*! @brief Changes the maximum number of bytes uploaded by one update. */
+        void setUploadLimit(std::size_t bytes);
+
+        /*! @brief Returns the maximum number of bytes uploaded by one update. */
+        std::size_t getUploadLimit() const;
+
+        /*! @brief Changes the size, in pixels, of the coarse level of textures added afterwards. */
+        void setCoarseSize(std::size_t pixels);
+
+        /*! @brief Returns the size, in pixels, of the coarse level. */
+        std::size_t getCoarseSize() const;
+
+    private:
+
+        /*! @brief Frees the chain of an entry if it owns it. */
+        static void Release(TextureStreamerEntry& entry);
+
+        /*! @brief Chooses the levels to upload or evict, and resets demands. entriesMutex must be locked. */
+        void planUploads(std::vector < TextureStreamerUpload >& uploads);
+
+        /*! @brief Uploads levels [level, end) of image to texture. */
+        static bool UploadLevels(Texture& texture, Image const& image, std::size_t level);
+    };
+}
+
+#endif // CLEAN_TEXTURESTREAMER_H
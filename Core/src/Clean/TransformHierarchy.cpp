@@ -0,0 +1,406 @@
+/** \file Core/TransformHierarchy.cpp
+**/
+
+#include "TransformHierarchy.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define CLEAN_TRANSFORM_SSE2
+#endif
+
+namespace Clean
+{
+    /*! @brief Returns the matrix translating by position, rotating by rotation and scaling by scale. */
+    static glm::mat4 ComposeMatrix(glm::vec3 const& position, glm::quat const& rotation, glm::vec3 const& scale)
+    {
+        glm::mat4 result = glm::mat4_cast(rotation);
+        result[0] *= scale.x;
+        result[1] *= scale.y;
+        result[2] *= scale.z;
+        result[3] = glm::vec4(position, 1.0f);
+        return result;
+    }
+
+    /*! @brief Computes lhs * rhs in result. result may not alias lhs. */
+    static void MultiplyMatrices(glm::mat4 const& lhs, glm::mat4 const& rhs, glm::mat4& result)
+    {
+#   ifdef CLEAN_TRANSFORM_SSE2
+        // Each column of the result is a linear combination of the columns of lhs.
+
+        const __m128 c0 = _mm_loadu_ps(&lhs[0][0]);
+        const __m128 c1 = _mm_loadu_ps(&lhs[1][0]);
+        const __m128 c2 = _mm_loadu_ps(&lhs[2][0]);
+        const __m128 c3 = _mm_loadu_ps(&lhs[3][0]);
+
+        for (int j = 0; j < 4; ++j)
+        {
+            __m128 column = _mm_mul_ps(c0, _mm_set1_ps(rhs[j][0]));
+            column = _mm_add_ps(column, _mm_mul_ps(c1, _mm_set1_ps(rhs[j][1])));
+            column = _mm_add_ps(column, _mm_mul_ps(c2, _mm_set1_ps(rhs[j][2])));
+            column = _mm_add_ps(column, _mm_mul_ps(c3, _mm_set1_ps(rhs[j][3])));
+            _mm_storeu_ps(&result[j][0], column);
+        }
+#   else
+        result = lhs * rhs;
+#   endif
+    }
+
+    SlotHandle TransformHierarchy::insert(SlotHandle const& parent, glm::vec3 const& position, glm::quat const& rotation, glm::vec3 const& scale)
+    {
+        std::uint32_t parentIndex = kNoParent;
+
+        if (parent.valid())
+        {
+            if (!slots.contains(parent)) return SlotHandle();
+            parentIndex = indexOf(parent);
+        }
+
+        const std::uint32_t index = static_cast < std::uint32_t >(handles.size());
+
+        // Appending keeps the depth-first order if the parent's subtree ends the arrays, as when a
+        // hierarchy is built parent first: the ancestors' subtrees just grow by one.
+
+        if (parentIndex != kNoParent && !orderDirty)
+        {
+            if (parentIndex + subtreeSizes[parentIndex] == index) {
+                for (std::uint32_t ancestor = parentIndex; ancestor != kNoParent; ancestor = parents[ancestor])
+                    subtreeSizes[ancestor]++;
+            } else {
+                orderDirty = true;
+            }
+        }
+
+        SlotHandle handle = slots.insert(index);
+
+        handles.push_back(handle);
+        parents.push_back(parentIndex);
+        subtreeSizes.push_back(1);
+        positions.push_back(position);
+        rotations.push_back(rotation);
+        scales.push_back(scale);
+        worlds.emplace_back(1.0f);
+        dirty.push_back(1);
+        parameters.emplace_back();
+
+        return handle;
+    }
+
+    bool TransformHierarchy::remove(SlotHandle const& handle)
+    {
+        if (!slots.contains(handle)) return false;
+        if (orderDirty) sortDepthFirst();
+
+        const std::uint32_t first = indexOf(handle);
+        const std::uint32_t count = subtreeSizes[first];
+        const std::uint32_t last = first + count;
+
+        for (std::uint32_t ancestor = parents[first]; ancestor != kNoParent; ancestor = parents[ancestor])
+            subtreeSizes[ancestor] -= count;
+
+        for (std::uint32_t i = first; i < last; ++i)
+            slots.erase(handles[i]);
+
+        auto eraseRange = [first, last](auto& values){
+            values.erase(values.begin() + first, values.begin() + last);
+        };
+
+        eraseRange(handles); eraseRange(parents); eraseRange(subtreeSizes);
+        eraseRange(positions); eraseRange(rotations); eraseRange(scales);
+        eraseRange(worlds); eraseRange(dirty); eraseRange(parameters);
+
+        // Transforms after the subtree moved back by count, and so did their parents if after it too.
+
+        for (std::size_t i = first; i < handles.size(); ++i)
+        {
+            *slots.find(handles[i]) = static_cast < std::uint32_t >(i);
+            if (parents[i] != kNoParent && parents[i] >= last) parents[i] -= count;
+        }
+
+        return true;
+    }
+
+    bool TransformHierarchy::setParent(SlotHandle const& handle, SlotHandle const& parent)
+    {
+        if (!slots.contains(handle)) return false;
+        if (parent.valid() && !slots.contains(parent)) return false;
+
+        const std::uint32_t index = indexOf(handle);
+        std::uint32_t parentIndex = parent.valid() ? indexOf(parent) : kNoParent;
+
+        for (std::uint32_t ancestor = parentIndex; ancestor != kNoParent; ancestor = parents[ancestor])
+        {
+            if (ancestor == index) return false;
+        }
+
+        parents[index] = parentIndex;
+        dirty[index] = 1;
+        orderDirty = true;
+        return true;
+    }
+
+    SlotHandle TransformHierarchy::getParent(SlotHandle const& handle) const
+    {
+        const std::uint32_t parent = parents[indexOf(handle)];
+        return parent == kNoParent ? SlotHandle() : handles[parent];
+    }
+
+    void TransformHierarchy::setLocal(SlotHandle const& handle, glm::vec3 const& position, glm::quat const& rotation, glm::vec3 const& scale)
+    {
+        const std::uint32_t index = indexOf(handle);
+        positions[index] = position;
+        rotations[index] = rotation;
+        scales[index] = scale;
+        dirty[index] = 1;
+    }
+
+    void TransformHierarchy::setPosition(SlotHandle const& handle, glm::vec3 const& position)
+    {
+        const std::uint32_t index = indexOf(handle);
+        positions[index] = position;
+        dirty[index] = 1;
+    }
+
+    void TransformHierarchy::setRotation(SlotHandle const& handle, glm::quat const& rotation)
+    {
+        const std::uint32_t index = indexOf(handle);
+        rotations[index] = rotation;
+        dirty[index] = 1;
+    }
+
+    void TransformHierarchy::setScale(SlotHandle const& handle, glm::vec3 const& scale)
+    {
+        const std::uint32_t index = indexOf(handle);
+        scales[index] = scale;
+        dirty[index] = 1;
+    }
+
+    glm::vec3 TransformHierarchy::getPosition(SlotHandle const& handle) const
+    {
+        return positions[indexOf(handle)];
+    }
+
+    glm::quat TransformHierarchy::getRotation(SlotHandle const& handle) const
+    {
+        return rotations[indexOf(handle)];
+    }
+
+    glm::vec3 TransformHierarchy::getScale(SlotHandle const& handle) const
+    {
+        return scales[indexOf(handle)];
+    }
+
+    glm::mat4 TransformHierarchy::getWorldMatrix(SlotHandle const& handle) const
+    {
+        return worlds[indexOf(handle)];
+    }
+
+    void TransformHierarchy::bindParameter(SlotHandle const& handle, std::shared_ptr < EffectParameter > const& parameter)
+    {
+        const std::uint32_t index = indexOf(handle);
+        parameters[index] = parameter;
+        dirty[index] = 1;
+    }
+
+    void TransformHierarchy::update()
+    {
+        ProfileScope("TransformHierarchy::update");
+
+        if (orderDirty) sortDepthFirst();
+
+        // Subtrees small enough become jobs; the transforms above them are computed first, in order, by
+        // this thread. Jobs are grouped until they hold about kTransformHierarchyGrain transforms.
+
+        std::vector < std::pair < std::size_t, std::size_t > > jobs;
+        std::size_t i = 0;
+
+        while (i < handles.size())
+        {
+            const std::size_t size = subtreeSizes[i];
+
+            if (size > kTransformHierarchyGrain) {
+                updateRange(i, i + 1);
+                i += 1;
+                continue;
+            }
+
+            if (!jobs.empty() && jobs.back().second == i && jobs.back().second - jobs.back().first + size <= kTransformHierarchyGrain)
+                jobs.back().second = i + size;
+            else
+                jobs.emplace_back(i, i + size);
+
+            i += size;
+        }
+
+        auto fn = [this, &jobs](std::size_t first, std::size_t last){
+            for (std::size_t job = first; job < last; ++job)
+                updateRange(jobs[job].first, jobs[job].second);
+        };
+
+        if (JobSystem* jobSystem = JobSystem::Find())
+            jobSystem->parallelFor(0, jobs.size(), 1, fn);
+        else
+            fn(0, jobs.size());
+
+        std::fill(dirty.begin(), dirty.end(), 0);
+    }
+
+    std::size_t TransformHierarchy::gatherWorldMatrices(std::vector < SlotHandle > const& list, void* dest, std::size_t stride) const
+    {
+        if (!stride) stride = sizeof(float) * 16;
+        auto* bytes = static_cast < unsigned char* >(dest);
+
+        static const glm::mat4 identity(1.0f);
+
+        for (std::size_t i = 0; i < list.size(); ++i)
+        {
+            std::uint32_t const* index = slots.find(list[i]);
+            glm::mat4 const& matrix = index ? worlds[*index] : identity;
+            std::memcpy(bytes + i * stride, &matrix[0][0], sizeof(float) * 16);
+        }
+
+        return list.empty() ? 0 : (list.size() - 1) * stride + sizeof(float) * 16;
+    }
+
+    bool TransformHierarchy::contains(SlotHandle const& handle) const
+    {
+        return slots.contains(handle);
+    }
+
+    std::size_t TransformHierarchy::size() const
+    {
+        return handles.size();
+    }
+
+    void TransformHierarchy::clear()
+    {
+        slots.clear();
+        handles.clear(); parents.clear(); subtreeSizes.clear();
+        positions.clear(); rotations.clear(); scales.clear();
+        worlds.clear(); dirty.clear(); parameters.clear();
+        orderDirty = false;
+    }
+
+    std::uint32_t TransformHierarchy::indexOf(SlotHandle const& handle) const
+    {
+        std::uint32_t const* index = slots.find(handle);
+        assert(index && "Invalid transform handle.");
+        return *index;
+    }
+
+    void TransformHierarchy::sortDepthFirst()
+    {
+        const std::size_t count = handles.size();
+
+        // Children lists, in their current order, as offsets in a single array.
+
+        std::vector < std::uint32_t > childOffsets(count + 1, 0);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (parents[i] != kNoParent) childOffsets[parents[i] + 1]++;
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+            childOffsets[i + 1] += childOffsets[i];
+
+        std::vector < std::uint32_t > children(childOffsets[count]);
+        std::vector < std::uint32_t > cursor(childOffsets.begin(), childOffsets.end() - 1);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (parents[i] != kNoParent) children[cursor[parents[i]]++] = static_cast < std::uint32_t >(i);
+        }
+
+        // Depth-first traversal from each root. order[new] = old.
+
+        std::vector < std::uint32_t > order;
+        order.reserve(count);
+        std::vector < std::uint32_t > stack;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (parents[i] != kNoParent) continue;
+            stack.push_back(static_cast < std::uint32_t >(i));
+
+            while (!stack.empty())
+            {
+                const std::uint32_t node = stack.back();
+                stack.pop_back();
+                order.push_back(node);
+
+                for (std::uint32_t c = childOffsets[node + 1]; c > childOffsets[node]; --c)
+                    stack.push_back(children[c - 1]);
+            }
+        }
+
+        assert(order.size() == count && "Transform hierarchy has a cycle.");
+
+        std::vector < std::uint32_t > newIndex(count);
+        for (std::size_t i = 0; i < count; ++i)
+            newIndex[order[i]] = static_cast < std::uint32_t >(i);
+
+        auto permute = [&order, count](auto& values){
+            typename std::remove_reference < decltype(values) >::type result;
+            result.reserve(count);
+            for (std::uint32_t old : order) result.push_back(std::move(values[old]));
+            values.swap(result);
+        };
+
+        permute(handles); permute(parents);
+        permute(positions); permute(rotations); permute(scales);
+        permute(worlds); permute(dirty); permute(parameters);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (parents[i] != kNoParent) parents[i] = newIndex[parents[i]];
+            *slots.find(handles[i]) = static_cast < std::uint32_t >(i);
+        }
+
+        // In depth-first order, children are after their parent: sizes accumulate backward.
+
+        subtreeSizes.assign(count, 1);
+
+        for (std::size_t i = count; i-- > 0;)
+        {
+            if (parents[i] != kNoParent) subtreeSizes[parents[i]] += subtreeSizes[i];
+        }
+
+        orderDirty = false;
+    }
+
+    void TransformHierarchy::updateRange(std::size_t first, std::size_t last)
+    {
+        for (std::size_t i = first; i < last; ++i)
+        {
+            const std::uint32_t parent = parents[i];
+
+            // A transform is dirty if it or one of its ancestors changed. Parents are before their children,
+            // and flags are cleared only once all ranges are done.
+
+            if (parent != kNoParent && dirty[parent])
+                dirty[i] = 1;
+
+            if (!dirty[i]) continue;
+
+            const glm::mat4 local = ComposeMatrix(positions[i], rotations[i], scales[i]);
+
+            if (parent == kNoParent) worlds[i] = local;
+            else MultiplyMatrices(worlds[parent], local, worlds[i]);
+
+            if (EffectParameter* parameter = parameters[i].get())
+            {
+                std::lock_guard < std::mutex > lck(parameter->mutex);
+                parameter->value.mat4 = worlds[i];
+                parameter->version = EffectParameterNextVersion();
+            }
+        }
+    }
+}
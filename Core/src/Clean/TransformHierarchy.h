@@ -0,0 +1,152 @@
+/** \file Core/TransformHierarchy.h
+**/
+
+#ifndef CLEAN_TRANSFORMHIERARCHY_H
+#define CLEAN_TRANSFORMHIERARCHY_H
+
+#include "SlotMap.h"
+#include "EffectParameter.h"
+
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Clean
+{
+    //! @brief Number of transforms below which a subtree is updated by a single job in TransformHierarchy::update().
+    static constexpr const std::size_t kTransformHierarchyGrain = 512;
+
+    /** @brief Parent/child hierarchy of transforms, computing world matrices for many objects at once.
+     *
+     * Each transform has a local position, rotation and scale relative to its parent. Transforms are stored as
+     * structure of arrays in depth-first order: a parent is always before its children, and each subtree is a
+     * contiguous range. Inserting a child or reparenting marks the order dirty; it is restored by the next
+     * \ref update().
+     *
+     * Modifying a local transform marks it dirty. \ref update() computes the world matrices of the dirty
+     * transforms and of their descendants only: the top of the tree is computed by the calling thread, then
+     * the subtrees below it are computed in parallel on the JobSystem, with SSE matrix products when available.
+     *
+     * World matrices feed the renderer either by \ref gatherWorldMatrices() into an instance buffer, or by
+     * binding an EffectParameter (usually kEffectModelMat4) to a transform: the parameter is written with a
+     * new version whenever the world matrix changes, so ParameterBlocks using it copy it again.
+     *
+     * A TransformHierarchy is not thread-safe: it is modified, then updated, by one thread.
+     *
+    **/
+    class TransformHierarchy
+    {
+        //! @brief Index of no transform.
+        static constexpr const std::uint32_t kNoParent = 0xFFFFFFFF;
+
+        //! @brief Position of each transform in the arrays, by handle.
+        SlotMap < std::uint32_t > slots;
+
+        //! @brief Handle of each transform.
+        std::vector < SlotHandle > handles;
+
+        //! @brief Position of the parent of each transform, or kNoParent.
+        std::vector < std::uint32_t > parents;
+
+        //! @brief Number of transforms in the subtree of each transform, itself included. Valid when the order is.
+        std::vector < std::uint32_t > subtreeSizes;
+
+        //! @brief Local transform of each transform.
+        std::vector < glm::vec3 > positions;
+        std::vector < glm::quat > rotations;
+        std::vector < glm::vec3 > scales;
+
+        //! @brief World matrix of each transform.
+        std::vector < glm::mat4 > worlds;
+
+        //! @brief True for transforms whose local transform changed since the last update.
+        std::vector < std::uint8_t > dirty;
+
+        //! @brief Parameter written with the world matrix of each transform. May be null.
+        std::vector < std::shared_ptr < EffectParameter > > parameters;
+
+        //! @brief True if the arrays are not in depth-first order anymore.
+        bool orderDirty = false;
+
+    public:
+
+        /*! @brief Inserts a transform, as a root if parent is null. Returns a null handle if parent is stale. */
+        SlotHandle insert(SlotHandle const& parent = SlotHandle(),
+                          glm::vec3 const& position = glm::vec3(0.0f),
+                          glm::quat const& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                          glm::vec3 const& scale = glm::vec3(1.0f));
+
+        /*! @brief Removes a transform and all its descendants. Returns false if handle is stale. */
+        bool remove(SlotHandle const& handle);
+
+        /*! @brief Changes the parent of a transform, or makes it a root if parent is null. Returns false if a
+         *  handle is stale or parent is a descendant of handle. **/
+        bool setParent(SlotHandle const& handle, SlotHandle const& parent);
+
+        /*! @brief Returns the parent of a transform, or a null handle. */
+        SlotHandle getParent(SlotHandle const& handle) const;
+
+        /*! @brief Sets the local transform. */
+        void setLocal(SlotHandle const& handle, glm::vec3 const& position, glm::quat const& rotation, glm::vec3 const& scale);
+
+        /*! @brief Sets the local position. */
+        void setPosition(SlotHandle const& handle, glm::vec3 const& position);
+
+        /*! @brief Sets the local rotation. */
+        void setRotation(SlotHandle const& handle, glm::quat const& rotation);
+
+        /*! @brief Sets the local scale. */
+        void setScale(SlotHandle const& handle, glm::vec3 const& scale);
+
+        /*! @brief Returns the local position. */
+        glm::vec3 getPosition(SlotHandle const& handle) const;
+
+        /*! @brief Returns the local rotation. */
+        glm::quat getRotation(SlotHandle const& handle) const;
+
+        /*! @brief Returns the local scale. */
+        glm::vec3 getScale(SlotHandle const& handle) const;
+
+        /*! @brief Returns the world matrix computed by the last update(). */
+        glm::mat4 getWorldMatrix(SlotHandle const& handle) const;
+
+        /*! @brief Binds a parameter written with the world matrix of the transform. parameter may be null
+         *  to unbind. The parameter is written at the next update(). **/
+        void bindParameter(SlotHandle const& handle, std::shared_ptr < EffectParameter > const& parameter);
+
+        /*! @brief Computes the world matrices of the dirty transforms and their descendants. */
+        void update();
+
+        /*! @brief Writes the world matrices of handles to dest, one every stride bytes (64 if zero), as
+         *  16 column-major floats. Stale handles write an identity matrix. Returns the bytes written. **/
+        std::size_t gatherWorldMatrices(std::vector < SlotHandle > const& handles, void* dest, std::size_t stride = 0) const;
+
+        /*! @brief Returns true if handle designates a transform. */
+        bool contains(SlotHandle const& handle) const;
+
+        /*! @brief Returns the number of transforms. */
+        std::size_t size() const;
+
+        /*! @brief Removes all transforms. */
+        void clear();
+
+    private:
+
+        /*! @brief Returns the position of handle in the arrays. Asserts handle is valid. */
+        std::uint32_t indexOf(SlotHandle const& handle) const;
+
+        /*! @brief Reorders the arrays in depth-first order and computes subtree sizes. */
+        void sortDepthFirst();
+
+        /*! @brief Computes the world matrices of transforms [first, last), which must be whole subtrees
+         *  or single transforms whose parent is already computed. **/
+        void updateRange(std::size_t first, std::size_t last);
+    };
+}
+
+#endif // CLEAN_TRANSFORMHIERARCHY_H
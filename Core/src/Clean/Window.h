@@ -90,6 +90,20 @@ namespace Clean
         float deltaY;
     };
     
+    /** @brief Consecutive mouse moves of a Window not yet delivered are sent as one move. */
+    template <>
+    struct EventCoalescing < WindowMouseMovedEvent >
+    {
+        static bool Merge(WindowMouseMovedEvent& last, WindowMouseMovedEvent const& next) 
+        {
+            if (last.emitter != next.emitter) return false;
+            
+            last.deltaX += next.deltaX;
+            last.deltaY += next.deltaY;
+            return true;
+        }
+    };
+    
     /*! @brief Listens to a Window object. */
     class WindowListener 
     {
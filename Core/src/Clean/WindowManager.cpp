@@ -5,6 +5,11 @@
 
 namespace Clean 
 {
+    WindowManager::WindowManager()
+    {
+        handleIndex = addIndex([](Window const& window){ return window.getHandle(); });
+    }
+    
     bool WindowManager::allWindowClosed() const 
     {
         bool result = true;
@@ -28,15 +33,6 @@ namespace Clean
     
     std::shared_ptr < Window > WindowManager::findByHandle(std::uint16_t const& hdl) 
     {
-        std::scoped_lock < std::mutex > lck(managedListMutex);
-        auto it = std::find_if(managedList.begin(), managedList.end(), [&hdl](std::shared_ptr < Window > const& wnd){
-            assert(wnd && "Null pointer stored.");
-            return wnd->getHandle() == hdl;
-        });
-        
-        if (it == managedList.end())
-            return nullptr;
-        else 
-            return *it;
+        return findIndexed(handleIndex, hdl, [&hdl](Window const& window){ return window.getHandle() == hdl; });
     }
 }
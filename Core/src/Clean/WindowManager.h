@@ -13,10 +13,13 @@ namespace Clean
     **/
     class WindowManager final : public Manager < Window >
     {
+        //! @brief Index of windows by handle.
+        std::size_t handleIndex;
+        
     public:
         
-        /** @brief Default constructor. */
-        WindowManager() = default;
+        /** @brief Constructs the manager and its index by handle. */
+        WindowManager();
         
         /** @brief Default destructor. */
         ~WindowManager() = default;
@@ -0,0 +1,157 @@
+/** \file Core/WorkerPool.cpp
+**/
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Clean
+{
+    //! @brief Pool of the worker running on this thread, if any.
+    static thread_local WorkerPool* currentPool = nullptr;
+
+    //! @brief Index of the worker running on this thread.
+    static thread_local std::size_t currentWorker = 0;
+
+    WorkerPool::WorkerPool(std::size_t threadsCount)
+        : pendingCount(0), sleepingCount(0), nextWorker(0), exiting(false)
+    {
+        if (!threadsCount)
+        {
+            const std::size_t hardware = std::thread::hardware_concurrency();
+            threadsCount = std::max < std::size_t >(1, hardware > 1 ? hardware - 1 : 1);
+        }
+
+        for (std::size_t i = 0; i < threadsCount; ++i)
+            workers.push_back(std::make_unique < Worker >());
+
+        for (std::size_t i = 0; i < threadsCount; ++i)
+            threads.emplace_back([this, i](){ loop(i); });
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard < std::mutex > lck(sleepMutex);
+            exiting.store(true);
+        }
+
+        sleepCondition.notify_all();
+
+        for (auto& thread : threads)
+        {
+            if (thread.joinable())
+                thread.join();
+        }
+    }
+
+    void WorkerPool::submit(std::function < void() > task)
+    {
+        assert(task && "Null task submitted to Clean::WorkerPool.");
+
+        const std::size_t index = (currentPool == this)
+            ? currentWorker
+            : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+        pendingCount.fetch_add(1);
+
+        {
+            Worker& worker = *workers[index];
+            std::lock_guard < std::mutex > lck(worker.mutex);
+            worker.tasks.push_back(std::move(task));
+        }
+
+        // A worker going to sleep increments sleepingCount before checking pendingCount: one of us sees
+        // the other's increment, so the task is never left with all workers asleep.
+        if (sleepingCount.load())
+        {
+            std::lock_guard < std::mutex > lck(sleepMutex);
+            sleepCondition.notify_one();
+        }
+    }
+
+    std::size_t WorkerPool::getThreadsCount() const
+    {
+        return workers.size();
+    }
+
+    bool WorkerPool::isWorkerThread() const
+    {
+        return currentPool == this;
+    }
+
+    bool WorkerPool::runTask()
+    {
+        const std::size_t index = (currentPool == this)
+            ? currentWorker
+            : nextWorker.load(std::memory_order_relaxed) % workers.size();
+
+        std::function < void() > task;
+        if (!take(index, task)) return false;
+
+        task();
+        return true;
+    }
+
+    bool WorkerPool::take(std::size_t index, std::function < void() >& task)
+    {
+        {
+            Worker& worker = *workers[index];
+            std::lock_guard < std::mutex > lck(worker.mutex);
+
+            if (!worker.tasks.empty())
+            {
+                task = std::move(worker.tasks.back());
+                worker.tasks.pop_back();
+                pendingCount.fetch_sub(1);
+                return true;
+            }
+        }
+
+        for (std::size_t i = 1; i < workers.size(); ++i)
+        {
+            Worker& victim = *workers[(index + i) % workers.size()];
+            std::lock_guard < std::mutex > lck(victim.mutex);
+
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                pendingCount.fetch_sub(1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void WorkerPool::loop(std::size_t index)
+    {
+        currentPool = this;
+        currentWorker = index;
+
+        std::function < void() > task;
+
+        while (true)
+        {
+            if (take(index, task))
+            {
+                task();
+                task = nullptr;
+                continue;
+            }
+
+            std::unique_lock < std::mutex > lck(sleepMutex);
+            sleepingCount.fetch_add(1);
+
+            sleepCondition.wait(lck, [this](){ return pendingCount.load() > 0 || exiting.load(); });
+            sleepingCount.fetch_sub(1);
+
+            if (exiting.load() && !pendingCount.load())
+                break;
+        }
+
+        currentPool = nullptr;
+    }
+}
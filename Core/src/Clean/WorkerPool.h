@@ -0,0 +1,101 @@
+/** \file Core/WorkerPool.h
+**/
+
+#ifndef CLEAN_WORKERPOOL_H
+#define CLEAN_WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Clean
+{
+    /** @brief A fixed number of threads executing small tasks.
+     *
+     * Each worker has its own deque of tasks. A task submitted from a worker goes to this worker's deque, and
+     * is executed by it in LIFO order while it is hot in cache. A task submitted from another thread goes to
+     * the workers in turn. An idle worker steals the oldest task of the other workers before sleeping.
+     *
+     * Tasks must not block waiting for other tasks of the pool, as there are no more threads than workers,
+     * but they may execute other tasks with \ref runTask() while waiting. Tasks submitted are all executed
+     * before the pool is destroyed. Most code should use the pool through JobSystem.
+     *
+    **/
+    class WorkerPool
+    {
+        /** @brief Tasks of one worker. */
+        struct Worker
+        {
+            //! @brief Protects tasks.
+            std::mutex mutex;
+
+            //! @brief Tasks, newest at the back.
+            std::deque < std::function < void() > > tasks;
+        };
+
+        //! @brief Deques of the workers.
+        std::vector < std::unique_ptr < Worker > > workers;
+
+        //! @brief Threads of the workers.
+        std::vector < std::thread > threads;
+
+        //! @brief Number of tasks submitted but not started.
+        std::atomic < std::size_t > pendingCount;
+
+        //! @brief Number of workers sleeping.
+        std::atomic < std::size_t > sleepingCount;
+
+        //! @brief Worker receiving the next task submitted from outside the pool.
+        std::atomic < std::size_t > nextWorker;
+
+        //! @brief True when the pool is destroyed.
+        std::atomic < bool > exiting;
+
+        //! @brief Protects sleepCondition.
+        std::mutex sleepMutex;
+
+        //! @brief Notified when a task is submitted while workers sleep.
+        std::condition_variable sleepCondition;
+
+    public:
+
+        /*! @brief Starts the workers. If threadsCount is 0, one worker is started for each hardware thread
+         *  minus one, the calling thread being busy with the main loop. **/
+        explicit WorkerPool(std::size_t threadsCount = 0);
+
+        /*! @brief Executes the tasks left and stops the workers. */
+        ~WorkerPool();
+
+        WorkerPool(WorkerPool const&) = delete;
+        WorkerPool& operator = (WorkerPool const&) = delete;
+
+        /*! @brief Submits a task to be executed by a worker. */
+        void submit(std::function < void() > task);
+
+        /*! @brief Returns the number of workers. */
+        std::size_t getThreadsCount() const;
+
+        /*! @brief Returns true if the calling thread is a worker of this pool. */
+        bool isWorkerThread() const;
+
+        /*! @brief Executes one task submitted to the pool on the calling thread. Returns false if there was none.
+         *  Threads waiting for tasks use it to help the workers instead of blocking. **/
+        bool runTask();
+
+    private:
+
+        /*! @brief Takes a task from the worker's deque, or steals one. Returns false if there is none. */
+        bool take(std::size_t index, std::function < void() >& task);
+
+        /*! @brief Runs a worker. */
+        void loop(std::size_t index);
+    };
+}
+
+#endif // CLEAN_WORKERPOOL_H
@@ -45,8 +45,13 @@
 #include <Clean/Allocate.h>
 #include <Clean/Mesh.h>
 #include <Clean/Camera.h>
+#include <Clean/BuildableShaderMapper.h>
+#include <Clean/Culling.h>
+#include <Clean/BoundingVolumeHierarchy.h>
+#include <Clean/TransformHierarchy.h>
 #include <iostream>
 #include <chrono>
+#include <thread>
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -90,6 +95,9 @@ public:
 static constexpr const float kFPSCameraDefaultSpeed = 0.007f;
 static constexpr const float kFPSCameraDefaultSensitivity = 0.04f;
 
+//! @brief Angular speed of the grid of cubes, in radians per millisecond.
+static constexpr const float kGridAngularSpeed = 0.0005f;
+
 /** @brief An example of a very simple FPS-like Camera. */
 class FPSCamera : public Clean::Camera, public TimeUpdatable
 {
@@ -153,6 +161,7 @@ public:
     
     void invert()
     {
+        std::scoped_lock < std::mutex > lck(mutex);
         worldUp = -worldUp;
         makeVectors();
     }
@@ -244,7 +253,10 @@ int main()
         fs.addRealPath("Texture", "../Textures");
         
         std::size_t moduleCount = core.loadAllModules();
-        assert(moduleCount && "No module found.");
+        std::size_t deferredCount = core.getDeferredModuleCount();
+        assert((moduleCount || deferredCount) && "No module found.");
+        
+        std::cout << moduleCount << " modules loaded, " << deferredCount << " libraries deferred." << std::endl;
         
         {
             // Try to find our driver 'Clean.GlDriver'. This is the default Clean::Driver for OpenGL. Driver
@@ -314,16 +326,11 @@ int main()
             assert(material && "Material 'Example' not found.");
             firstCommand.parameters.add(*material);
             
-            // Tries to load our Texture. 
-            
-            auto texture = gldriver->makeTexture("Clean://Texture/Cube.png");
-            material->setAmbientTexture(texture);
-            
-            // We can add our command to our RenderQueue. This must be done only *after* the command is completed, because
-            // RenderQueue adds its command by moving objects. Updating a command already added will not take effect in the
-            // RenderQueue.
+            // Tries to load our Texture. Only its coarse levels are uploaded now: finer ones are streamed when the cube 
+            // covers enough pixels on screen. 
             
-            defaultQueue->addCommand(firstCommand);
+            auto texture = gldriver->makeStreamedTexture("Clean://Texture/Cube.png");
+            material->setDiffuseTexture(texture);
             
             // Input subsystem is controlled by each Window. Therefore, a Camera can be connected to a Window input. Each Camera
             // action can be connected to an input key. However, as some keyboards have different keys, an action layout can be
@@ -336,6 +343,60 @@ int main()
             auto& effSession = gldriver->getEffectSession();
             effSession.add(*camera);
             
+            // The camera's matrices are uploaded at once, in the 'Camera' block of our shader. The block's layout is made
+            // from the mapper's constants of this block, and its members are the camera's parameters. 
+            
+            auto mapper = std::dynamic_pointer_cast < BuildableShaderMapper >(firstCommand.pipeline->getMapper());
+            
+            if (mapper)
+            {
+                auto cameraBlock = AllocateShared < ParameterBlock >("Camera", 0, mapper->makeBlockLayout("Camera"), kParameterBlockPerFrame);
+                cameraBlock->set(*camera);
+                effSession.addBlock(cameraBlock);
+            }
+            
+            // The cube is drawn several times, on a grid turning around its centre. The grid and each instance are transforms
+            // of a TransformHierarchy: the instances are children of the grid, and the hierarchy writes their world matrix in
+            // their model parameter. The box of each instance in world space is stored in a BoundingVolumeHierarchy, with the
+            // index of the instance as user value. 
+            
+            struct CubeInstance
+            {
+                SlotHandle transform;
+                SlotHandle object;
+                std::shared_ptr < EffectParameter > model;
+                BoundingBox bounds;
+            };
+            
+            std::vector < CubeInstance > instances;
+            TransformHierarchy transforms;
+            BoundingVolumeHierarchy bvh;
+            
+            SlotHandle grid = transforms.insert(SlotHandle(), glm::vec3(0.0f, 0.0f, -4.0f));
+            
+            for (int x = -2; x <= 2; ++x)
+            {
+                for (int z = -2; z <= 2; ++z)
+                {
+                    CubeInstance instance;
+                    instance.transform = transforms.insert(grid, glm::vec3(x * 2.0f, 0.0f, z * 2.0f));
+                    instance.model = AllocateShared < EffectParameter >(kEffectModelMat4, ShaderValue{ .mat4 = glm::mat4(1.0f) }, kShaderParamMat4);
+                    transforms.bindParameter(instance.transform, instance.model);
+                    instances.push_back(instance);
+                }
+            }
+            
+            transforms.update();
+            
+            for (std::size_t i = 0; i < instances.size(); ++i)
+            {
+                CubeInstance& instance = instances[i];
+                instance.bounds = mesh->getBounds().transformed(transforms.getWorldMatrix(instance.transform));
+                instance.object = bvh.insert(instance.bounds, i);
+            }
+            
+            bvh.build();
+            
             /* 
             
             auto locale = Locale::Current();
@@ -350,16 +411,72 @@ int main()
             // with their update implementation, but would not commit rendering jobs and swap buffers of the rendering swap
             // chains. When you work with multiple driver, you should call Clean::Core::updateAllDrivers().
             
-            auto lastTime = std::chrono::high_resolution_clock::now();
+            //
+            // Frames are recorded by a second thread through the driver's FramePipeline: while the driver submits a frame,
+            // the next one is simulated and recorded. Commands added for a frame with RenderQueue::addCommand(command, frame)
+            // are rendered only with this frame. Window events must still be processed by the main thread, in update().
+            // Driver::endRecord() takes a snapshot of the camera's parameters: the submitted frame is drawn with them 
+            // while the camera moves for the next one. 
+            //
+            // Each frame, the grid turns and the TransformHierarchy updates the instances' world matrices. Their boxes are refit
+            // in the BoundingVolumeHierarchy, which is then queried with the camera's frustum: only the instances whose box
+            // intersects it are given to a CullingBatch, which tests them exactly before adding their commands to the
+            // RenderQueue. An instance's command is a copy of our first command with its model matrix, and the size of the cube
+            // on screen for this frame. The driver requests the streamed textures of the command at this size. 
+            
+            auto& framePipeline = gldriver->getFramePipeline();
+            framePipeline.setFramesInFlight(2);
+            
+            std::thread recorder([&framePipeline, &firstCommand, &instances, &transforms, &bvh, grid, gldriver, defaultQueue, window, mesh, camera](){
+                auto lastTime = std::chrono::high_resolution_clock::now();
+                CullingBatch culling;
+                float gridAngle = 0.0f;
+                
+                while (std::uint64_t frame = framePipeline.beginRecord())
+                {
+                    auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - lastTime);
+                    lastTime = std::chrono::high_resolution_clock::now();
+                    
+                    camera->update(deltaTime);
+                    camera->commit();
+                    
+                    gridAngle += static_cast < float >(deltaTime.count()) * kGridAngularSpeed;
+                    transforms.setRotation(grid, glm::angleAxis(gridAngle, glm::vec3(0.0f, 1.0f, 0.0f)));
+                    transforms.update();
+                    
+                    for (CubeInstance& instance : instances)
+                    {
+                        instance.bounds = mesh->getBounds().transformed(transforms.getWorldMatrix(instance.transform));
+                        bvh.refit(instance.object, instance.bounds);
+                    }
+                    
+                    const float viewportHeight = static_cast < float >(window->getSize().height);
+                    const Frustum frustum = camera->getFrustum();
+                    
+                    culling.clear();
+                    
+                    bvh.queryFrustum(frustum, [&](SlotHandle const&, std::uint64_t user) {
+                        CubeInstance const& instance = instances[user];
+                        
+                        RenderCommand command = firstCommand;
+                        command.parameters.add(instance.model);
+                        command.screenSize = viewportHeight * Mesh::ProjectedScreenSize(BoundingSphere::FromBox(instance.bounds), camera->getPosition(), camera->getProjectionMatrix());
+                        
+                        culling.add(instance.bounds, command);
+                    });
+                    
+                    culling.cull(frustum);
+                    culling.commit(*defaultQueue, frame);
+                    
+                    gldriver->endRecord(frame);
+                }
+            });
             
             while (!gldriver->allWindowClosed())
-            {
-                auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - lastTime);
-                lastTime = std::chrono::high_resolution_clock::now();
-                
-                camera->update(deltaTime);
                 gldriver->update();
-            }
+            
+            framePipeline.cancel();
+            recorder.join();
         }
         
         core.destroy();
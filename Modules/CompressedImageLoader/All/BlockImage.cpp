@@ -0,0 +1,97 @@
+/**
+ *  \file CompressedImageLoader/BlockImage.cpp
+ *  \date 10/18/2026
+**/
+
+#include "BlockImage.h"
+
+#include <Clean/Core.h>
+#include <Clean/Allocate.h>
+#include <Clean/FileSystem.h>
+#include <Clean/NotificationCenter.h>
+#include <Clean/Platform.h>
+
+#include <algorithm>
+#include <cstring>
+using namespace Clean;
+
+std::uint32_t BlockImageReadU32(std::string const& bytes, std::size_t offset)
+{
+    const unsigned char* data = reinterpret_cast < const unsigned char* >(bytes.data()) + offset;
+    return static_cast < std::uint32_t >(data[0])
+        | (static_cast < std::uint32_t >(data[1]) << 8)
+        | (static_cast < std::uint32_t >(data[2]) << 16)
+        | (static_cast < std::uint32_t >(data[3]) << 24);
+}
+
+std::uint64_t BlockImageReadU64(std::string const& bytes, std::size_t offset)
+{
+    return static_cast < std::uint64_t >(BlockImageReadU32(bytes, offset))
+        | (static_cast < std::uint64_t >(BlockImageReadU32(bytes, offset + 4)) << 32);
+}
+
+std::size_t BlockImageMaxLevels(std::uint32_t width, std::uint32_t height)
+{
+    std::uint32_t size = std::max(width, height);
+    std::size_t count = 1;
+
+    while (size >>= 1)
+        count++;
+
+    return count;
+}
+
+bool BlockImageReadFile(std::string const& filepath, std::string& bytes, std::string& realPath)
+{
+    std::fstream stream = Core::Get().getCurrentFileSystem().open(filepath, std::ios::in | std::ios::binary, &realPath);
+
+    if (!stream)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "File %s not found.", filepath.data()));
+        return false;
+    }
+
+    Platform::StreamGetContent(stream, bytes);
+    return true;
+}
+
+std::shared_ptr < Image > BlockImageMake(std::uint8_t format, std::string const& bytes, std::vector < PixelSetLevel > const& levels)
+{
+    assert(!levels.empty() && "No levels given.");
+    std::size_t totalSize = 0;
+
+    for (auto const& level : levels)
+    {
+        if (level.offset > bytes.size() || level.size > bytes.size() - level.offset || level.size < PixelFormatGetLevelSize(format, level.width, level.height))
+        {
+            NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "Level %ix%i is truncated.",
+                (int) level.width, (int) level.height));
+            return nullptr;
+        }
+
+        totalSize += level.size;
+    }
+
+    auto pixels = AllocateShared < PixelSet >();
+    pixels->format = format;
+    pixels->lineWidth = PixelFormatGetLevelSize(format, levels[0].width, 4);
+    pixels->columnsCount = levels[0].height;
+    pixels->data = Allocate < unsigned char >(totalSize);
+    pixels->levels.reserve(levels.size());
+
+    std::size_t offset = 0;
+
+    for (auto const& level : levels)
+    {
+        PixelSetLevel stored = level;
+        stored.offset = offset;
+        memcpy(pixels->data + offset, bytes.data() + level.offset, level.size);
+        offset += level.size;
+        pixels->levels.push_back(stored);
+    }
+
+    auto image = AllocateShared < Image >(pixels, SizePair{ 0, 0 }, SizePair{ levels[0].width, levels[0].height });
+    assert(image && "Null Allocation occured.");
+
+    return image;
+}
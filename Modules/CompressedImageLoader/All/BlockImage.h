@@ -0,0 +1,43 @@
+/**
+ *  \file CompressedImageLoader/BlockImage.h
+ *  \date 10/18/2026
+**/
+
+#ifndef COMPRESSEDIMAGELOADER_BLOCKIMAGE_H
+#define COMPRESSEDIMAGELOADER_BLOCKIMAGE_H
+
+#include <Clean/Image.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*! @brief Reads a little-endian 32 bits value at given offset. Caller must check bounds. */
+std::uint32_t BlockImageReadU32(std::string const& bytes, std::size_t offset);
+
+/*! @brief Reads a little-endian 64 bits value at given offset. Caller must check bounds. */
+std::uint64_t BlockImageReadU64(std::string const& bytes, std::size_t offset);
+
+/*! @brief Returns the number of levels of a full mipmaps chain for the given size: floor(log2(max(width, height))) + 1.
+ *  Used to clamp the levels count read from a file header. Size must not be zero.
+**/
+std::size_t BlockImageMaxLevels(std::uint32_t width, std::uint32_t height);
+
+/*! @brief Reads the whole content of a binary file, through the current FileSystem.
+ *  Returns false and sends an error notification if the file cannot be opened.
+**/
+bool BlockImageReadFile(std::string const& filepath, std::string& bytes, std::string& realPath);
+
+/*! @brief Makes an Image from the mipmaps chain of a block-compressed file.
+ *
+ * \param format Block-compressed format of every level.
+ * \param bytes Content of the file.
+ * \param levels Levels of the image, where offset is relative to bytes. Every level is copied
+ *      contiguously in the PixelSet data, base level first.
+ *
+ * \return A new Image, or nullptr if a level is out of the file bounds.
+ *
+**/
+std::shared_ptr < Clean::Image > BlockImageMake(std::uint8_t format, std::string const& bytes, std::vector < Clean::PixelSetLevel > const& levels);
+
+#endif // COMPRESSEDIMAGELOADER_BLOCKIMAGE_H
@@ -0,0 +1,127 @@
+/**
+ *  \file CompressedImageLoader/DDSLoader.cpp
+ *  \date 10/18/2026
+**/
+
+#include "DDSLoader.h"
+#include "BlockImage.h"
+
+#include <Clean/NotificationCenter.h>
+#include <Clean/Platform.h>
+using namespace Clean;
+
+static constexpr const std::uint32_t kDDSMagic = 0x20534444;       // 'DDS '
+static constexpr const std::uint32_t kDDSFourCCDXT1 = 0x31545844;  // 'DXT1'
+static constexpr const std::uint32_t kDDSFourCCDXT5 = 0x35545844;  // 'DXT5'
+static constexpr const std::uint32_t kDDSFourCCDX10 = 0x30315844;  // 'DX10'
+
+static constexpr const std::uint32_t kDDSFlagMipMapCount = 0x20000;
+static constexpr const std::uint32_t kDDSPixelFormatFourCC = 0x4;
+static constexpr const std::uint32_t kDDSCaps2Cubemap = 0x200;
+static constexpr const std::uint32_t kDDSCaps2Volume = 0x200000;
+
+static constexpr const std::size_t kDDSHeaderSize = 128;
+static constexpr const std::size_t kDDSHeaderDX10Size = 20;
+
+/*! @brief Converts a DXGI_FORMAT value to the corresponding PixelFormat. */
+std::uint8_t DDSPixelFormatFromDXGI(std::uint32_t dxgiFormat)
+{
+    switch (dxgiFormat)
+    {
+        case 71: // DXGI_FORMAT_BC1_UNORM
+        case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+        return kPixelFormatBC1;
+
+        case 77: // DXGI_FORMAT_BC3_UNORM
+        case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+        return kPixelFormatBC3;
+
+        case 98: // DXGI_FORMAT_BC7_UNORM
+        case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+        return kPixelFormatBC7;
+
+        default:
+        return kPixelFormatNull;
+    }
+}
+
+std::shared_ptr < Image > DDSLoader::load(std::string const& filepath) const
+{
+    std::string bytes, realPath;
+    if (!BlockImageReadFile(filepath, bytes, realPath))
+        return nullptr;
+
+    if (bytes.size() < kDDSHeaderSize || BlockImageReadU32(bytes, 0) != kDDSMagic)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "File %s is not a DDS file.", realPath.data()));
+        return nullptr;
+    }
+
+    const std::uint32_t flags = BlockImageReadU32(bytes, 8);
+    const std::uint32_t height = BlockImageReadU32(bytes, 12);
+    const std::uint32_t width = BlockImageReadU32(bytes, 16);
+    const std::uint32_t mipMapCount = BlockImageReadU32(bytes, 28);
+    const std::uint32_t pixelFormatFlags = BlockImageReadU32(bytes, 80);
+    const std::uint32_t fourCC = BlockImageReadU32(bytes, 84);
+    const std::uint32_t caps2 = BlockImageReadU32(bytes, 112);
+
+    std::uint8_t format = kPixelFormatNull;
+    std::size_t dataOffset = kDDSHeaderSize;
+
+    if ((caps2 & (kDDSCaps2Cubemap | kDDSCaps2Volume)) == 0 && (pixelFormatFlags & kDDSPixelFormatFourCC))
+    {
+        if (fourCC == kDDSFourCCDXT1) format = kPixelFormatBC1;
+        else if (fourCC == kDDSFourCCDXT5) format = kPixelFormatBC3;
+
+        else if (fourCC == kDDSFourCCDX10 && bytes.size() >= kDDSHeaderSize + kDDSHeaderDX10Size)
+        {
+            const std::uint32_t arraySize = BlockImageReadU32(bytes, kDDSHeaderSize + 12);
+            if (arraySize <= 1) format = DDSPixelFormatFromDXGI(BlockImageReadU32(bytes, kDDSHeaderSize));
+            dataOffset += kDDSHeaderDX10Size;
+        }
+    }
+
+    if (format == kPixelFormatNull || !width || !height)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "DDS file %s is not a supported block-compressed 2D texture.", realPath.data()));
+        return nullptr;
+    }
+
+    // The header's mipMapCount is not trusted: a chain never has more levels than the base level allows.
+    std::size_t levelsCount = (flags & kDDSFlagMipMapCount) ? std::max < std::uint32_t >(1, mipMapCount) : 1;
+    levelsCount = std::min(levelsCount, BlockImageMaxLevels(width, height));
+
+    std::vector < PixelSetLevel > levels;
+    levels.reserve(levelsCount);
+
+    for (std::size_t i = 0; i < levelsCount; ++i)
+    {
+        PixelSetLevel level;
+        level.width = std::max < std::size_t >(1, width >> i);
+        level.height = std::max < std::size_t >(1, height >> i);
+        level.offset = dataOffset;
+        level.size = PixelFormatGetLevelSize(format, level.width, level.height);
+        dataOffset += level.size;
+        levels.push_back(level);
+    }
+
+    return BlockImageMake(format, bytes, levels);
+}
+
+bool DDSLoader::isLoadable(std::string const& ext) const
+{
+    return ext == "dds" || ext == "DDS";
+}
+
+FileLoaderInfos DDSLoader::getInfos() const
+{
+    return
+    {
+        .name = "DDSLoader",
+        .description = "Loads block-compressed DDS images with their mipmaps.",
+        .authors = "Luk2010",
+        .version = Version::FromString("1.0"),
+        .extensions = { "dds" },
+        .magics = { { 0, "DDS " } }
+    };
+}
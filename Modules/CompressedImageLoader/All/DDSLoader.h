@@ -0,0 +1,32 @@
+/**
+ *  \file CompressedImageLoader/DDSLoader.h
+ *  \date 10/18/2026
+**/
+
+#ifndef COMPRESSEDIMAGELOADER_DDSLOADER_H
+#define COMPRESSEDIMAGELOADER_DDSLOADER_H
+
+#include <Clean/Image.h>
+
+/** @brief Loads DDS files holding BC1, BC3 or BC7 images with their mipmaps.
+ *
+ * Only 2D textures are supported (no cubemaps, arrays or volumes). Pre-built mipmaps are kept
+ * in the PixelSet levels and uploaded as-is by the Driver. Unlike STBILoader, compressed images
+ * are not flipped vertically: blocks cannot be flipped for every format, so files must be 
+ * authored with the orientation expected by the shaders.
+ *
+**/
+class DDSLoader : public Clean::FileLoader < Clean::Image >
+{
+public:
+    /*! @brief Loads one image from a file. */
+    std::shared_ptr < Clean::Image > load(std::string const& filepath) const;
+    
+    /*! @brief Must return true if the given extension is loadable by this loader. */
+    bool isLoadable(std::string const& extension) const;
+    
+    /*! @brief Returns informations about this loader. */
+    Clean::FileLoaderInfos getInfos() const;
+};
+
+#endif // COMPRESSEDIMAGELOADER_DDSLOADER_H
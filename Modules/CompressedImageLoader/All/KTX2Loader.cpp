@@ -0,0 +1,125 @@
+/**
+ *  \file CompressedImageLoader/KTX2Loader.cpp
+ *  \date 10/18/2026
+**/
+
+#include "KTX2Loader.h"
+#include "BlockImage.h"
+
+#include <Clean/NotificationCenter.h>
+#include <Clean/Platform.h>
+
+#include <cstring>
+#include <iterator>
+using namespace Clean;
+
+static constexpr const unsigned char kKTX2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+static constexpr const std::size_t kKTX2HeaderSize = 80;
+static constexpr const std::size_t kKTX2LevelIndexSize = 24;
+
+/*! @brief Converts a VkFormat value to the corresponding PixelFormat. */
+std::uint8_t KTX2PixelFormatFromVk(std::uint32_t vkFormat)
+{
+    switch (vkFormat)
+    {
+        case 131: // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+        case 132: // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+        case 133: // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+        case 134: // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+        return kPixelFormatBC1;
+
+        case 137: // VK_FORMAT_BC3_UNORM_BLOCK
+        case 138: // VK_FORMAT_BC3_SRGB_BLOCK
+        return kPixelFormatBC3;
+
+        case 145: // VK_FORMAT_BC7_UNORM_BLOCK
+        case 146: // VK_FORMAT_BC7_SRGB_BLOCK
+        return kPixelFormatBC7;
+
+        case 147: // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+        case 148: // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+        return kPixelFormatETC2RGB8;
+
+        case 151: // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+        case 152: // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+        return kPixelFormatETC2RGBA8;
+
+        default:
+        return kPixelFormatNull;
+    }
+}
+
+std::shared_ptr < Image > KTX2Loader::load(std::string const& filepath) const
+{
+    std::string bytes, realPath;
+    if (!BlockImageReadFile(filepath, bytes, realPath))
+        return nullptr;
+
+    if (bytes.size() < kKTX2HeaderSize || memcmp(bytes.data(), kKTX2Identifier, sizeof(kKTX2Identifier)) != 0)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "File %s is not a KTX2 file.", realPath.data()));
+        return nullptr;
+    }
+
+    const std::uint8_t format = KTX2PixelFormatFromVk(BlockImageReadU32(bytes, 12));
+    const std::uint32_t width = BlockImageReadU32(bytes, 20);
+    const std::uint32_t height = BlockImageReadU32(bytes, 24);
+    const std::uint32_t depth = BlockImageReadU32(bytes, 28);
+    const std::uint32_t layerCount = BlockImageReadU32(bytes, 32);
+    const std::uint32_t faceCount = BlockImageReadU32(bytes, 36);
+    const std::uint32_t levelCount = BlockImageReadU32(bytes, 40);
+    const std::uint32_t supercompression = BlockImageReadU32(bytes, 44);
+
+    if (format == kPixelFormatNull || !width || !height || depth > 0 || layerCount > 1 || faceCount != 1 || supercompression != 0)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "KTX2 file %s is not a supported block-compressed 2D texture.", realPath.data()));
+        return nullptr;
+    }
+
+    // NOTES: A levelCount of zero asks the loader to generate the mipmaps. Block-compressed levels can't be
+    // filtered, neither here nor by the Driver (see GlTexture::uploadCompressed()): the image is loaded with
+    // its base level only, and is not mipmapped.
+
+    const std::size_t levelsCount = std::min < std::size_t >(std::max < std::uint32_t >(1, levelCount), BlockImageMaxLevels(width, height));
+
+    if (bytes.size() < kKTX2HeaderSize + levelsCount * kKTX2LevelIndexSize)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "KTX2 file %s has a truncated level index.", realPath.data()));
+        return nullptr;
+    }
+
+    std::vector < PixelSetLevel > levels;
+    levels.reserve(levelsCount);
+
+    for (std::size_t i = 0; i < levelsCount; ++i)
+    {
+        const std::size_t entry = kKTX2HeaderSize + i * kKTX2LevelIndexSize;
+
+        PixelSetLevel level;
+        level.width = std::max < std::size_t >(1, width >> i);
+        level.height = std::max < std::size_t >(1, height >> i);
+        level.offset = static_cast < std::size_t >(BlockImageReadU64(bytes, entry));
+        level.size = static_cast < std::size_t >(BlockImageReadU64(bytes, entry + 8));
+        levels.push_back(level);
+    }
+
+    return BlockImageMake(format, bytes, levels);
+}
+
+bool KTX2Loader::isLoadable(std::string const& ext) const
+{
+    return ext == "ktx2" || ext == "KTX2";
+}
+
+FileLoaderInfos KTX2Loader::getInfos() const
+{
+    return
+    {
+        .name = "KTX2Loader",
+        .description = "Loads block-compressed KTX2 images with their mipmaps.",
+        .authors = "Luk2010",
+        .version = Version::FromString("1.0"),
+        .extensions = { "ktx2" },
+        .magics = { { 0, std::string(std::begin(kKTX2Identifier), std::end(kKTX2Identifier)) } }
+    };
+}
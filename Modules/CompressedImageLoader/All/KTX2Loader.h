@@ -0,0 +1,31 @@
+/**
+ *  \file CompressedImageLoader/KTX2Loader.h
+ *  \date 10/18/2026
+**/
+
+#ifndef COMPRESSEDIMAGELOADER_KTX2LOADER_H
+#define COMPRESSEDIMAGELOADER_KTX2LOADER_H
+
+#include <Clean/Image.h>
+
+/** @brief Loads KTX2 files holding BC1, BC3, BC7 or ETC2 images with their mipmaps.
+ *
+ * Supercompressed files (BasisLZ, Zstandard) are not supported, and neither are layers, faces
+ * or depth. sRGB variants of the formats are loaded as their linear counterpart. See DDSLoader
+ * for notes about the orientation.
+ *
+**/
+class KTX2Loader : public Clean::FileLoader < Clean::Image >
+{
+public:
+    /*! @brief Loads one image from a file. */
+    std::shared_ptr < Clean::Image > load(std::string const& filepath) const;
+    
+    /*! @brief Must return true if the given extension is loadable by this loader. */
+    bool isLoadable(std::string const& extension) const;
+    
+    /*! @brief Returns informations about this loader. */
+    Clean::FileLoaderInfos getInfos() const;
+};
+
+#endif // COMPRESSEDIMAGELOADER_KTX2LOADER_H
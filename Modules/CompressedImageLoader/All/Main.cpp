@@ -0,0 +1,44 @@
+/**
+ *  \file CompressedImageLoader/Main.cpp
+ *  \date 10/18/2026
+**/
+
+#include "DDSLoader.h"
+#include "KTX2Loader.h"
+
+#include <Clean/Module.h>
+#include <Clean/Core.h>
+#include <Clean/Allocate.h>
+
+void CompressedImageLoaderStartModule(void)
+{
+    Clean::Core& core = Clean::Core::Get();
+    core.addFileLoader < Clean::Image, DDSLoader >(Clean::AllocateShared < DDSLoader >());
+    core.addFileLoader < Clean::Image, KTX2Loader >(Clean::AllocateShared < KTX2Loader >());
+}
+
+void CompressedImageLoaderStopModule(void)
+{
+    Clean::Core& core = Clean::Core::Get();
+
+    auto ddsLoader = core.findFileLoaderByName < Clean::Image >("DDSLoader");
+    if (ddsLoader) core.removeFileLoader < Clean::Image >(ddsLoader);
+
+    auto ktx2Loader = core.findFileLoaderByName < Clean::Image >("KTX2Loader");
+    if (ktx2Loader) core.removeFileLoader < Clean::Image >(ktx2Loader);
+}
+
+Clean::ModuleInfos CompressedImageLoaderModuleInfos = {
+    .name = "CompressedImageLoader",
+    .description = "FileLoader for block-compressed DDS and KTX2 images.",
+    .author = "Luk2010",
+    .version = Clean::Version::FromString("1.0"),
+
+    .startCallback = &CompressedImageLoaderStartModule,
+    .stopCallback = &CompressedImageLoaderStopModule
+};
+
+extern "C" Clean::ModuleInfos* GetFirstModuleInfos(void)
+{
+    return &CompressedImageLoaderModuleInfos;
+}
@@ -6,6 +6,7 @@
 #include "GlDriver.h"
 
 #include <Clean/NotificationCenter.h>
+#include <Clean/Profiler.h>
 using namespace Clean;
 
 GLenum GlBufferUsage(std::uint8_t usage) 
@@ -27,6 +28,7 @@ GlBuffer::GlBuffer(GlDriver* driver, std::uint8_t glType, GLsizeiptr glSize, GLv
     
     if (type == kBufferTypeVertex) target = GL_ARRAY_BUFFER;
     else if (type == kBufferTypeIndex) target = GL_ELEMENT_ARRAY_BUFFER;
+    else if (type == kBufferTypeUniform) target = GL_UNIFORM_BUFFER;
     else target = GL_INVALID_ENUM;
     
     if (glSize) {
@@ -34,6 +36,8 @@ GlBuffer::GlBuffer(GlDriver* driver, std::uint8_t glType, GLsizeiptr glSize, GLv
         
         if (ptr) {
             gl.bufferData(target, size, ptr, usage);
+            ProfileCount("uploads", 1);
+            ProfileCount("uploadedBytes", static_cast < std::int64_t >(size));
         }
         else {
             gl.bufferData(target, size, NULL, usage);
@@ -90,6 +94,10 @@ std::uint8_t GlBuffer::getDataType() const
 
 void GlBuffer::update(const void* data, std::size_t sz, std::uint8_t usg, bool /* acquire */)
 {
+    ProfileScope("GlBuffer::update");
+    ProfileCount("uploads", 1);
+    ProfileCount("uploadedBytes", static_cast < std::int64_t >(sz));
+    
     if (!handle) {
         gl.genBuffers(1, &handle);
         released = false;
@@ -135,6 +143,7 @@ bool GlBuffer::isBindable() const
 
 void GlBuffer::bind(Driver&) const 
 {
+    ProfileCount("binds", 1);
     gl.bindBuffer(target, handle);
 }
 
@@ -148,6 +157,11 @@ std::uint8_t GlBuffer::getType() const
     return type;
 }
 
+GLuint GlBuffer::getGLHandle() const 
+{
+    return handle;
+}
+
 void GlBuffer::releaseResource()
 {
     gl.deleteBuffers(1, &handle);
@@ -31,7 +31,7 @@ class GlBuffer : public Clean::Buffer
     GLsizeiptr size;
     
     //! @brief Target used for default binding. kBufferTypeVertex uses GL_ARRAY_BUFFER, kBufferTypeIndex uses 
-    //! GL_ElEMENT_ARRAY_BUFFER. Other buffer type may use other targets, and buffer copy may also uses GL_COPY_READ_BUFFER
+    //! GL_ElEMENT_ARRAY_BUFFER, kBufferTypeUniform uses GL_UNIFORM_BUFFER. Other buffer type may use other targets, and buffer copy may also uses GL_COPY_READ_BUFFER
     //! and GL_COPY_WRITE_BUFFER.
     GLenum target;
     
@@ -42,7 +42,7 @@ public:
      * A valid OpenGL Context must be locked and current while creating the buffer. See Driver::makeBuffer
      * for more explanations. 
      *
-     * \param[in] glType Type for this buffer. Can be kBufferTypeVertex, kBufferTypeIndex.
+     * \param[in] glType Type for this buffer. Can be kBufferTypeVertex, kBufferTypeIndex, kBufferTypeUniform.
      * \param[in] glSize Size for this buffer. 
      * \param[in] ptr Pointer to the beginning of the data we want to copy. 
      * \param[in] glUsage usage for this buffer. 
@@ -109,6 +109,9 @@ public:
     /*! @brief Returns the base type for this buffer. */
     std::uint8_t getType() const;
     
+    /*! @brief Returns the OpenGL buffer object. */
+    GLuint getGLHandle() const;
+    
 protected:
     
     /*! @brief Releases the buffer's handle. */
@@ -3,10 +3,12 @@
 
 #include "GlBufferManager.h"
 
+GlBufferManager::GlBufferManager()
+{
+    handleIndex = addIndex([](GlBuffer const& buffer){ return buffer.getHandle(); });
+}
+
 std::shared_ptr < GlBuffer > GlBufferManager::findByHandle(std::size_t handle)
 {
-    std::scoped_lock < std::mutex > lck(managedListMutex);
-    auto it = std::find_if(managedList.begin(), managedList.end(), [handle](auto buffer) { return buffer->getHandle() == handle; });
-    if (it != managedList.end()) return *it;
-    return nullptr;
+    return findIndexed(handleIndex, handle, [handle](GlBuffer const& buffer){ return buffer.getHandle() == handle; });
 }
\ No newline at end of file
@@ -10,8 +10,14 @@
 /** @brief Manages a set of GlBuffer for GlDriver. */
 class GlBufferManager : public Clean::Manager < GlBuffer >
 {
+    //! @brief Index of buffers by handle.
+    std::size_t handleIndex;
+    
 public:
     
+    /*! @brief Constructs the manager and its index by handle. */
+    GlBufferManager();
+    
     /*! @brief Finds a buffer by its handle. */
     std::shared_ptr < GlBuffer > findByHandle(std::size_t handle);
 };
@@ -20,8 +20,11 @@
 #endif
 
 #include <Clean/NotificationCenter.h>
+#include <Clean/Profiler.h>
 #include <Clean/Allocate.h>
 #include <Clean/VertexDescriptor.h>
+
+#include <algorithm>
 using namespace Clean;
 
 bool GlDriver::initialize() 
@@ -44,6 +47,8 @@ bool GlDriver::initialize()
     defaultWindow = nullptr;
     
     OSXGlFillGlTable(glTable);
+    loadProgramCacheInfos();
+    loadParallelCompileInfos();
     loadDefaultShaders();
     loadDefaultGlStates();
 
@@ -98,6 +103,8 @@ bool GlDriver::initialize()
     // Now we can load our shaders. 
 
     defaultContext->makeCurrent();
+    loadProgramCacheInfos();
+    loadParallelCompileInfos();
     loadDefaultShaders();
 
     state.store(kDriverStateInited);
@@ -108,14 +115,29 @@ bool GlDriver::initialize()
     
 void GlDriver::destroy()
 {
+    framePipeline.cancel();
+    textureStreamer.clear();
+    stopCompilerThread();
+    
     {
         defaultContext->lock();
+        
+        {
+            std::scoped_lock < std::mutex > lck(pendingLinksMutex);
+            
+            for (auto& job : pendingLinks)
+                job.compilation->done(job.pipeline->finishLink());
+            
+            pendingLinks.clear();
+        }
+        
         std::scoped_lock < std::mutex > ctxtLock(defaultShadersMapMutex);
         for (auto& pair : defaultShadersMap) {
             pair.second->release();
         }
         
         defaultShadersMap.clear();    
+        uniformRing.release();
         defaultContext->unlock();
     }
     
@@ -143,6 +165,9 @@ PixelFormat GlDriver::selectPixelFormat(PixelFormat const& pixFormat, PixelForma
     
 void GlDriver::drawShaderAttributes(ShaderAttributesMap const& attributes)
 {
+    ProfileScope("GlDriver::drawShaderAttributes");
+    ProfileCount("draws", 1);
+    
     IndexedInfos indexInfos = attributes.getIndexedInfos();
     
     if (indexInfos.elements && indexInfos.buffer) {
@@ -232,6 +257,9 @@ public:
             case kEffectMaterialEmissiveVec4Hash:
             return ShaderParameter(kShaderParamVec4, "material.emissive", -1, param.value);
             
+            case kEffectMaterialDiffuseUVVec4Hash:
+            return ShaderParameter(kShaderParamVec4, "material.diffuseUV", -1, param.value);
+            
             default:
             return ShaderMapper::map(param, pipeline);
         }
@@ -254,6 +282,8 @@ std::string const GlDriver::getName() const
 
 std::shared_ptr < Buffer > GlDriver::makeBuffer(std::uint8_t type, std::shared_ptr < Buffer > const& buffer)
 {
+    ProfileScope("GlDriver::makeBuffer");
+    
     std::scoped_lock < GlContext const > ctxtLock(*defaultContext);
     
     GLvoid* data = buffer->lock(kBufferIOReadOnly);
@@ -265,15 +295,13 @@ std::shared_ptr < Buffer > GlDriver::makeBuffer(std::uint8_t type, std::shared_p
     buffer->unlock(kBufferIOReadOnly);
     
     if (!bufHandle) {
-        Notification notif = BuildNotification(kNotificationLevelError, "Can't create GlBuffer from buffer #%i: "
+        PostNotification(kNotificationLevelError, "Can't create GlBuffer from buffer #%i: "
             "\tsize = %i\n\tusage = %i\n\ttype = %i", buffer->getHandle(), size, usage, buffer->getType());
-        NotificationCenter::GetDefault()->send(notif);
     }
     
     else {
-        Notification notif = BuildNotification(kNotificationLevelInfo, "Created new GlBuffer from buffer #%i: "
+        PostNotification(kNotificationLevelInfo, "Created new GlBuffer from buffer #%i: "
             "\tsize = %i\n\tusage = %i\n\ttype = %i", buffer->getHandle(), size, usage, buffer->getType());
-        NotificationCenter::GetDefault()->send(notif);
         bufferManager.add(bufHandle);
     }
     
@@ -400,6 +428,215 @@ std::shared_ptr < Texture > GlDriver::makeTexture(std::shared_ptr < Image > cons
     return std::static_pointer_cast < Texture >(texture);
 }
 
+bool GlDriver::bindParameterBlock(ParameterBlock& block)
+{
+    return uniformRing.bind(this, block);
+}
+
+std::string const& GlDriver::getProgramCacheIdentity() const
+{
+    return programCacheIdentity;
+}
+
+bool GlDriver::isProgramBinarySupported() const
+{
+    return programBinarySupported;
+}
+
+bool GlDriver::isParallelCompileSupported() const
+{
+    return parallelCompileSupported;
+}
+
+std::shared_ptr < PipelineCompilation > GlDriver::compilePipelines(std::vector < std::shared_ptr < RenderPipeline > > const& pipelines)
+{
+    if (!parallelCompileSupported && !startCompilerThread()) {
+        std::scoped_lock < GlContext const > ctxtLock(*defaultContext);
+        return Driver::compilePipelines(pipelines);
+    }
+    
+    auto compilation = AllocateShared < PipelineCompilation >(pipelines.size());
+    assert(compilation && "Null allocation.");
+    
+    if (!parallelCompileSupported) {
+        for (auto const& pipeline : pipelines) {
+            if (!pipeline) { compilation->done(false); continue; }
+            compilerJobs.push({ ReinterpretShared < GlRenderPipeline >(pipeline), compilation });
+        }
+        
+        return compilation;
+    }
+    
+    // All programs are linked now: the GL driver compiles them on its own threads, and update() 
+    // checks their completion status without blocking. 
+    
+    std::scoped_lock < GlContext const > ctxtLock(*defaultContext);
+    std::scoped_lock < std::mutex > lck(pendingLinksMutex);
+    
+    for (auto const& pipeline : pipelines) {
+        if (!pipeline) { compilation->done(false); continue; }
+        auto glPipeline = ReinterpretShared < GlRenderPipeline >(pipeline);
+        
+        if (glPipeline->beginLink()) compilation->done(true);
+        else pendingLinks.push_back({ glPipeline, compilation });
+    }
+    
+    return compilation;
+}
+
+void GlDriver::update()
+{
+    ProfileScope("GlDriver::update");
+    
+    {
+        std::scoped_lock < std::mutex > lck(pendingLinksMutex);
+        
+        if (!pendingLinks.empty()) {
+            std::scoped_lock < GlContext const > ctxtLock(*defaultContext);
+            
+            auto it = std::remove_if(pendingLinks.begin(), pendingLinks.end(), [](PipelineCompileJob& job){
+                if (!job.pipeline->isLinkComplete()) return false;
+                job.compilation->done(job.pipeline->finishLink());
+                return true;
+            });
+            
+            pendingLinks.erase(it, pendingLinks.end());
+        }
+    }
+    
+    {
+        std::scoped_lock < std::mutex > lck(occlusionQueriesMutex);
+        
+        if (!occlusionQueries.empty()) {
+            std::scoped_lock < GlContext const > ctxtLock(*defaultContext);
+            
+            auto it = std::remove_if(occlusionQueries.begin(), occlusionQueries.end(), [](std::weak_ptr < GlOcclusionQuery > const& weak){
+                auto query = weak.lock();
+                if (!query) return true;
+                query->fetch();
+                return false;
+            });
+            
+            occlusionQueries.erase(it, occlusionQueries.end());
+        }
+    }
+    
+    Driver::update();
+}
+
+std::shared_ptr < OcclusionQuery > GlDriver::makeOcclusionQuery()
+{
+    std::shared_ptr < GlOcclusionQuery > query;
+    
+    {
+        std::scoped_lock < GlContext const > ctxtLock(*defaultContext);
+        query = AllocateShared < GlOcclusionQuery >(glTable);
+    }
+    
+    std::scoped_lock < std::mutex > lck(occlusionQueriesMutex);
+    occlusionQueries.push_back(query);
+    return query;
+}
+
+std::shared_ptr < FrameFence > GlDriver::makeFrameFence()
+{
+    return AllocateShared < GlFrameFence >(glTable, *defaultContext);
+}
+
+std::shared_ptr < RenderTexture > GlDriver::makeRenderTexture(RenderTextureDescriptor const& descriptor)
+{
+    std::scoped_lock < GlContext const > ctxtLock(*defaultContext);
+    
+    auto target = AllocateShared < GlRenderTexture >(this, descriptor, glTable);
+    if (!target || !target->isValid()) return nullptr;
+    
+    return std::static_pointer_cast < RenderTexture >(target);
+}
+
+std::shared_ptr < GlContext > GlDriver::makeSharedContext()
+{
+    std::scoped_lock < std::mutex > lck(defaultsMutex);
+    
+#   ifdef CLEAN_WINDOW_COCOA
+    auto currentContext = ReinterpretShared < OSXGlContext >(defaultContext);
+    auto sharedContext = AllocateShared < OSXGlContext >(currentContext->getPixelFormat(), *currentContext);
+    
+    if (!sharedContext || !sharedContext->isValid()) 
+        return nullptr;
+    
+    return sharedContext;
+
+#   elif defined(CLEAN_WINDOW_WIN32)
+    // The compiler thread draws nothing: its context uses the hidden window. 
+    
+    HGLRC sharedContextHandle = WinGlMakeContext(hiddenWindow, defaultContext->getPixelFormat(), hiddenContext, wglTable);
+    if (!sharedContextHandle) return nullptr;
+    
+    auto sharedContext = AllocateShared < WinGlContext >(hiddenWindow, sharedContextHandle, wglTable, defaultContext->getPixelFormat());
+    
+    if (!sharedContext || !sharedContext->isValid()) 
+        return nullptr;
+    
+    return sharedContext;
+
+#   else
+    return nullptr;
+
+#   endif
+}
+
+bool GlDriver::startCompilerThread()
+{
+    std::scoped_lock < std::mutex > lck(compilerMutex);
+    if (compilerThread.joinable()) return true;
+    
+    if (!compilerContext) {
+        compilerContext = makeSharedContext();
+        
+        if (!compilerContext) {
+            Notification notif = BuildNotification(kNotificationLevelWarning, 
+                "Driver %s can't create a shared context: pipelines will be compiled on the calling thread.", 
+                getName().data());
+            NotificationCenter::GetDefault()->send(notif);
+            return false;
+        }
+    }
+    
+    compilerThread = std::thread([this, context = compilerContext](){
+        PipelineCompileJob job;
+        
+        while (true) 
+        {
+            compilerJobs.pop(job);
+            if (!job.pipeline) break;
+            
+            context->lock();
+            bool result = job.pipeline->compile();
+            
+            // Other contexts see the program only once the commands of this context are done. 
+            glTable.finish();
+            context->unlock();
+            
+            job.compilation->done(result);
+            job = PipelineCompileJob();
+        }
+    });
+    
+    return true;
+}
+
+void GlDriver::stopCompilerThread()
+{
+    std::scoped_lock < std::mutex > lck(compilerMutex);
+    
+    if (compilerThread.joinable()) {
+        compilerJobs.push(PipelineCompileJob());
+        compilerThread.join();
+    }
+    
+    compilerContext.reset();
+}
+
 std::shared_ptr < RenderWindow > GlDriver::_createRenderWindow(std::size_t width, std::size_t height, 
     std::string const& title, std::uint16_t style, bool fullscreen) const 
 {
@@ -481,3 +718,44 @@ void GlDriver::loadDefaultGlStates()
 {
     glTable.enable(GL_DEPTH_TEST);
 }
+
+void GlDriver::loadProgramCacheInfos()
+{
+    std::scoped_lock < GlContext const > lck(*defaultContext);
+    
+    GLint formats = 0;
+    glTable.getIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    programBinarySupported = (formats > 0) && glTable.getProgramBinary && glTable.programBinary;
+    
+    programCacheIdentity = getName();
+    
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        const GLubyte* value = glTable.getString(name);
+        programCacheIdentity += '|';
+        if (value) programCacheIdentity += reinterpret_cast < const char* >(value);
+    }
+}
+
+void GlDriver::loadParallelCompileInfos()
+{
+    std::scoped_lock < GlContext const > lck(*defaultContext);
+    parallelCompileSupported = false;
+    
+    if (!glTable.getStringi || !glTable.maxShaderCompilerThreadsKHR) 
+        return;
+    
+    GLint count = 0;
+    glTable.getIntegerv(GL_NUM_EXTENSIONS, &count);
+    
+    for (GLint i = 0; i < count && !parallelCompileSupported; ++i) {
+        const GLubyte* name = glTable.getStringi(GL_EXTENSIONS, static_cast < GLuint >(i));
+        if (!name) continue;
+        
+        std::string extension(reinterpret_cast < const char* >(name));
+        parallelCompileSupported = extension == "GL_KHR_parallel_shader_compile" || extension == "GL_ARB_parallel_shader_compile";
+    }
+    
+    // 0xFFFFFFFF lets the implementation choose its number of threads. 
+    if (parallelCompileSupported)
+        glTable.maxShaderCompilerThreadsKHR(0xFFFFFFFF);
+}
@@ -5,11 +5,20 @@
 #define GLDRIVER_GLDRIVER_H
 
 #include <Clean/Driver.h>
+#include <Clean/ConcurrentQueue.h>
 
 #include "GlContext.h"
 #include "GlRenderWindow.h"
 #include "GlBufferManager.h"
 #include "GlShaderManager.h"
+#include "GlUniformRing.h"
+#include "GlOcclusionQuery.h"
+#include "GlFrameFence.h"
+#include "GlRenderTexture.h"
+
+#include <thread>
+
+class GlRenderPipeline;
 
 class GlDriver : public Clean::Driver 
 {
@@ -69,6 +78,56 @@ public:
     //! has been called before.
     GlPtrTable glTable;
     
+private:
+    
+    //! @brief Uniform buffer where ParameterBlocks are uploaded. 
+    GlUniformRing uniformRing { glTable };
+    
+    //! @brief Driver's name, GL vendor, renderer and version. Programs binaries are valid only for the
+    //! same identity. Set by initialize(). 
+    std::string programCacheIdentity;
+    
+    //! @brief True if the context gives at least one program binary format. 
+    bool programBinarySupported = false;
+    
+    //! @brief True if GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile is available. 
+    bool parallelCompileSupported = false;
+    
+    /** @brief A pipeline being compiled by compilePipelines(). */
+    struct PipelineCompileJob 
+    {
+        //! @brief Pipeline to compile. Null to stop the compiler thread. 
+        std::shared_ptr < GlRenderPipeline > pipeline;
+        
+        //! @brief Compilation notified when the pipeline is done. 
+        std::shared_ptr < Clean::PipelineCompilation > compilation;
+    };
+    
+    //! @brief Pipelines linked in parallel by the GL driver, polled by update(). 
+    std::vector < PipelineCompileJob > pendingLinks;
+    
+    //! @brief Protects pendingLinks. 
+    std::mutex pendingLinksMutex;
+    
+    //! @brief Context shared with defaultContext, current on compilerThread. 
+    std::shared_ptr < GlContext > compilerContext;
+    
+    //! @brief Thread compiling pipelines when parallel compile is not available. Started by the first
+    //! call to compilePipelines(). 
+    std::thread compilerThread;
+    
+    //! @brief Pipelines to compile by compilerThread. 
+    Clean::ConcurrentQueue < PipelineCompileJob > compilerJobs;
+    
+    //! @brief Protects compilerContext and compilerThread. 
+    std::mutex compilerMutex;
+    
+    //! @brief Queries made by makeOcclusionQuery(), whose results are read by update(). 
+    std::vector < std::weak_ptr < GlOcclusionQuery > > occlusionQueries;
+    
+    //! @brief Protects occlusionQueries. 
+    std::mutex occlusionQueriesMutex;
+    
 public:
     
     /*! @brief Initializes an OpenGL Driver. 
@@ -120,6 +179,40 @@ public:
     /*! @brief Makes a texture from an Image. */
     std::shared_ptr < Clean::Texture > makeTexture(std::shared_ptr < Clean::Image > const& image);
     
+    /*! @brief Uploads a ParameterBlock to the uniform ring if it changed, and binds it to its binding index. */
+    bool bindParameterBlock(Clean::ParameterBlock& block);
+    
+    /*! @brief Returns the string identifying programs binaries of this driver in a PipelineCache. */
+    std::string const& getProgramCacheIdentity() const;
+    
+    /*! @brief Returns true if programs can be stored in a PipelineCache. */
+    bool isProgramBinarySupported() const;
+    
+    /*! @brief Returns true if KHR_parallel_shader_compile is available. */
+    bool isParallelCompileSupported() const;
+    
+    /*! @brief Compiles the pipelines without blocking. 
+     *
+     * With KHR_parallel_shader_compile, all programs are linked at once by the GL driver's threads, and
+     * update() checks which ones are complete. Otherwise, pipelines are compiled one after the other by a
+     * thread with its own context, shared with the default context. 
+     *
+    **/
+    std::shared_ptr < Clean::PipelineCompilation > compilePipelines(std::vector < std::shared_ptr < Clean::RenderPipeline > > const& pipelines);
+    
+    /*! @brief Makes a GlOcclusionQuery. */
+    std::shared_ptr < Clean::OcclusionQuery > makeOcclusionQuery();
+    
+    /*! @brief Makes a GlFrameFence in the default context. */
+    std::shared_ptr < Clean::FrameFence > makeFrameFence();
+    
+    /*! @brief Makes a GlRenderTexture in the default context, or returns null if its framebuffer is incomplete. */
+    std::shared_ptr < Clean::RenderTexture > makeRenderTexture(Clean::RenderTextureDescriptor const& descriptor);
+    
+    /*! @brief Checks the pipelines linked in parallel, reads the results of occlusion queries, and updates
+     *  the driver. */
+    void update();
+    
 protected:
     
     /*! @brief Loads default shaders for this driver. */
@@ -134,6 +227,21 @@ protected:
     
     /*! @brief Loads default GL states like depth-test. */
     void loadDefaultGlStates();
+    
+    /*! @brief Finds programCacheIdentity and programBinarySupported. */
+    void loadProgramCacheInfos();
+    
+    /*! @brief Finds parallelCompileSupported, and lets the GL driver use all its compiler threads. */
+    void loadParallelCompileInfos();
+    
+    /*! @brief Creates a context shared with defaultContext, to be used on another thread. */
+    std::shared_ptr < GlContext > makeSharedContext();
+    
+    /*! @brief Starts compilerThread if not already started. Returns false if no context can be made for it. */
+    bool startCompilerThread();
+    
+    /*! @brief Stops compilerThread once all its pipelines are compiled. */
+    void stopCompilerThread();
 };
 
 #endif // GLDRIVER_GLDRIVER_H
@@ -0,0 +1,38 @@
+/** \file GlDriver/GlFrameFence.cpp
+**/
+
+#include "GlFrameFence.h"
+
+#include <mutex>
+
+GlFrameFence::GlFrameFence(GlPtrTable const& tbl, GlContext const& ctxt) : gl(tbl), context(ctxt)
+{
+    std::scoped_lock < GlContext const > ctxtLock(context);
+    sync = gl.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    
+    // Without a sync object, nothing tells when the frame is done: it is not waited for.
+    if (!sync) signaled.store(true, std::memory_order_release);
+}
+
+GlFrameFence::~GlFrameFence()
+{
+    if (!sync) return;
+    
+    std::scoped_lock < GlContext const > ctxtLock(context);
+    gl.deleteSync(sync);
+}
+
+void GlFrameFence::fetch()
+{
+    if (!sync) return;
+    
+    std::scoped_lock < GlContext const > ctxtLock(context);
+    
+    // GL_SYNC_FLUSH_COMMANDS_BIT makes sure the fence reaches the GPU, or it may never be signaled.
+    GLenum status = gl.clientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return;
+    
+    gl.deleteSync(sync);
+    sync = nullptr;
+    signaled.store(true, std::memory_order_release);
+}
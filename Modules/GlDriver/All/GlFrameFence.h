@@ -0,0 +1,40 @@
+/** \file GlDriver/GlFrameFence.h
+**/
+
+#ifndef GLDRIVER_GLFRAMEFENCE_H
+#define GLDRIVER_GLFRAMEFENCE_H
+
+#include "GlInclude.h"
+#include "GlContext.h"
+#include <Clean/FrameFence.h>
+
+/** @brief OpenGL implementation of Clean::FrameFence, with a sync object.
+ *
+ * The sync object is inserted when the fence is constructed, and polled by fetch() with a null timeout. 
+ * Both lock the context given, so the FramePipeline may poll the fence outside of any GL call.
+ *
+**/
+class GlFrameFence : public Clean::FrameFence
+{
+    //! @brief Gl Pointer Table.
+    GlPtrTable const& gl;
+    
+    //! @brief Context the sync object was inserted in.
+    GlContext const& context;
+    
+    //! @brief Sync object, null once signaled.
+    GLsync sync = nullptr;
+    
+public:
+    
+    /*! @brief Inserts the sync object after the commands submitted in context. */
+    GlFrameFence(GlPtrTable const& tbl, GlContext const& ctxt);
+    
+    /*! @brief Deletes the sync object. */
+    ~GlFrameFence();
+    
+    /*! @brief Checks the sync object without waiting, and deletes it when signaled. */
+    void fetch();
+};
+
+#endif // GLDRIVER_GLFRAMEFENCE_H
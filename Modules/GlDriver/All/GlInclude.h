@@ -17,6 +17,35 @@
 
 #endif
 
+// Block-compressed formats are not part of every core profile headers (S3TC is still an 
+// extension, and macOS gl3.h does not define it even if the hardware supports it).
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#   define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#   define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#   define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#   define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#   define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
+// KHR_parallel_shader_compile is too recent for some headers, and is not available on macOS.
+#ifndef GL_COMPLETION_STATUS_KHR
+#   define GL_COMPLETION_STATUS_KHR 0x91B1
+typedef void (*PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+#endif
+
+// GL_ANY_SAMPLES_PASSED is core since OpenGL 3.3, older headers may not define it.
+#ifndef GL_ANY_SAMPLES_PASSED
+#   define GL_ANY_SAMPLES_PASSED 0x8C2F
+#endif
+
 /** @brief Holds all function pointers to OpenGL functions. */
 struct GlPtrTable 
 {
@@ -85,6 +114,38 @@ struct GlPtrTable
     PFNGLDELETESHADERPROC deleteShader;
     PFNGLENABLEPROC enable;
     PFNGLDEPTHFUNCPROC depthFunc;
+    PFNGLCOMPRESSEDTEXIMAGE2DPROC compressedTexImage2D;
+    PFNGLBUFFERSUBDATAPROC bufferSubData;
+    PFNGLBINDBUFFERRANGEPROC bindBufferRange;
+    PFNGLMAPBUFFERRANGEPROC mapBufferRange;
+    PFNGLGETUNIFORMBLOCKINDEXPROC getUniformBlockIndex;
+    PFNGLUNIFORMBLOCKBINDINGPROC uniformBlockBinding;
+    PFNGLGETSTRINGPROC getString;
+    PFNGLGETPROGRAMBINARYPROC getProgramBinary;
+    PFNGLPROGRAMBINARYPROC programBinary;
+    PFNGLPROGRAMPARAMETERIPROC programParameteri;
+    PFNGLGETSTRINGIPROC getStringi;
+    PFNGLFINISHPROC finish;
+    PFNGLGENQUERIESPROC genQueries;
+    PFNGLDELETEQUERIESPROC deleteQueries;
+    PFNGLBEGINQUERYPROC beginQuery;
+    PFNGLENDQUERYPROC endQuery;
+    PFNGLGETQUERYOBJECTUIVPROC getQueryObjectuiv;
+    PFNGLFENCESYNCPROC fenceSync;
+    PFNGLCLIENTWAITSYNCPROC clientWaitSync;
+    PFNGLDELETESYNCPROC deleteSync;
+    PFNGLGENFRAMEBUFFERSPROC genFramebuffers;
+    PFNGLDELETEFRAMEBUFFERSPROC deleteFramebuffers;
+    PFNGLBINDFRAMEBUFFERPROC bindFramebuffer;
+    PFNGLFRAMEBUFFERTEXTURE2DPROC framebufferTexture2D;
+    PFNGLCHECKFRAMEBUFFERSTATUSPROC checkFramebufferStatus;
+    PFNGLDRAWBUFFERPROC drawBuffer;
+    PFNGLREADBUFFERPROC readBuffer;
+    PFNGLVIEWPORTPROC viewport;
+    PFNGLCLEARCOLORPROC clearColor;
+    PFNGLCLEARDEPTHPROC clearDepth;
+    PFNGLCLEARPROC clear;
+    PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreadsKHR;
 };
 
 // Helper to check for extension string presence.  Adapted from:
@@ -0,0 +1,49 @@
+/** \file GlDriver/GlOcclusionQuery.cpp
+**/
+
+#include "GlOcclusionQuery.h"
+
+GlOcclusionQuery::GlOcclusionQuery(GlPtrTable const& tbl) : gl(tbl)
+{
+    gl.genQueries(1, &handle);
+}
+
+GlOcclusionQuery::~GlOcclusionQuery()
+{
+    if (handle) gl.deleteQueries(1, &handle);
+}
+
+void GlOcclusionQuery::begin()
+{
+    if (pending.load(std::memory_order_relaxed)) 
+        return;
+    
+    gl.beginQuery(GL_ANY_SAMPLES_PASSED, handle);
+    active = true;
+}
+
+void GlOcclusionQuery::end()
+{
+    if (!active) 
+        return;
+    
+    gl.endQuery(GL_ANY_SAMPLES_PASSED);
+    active = false;
+    pending.store(true, std::memory_order_relaxed);
+}
+
+void GlOcclusionQuery::fetch()
+{
+    if (!pending.load(std::memory_order_relaxed))
+        return;
+    
+    GLuint available = GL_FALSE;
+    gl.getQueryObjectuiv(handle, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE) return;
+    
+    GLuint passed = GL_FALSE;
+    gl.getQueryObjectuiv(handle, GL_QUERY_RESULT, &passed);
+    
+    occluded.store(passed == GL_FALSE, std::memory_order_relaxed);
+    pending.store(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,47 @@
+/** \file GlDriver/GlOcclusionQuery.h
+**/
+
+#ifndef GLDRIVER_GLOCCLUSIONQUERY_H
+#define GLDRIVER_GLOCCLUSIONQUERY_H
+
+#include "GlInclude.h"
+#include <Clean/OcclusionQuery.h>
+
+/** @brief OpenGL implementation of Clean::OcclusionQuery, with GL_ANY_SAMPLES_PASSED.
+ *
+ * A query issued while the result of the previous one is still pending is ignored, so a query drawn every
+ * frame still gets results when the GPU is a few frames late.
+ *
+ * \note Must be used from the thread owning the driver's context.
+ *
+**/
+class GlOcclusionQuery : public Clean::OcclusionQuery
+{
+    //! @brief Gl Pointer Table.
+    GlPtrTable const& gl;
+    
+    //! @brief Query object.
+    GLuint handle = 0;
+    
+    //! @brief True between begin() and end() if begin() issued the query.
+    bool active = false;
+    
+public:
+    
+    /*! @brief Creates the query object. */
+    GlOcclusionQuery(GlPtrTable const& tbl);
+    
+    /*! @brief Deletes the query object. */
+    ~GlOcclusionQuery();
+    
+    /*! @brief Begins the query if no result is pending. */
+    void begin();
+    
+    /*! @brief Ends the query begun by begin(). */
+    void end();
+    
+    /*! @brief Reads the result if it is available. */
+    void fetch();
+};
+
+#endif // GLDRIVER_GLOCCLUSIONQUERY_H
@@ -4,12 +4,14 @@
 #include "GlRenderPipeline.h"
 #include "GlShader.h"
 #include "GlCheckError.h"
+#include "GlDriver.h"
 
 #include <algorithm>
 #include <glm/gtc/type_ptr.hpp>
 
 #include <Clean/NotificationCenter.h>
 #include <Clean/Traits.h>
+#include <Clean/Profiler.h>
 using namespace Clean;
 
 static GLenum GlGetShaderAttrib(std::uint8_t type)
@@ -76,21 +78,129 @@ void GlRenderPipeline::shader(std::uint8_t stage, std::shared_ptr < Shader > con
             "An error occured while glAttachShader: %s.",
             error.string.data());
         NotificationCenter::GetDefault()->send(notif);
+        return;
     }
+    
+    std::scoped_lock < std::mutex > lck(linkMutex);
+    attachedShaders.push_back(shader);
 }
 
 void GlRenderPipeline::link()
+{
+    std::scoped_lock < std::mutex > lck(linkMutex);
+    
+    if (!_beginLink()) 
+        _endLink();
+}
+
+bool GlRenderPipeline::compile()
+{
+    std::scoped_lock < std::mutex > lck(linkMutex);
+    
+    if (linking) 
+        return _endLink();
+    
+    if (isLinked()) 
+        return true;
+    
+    return _beginLink() || _endLink();
+}
+
+bool GlRenderPipeline::beginLink()
+{
+    std::scoped_lock < std::mutex > lck(linkMutex);
+    
+    if (linking) 
+        return false;
+    
+    if (isLinked()) 
+        return true;
+    
+    return _beginLink();
+}
+
+bool GlRenderPipeline::isLinkComplete() const
+{
+    std::scoped_lock < std::mutex > lck(linkMutex);
+    
+    if (!linking || !static_cast < GlDriver* >(driver)->isParallelCompileSupported()) 
+        return true;
+    
+    GLint result = GL_FALSE;
+    gl.getProgramiv(programHandle, GL_COMPLETION_STATUS_KHR, &result);
+    return result == GL_TRUE;
+}
+
+bool GlRenderPipeline::finishLink()
+{
+    std::scoped_lock < std::mutex > lck(linkMutex);
+    
+    if (!linking) 
+        return isLinked();
+    
+    return _endLink();
+}
+
+std::vector < std::shared_ptr < Shader > > GlRenderPipeline::getShaders() const
+{
+    std::scoped_lock < std::mutex > lck(linkMutex);
+    return std::vector < std::shared_ptr < Shader > >(attachedShaders.begin(), attachedShaders.end());
+}
+
+bool GlRenderPipeline::_beginLink()
 {
     textureUnits.lock().clear();
     textureUnits.unlock();
     unitCounter.reset(0);
+    invalidateUploadedParameters();
+    blockBindings.lock().clear();
+    blockBindings.unlock();
+    
+    // When the driver has a PipelineCache, the program binary is loaded from it. Shaders are compiled only
+    // if it is not found, and the linked program is then stored. 
+    
+    linkCache = driver ? driver->getPipelineCache() : nullptr;
+    linkCacheKey = 0;
+    GlDriver* glDriver = static_cast < GlDriver* >(driver);
+    
+    if (linkCache && !glDriver->isProgramBinarySupported())
+        linkCache.reset();
+    
+    if (linkCache) {
+        linkCacheKey = makeCacheKey(glDriver->getProgramCacheIdentity());
+        
+        if (loadBinary(*linkCache, linkCacheKey)) {
+            linkCache.reset();
+            return true;
+        }
+        
+        gl.programParameteri(programHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    
+    // Compile status is not queried here: with KHR_parallel_shader_compile, the shaders compile while 
+    // the program links. Errors of the shaders are reported by _endLink() if the link fails. 
+    
+    for (auto const& shader : attachedShaders)
+        shader->beginCompile();
     
     gl.linkProgram(programHandle);
+    linking = true;
+    return false;
+}
+
+bool GlRenderPipeline::_endLink()
+{
+    linking = false;
+    std::shared_ptr < PipelineCache > cache = std::move(linkCache);
+    linkCache.reset();
     
     GLint result;
     gl.getProgramiv(programHandle, GL_LINK_STATUS, &result);
     
     if (result != GL_TRUE) {
+        for (auto const& shader : attachedShaders)
+            shader->compile();
+        
         GLint maxLength;
         gl.getProgramiv(programHandle, GL_INFO_LOG_LENGTH, &maxLength);
         
@@ -104,15 +214,85 @@ void GlRenderPipeline::link()
         NotificationCenter::GetDefault()->send(notif);
 
         free(buffer);
+        return false;
     }
+    
+    if (cache) {
+        storeBinary(*cache, linkCacheKey);
+    }
+    
+    return true;
 }
 
-void GlRenderPipeline::bind(Driver const& driver) const 
+std::uint64_t GlRenderPipeline::makeCacheKey(std::string const& identity) const
+{
+    std::vector < std::shared_ptr < GlShader > > shaders(attachedShaders);
+    std::sort(shaders.begin(), shaders.end(), [](auto const& lhs, auto const& rhs){ return lhs->getType() < rhs->getType(); });
+    
+    std::vector < std::uint64_t > sources;
+    sources.reserve(shaders.size() * 2);
+    
+    for (auto const& shader : shaders) {
+        sources.push_back(shader->getType());
+        sources.push_back(shader->getSourceHash());
+    }
+    
+    return PipelineCacheMakeKey(sources, identity);
+}
+
+bool GlRenderPipeline::loadBinary(PipelineCache& cache, std::uint64_t key)
 {
-    if (!isLinked()) {
-        const_cast < GlRenderPipeline* >(this)->link();
+    PipelineCacheEntry entry;
+    if (!cache.load(key, entry) || entry.data.empty()) return false;
+    
+    gl.programBinary(programHandle, static_cast < GLenum >(entry.format), entry.data.data(), static_cast < GLsizei >(entry.data.size()));
+    
+    GLint result;
+    gl.getProgramiv(programHandle, GL_LINK_STATUS, &result);
+    GlCheckError(gl.getError);
+    
+    if (result == GL_TRUE)
+        return true;
+    
+    // The driver rejects binaries from another driver version: this one will be replaced once the 
+    // program is linked again from its sources. 
+    cache.remove(key);
+    return false;
+}
+
+void GlRenderPipeline::storeBinary(PipelineCache& cache, std::uint64_t key) const
+{
+    GLint length = 0;
+    gl.getProgramiv(programHandle, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    
+    PipelineCacheEntry entry;
+    entry.data.resize(static_cast < std::size_t >(length));
+    
+    GLsizei written = 0;
+    GLenum format = 0;
+    gl.getProgramBinary(programHandle, length, &written, &format, entry.data.data());
+    
+    GlError error = GlCheckError(gl.getError);
+    if (error.error != GL_NO_ERROR || written <= 0) {
+        Notification notif = BuildNotification(kNotificationLevelWarning,
+            "Can't get binary of program #%i: %s",
+            this->getHandle(), error.string.data());
+        NotificationCenter::GetDefault()->send(notif);
+        return;
     }
     
+    entry.data.resize(static_cast < std::size_t >(written));
+    entry.format = static_cast < std::uint32_t >(format);
+    cache.store(key, entry);
+}
+
+void GlRenderPipeline::bind(Driver const& driver) const 
+{
+    ProfileCount("binds", 1);
+    
+    // A pipeline given to Driver::compilePipelines() may still be linking: this waits for it. 
+    const_cast < GlRenderPipeline* >(this)->compile();
     gl.useProgram(programHandle);
 }
 
@@ -153,115 +333,202 @@ void GlRenderPipeline::bindParameter(ShaderParameter const& parameter) const
     if (location < 0) {
         location = gl.getUniformLocation(programHandle, parameter.name.data());
         if (location < 0) {
-            Notification notif = BuildNotification(kNotificationLevelInfo,
+            PostNotification(kNotificationLevelInfo,
                 "Can't bind ShaderParameter '%s' because it was not found in GlRenderPipeline #%i.",
                 parameter.name.data(), this->getHandle());
-            NotificationCenter::GetDefault()->send(notif);
             return;
         }
     }
     
-    switch(parameter.type)
+    bindParameterAt(location, parameter.type, parameter.value);
+    
+    GlError error = GlCheckError(gl.getError);
+    if (error.error != GL_NO_ERROR) {
+        PostNotification(kNotificationLevelError,
+            "An error occured while glUniform: %s.",
+            error.string.data());
+    }
+    
+    if (rebindCurrent) {
+        gl.useProgram(currentProgram);
+    }
+}
+
+void GlRenderPipeline::bindEffectParameters(std::vector < std::shared_ptr < EffectParameter > > const& parameters, std::uint64_t layout) const
+{
+    GLuint currentProgram = GlGetCurrentProgram(gl);
+    
+    if (currentProgram != programHandle) {
+        gl.useProgram(programHandle);
+    }
+    
+    RenderPipeline::bindEffectParameters(parameters, layout);
+    
+    GlError error = GlCheckError(gl.getError);
+    if (error.error != GL_NO_ERROR) {
+        PostNotification(kNotificationLevelError,
+            "An error occured while glUniform: %s.",
+            error.string.data());
+    }
+    
+    if (currentProgram != programHandle) {
+        gl.useProgram(currentProgram);
+    }
+}
+
+std::int32_t GlRenderPipeline::findParameterLocation(ShaderParameter const& parameter) const
+{
+    if (parameter.idx >= 0)
+        return parameter.idx;
+    
+    GLint location = gl.getUniformLocation(programHandle, parameter.name.data());
+    
+    if (location < 0) {
+        PostNotification(kNotificationLevelInfo,
+            "ShaderParameter '%s' was not found in GlRenderPipeline #%i and will not be bound.",
+            parameter.name.data(), this->getHandle());
+    }
+    
+    return location;
+}
+
+void GlRenderPipeline::bindParameterAt(std::int32_t location, std::uint8_t type, ShaderValue const& value) const
+{
+    switch(type)
     {
         case kShaderParamU32:
-        gl.uniform1ui(location, parameter.value.u32);
+        gl.uniform1ui(location, value.u32);
         break;
         
         case kShaderParamI32:
-        gl.uniform1i(location, parameter.value.i32);
+        gl.uniform1i(location, value.i32);
         break;
         
         case kShaderParamFloat:
-        gl.uniform1f(location, parameter.value.fl);
+        gl.uniform1f(location, value.fl);
         break;
         
         case kShaderParamVec2:
-        gl.uniform2fv(location, 1, glm::value_ptr(parameter.value.vec2));
+        gl.uniform2fv(location, 1, glm::value_ptr(value.vec2));
         break;
         
         case kShaderParamVec3:
-        gl.uniform3fv(location, 1, glm::value_ptr(parameter.value.vec3));
+        gl.uniform3fv(location, 1, glm::value_ptr(value.vec3));
         break;
         
         case kShaderParamVec4:
-        gl.uniform4fv(location, 1, glm::value_ptr(parameter.value.vec4));
+        gl.uniform4fv(location, 1, glm::value_ptr(value.vec4));
         break;
         
         case kShaderParamUVec2:
-        gl.uniform2uiv(location, 1, glm::value_ptr(parameter.value.uvec2));
+        gl.uniform2uiv(location, 1, glm::value_ptr(value.uvec2));
         break;
         
         case kShaderParamUVec3:
-        gl.uniform3uiv(location, 1, glm::value_ptr(parameter.value.uvec3));
+        gl.uniform3uiv(location, 1, glm::value_ptr(value.uvec3));
         break;
         
         case kShaderParamUVec4:
-        gl.uniform4uiv(location, 1, glm::value_ptr(parameter.value.uvec4));
+        gl.uniform4uiv(location, 1, glm::value_ptr(value.uvec4));
         break;
         
         case kShaderParamIVec2:
-        gl.uniform2iv(location, 1, glm::value_ptr(parameter.value.ivec2));
+        gl.uniform2iv(location, 1, glm::value_ptr(value.ivec2));
         break;
         
         case kShaderParamIVec3:
-        gl.uniform3iv(location, 1, glm::value_ptr(parameter.value.ivec3));
+        gl.uniform3iv(location, 1, glm::value_ptr(value.ivec3));
         break;
         
         case kShaderParamIVec4:
-        gl.uniform4iv(location, 1, glm::value_ptr(parameter.value.ivec4));
+        gl.uniform4iv(location, 1, glm::value_ptr(value.ivec4));
         break;
         
         case kShaderParamMat2:
-        gl.uniformMatrix2fv(location, 1, false, glm::value_ptr(parameter.value.mat2));
+        gl.uniformMatrix2fv(location, 1, false, glm::value_ptr(value.mat2));
         break;
         
         case kShaderParamMat3:
-        gl.uniformMatrix3fv(location, 1, false, glm::value_ptr(parameter.value.mat3));
+        gl.uniformMatrix3fv(location, 1, false, glm::value_ptr(value.mat3));
         break;
         
         case kShaderParamMat4:
-        gl.uniformMatrix4fv(location, 1, false, glm::value_ptr(parameter.value.mat4));
+        gl.uniformMatrix4fv(location, 1, false, glm::value_ptr(value.mat4));
         break;
         
         case kShaderParamMat2x3:
-        gl.uniformMatrix2x3fv(location, 1, false, glm::value_ptr(parameter.value.mat2x3));
+        gl.uniformMatrix2x3fv(location, 1, false, glm::value_ptr(value.mat2x3));
         break;
         
         case kShaderParamMat3x2:
-        gl.uniformMatrix3x2fv(location, 1, false, glm::value_ptr(parameter.value.mat3x2));
+        gl.uniformMatrix3x2fv(location, 1, false, glm::value_ptr(value.mat3x2));
         break;
         
         case kShaderParamMat2x4:
-        gl.uniformMatrix2x4fv(location, 1, false, glm::value_ptr(parameter.value.mat2x4));
+        gl.uniformMatrix2x4fv(location, 1, false, glm::value_ptr(value.mat2x4));
         break;
         
         case kShaderParamMat4x2:
-        gl.uniformMatrix4x2fv(location, 1, false, glm::value_ptr(parameter.value.mat4x2));
+        gl.uniformMatrix4x2fv(location, 1, false, glm::value_ptr(value.mat4x2));
         break;
         
         case kShaderParamMat3x4:
-        gl.uniformMatrix3x4fv(location, 1, false, glm::value_ptr(parameter.value.mat3x4));
+        gl.uniformMatrix3x4fv(location, 1, false, glm::value_ptr(value.mat3x4));
         break;
         
         case kShaderParamMat4x3:
-        gl.uniformMatrix4x3fv(location, 1, false, glm::value_ptr(parameter.value.mat4x3));
+        gl.uniformMatrix4x3fv(location, 1, false, glm::value_ptr(value.mat4x3));
         break;
         
         default:
         break;
     }
+}
+
+bool GlRenderPipeline::bindParameterBlock(ParameterBlock& block) const
+{
+    BlockBinding binding;
+    bool found = false;
     
-    GlError error = GlCheckError(gl.getError);
-    if (error.error != GL_NO_ERROR) {
-        Notification notif = BuildNotification(kNotificationLevelError,
-            "An error occured while glUniform: %s.",
-            error.string.data());
-        NotificationCenter::GetDefault()->send(notif);
+    {
+        auto& bindings = blockBindings.lock();
+        auto it = bindings.find(block.getName());
+        found = (it != bindings.end());
+        if (found) binding = it->second;
+        blockBindings.unlock();
     }
     
-    if (rebindCurrent) {
-        gl.useProgram(currentProgram);
+    // First use of this block, or binding index changed: the program's block is bound to the block's binding
+    // index.
+    
+    if (!found || (binding.index != GL_INVALID_INDEX && binding.binding != block.getBinding()))
+    {
+        if (!found)
+            binding.index = gl.getUniformBlockIndex(programHandle, block.getName().data());
+        
+        if (binding.index != GL_INVALID_INDEX) 
+        {
+            binding.binding = block.getBinding();
+            gl.uniformBlockBinding(programHandle, binding.index, binding.binding);
+        }
+        
+        auto& bindings = blockBindings.lock();
+        bindings[block.getName()] = binding;
+        blockBindings.unlock();
+    }
+    
+    if (binding.index == GL_INVALID_INDEX)
+        return false;
+    
+    // The block's parameters are not uploaded as single uniforms while it is uploaded for the current command.
+    
+    if (!static_cast < GlDriver* >(driver)->bindParameterBlock(block)) {
+        uncoverParameters(block.getBinding());
+        return false;
     }
+    
+    coverParameters(block.getBinding(), block.getLayout());
+    return true;
 }
 
 void GlRenderPipeline::bindShaderAttributes(ShaderAttributesMap const& attributes) const 
@@ -276,10 +543,9 @@ void GlRenderPipeline::bindShaderAttributes(ShaderAttributesMap const& attribute
         if (attrib.enabled)
         {
             if (!attrib.buffer) {
-                Notification notif = BuildNotification(kNotificationLevelWarning,
+                PostNotification(kNotificationLevelWarning,
                      "ShaderAttribute index %i has a null buffer but is enabled.",
                      attribNum);
-                NotificationCenter::GetDefault()->send(notif);
                 continue;
             }
             
@@ -302,10 +568,9 @@ void GlRenderPipeline::bindShaderAttributes(ShaderAttributesMap const& attribute
             
             GlError error = GlCheckError(gl.getError);
             if (error.error != GL_NO_ERROR) {
-                Notification notif = BuildNotification(kNotificationLevelError,
+                PostNotification(kNotificationLevelError,
                     "Can't bind ShaderAttribute: %s",
                     error.string.data());
-                NotificationCenter::GetDefault()->send(notif);
             }
             
             if (!attrib.buffer->isBindable()) {
@@ -340,10 +605,9 @@ std::uint8_t GlRenderPipeline::findAttributeIndex(std::string const& attrib) con
     
     GlError error = GlCheckError(gl.getError);
     if (error.error != GL_NO_ERROR) {
-        Notification notif = BuildNotification(kNotificationLevelError,
+        PostNotification(kNotificationLevelError,
             "glGetAttribLocation('%s') failed: %s",
             attrib.data(), error.string.data());
-        NotificationCenter::GetDefault()->send(notif);
     }
     
     return result;
@@ -363,10 +627,9 @@ void GlRenderPipeline::bindTexture(ShaderParameter const& parameter, Texture con
     if (location < 0) {
         location = gl.getUniformLocation(programHandle, parameter.name.data());
         if (location < 0) {
-            Notification notif = BuildNotification(kNotificationLevelInfo,
+            PostNotification(kNotificationLevelInfo,
                 "Can't bind ShaderParameter '%s' because it was not found in GlRenderPipeline #%i.",
                 parameter.name.data(), this->getHandle());
-            NotificationCenter::GetDefault()->send(notif);
             return;
         }
     }
@@ -378,10 +641,9 @@ void GlRenderPipeline::bindTexture(ShaderParameter const& parameter, Texture con
     
     if (unit == -1) 
     {
-        Notification notif = BuildNotification(kNotificationLevelWarning, 
+        PostNotification(kNotificationLevelWarning, 
             "Parameter location %i can't be associated to a Texture unit. (GlRenderPipeline #%i)",
             location, getHandle());
-        NotificationCenter::GetDefault()->send(notif);
         return;
     }
     
@@ -391,10 +653,9 @@ void GlRenderPipeline::bindTexture(ShaderParameter const& parameter, Texture con
     
     GlError error = GlCheckError(gl.getError);
     if (error.error != GL_NO_ERROR) {
-        Notification notif = BuildNotification(kNotificationLevelError,
+        PostNotification(kNotificationLevelError,
             "An error occured: %s.",
             error.string.data());
-        NotificationCenter::GetDefault()->send(notif);
     }
     
     if (rebindCurrent) {
@@ -412,6 +673,9 @@ void GlRenderPipeline::releaseResource()
     if (programHandle) {
         gl.deleteProgram(programHandle);
         programHandle = 0;
+        attachedShaders.clear();
+        linkCache.reset();
+        linking = false;
         released = true;
     }
 }
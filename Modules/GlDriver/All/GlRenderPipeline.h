@@ -5,8 +5,10 @@
 #define GLDRIVER_GLRENDERPIPELINE_H
 
 #include "GlInclude.h"
+#include "GlShader.h"
 
 #include <Clean/RenderPipeline.h>
+#include <Clean/PipelineCache.h>
 #include <Clean/Property.h>
 #include <Clean/AtomicCounter.h>
 
@@ -23,9 +25,35 @@ class GlRenderPipeline : public Clean::RenderPipeline
     //! @brief Association map between parameter's location and texture unit. 
     mutable Clean::Property < std::map < GLint, GLint > > textureUnits;
     
+    //! @brief Shaders attached to the program. 
+    std::vector < std::shared_ptr < GlShader > > attachedShaders;
+    
     //! @brief Counter for newly allocated texture units. 
     mutable Clean::AtomicCounter < GLint > unitCounter;
     
+    /** @brief A uniform block of the program. */
+    struct BlockBinding 
+    {
+        //! @brief Index of the block in the program, or GL_INVALID_INDEX if the program does not use it.
+        GLuint index = GL_INVALID_INDEX;
+        
+        //! @brief Binding index the block is bound to. 
+        GLuint binding = 0;
+    };
+    
+    //! @brief Uniform blocks already looked for, by name. Cleared when the program is linked. 
+    mutable Clean::Property < std::map < std::string, BlockBinding > > blockBindings;
+    
+    //! @brief Protects the link of the program, which may be done by the driver's compiler thread. 
+    mutable std::mutex linkMutex;
+    
+    //! @brief True between glLinkProgram and the check of the link status. 
+    bool linking = false;
+    
+    //! @brief Cache where the program is stored once linked, and its key. 
+    std::shared_ptr < Clean::PipelineCache > linkCache;
+    std::uint64_t linkCacheKey = 0;
+    
 public:
     
     /*! @brief Constructs a pipeline. */
@@ -41,9 +69,37 @@ public:
     **/
     void shader(std::uint8_t stage, std::shared_ptr < Clean::Shader > const& shad);
     
-    /*! @brief Links the program. */
+    /*! @brief Links the program. 
+     *
+     * If the driver has a PipelineCache, the program binary is loaded from it, and the shaders are not
+     * compiled. Otherwise, the shaders are compiled, the program is linked and its binary stored. 
+     *
+    **/
     void link();
     
+    /*! @brief Links the program if not already done. Returns true if it is linked. */
+    bool compile();
+    
+    /*! @brief Starts linking the program without waiting for it. 
+     *
+     * With KHR_parallel_shader_compile, shaders are compiled and the program is linked by the driver's
+     * threads: \ref isLinkComplete() tells when \ref finishLink() won't block. Returns true if the program
+     * was loaded from the PipelineCache, and finishLink() is not needed. 
+     *
+    **/
+    bool beginLink();
+    
+    /*! @brief Returns true if the link started by beginLink() is complete, or if no link was started. */
+    bool isLinkComplete() const;
+    
+    /*! @brief Checks the link started by beginLink(), and stores the program in the PipelineCache. 
+     *  Returns true if the program is linked. 
+    **/
+    bool finishLink();
+    
+    /*! @brief Returns the shaders attached to the program. */
+    std::vector < std::shared_ptr < Clean::Shader > > getShaders() const;
+    
     /*! @brief Binds the program to given driver. */
     void bind(Clean::Driver const& driver) const;
     
@@ -58,6 +114,24 @@ public:
     **/
     void bindParameter(Clean::ShaderParameter const& parameters) const;
     
+    using Clean::RenderPipeline::bindEffectParameters;
+    
+    /*! @brief Binds parameters with their BindingPlan. 
+     *  The program is made current and glGetError is checked once for all the parameters. 
+    **/
+    void bindEffectParameters(std::vector < std::shared_ptr < Clean::EffectParameter > > const& parameters, std::uint64_t layout) const;
+    
+    /*! @brief Returns the parameter's index if set, or its uniform location. */
+    std::int32_t findParameterLocation(Clean::ShaderParameter const& parameter) const;
+    
+    /*! @brief Calls the correct glUniform* function. Program must be current. */
+    void bindParameterAt(std::int32_t location, std::uint8_t type, Clean::ShaderValue const& value) const;
+    
+    /*! @brief Binds a ParameterBlock to the uniform block of the same name. 
+     *  The block's values are uploaded by GlDriver's uniform ring. 
+    **/
+    bool bindParameterBlock(Clean::ParameterBlock& block) const;
+    
     /*! @brief Binds multiple ShaderAttribute onto this pipeline. */
     void bindShaderAttributes(Clean::ShaderAttributesMap const& attributes) const;
     
@@ -90,6 +164,21 @@ protected:
     
     /*! @brief Finds the Texture Unit associated to given parameter's location. */
     GLint findTextureUnit(GLint location) const;
+    
+    /*! @brief Starts the link. linkMutex must be locked. Returns true if the program was loaded from cache. */
+    bool _beginLink();
+    
+    /*! @brief Ends the link started by _beginLink(). linkMutex must be locked. */
+    bool _endLink();
+    
+    /*! @brief Returns the key of the program in a PipelineCache, from the attached shaders. */
+    std::uint64_t makeCacheKey(std::string const& identity) const;
+    
+    /*! @brief Loads the program binary from cache. Returns true if the program is linked. */
+    bool loadBinary(Clean::PipelineCache& cache, std::uint64_t key);
+    
+    /*! @brief Stores the binary of the linked program into cache. */
+    void storeBinary(Clean::PipelineCache& cache, std::uint64_t key) const;
 };
 
 #endif // GLDRIVER_GLRENDERPIPELINE_H
@@ -0,0 +1,132 @@
+/** \file GlDriver/GlRenderTexture.cpp
+**/
+
+#include "GlRenderTexture.h"
+#include "GlCheckError.h"
+
+#include <Clean/Driver.h>
+#include <Clean/Allocate.h>
+#include <Clean/NotificationCenter.h>
+using namespace Clean;
+
+GlRenderTexture::GlRenderTexture(Driver* driver, RenderTextureDescriptor const& desc, GlPtrTable const& tbl) 
+    : RenderTexture(desc), gl(tbl)
+{
+    gl.genFramebuffers(1, &framebuffer);
+    gl.genVertexArrays(1, &vao);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    
+    if (descriptor.colorFormat != kPixelFormatNull)
+    {
+        GLint internalFormat = descriptor.colorFormat == kPixelFormatRGB8 ? GL_RGB8 : GL_RGBA8;
+        GLenum format = descriptor.colorFormat == kPixelFormatRGB8 ? GL_RGB : GL_RGBA;
+        
+        color = makeAttachment(driver, internalFormat, format, GL_UNSIGNED_BYTE);
+        if (color) gl.framebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color->getGLHandle(), 0);
+    }
+    
+    else 
+    {
+        gl.drawBuffer(GL_NONE);
+        gl.readBuffer(GL_NONE);
+    }
+    
+    if (descriptor.depth)
+    {
+        depth = makeAttachment(driver, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT);
+        if (depth) gl.framebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth->getGLHandle(), 0);
+    }
+    
+    if (!isValid())
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, 
+            "Framebuffer #%i of %zux%zu is incomplete.", framebuffer, descriptor.width, descriptor.height));
+    }
+    
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+GlRenderTexture::~GlRenderTexture()
+{
+    if (color) color->release();
+    if (depth) depth->release();
+    
+    gl.deleteVertexArrays(1, &vao);
+    gl.deleteFramebuffers(1, &framebuffer);
+}
+
+bool GlRenderTexture::isValid() const 
+{
+    if (!framebuffer)
+        return false;
+    
+    GLint bound = 0;
+    gl.getIntegerv(GL_FRAMEBUFFER_BINDING, &bound);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    
+    GLenum status = gl.checkFramebufferStatus(GL_FRAMEBUFFER);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, (GLuint) bound);
+    
+    return status == GL_FRAMEBUFFER_COMPLETE;
+}
+
+void GlRenderTexture::lock()
+{
+    
+}
+
+void GlRenderTexture::unlock()
+{
+    
+}
+
+void GlRenderTexture::bind(Driver&) const 
+{
+    gl.bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    gl.bindVertexArray(vao);
+    gl.viewport(0, 0, (GLsizei) descriptor.width, (GLsizei) descriptor.height);
+}
+
+void GlRenderTexture::prepare(Driver& driver) const 
+{
+    bind(driver);
+    
+    gl.enable(GL_DEPTH_TEST);
+    gl.depthFunc(GL_LESS);
+    
+    gl.clearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+    gl.clearDepth(1.0);
+    gl.clear((color ? GL_COLOR_BUFFER_BIT : 0) | (depth ? GL_DEPTH_BUFFER_BIT : 0));
+}
+
+std::shared_ptr < Texture > GlRenderTexture::getColorTexture() const 
+{
+    return std::static_pointer_cast < Texture >(color);
+}
+
+std::shared_ptr < Texture > GlRenderTexture::getDepthTexture() const 
+{
+    return std::static_pointer_cast < Texture >(depth);
+}
+
+std::shared_ptr < GlTexture > GlRenderTexture::makeAttachment(Driver* driver, GLint internalFormat, GLenum format, GLenum type) const 
+{
+    GLuint handle = 0; 
+    gl.genTextures(1, &handle);
+    if (!handle) return nullptr;
+    
+    auto texture = AllocateShared < GlTexture >(driver, handle, GL_TEXTURE_2D, gl);
+    assert(texture && "Clean::AllocateShared failed (maybe memory is not available?).");
+    
+    gl.bindTexture(GL_TEXTURE_2D, handle);
+    gl.texImage2D(GL_TEXTURE_2D, 0, internalFormat, (GLsizei) descriptor.width, (GLsizei) descriptor.height, 0, format, type, nullptr);
+    gl.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    gl.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    gl.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    gl.bindTexture(GL_TEXTURE_2D, 0);
+    
+    texture->retain();
+    return texture;
+}
@@ -0,0 +1,72 @@
+/** \file GlDriver/GlRenderTexture.h
+**/
+
+#ifndef GLDRIVER_GLRENDERTEXTURE_H
+#define GLDRIVER_GLRENDERTEXTURE_H
+
+#include "GlInclude.h"
+#include "GlTexture.h"
+
+#include <Clean/RenderTexture.h>
+
+#include <memory>
+
+/** @brief OpenGL implementation of Clean::RenderTexture, with a framebuffer object.
+ *
+ * The color attachment is a GL_RGBA8 or GL_RGB8 texture, and the depth attachment a GL_DEPTH_COMPONENT24
+ * texture, so both can be sampled by the passes reading them. OpenGL orders writes to a framebuffer before
+ * later reads of its textures by itself: no barrier is needed between passes.
+ *
+ * \note Must be constructed and used from the thread owning the driver's context.
+ *
+**/
+class GlRenderTexture : public Clean::RenderTexture
+{
+    //! @brief Gl Pointer Table.
+    GlPtrTable const& gl;
+    
+    //! @brief Framebuffer object.
+    GLuint framebuffer = 0;
+    
+    //! @brief Our VAO, as a VAO can't be shared between contexts.
+    GLuint vao = 0;
+    
+    //! @brief Attachments, retained by this target. Null if not in the descriptor.
+    std::shared_ptr < GlTexture > color, depth;
+    
+public:
+    
+    /*! @brief Creates the framebuffer and its attachments. */
+    GlRenderTexture(Clean::Driver* driver, Clean::RenderTextureDescriptor const& desc, GlPtrTable const& tbl);
+    
+    /*! @brief Releases the attachments and deletes the framebuffer. */
+    ~GlRenderTexture();
+    
+    /*! @brief Returns true if the framebuffer is complete. */
+    bool isValid() const;
+    
+    /*! @brief Does nothing. */
+    void lock();
+    
+    /*! @brief Does nothing. */
+    void unlock();
+    
+    /*! @brief Binds the framebuffer and our VAO, and sets the viewport to the attachments' size. */
+    void bind(Clean::Driver& driver) const;
+    
+    /*! @brief Binds the target, and clears its attachments. */
+    void prepare(Clean::Driver& driver) const;
+    
+    /*! @brief Returns the color attachment, or null. */
+    std::shared_ptr < Clean::Texture > getColorTexture() const;
+    
+    /*! @brief Returns the depth attachment, or null. */
+    std::shared_ptr < Clean::Texture > getDepthTexture() const;
+    
+protected:
+    
+    /*! @brief Makes a texture of the attachments' size. */
+    std::shared_ptr < GlTexture > makeAttachment(Clean::Driver* driver, GLint internalFormat, GLenum format, GLenum type) const;
+};
+
+#endif // GLDRIVER_GLRENDERTEXTURE_H
@@ -24,5 +24,7 @@ GlRenderWindow::~GlRenderWindow()
 
 void GlRenderWindow::bind(Driver& driver) const 
 {
+    // A GlRenderTexture may have been drawn into since the last command.
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
     gl.bindVertexArray(vao);
 }
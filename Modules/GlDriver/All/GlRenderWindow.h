@@ -30,7 +30,7 @@ public:
     /*! @brief Returns true if valid (initialized). */
     virtual bool isValid() const = 0;
     
-    /*! @brief Binds the current VAO. */
+    /*! @brief Binds the default framebuffer and the current VAO. */
     virtual void bind(Clean::Driver& driver) const;
 };
 
@@ -4,6 +4,7 @@
 #include "GlShader.h"
 
 #include <Clean/NotificationCenter.h>
+#include <Clean/Hash.h>
 using namespace Clean;
 
 static GLenum GlShaderStage(std::uint8_t type)
@@ -22,13 +23,39 @@ static GLenum GlShaderStage(std::uint8_t type)
 }
 
 GlShader::GlShader(const char* src, std::uint8_t type, GlPtrTable const& tbl)
-    : Shader(type), shaderHandle(0), compiled(false), compilerError(), gl(tbl)
+    : Shader(type), shaderHandle(0), compiled(false), compileDone(false), statusChecked(false), sourceHash(0), compilerError(), gl(tbl)
 {
     shaderHandle = gl.createShader(GlShaderStage(type));
     if (!shaderHandle) return;
     
     gl.shaderSource(shaderHandle, 1, &src, NULL);
+    sourceHash = Hash64(src);
+}
+
+void GlShader::beginCompile()
+{
+    std::scoped_lock < std::mutex > lck(compileMutex);
+    
+    if (compileDone || !shaderHandle) 
+        return;
+    
+    compileDone = true;
     gl.compileShader(shaderHandle);
+}
+
+bool GlShader::compile()
+{
+    std::scoped_lock < std::mutex > lck(compileMutex);
+    
+    if (statusChecked || !shaderHandle) 
+        return compiled;
+    
+    if (!compileDone) {
+        compileDone = true;
+        gl.compileShader(shaderHandle);
+    }
+    
+    statusChecked = true;
     
     GLint status;
     gl.getShaderiv(shaderHandle, GL_COMPILE_STATUS, &status);
@@ -45,10 +72,11 @@ GlShader::GlShader(const char* src, std::uint8_t type, GlPtrTable const& tbl)
         NotificationCenter::GetDefault()->send(notif);
         
         compilerError = std::string(buffer, length);
-        return;
+        return false;
     }
     
     compiled = true;
+    return true;
 }
 
 GlShader::~GlShader()
@@ -68,9 +96,14 @@ GLuint GlShader::getGLHandle() const
     return shaderHandle;
 }
 
+std::uint64_t GlShader::getSourceHash() const
+{
+    return sourceHash;
+}
+
 void GlShader::releaseResource()
 {
-    if (!compiled) return;
+    if (!shaderHandle) return;
     gl.deleteShader(shaderHandle);
     shaderHandle = 0;
     compiled = false;
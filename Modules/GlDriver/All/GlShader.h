@@ -6,6 +6,7 @@
 
 #include "GlInclude.h"
 
+#include <mutex>
 #include <string>
 #include <Clean/Shader.h>
 
@@ -18,6 +19,18 @@ class GlShader : public Clean::Shader
     //! @brief Is this shader correctly compiled?
     bool compiled;
     
+    //! @brief True once glCompileShader was called. 
+    bool compileDone;
+    
+    //! @brief True once the compile status was checked. 
+    bool statusChecked;
+    
+    //! @brief Protects the compilation, as pipelines sharing this shader may be compiled by different threads. 
+    std::mutex compileMutex;
+    
+    //! @brief Hash of the source, used to find the programs using this shader in a PipelineCache. 
+    std::uint64_t sourceHash;
+    
     //! @brief Error stored from the compilation, or empty if no error.
     std::string compilerError;
     
@@ -26,7 +39,12 @@ class GlShader : public Clean::Shader
     
 public:
     
-    /*! @brief Constructs the shader. */
+    /*! @brief Constructs the shader. 
+     *
+     * The source is given to the shader object, but it is compiled by \ref compile() only when a program 
+     * using it is linked and is not found in the driver's PipelineCache. 
+     *
+    **/
     GlShader(const char* src, std::uint8_t stage, GlPtrTable const& tbl);
     
     /*! @brief Destructs the shader. */
@@ -38,6 +56,17 @@ public:
     /*! @brief Returns GL Handle. */
     GLuint getGLHandle() const;
     
+    /*! @brief Compiles the shader if not already done. Returns true if the shader is compiled. */
+    bool compile();
+    
+    /*! @brief Calls glCompileShader if not already done, without waiting for the compile status. 
+     *  With KHR_parallel_shader_compile, the compilation runs on the driver's threads. 
+    **/
+    void beginCompile();
+    
+    /*! @brief Returns the hash of the source. */
+    std::uint64_t getSourceHash() const;
+    
 protected:
     
     /*! @brief Releases the shader object. */
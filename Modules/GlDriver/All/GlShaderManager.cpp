@@ -3,18 +3,18 @@
 
 #include "GlShaderManager.h"
 
+GlShaderManager::GlShaderManager()
+{
+    handleIndex = addIndex([](GlShader const& shader){ return shader.getHandle(); });
+}
+
 std::shared_ptr < GlShader > GlShaderManager::findByHandle(std::size_t handle) const 
 {
-    std::scoped_lock < std::mutex > lck(managedListMutex);
-    auto it = std::find_if(managedList.begin(), managedList.end(), [handle](auto shader) { return shader->getHandle() == handle; });
-    if (it == managedList.end()) return nullptr;
-    return *it;
+    return findIndexed(handleIndex, handle, [handle](GlShader const& shader){ return shader.getHandle() == handle; });
 }
 
 std::shared_ptr < GlShader > GlShaderManager::findByPath(std::string const& origin) const
 {
-    std::scoped_lock < std::mutex > lck(managedListMutex);
-    auto it = std::find_if(managedList.begin(), managedList.end(), [origin](auto shader) { return shader->getOriginPath() == origin; });
-    if (it == managedList.end()) return nullptr;
-    return *it;
+    // Driver sets the origin after GlDriver added the shader: it is not a stable key to index.
+    return findIf([&origin](GlShader const& shader){ return shader.getOriginPath() == origin; });
 }
\ No newline at end of file
@@ -9,9 +9,12 @@
 
 class GlShaderManager : public Clean::Manager < GlShader >
 {
+    //! @brief Index of shaders by handle.
+    std::size_t handleIndex;
+    
 public:
     
-    GlShaderManager() = default;
+    GlShaderManager();
     
     std::shared_ptr < GlShader > findByHandle(std::size_t handle) const;
     
@@ -7,6 +7,8 @@
 #include "GlCheckError.h"
 
 #include <Clean/NotificationCenter.h>
+#include <Clean/MipmapGenerator.h>
+#include <Clean/Profiler.h>
 using namespace Clean;
 
 /*! @brief Converts a GL Texture Target to its corresponding GL Texture binding. */
@@ -89,9 +91,15 @@ std::size_t GlTexture::getHeight() const
 
 void GlTexture::bind() const 
 {
+    ProfileCount("binds", 1);
     gl.bindTexture(target, handle);
 }
 
+GLuint GlTexture::getGLHandle() const
+{
+    return handle;
+}
+
 GLenum GlGetInternalFormat(std::uint8_t format)
 {
     switch (format)
@@ -104,6 +112,21 @@ GLenum GlGetInternalFormat(std::uint8_t format)
     }
 }
 
+GLenum GlGetCompressedInternalFormat(std::uint8_t format)
+{
+    switch (format)
+    {
+        case kPixelFormatBC1: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case kPixelFormatBC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case kPixelFormatBC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case kPixelFormatETC2RGB8: return GL_COMPRESSED_RGB8_ETC2;
+        case kPixelFormatETC2RGBA8: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+        
+        default:
+        return GL_INVALID_ENUM;
+    }
+}
+
 GLenum GlChooseBestInternalPixelFormat(std::uint8_t internal, std::uint8_t external)
 {
     GLenum desiredInternalFormat = GlGetInternalFormat(internal);
@@ -139,6 +162,14 @@ GLenum GlGetPixelDataType(std::uint8_t format)
 bool GlTexture::upload(std::shared_ptr < Image > const& image)
 {
     if (!image) return false;
+    
+    auto pixels = image->getPixelSet();
+    if (pixels && PixelFormatIsCompressed(pixels->format)) 
+        return uploadCompressed(*pixels);
+    
+    if (pixels && !pixels->levels.empty())
+        return uploadLevels(*pixels);
+    
     GlTextureBinder binder(target, *this, gl);
     
     GLenum desiredInternalFormat = GlChooseBestInternalPixelFormat(internalFormat, image->pixelFormat());
@@ -186,7 +217,11 @@ bool GlTexture::upload(std::shared_ptr < Image > const& image)
         break;
     }
     
+    // NOTES: Images coming from Driver::makeTexture(filepath) already hold their mipmaps, generated on
+    // the CPU by MipmapGenerate(). This is only used for images given directly to GlDriver::makeTexture().
     gl.generateMipmap(GL_TEXTURE_2D);
+    levelsCount = MipmapGetLevelsCount(size.x, size.y);
+    
     auto error = GlCheckError(gl.getError);
     
     if (error.error != GL_NO_ERROR)
@@ -198,6 +233,115 @@ bool GlTexture::upload(std::shared_ptr < Image > const& image)
     return true;
 }
 
+bool GlTexture::uploadCompressed(PixelSet const& pixels)
+{
+    GLenum internal = GlGetCompressedInternalFormat(pixels.format);
+    
+    if (internal == GL_INVALID_ENUM || pixels.levels.empty() || !pixels.data)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "Invalid compressed PixelSet. Format is: %s.", 
+            PixelFormatToString(pixels.format).data()));
+        return false;
+    }
+    
+    if (target != GL_TEXTURE_2D)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "Compressed upload only supports GL_TEXTURE_2D (target %i).", 
+            (int) target));
+        return false;
+    }
+    
+    GlTextureBinder binder(target, *this, gl);
+    gl.pixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    
+    for (std::size_t i = 0; i < pixels.levels.size(); ++i)
+    {
+        PixelSetLevel const& level = pixels.levels[i];
+        
+        gl.compressedTexImage2D(target, static_cast < GLint >(i), internal,
+                                static_cast < GLsizei >(level.width), static_cast < GLsizei >(level.height),
+                                0, static_cast < GLsizei >(level.size),
+                                static_cast < const GLvoid* >(pixels.data + level.offset));
+    }
+    
+    setLevelsCount(pixels.levels.size());
+    auto error = GlCheckError(gl.getError);
+    
+    if (error.error != GL_NO_ERROR)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "glCompressedTexImage2D failed: %s.", error.string.data()));
+        return false;
+    }
+    
+    return true;
+}
+
+bool GlTexture::uploadLevels(PixelSet const& pixels)
+{
+    GLenum desiredInternalFormat = GlChooseBestInternalPixelFormat(internalFormat, pixels.format);
+    GLenum format = GlGetPixelFormat(pixels.format);
+    GLenum dataType = GlGetPixelDataType(pixels.format);
+    
+    if (desiredInternalFormat == GL_INVALID_ENUM || format == GL_INVALID_ENUM || dataType == GL_INVALID_ENUM || !pixels.data)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "Invalid PixelSet. Format is: %s.", 
+            PixelFormatToString(pixels.format).data()));
+        return false;
+    }
+    
+    if (target != GL_TEXTURE_2D)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "Levels upload only supports GL_TEXTURE_2D (target %i).", 
+            (int) target));
+        return false;
+    }
+    
+    GlTextureBinder binder(target, *this, gl);
+    gl.pixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    gl.pixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    
+    for (std::size_t i = 0; i < pixels.levels.size(); ++i)
+    {
+        PixelSetLevel const& level = pixels.levels[i];
+        
+        gl.texImage2D(target, static_cast < GLint >(i), desiredInternalFormat,
+                      static_cast < GLsizei >(level.width), static_cast < GLsizei >(level.height),
+                      0, format, dataType,
+                      static_cast < const GLvoid* >(pixels.data + level.offset));
+    }
+    
+    setLevelsCount(pixels.levels.size());
+    auto error = GlCheckError(gl.getError);
+    
+    if (error.error != GL_NO_ERROR)
+    {
+        NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "glTexImage2D failed: %s.", error.string.data()));
+        return false;
+    }
+    
+    return true;
+}
+
+void GlTexture::setLevelsCount(std::size_t count)
+{
+    assert(count && "Invalid levels count.");
+    const GLint maxLevel = static_cast < GLint >(count - 1);
+    
+    gl.texParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    gl.texParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    gl.texParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+    gl.texParameteri(target, GL_TEXTURE_MAX_LEVEL, maxLevel);
+    gl.texParameteri(target, GL_TEXTURE_MIN_FILTER, maxLevel ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    gl.texParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    
+    // Levels after count still hold the memory of a previous (longer) chain: redefining them
+    // with an empty size lets the driver free it.
+    for (std::size_t i = count; i < levelsCount; ++i)
+        gl.texImage2D(target, static_cast < GLint >(i), GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    
+    levelsCount = count;
+}
+
 void GlTexture::releaseResource() 
 {
     gl.deleteTextures(1, &handle);
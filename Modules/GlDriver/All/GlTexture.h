@@ -25,6 +25,10 @@ class GlTexture : public Clean::Texture
     //! @brief Gl Pointer Table.
     GlPtrTable const& gl;
     
+    //! @brief Number of levels currently specified for this texture. Used to free the levels
+    //! left over when a shorter chain is uploaded.
+    std::size_t levelsCount = 0;
+    
 public:
     
     /*! @brief Constructs a GlTexture with a handle. */
@@ -39,11 +43,30 @@ public:
     /*! @brief Binds the texture. */
     void bind() const;
     
+    /*! @brief Returns GL Handle. */
+    GLuint getGLHandle() const;
+    
     /*! @brief Uploads data to this texture. */
     bool upload(std::shared_ptr < Clean::Image > const& image);
     
 protected:
     
+    /*! @brief Uploads every level of a block-compressed PixelSet. 
+     *
+     * Compressed PixelSets always hold their own mipmaps chain, as glGenerateMipmap cannot be
+     * used on compressed textures. If only one level is given, the texture has no mipmaps.
+     *
+    **/
+    bool uploadCompressed(Clean::PixelSet const& pixels);
+    
+    /*! @brief Uploads every level of an uncompressed PixelSet holding its mipmaps chain. */
+    bool uploadLevels(Clean::PixelSet const& pixels);
+    
+    /*! @brief Sets parameters for a chain of levels [0, count) and frees levels previously 
+     *  specified after count. Texture must be bound. 
+    **/
+    void setLevelsCount(std::size_t count);
+    
     /*! @brief Implementation of the real resource releasing. */
     void releaseResource();
 };
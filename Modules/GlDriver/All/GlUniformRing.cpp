@@ -0,0 +1,84 @@
+/** \file GlDriver/GlUniformRing.cpp
+**/
+
+#include "GlUniformRing.h"
+#include "GlCheckError.h"
+#include "GlDriver.h"
+
+#include <Clean/Allocate.h>
+#include <Clean/NotificationCenter.h>
+using namespace Clean;
+
+GlUniformRing::GlUniformRing(GlPtrTable const& tbl, GLsizeiptr size)
+    : gl(tbl), capacity(size), offset(0), alignment(0)
+{
+
+}
+
+bool GlUniformRing::bind(GlDriver* driver, ParameterBlock& block)
+{
+    const GLsizeiptr size = static_cast < GLsizeiptr >(block.getLayout().getSize());
+    if (!size || size > capacity) return false;
+
+    std::scoped_lock < std::mutex > lck(mutex);
+
+    if (!buffer)
+    {
+        buffer = AllocateShared < GlBuffer >(driver, kBufferTypeUniform, capacity, nullptr, GL_STREAM_DRAW);
+        buffer->retain();
+        gl.getIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        if (alignment <= 0) alignment = 256;
+    }
+
+    const std::uint64_t version = block.update();
+    auto it = uploads.find(block.getHandle());
+
+    if (it == uploads.end() || it->second.version != version)
+    {
+        GLintptr start = (offset + alignment - 1) / alignment * alignment;
+
+        if (start + size > capacity)
+        {
+            // Orphans the storage: ranges still used by the GPU stay valid, and every block will be
+            // uploaded again in the new storage.
+            buffer->update(nullptr, static_cast < std::size_t >(capacity), kBufferUsageStream);
+            uploads.clear();
+            start = 0;
+        }
+
+        gl.bindBuffer(GL_UNIFORM_BUFFER, buffer->getGLHandle());
+        void* dest = gl.mapBufferRange(GL_UNIFORM_BUFFER, start, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+        if (!dest)
+        {
+            GlError error = GlCheckError(gl.getError);
+            NotificationCenter::GetDefault()->send(BuildNotification(kNotificationLevelError, "Can't map uniform ring for block '%s': %s.",
+                block.getName().data(), error.string.data()));
+            return false;
+        }
+
+        Upload upload;
+        upload.version = block.copy(dest);
+        upload.offset = start;
+        gl.unmapBuffer(GL_UNIFORM_BUFFER);
+
+        it = uploads.insert_or_assign(block.getHandle(), upload).first;
+        offset = start + size;
+    }
+
+    gl.bindBufferRange(GL_UNIFORM_BUFFER, block.getBinding(), buffer->getGLHandle(), it->second.offset, size);
+    return true;
+}
+
+void GlUniformRing::release()
+{
+    std::scoped_lock < std::mutex > lck(mutex);
+
+    if (buffer) {
+        buffer->release();
+        buffer.reset();
+    }
+
+    uploads.clear();
+    offset = 0;
+}
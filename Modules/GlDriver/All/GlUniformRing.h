@@ -0,0 +1,78 @@
+/** \file GlDriver/GlUniformRing.h
+**/
+
+#ifndef GLDRIVER_GLUNIFORMRING_H
+#define GLDRIVER_GLUNIFORMRING_H
+
+#include "GlInclude.h"
+#include "GlBuffer.h"
+
+#include <Clean/ParameterBlock.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class GlDriver;
+
+//! @brief Default size of the uniform ring: 4 MiB.
+static constexpr const GLsizeiptr kGlUniformRingDefaultSize = 4 * 1024 * 1024;
+
+/** @brief Uploads ParameterBlocks to one uniform buffer used as a ring.
+ *
+ * Each block upload is written after the previous one, at GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, with an
+ * unsynchronized map: the GPU may still read older ranges, but they are never written again until the
+ * ring wraps. When it wraps, the buffer is orphaned with glBufferData, so the driver gives a new storage
+ * while pending draws keep the old one. A block is uploaded again only if its version changed since its
+ * last upload in the current storage, and it is bound with glBindBufferRange.
+ *
+ * \note Must be used from the thread owning the driver's context.
+ *
+**/
+class GlUniformRing
+{
+    /** @brief Last upload of a block in the current storage. */
+    struct Upload
+    {
+        //! @brief ParameterBlock's version uploaded.
+        std::uint64_t version = 0;
+
+        //! @brief Offset of the upload in the ring.
+        GLintptr offset = 0;
+    };
+
+    //! @brief Holds Gl table.
+    GlPtrTable const& gl;
+
+    //! @brief Uniform buffer of the ring, created on first use.
+    std::shared_ptr < GlBuffer > buffer;
+
+    //! @brief Size of buffer.
+    GLsizeiptr capacity;
+
+    //! @brief First free byte in buffer.
+    GLintptr offset;
+
+    //! @brief GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+    GLint alignment;
+
+    //! @brief Uploads in the current storage, by ParameterBlock handle.
+    std::unordered_map < std::size_t, Upload > uploads;
+
+    //! @brief Protects every field above.
+    std::mutex mutex;
+
+public:
+
+    /*! @brief Constructs an empty ring. */
+    GlUniformRing(GlPtrTable const& tbl, GLsizeiptr size = kGlUniformRingDefaultSize);
+
+    /*! @brief Uploads the block if it changed, and binds its range to the block's binding index.
+     *  Returns false if the block can't be uploaded. */
+    bool bind(GlDriver* driver, Clean::ParameterBlock& block);
+
+    /*! @brief Releases the uniform buffer. */
+    void release();
+};
+
+#endif // GLDRIVER_GLUNIFORMRING_H
@@ -75,6 +75,38 @@ void OSXGlFillGlTable(GlPtrTable& gl)
     gl.deleteShader = glDeleteShader;
     gl.enable = glEnable;
     gl.depthFunc = glDepthFunc;
+    gl.compressedTexImage2D = glCompressedTexImage2D;
+    gl.bufferSubData = glBufferSubData;
+    gl.bindBufferRange = glBindBufferRange;
+    gl.mapBufferRange = glMapBufferRange;
+    gl.getUniformBlockIndex = glGetUniformBlockIndex;
+    gl.uniformBlockBinding = glUniformBlockBinding;
+    gl.getString = glGetString;
+    gl.getProgramBinary = glGetProgramBinary;
+    gl.programBinary = glProgramBinary;
+    gl.programParameteri = glProgramParameteri;
+    gl.getStringi = glGetStringi;
+    gl.finish = glFinish;
+    gl.genQueries = glGenQueries;
+    gl.deleteQueries = glDeleteQueries;
+    gl.beginQuery = glBeginQuery;
+    gl.endQuery = glEndQuery;
+    gl.getQueryObjectuiv = glGetQueryObjectuiv;
+    gl.fenceSync = glFenceSync;
+    gl.clientWaitSync = glClientWaitSync;
+    gl.deleteSync = glDeleteSync;
+    gl.genFramebuffers = glGenFramebuffers;
+    gl.deleteFramebuffers = glDeleteFramebuffers;
+    gl.bindFramebuffer = glBindFramebuffer;
+    gl.framebufferTexture2D = glFramebufferTexture2D;
+    gl.checkFramebufferStatus = glCheckFramebufferStatus;
+    gl.drawBuffer = glDrawBuffer;
+    gl.readBuffer = glReadBuffer;
+    gl.viewport = glViewport;
+    gl.clearColor = glClearColor;
+    gl.clearDepth = glClearDepth;
+    gl.clear = glClear;
+    gl.maxShaderCompilerThreadsKHR = nullptr; // KHR_parallel_shader_compile is not available on macOS.
 }
 
 /*! @brief Fills attribs with the corresponding NSOpenGLPixelFormatAttribute values
@@ -107,7 +107,7 @@ public:
     /*! @brief Unlocks NSOpenGLContext from called thread. */
     void unlock();
     
-    /*! @brief Actually makes current the NSOpenGLContext of this window. */
+    /*! @brief Actually makes current the NSOpenGLContext of this window, and sets the viewport to its contentView size. */
     void bind(Clean::Driver& driver) const;
     
     /*! @brief Returns the current Window's style. */
@@ -338,6 +338,11 @@ void OSXGlRenderWindow::bind(Driver& driver) const
     if (nativeContext) {
         nativeContext->makeCurrent();
         GlRenderWindow::bind(driver);
+        
+        if (nativeWindow) {
+            NSRect frame = [[nativeWindow contentView] frame];
+            glViewport(0, 0, (GLsizei)frame.size.width, (GLsizei)frame.size.height);
+        }
     }
 }
 
@@ -368,7 +373,6 @@ void OSXGlRenderWindow::prepare(Driver& driver) const
     {
         bind(driver);
         
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glEnable(GL_DEPTH_TEST);
         glDepthFunc(GL_LESS);
         
@@ -377,9 +381,6 @@ void OSXGlRenderWindow::prepare(Driver& driver) const
         glClearColor(0.0f, 1.0f, 0.0f, 1.0f);
         glClearDepth(1.0f);
         glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT|GL_STENCIL_BUFFER_BIT);
-        
-        NSRect frame = [[nativeWindow contentView] frame];
-        glViewport(0, 0, (GLsizei)frame.size.width, (GLsizei)frame.size.height);
     }
 }
 
@@ -193,6 +193,38 @@ void WinGlMakeGLTable(WGlPtrTable const& wgl, GlPtrTable& gl)
     gl.deleteShader = (PFNGLDELETESHADERPROC) WinGlGetProcAddress(wgl, "glDeleteShader");
     gl.enable = (PFNGLENABLEPROC) WinGlGetProcAddress(wgl, "glEnable");
     gl.depthFunc = (PFNGLDEPTHFUNCPROC) WinGlGetProcAddress(wgl, "glDepthFunc");
+    gl.compressedTexImage2D = (PFNGLCOMPRESSEDTEXIMAGE2DPROC) WinGlGetProcAddress(wgl, "glCompressedTexImage2D");
+    gl.bufferSubData = (PFNGLBUFFERSUBDATAPROC) WinGlGetProcAddress(wgl, "glBufferSubData");
+    gl.bindBufferRange = (PFNGLBINDBUFFERRANGEPROC) WinGlGetProcAddress(wgl, "glBindBufferRange");
+    gl.mapBufferRange = (PFNGLMAPBUFFERRANGEPROC) WinGlGetProcAddress(wgl, "glMapBufferRange");
+    gl.getUniformBlockIndex = (PFNGLGETUNIFORMBLOCKINDEXPROC) WinGlGetProcAddress(wgl, "glGetUniformBlockIndex");
+    gl.uniformBlockBinding = (PFNGLUNIFORMBLOCKBINDINGPROC) WinGlGetProcAddress(wgl, "glUniformBlockBinding");
+    gl.getString = (PFNGLGETSTRINGPROC) WinGlGetProcAddress(wgl, "glGetString");
+    gl.getProgramBinary = (PFNGLGETPROGRAMBINARYPROC) WinGlGetProcAddress(wgl, "glGetProgramBinary");
+    gl.programBinary = (PFNGLPROGRAMBINARYPROC) WinGlGetProcAddress(wgl, "glProgramBinary");
+    gl.programParameteri = (PFNGLPROGRAMPARAMETERIPROC) WinGlGetProcAddress(wgl, "glProgramParameteri");
+    gl.getStringi = (PFNGLGETSTRINGIPROC) WinGlGetProcAddress(wgl, "glGetStringi");
+    gl.finish = (PFNGLFINISHPROC) WinGlGetProcAddress(wgl, "glFinish");
+    gl.genQueries = (PFNGLGENQUERIESPROC) WinGlGetProcAddress(wgl, "glGenQueries");
+    gl.deleteQueries = (PFNGLDELETEQUERIESPROC) WinGlGetProcAddress(wgl, "glDeleteQueries");
+    gl.beginQuery = (PFNGLBEGINQUERYPROC) WinGlGetProcAddress(wgl, "glBeginQuery");
+    gl.endQuery = (PFNGLENDQUERYPROC) WinGlGetProcAddress(wgl, "glEndQuery");
+    gl.getQueryObjectuiv = (PFNGLGETQUERYOBJECTUIVPROC) WinGlGetProcAddress(wgl, "glGetQueryObjectuiv");
+    gl.fenceSync = (PFNGLFENCESYNCPROC) WinGlGetProcAddress(wgl, "glFenceSync");
+    gl.clientWaitSync = (PFNGLCLIENTWAITSYNCPROC) WinGlGetProcAddress(wgl, "glClientWaitSync");
+    gl.deleteSync = (PFNGLDELETESYNCPROC) WinGlGetProcAddress(wgl, "glDeleteSync");
+    gl.genFramebuffers = (PFNGLGENFRAMEBUFFERSPROC) WinGlGetProcAddress(wgl, "glGenFramebuffers");
+    gl.deleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC) WinGlGetProcAddress(wgl, "glDeleteFramebuffers");
+    gl.bindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC) WinGlGetProcAddress(wgl, "glBindFramebuffer");
+    gl.framebufferTexture2D = (PFNGLFRAMEBUFFERTEXTURE2DPROC) WinGlGetProcAddress(wgl, "glFramebufferTexture2D");
+    gl.checkFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC) WinGlGetProcAddress(wgl, "glCheckFramebufferStatus");
+    gl.drawBuffer = (PFNGLDRAWBUFFERPROC) WinGlGetProcAddress(wgl, "glDrawBuffer");
+    gl.readBuffer = (PFNGLREADBUFFERPROC) WinGlGetProcAddress(wgl, "glReadBuffer");
+    gl.viewport = (PFNGLVIEWPORTPROC) WinGlGetProcAddress(wgl, "glViewport");
+    gl.clearColor = (PFNGLCLEARCOLORPROC) WinGlGetProcAddress(wgl, "glClearColor");
+    gl.clearDepth = (PFNGLCLEARDEPTHPROC) WinGlGetProcAddress(wgl, "glClearDepth");
+    gl.clear = (PFNGLCLEARPROC) WinGlGetProcAddress(wgl, "glClear");
+    gl.maxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC) WinGlGetProcAddress(wgl, "glMaxShaderCompilerThreadsKHR");
 }
 
 BOOL WinGlIsWindows10BuildOrGreater(WORD build)
@@ -35,7 +35,8 @@ Clean::FileLoaderInfos JSONMapperLoader::getInfos() const
         .name = "JSONMapperLoader",
         .description = "JSON to ShaderMapper loader.",
         .authors = "Luk2010",
-        .version = Version::FromString("1.0")
+        .version = Version::FromString("1.0"),
+        .extensions = { "json" }
     };
 }
 
@@ -146,6 +147,9 @@ std::shared_ptr < Clean::ShaderMapper > JSONMapperLoader::load(std::string const
                 else 
                     constant.index = static_cast < std::int8_t >(cstMember.value.FindMember("index")->value.GetInt());
                 
+                if (cstMember.value.HasMember("block"))
+                    constant.block = cstMember.value.FindMember("block")->value.GetString();
+                
                 assert(constant.type && "Invalid Constant Type.");
                 result->addConstant(constant);
             }
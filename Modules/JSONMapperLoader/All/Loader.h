@@ -36,6 +36,8 @@ static Clean::Version const kCurrentJSONMapperVersion = Clean::Version::FromStri
  * 'type': Types used for this Attribute. Can be int, unsigned, float, double, vec2, vec3, vec4,
  *      ivec2, ivec3, ivec4, uvec2, uvec3, uvec4, mat2, mat3, mat4, and all glm types. 
  * 'index': Index used for the Attribute in the shader. -1 by default. 
+ * 'block': Name of the uniform block holding the Constant, if any. Constants of a block are packed
+ *      with std140 rules, in the order of this file. \see BuildableShaderMapper::makeBlockLayout.
  *
  * Some fields may be added by the future. 
  *
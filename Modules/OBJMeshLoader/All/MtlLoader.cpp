@@ -23,7 +23,8 @@ FileLoaderInfos MtlLoader::getInfos() const
         .name = "MtlLoader",
         .description = "Mtl Lightwave File Loader",
         .authors = "luk2010",
-        .version = Version::FromString("1.0")
+        .version = Version::FromString("1.0"),
+        .extensions = { "mtl" }
     };
 }
 
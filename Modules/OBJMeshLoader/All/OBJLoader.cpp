@@ -164,7 +164,8 @@ FileLoaderInfos OBJLoader::getInfos() const
         .name = "OBJMeshLoader",
         .description = "Loads OBJ File format meshes.",
         .authors = "Luk2010",
-        .version = Version::FromString("1.0")
+        .version = Version::FromString("1.0"),
+        .extensions = { "obj" }
     };
 }
 
@@ -382,5 +383,9 @@ std::shared_ptr < Mesh > OBJLoader::convertOBJFile(OBJFile &file) const
     result->addBuffers(buffers);
     result->addSubMeshes(submeshes);
     
+    // Coarser levels of detail are generated now, as OBJ files have none. They only add one index buffer
+    // per level, sharing the vertex buffer.
+    result->generateLods();
+    
     return result;
 }
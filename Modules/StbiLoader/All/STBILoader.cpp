@@ -35,6 +35,7 @@ std::shared_ptr < Image > STBILoader::load(std::string const& filepath) const
     
     auto pixels = AllocateShared < PixelSet >();
     pixels->lineWidth = width * 4 * sizeof(unsigned char);
+    pixels->columnsCount = height;
     pixels->format = kPixelFormatRGBA8;
     pixels->data = data;
     
@@ -48,3 +49,16 @@ bool STBILoader::isLoadable(std::string const& ext) const
 {
     return ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "gif";
 }
+
+FileLoaderInfos STBILoader::getInfos() const
+{
+    return
+    {
+        .name = "STBILoader",
+        .description = "Loads PNG, JPEG and GIF images with STB Image.",
+        .authors = "Luk2010",
+        .version = Version::FromString("1.0"),
+        .extensions = { "png", "jpg", "jpeg", "gif" },
+        .magics = { { 0, "\x89PNG" }, { 0, "\xFF\xD8\xFF" }, { 0, "GIF8" } }
+    };
+}
@@ -17,6 +17,9 @@ public:
     
     /*! @brief Must return true if the given extension is loadable by this loader. */
     bool isLoadable(std::string const& extension) const;
+    
+    /*! @brief Returns informations about this loader. */
+    Clean::FileLoaderInfos getInfos() const;
 };
 
 #endif // STBILOADER_STBILOADER_H
@@ -0,0 +1,132 @@
+/**
+ * Clean AtlasBench
+ *
+ * Offline benchmark of TextureAtlas. Packs the given images (any image loadable by Clean::ImageManager) in
+ * atlas pages, and compares the RenderCommands needed to draw one object by image: without the atlas, each
+ * image is a different texture, thus a different command. With the atlas, objects textured by images of the
+ * same page are sub commands of one command made by TextureAtlas::sub(), and only their UV transform changes
+ * between two draws. The number of draw calls is the same, but texture and pipeline binds are saved.
+ *
+ * Pages are only packed, not uploaded: no Driver is needed.
+ *
+ * Usage: AtlasBench <page size> <image> [image...]
+ *
+**/
+
+#include <Clean/NotificationListener.h>
+#include <Clean/Core.h>
+#include <Clean/Allocate.h>
+#include <Clean/TextureAtlas.h>
+#include <Clean/RenderCommand.h>
+
+#include <iostream>
+#include <chrono>
+#include <map>
+
+/** @brief Displays warnings and errors to std::cerr. */
+class NotificationListener : public Clean::NotificationListener
+{
+public:
+
+    /*! @brief Displays notification to std::cerr. */
+    void process(Clean::Notification const& notification)
+    {
+        if (notification.level == Clean::kNotificationLevelInfo)
+            return;
+
+        std::cerr << "[" << notification.function << "] " << notification.message << std::endl;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    using namespace Clean;
+
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <page size> <image> [image...]" << std::endl;
+        return 1;
+    }
+
+    const std::size_t pageSize = static_cast < std::size_t >(std::atoi(argv[1]));
+
+    if (!pageSize)
+    {
+        std::cerr << "Invalid page size '" << argv[1] << "'." << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        Core& core = Core::Create(AllocateShared < ::NotificationListener >());
+
+        if (!core.loadAllModules() && !core.getDeferredModuleCount())
+        {
+            std::cerr << "No module found." << std::endl;
+            return 1;
+        }
+
+        TextureAtlas atlas(pageSize, pageSize / 2);
+        std::vector < std::shared_ptr < Image > > images;
+
+        for (int i = 2; i < argc; ++i)
+        {
+            auto image = atlas.add(std::string(argv[i]));
+
+            if (!image)
+            {
+                std::cerr << "Image " << argv[i] << " is not accepted by the atlas." << std::endl;
+                continue;
+            }
+
+            images.push_back(image);
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        const std::size_t packed = atlas.pack();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        // Without the atlas: one command by texture, each drawing one quad.
+        std::vector < RenderCommand > separate;
+
+        for (std::size_t i = 0; i < images.size(); ++i)
+        {
+            separate.emplace_back();
+            separate.back().sub(kDrawingMethodFilled, ShaderAttributesMap(6));
+        }
+
+        // With the atlas: one command by page, each image is a sub command of it.
+        std::map < std::size_t, RenderCommand > batched;
+
+        for (auto const& image : images)
+        {
+            TextureAtlasRegion region;
+            if (!atlas.findRegion(*image, region)) continue;
+
+            atlas.sub(*image, batched[region.page], kDrawingMethodFilled, ShaderAttributesMap(6));
+        }
+
+        std::size_t subCommands = 0;
+
+        for (auto const& pair : batched)
+            subCommands += pair.second.subCommands.size();
+
+        std::cout << packed << " images packed in " << atlas.getPagesCount() << " pages of " << pageSize << "x" << pageSize
+            << " in " << std::chrono::duration_cast < std::chrono::microseconds >(end - start).count() << " us." << std::endl;
+
+        for (std::size_t i = 0; i < atlas.getPagesCount(); ++i)
+            std::cout << "  Page " << i << ": " << static_cast < int >(atlas.getOccupancy(i) * 100.0f) << "% used." << std::endl;
+
+        std::cout << "RenderCommands: " << separate.size() << " without atlas, " << batched.size() << " with atlas ("
+            << subCommands << " draws in both cases)." << std::endl;
+
+        core.destroy();
+        return 0;
+    }
+
+    catch (std::exception const& e)
+    {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,191 @@
+/**
+ * Clean TextureCompressor
+ *
+ * Offline tool that encodes any image loadable by Clean::ImageManager (thus by any loaded module, like
+ * STBILoader) to a block-compressed DDS file. The full mipmaps chain is generated with MipmapGenerate() if
+ * the source has none, so the Driver never has to build it at runtime. Every level is encoded, and blocks
+ * are encoded on all available threads.
+ *
+ * Usage: TextureCompressor <input> <output.dds> [bc1|bc3] [threads] [box|kaiser|none]
+ *
+ * The last argument is the mipmaps filter, box by default. 'none' only encodes the levels of the source.
+ *
+ * Notes that STBILoader flips images vertically for OpenGL. As DDSLoader does not flip compressed images,
+ * DDS files produced from STBILoader images have the same orientation than the original textures once
+ * uploaded by the Driver.
+ *
+**/
+
+#include <Clean/NotificationListener.h>
+#include <Clean/Core.h>
+#include <Clean/Allocate.h>
+#include <Clean/ImageManager.h>
+#include <Clean/PixelSetConverterManager.h>
+#include <Clean/BlockEncoder.h>
+#include <Clean/MipmapGenerator.h>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+
+/** @brief Displays warnings and errors to std::cerr. */
+class NotificationListener : public Clean::NotificationListener
+{
+public:
+
+    /*! @brief Displays notification to std::cerr. */
+    void process(Clean::Notification const& notification)
+    {
+        if (notification.level == Clean::kNotificationLevelInfo)
+            return;
+
+        std::cerr << "[" << notification.function << "] " << notification.message << std::endl;
+    }
+};
+
+/*! @brief Writes a 32 bits little-endian value to a stream. */
+static void WriteU32(std::ostream& stream, std::uint32_t value)
+{
+    const char bytes[4] = {
+        static_cast < char >(value & 0xFF), static_cast < char >((value >> 8) & 0xFF),
+        static_cast < char >((value >> 16) & 0xFF), static_cast < char >((value >> 24) & 0xFF) };
+    stream.write(bytes, 4);
+}
+
+/*! @brief Writes a block-compressed PixelSet with its levels to a DDS file. */
+static bool WriteDDS(std::string const& path, Clean::PixelSet const& pixels)
+{
+    std::ofstream stream(path, std::ios::out | std::ios::binary);
+    if (!stream) return false;
+
+    const std::uint32_t fourCC = (pixels.format == Clean::kPixelFormatBC1) ? 0x31545844 : 0x35545844;
+    const std::uint32_t mipMapCount = static_cast < std::uint32_t >(pixels.levels.size());
+
+    WriteU32(stream, 0x20534444);                                           // 'DDS '
+    WriteU32(stream, 124);                                                  // dwSize
+    WriteU32(stream, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000);         // CAPS, HEIGHT, WIDTH, PIXELFORMAT, MIPMAPCOUNT, LINEARSIZE
+    WriteU32(stream, static_cast < std::uint32_t >(pixels.levels[0].height));
+    WriteU32(stream, static_cast < std::uint32_t >(pixels.levels[0].width));
+    WriteU32(stream, static_cast < std::uint32_t >(pixels.levels[0].size));
+    WriteU32(stream, 0);                                                    // dwDepth
+    WriteU32(stream, mipMapCount);
+    for (int i = 0; i < 11; ++i) WriteU32(stream, 0);                       // dwReserved1
+
+    WriteU32(stream, 32);                                                   // ddspf.dwSize
+    WriteU32(stream, 0x4);                                                  // DDPF_FOURCC
+    WriteU32(stream, fourCC);
+    for (int i = 0; i < 5; ++i) WriteU32(stream, 0);                        // Bit count and masks
+
+    WriteU32(stream, 0x1000 | (mipMapCount > 1 ? 0x400008 : 0));           // TEXTURE, MIPMAP | COMPLEX
+    for (int i = 0; i < 4; ++i) WriteU32(stream, 0);                        // dwCaps2-4, dwReserved2
+
+    for (auto const& level : pixels.levels)
+        stream.write(reinterpret_cast < const char* >(pixels.data + level.offset), level.size);
+
+    return static_cast < bool >(stream);
+}
+
+int main(int argc, char** argv)
+{
+    using namespace Clean;
+
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input> <output.dds> [bc1|bc3] [threads] [box|kaiser|none]" << std::endl;
+        return 1;
+    }
+
+    const std::string input = argv[1];
+    const std::string output = argv[2];
+    const std::string formatName = (argc > 3) ? argv[3] : "bc3";
+    const std::size_t threads = (argc > 4) ? static_cast < std::size_t >(std::atoi(argv[4])) : 0;
+    const std::string filterName = (argc > 5) ? argv[5] : "box";
+
+    std::uint8_t format = kPixelFormatNull;
+    if (formatName == "bc1") format = kPixelFormatBC1;
+    else if (formatName == "bc3") format = kPixelFormatBC3;
+
+    if (!BlockEncoderSupports(format))
+    {
+        std::cerr << "Unsupported format '" << formatName << "'. Use bc1 or bc3." << std::endl;
+        return 1;
+    }
+
+    if (filterName != "box" && filterName != "kaiser" && filterName != "none")
+    {
+        std::cerr << "Unsupported mipmaps filter '" << filterName << "'. Use box, kaiser or none." << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        Core& core = Core::Create(AllocateShared < ::NotificationListener >());
+
+        if (!core.loadAllModules() && !core.getDeferredModuleCount())
+        {
+            std::cerr << "No module found." << std::endl;
+            return 1;
+        }
+
+        auto image = ImageManager::Current().load(input);
+
+        if (!image || !image->getPixelSet())
+        {
+            std::cerr << "Can't load image " << input << "." << std::endl;
+            return 1;
+        }
+
+        auto pixels = image->getPixelSet();
+
+        if (pixels->format != kPixelFormatRGBA8)
+        {
+            auto converter = PixelSetConverterManager::Current().findConverter(pixels->format, kPixelFormatRGBA8);
+
+            if (!converter)
+            {
+                std::cerr << "Can't convert " << PixelFormatToString(pixels->format) << " to RGBA8." << std::endl;
+                return 1;
+            }
+
+            pixels = converter->convert(pixels);
+        }
+
+        // Images loaded by STBILoader have no levels. Colors are filtered in sRGB space, as the Driver does.
+        if (pixels->levels.empty() && filterName != "none")
+        {
+            auto chain = MipmapGenerate(pixels, filterName == "kaiser" ? kMipmapFilterKaiser : kMipmapFilterBox, true, threads);
+
+            if (!chain)
+            {
+                std::cerr << "Can't generate the mipmaps of " << input << "." << std::endl;
+                return 1;
+            }
+
+            pixels = chain;
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        auto encoded = BlockEncodePixelSet(pixels, format, threads);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        if (!encoded || !WriteDDS(output, *encoded))
+        {
+            std::cerr << "Can't write " << output << "." << std::endl;
+            return 1;
+        }
+
+        std::cout << input << " -> " << output << " (" << PixelFormatToString(format) << ", "
+            << encoded->levels.size() << " levels) in "
+            << std::chrono::duration_cast < std::chrono::milliseconds >(end - start).count() << " ms." << std::endl;
+
+        core.destroy();
+        return 0;
+    }
+
+    catch (std::exception const& e)
+    {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -3,15 +3,30 @@ layout (location = 0) in vec4 aPos;
 layout (location = 1) in vec4 aColor;
 layout (location = 2) in vec3 aTexCoord;
 
-uniform mat4 uProjection;
-uniform mat4 uView;
+// Camera's matrices, uploaded at once by a ParameterBlock. Members are in the order of the mapper's constants.
+layout (std140) uniform Camera
+{
+	mat4 uProjection;
+	mat4 uView;
+};
+
+// Scale (xy) and offset (zw) of the texture coordinates, to sample a region of a TextureAtlas page.
+struct Material
+{
+	vec4 diffuseUV;
+};
+
+uniform Material material;
+
+// Model matrix of the drawn instance.
+uniform mat4 uModel;
 
 out vec3 ourColor;
 out vec2 TexCoord;
 
 void main()
 {
-	gl_Position = uProjection * uView * aPos;
+	gl_Position = uProjection * uView * uModel * aPos;
 	ourColor = aColor.rgb;
-	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+	TexCoord = aTexCoord.xy * material.diffuseUV.xy + material.diffuseUV.zw;
 }
\ No newline at end of file